@@ -326,7 +326,7 @@ template <typename Stream> void AddrManImpl::Unserialize(Stream &s_) {
             vRandom.push_back(nIdCount);
             mapInfo[nIdCount] = info;
             mapAddr[info] = nIdCount;
-            vvTried[nKBucket][nKBucketPos] = nIdCount;
+            SetTried(nKBucket, nKBucketPos, nIdCount);
             nIdCount++;
         } else {
             nLost++;
@@ -389,7 +389,7 @@ template <typename Stream> void AddrManImpl::Unserialize(Stream &s_) {
         if (restore_bucketing && vvNew[bucket][bucket_position] == -1) {
             // Bucketing has not changed, using existing bucket positions
             // for the new table
-            vvNew[bucket][bucket_position] = entry_index;
+            SetNew(bucket, bucket_position, entry_index);
             ++info.nRefCount;
         } else {
             // In case the new table data cannot be used (bucket count
@@ -398,7 +398,7 @@ template <typename Stream> void AddrManImpl::Unserialize(Stream &s_) {
             bucket = info.GetNewBucket(nKey, m_asmap);
             bucket_position = info.GetBucketPosition(nKey, true, bucket);
             if (vvNew[bucket][bucket_position] == -1) {
-                vvNew[bucket][bucket_position] = entry_index;
+                SetNew(bucket, bucket_position, entry_index);
                 ++info.nRefCount;
             }
         }
@@ -451,14 +451,39 @@ AddrInfo *AddrManImpl::Create(const CAddress &addr, const CNetAddr &addrSource,
     AssertLockHeld(cs);
 
     int nId = nIdCount++;
-    mapInfo[nId] = AddrInfo(addr, addrSource);
+    AddrInfo &info{mapInfo.insert_or_assign(nId, AddrInfo(addr, addrSource))
+                       .first->second};
     mapAddr[addr] = nId;
-    mapInfo[nId].nRandomPos = vRandom.size();
+    info.nRandomPos = vRandom.size();
     vRandom.push_back(nId);
     if (pnId) {
         *pnId = nId;
     }
-    return &mapInfo[nId];
+    return &info;
+}
+
+void AddrManImpl::SetTried(int bucket, int pos, int nId) {
+    AssertLockHeld(cs);
+
+    int &entry{vvTried[bucket][pos]};
+    if (entry == -1 && nId != -1) {
+        m_tried_occupancy.Add(bucket);
+    } else if (entry != -1 && nId == -1) {
+        m_tried_occupancy.Remove(bucket);
+    }
+    entry = nId;
+}
+
+void AddrManImpl::SetNew(int bucket, int pos, int nId) {
+    AssertLockHeld(cs);
+
+    int &entry{vvNew[bucket][pos]};
+    if (entry == -1 && nId != -1) {
+        m_new_occupancy.Add(bucket);
+    } else if (entry != -1 && nId == -1) {
+        m_new_occupancy.Remove(bucket);
+    }
+    entry = nId;
 }
 
 void AddrManImpl::SwapRandom(unsigned int nRndPos1,
@@ -510,7 +535,7 @@ void AddrManImpl::ClearNew(int nUBucket, int nUBucketPos) {
         AddrInfo &infoDelete = mapInfo[nIdDelete];
         assert(infoDelete.nRefCount > 0);
         infoDelete.nRefCount--;
-        vvNew[nUBucket][nUBucketPos] = -1;
+        SetNew(nUBucket, nUBucketPos, -1);
         LogPrint(BCLog::ADDRMAN, "Removed %s from new[%i][%i]\n",
                  infoDelete.ToString(), nUBucket, nUBucketPos);
         if (infoDelete.nRefCount == 0) {
@@ -528,7 +553,7 @@ void AddrManImpl::MakeTried(AddrInfo &info, int nId) {
         const int bucket{(start_bucket + n) % ADDRMAN_NEW_BUCKET_COUNT};
         const int pos{info.GetBucketPosition(nKey, true, bucket)};
         if (vvNew[bucket][pos] == nId) {
-            vvNew[bucket][pos] = -1;
+            SetNew(bucket, pos, -1);
             info.nRefCount--;
             if (info.nRefCount == 0) {
                 break;
@@ -553,7 +578,7 @@ void AddrManImpl::MakeTried(AddrInfo &info, int nId) {
 
         // Remove the to-be-evicted item from the tried set.
         infoOld.fInTried = false;
-        vvTried[nKBucket][nKBucketPos] = -1;
+        SetTried(nKBucket, nKBucketPos, -1);
         nTried--;
 
         // find which new bucket it belongs to
@@ -564,7 +589,7 @@ void AddrManImpl::MakeTried(AddrInfo &info, int nId) {
 
         // Enter it into the new set again.
         infoOld.nRefCount = 1;
-        vvNew[nUBucket][nUBucketPos] = nIdEvict;
+        SetNew(nUBucket, nUBucketPos, nIdEvict);
         nNew++;
         LogPrint(BCLog::ADDRMAN,
                  "Moved %s from tried[%i][%i] to new[%i][%i] to make space\n",
@@ -573,13 +598,33 @@ void AddrManImpl::MakeTried(AddrInfo &info, int nId) {
     }
     assert(vvTried[nKBucket][nKBucketPos] == -1);
 
-    vvTried[nKBucket][nKBucketPos] = nId;
+    SetTried(nKBucket, nKBucketPos, nId);
     nTried++;
     info.fInTried = true;
 }
 
+std::vector<AddrManImpl::NewTablePos>
+AddrManImpl::GetNewTablePositions(const uint256 &key,
+                                  const std::vector<CAddress> &vAddr,
+                                  const CNetAddr &source) const {
+    std::vector<NewTablePos> positions;
+    positions.reserve(vAddr.size());
+    for (const CAddress &addr : vAddr) {
+        if (!addr.IsRoutable()) {
+            positions.push_back({-1, -1});
+            continue;
+        }
+        const AddrInfo info{addr, source};
+        const int bucket{info.GetNewBucket(key, m_asmap)};
+        positions.push_back(
+            {bucket, info.GetBucketPosition(key, true, bucket)});
+    }
+    return positions;
+}
+
 bool AddrManImpl::AddSingle(const CAddress &addr, const CNetAddr &source,
-                            std::chrono::seconds time_penalty) {
+                            std::chrono::seconds time_penalty,
+                            const NewTablePos &new_pos) {
     AssertLockHeld(cs);
 
     if (!addr.IsRoutable()) {
@@ -636,8 +681,8 @@ bool AddrManImpl::AddSingle(const CAddress &addr, const CNetAddr &source,
         nNew++;
     }
 
-    int nUBucket = pinfo->GetNewBucket(nKey, source, m_asmap);
-    int nUBucketPos = pinfo->GetBucketPosition(nKey, true, nUBucket);
+    const int nUBucket{new_pos.bucket};
+    const int nUBucketPos{new_pos.position};
     bool fInsert = vvNew[nUBucket][nUBucketPos] == -1;
     if (vvNew[nUBucket][nUBucketPos] != nId) {
         if (!fInsert) {
@@ -651,7 +696,7 @@ bool AddrManImpl::AddSingle(const CAddress &addr, const CNetAddr &source,
         if (fInsert) {
             ClearNew(nUBucket, nUBucketPos);
             pinfo->nRefCount++;
-            vvNew[nUBucket][nUBucketPos] = nId;
+            SetNew(nUBucket, nUBucketPos, nId);
             LogPrint(BCLog::ADDRMAN, "Added %s mapped to AS%i to new[%i][%i]\n",
                      addr.ToString(), addr.GetMappedAS(m_asmap), nUBucket,
                      nUBucketPos);
@@ -725,12 +770,14 @@ void AddrManImpl::Good_(const CService &addr, bool test_before_evict,
 }
 
 bool AddrManImpl::Add_(const std::vector<CAddress> &vAddr,
+                       const std::vector<NewTablePos> &positions,
                        const CNetAddr &source,
                        std::chrono::seconds time_penalty) {
+    assert(positions.size() == vAddr.size());
     int added{0};
-    for (std::vector<CAddress>::const_iterator it = vAddr.begin();
-         it != vAddr.end(); it++) {
-        added += AddSingle(*it, source, time_penalty) ? 1 : 0;
+    for (size_t i = 0; i < vAddr.size(); ++i) {
+        added +=
+            AddSingle(vAddr[i], source, time_penalty, positions[i]) ? 1 : 0;
     }
     if (added > 0) {
         LogPrint(BCLog::ADDRMAN,
@@ -778,8 +825,12 @@ std::pair<CAddress, NodeSeconds> AddrManImpl::Select_(bool newOnly) const {
         // use a tried node
         double fChanceFactor = 1.0;
         while (1) {
-            // Pick a tried bucket, and an initial position in that bucket.
-            int nKBucket = insecure_rand.randrange(ADDRMAN_TRIED_BUCKET_COUNT);
+            // Pick a non-empty tried bucket, and an initial position in that
+            // bucket. This is equivalent to picking any bucket and starting
+            // over as long as it is empty, without the retries.
+            int nKBucket = m_tried_occupancy.GetNonEmptyBucket(
+                insecure_rand.randrange(
+                    m_tried_occupancy.NumNonEmptyBuckets()));
             int nKBucketPos = insecure_rand.randrange(ADDRMAN_BUCKET_SIZE);
             // Iterate over the positions of that bucket, starting at the
             // initial one, and looping around.
@@ -790,11 +841,7 @@ std::pair<CAddress, NodeSeconds> AddrManImpl::Select_(bool newOnly) const {
                     break;
                 }
             }
-            // If the bucket is entirely empty, start over with a (likely)
-            // different one.
-            if (i == ADDRMAN_BUCKET_SIZE) {
-                continue;
-            }
+            assert(i < ADDRMAN_BUCKET_SIZE);
             // Find the entry to return.
             int nId =
                 vvTried[nKBucket][(nKBucketPos + i) % ADDRMAN_BUCKET_SIZE];
@@ -816,8 +863,10 @@ std::pair<CAddress, NodeSeconds> AddrManImpl::Select_(bool newOnly) const {
         // use a new node
         double fChanceFactor = 1.0;
         while (1) {
-            // Pick a new bucket, and an initial position in that bucket.
-            int nUBucket = insecure_rand.randrange(ADDRMAN_NEW_BUCKET_COUNT);
+            // Pick a non-empty new bucket, and an initial position in that
+            // bucket.
+            int nUBucket = m_new_occupancy.GetNonEmptyBucket(
+                insecure_rand.randrange(m_new_occupancy.NumNonEmptyBuckets()));
             int nUBucketPos = insecure_rand.randrange(ADDRMAN_BUCKET_SIZE);
             // Iterate over the positions of that bucket, starting at the
             // initial one, and looping around.
@@ -828,11 +877,7 @@ std::pair<CAddress, NodeSeconds> AddrManImpl::Select_(bool newOnly) const {
                     break;
                 }
             }
-            // If the bucket is entirely empty, start over with a (likely)
-            // different one.
-            if (i == ADDRMAN_BUCKET_SIZE) {
-                continue;
-            }
+            assert(i < ADDRMAN_BUCKET_SIZE);
             // Find the entry to return.
             int nId = vvNew[nUBucket][(nUBucketPos + i) % ADDRMAN_BUCKET_SIZE];
             const auto it_found{mapInfo.find(nId)};
@@ -1119,9 +1164,12 @@ int AddrManImpl::CheckAddrman() const {
         return -10;
     }
 
+    size_t tried_nonempty_buckets{0};
     for (int n = 0; n < ADDRMAN_TRIED_BUCKET_COUNT; n++) {
+        int entries{0};
         for (int i = 0; i < ADDRMAN_BUCKET_SIZE; i++) {
             if (vvTried[n][i] != -1) {
+                ++entries;
                 if (!setTried.count(vvTried[n][i])) {
                     return -11;
                 }
@@ -1136,11 +1184,21 @@ int AddrManImpl::CheckAddrman() const {
                 setTried.erase(vvTried[n][i]);
             }
         }
+        if (m_tried_occupancy.NumEntries(n) != entries) {
+            return -20;
+        }
+        tried_nonempty_buckets += entries > 0;
+    }
+    if (m_tried_occupancy.NumNonEmptyBuckets() != tried_nonempty_buckets) {
+        return -20;
     }
 
+    size_t new_nonempty_buckets{0};
     for (int n = 0; n < ADDRMAN_NEW_BUCKET_COUNT; n++) {
+        int entries{0};
         for (int i = 0; i < ADDRMAN_BUCKET_SIZE; i++) {
             if (vvNew[n][i] != -1) {
+                ++entries;
                 if (!mapNew.count(vvNew[n][i])) {
                     return -12;
                 }
@@ -1154,6 +1212,13 @@ int AddrManImpl::CheckAddrman() const {
                 }
             }
         }
+        if (m_new_occupancy.NumEntries(n) != entries) {
+            return -21;
+        }
+        new_nonempty_buckets += entries > 0;
+    }
+    if (m_new_occupancy.NumNonEmptyBuckets() != new_nonempty_buckets) {
+        return -21;
     }
 
     if (setTried.size()) {
@@ -1178,9 +1243,19 @@ size_t AddrManImpl::size() const {
 bool AddrManImpl::Add(const std::vector<CAddress> &vAddr,
                       const CNetAddr &source,
                       std::chrono::seconds time_penalty) {
+    // Hash the positions of the addresses in the new table before taking the
+    // lock, so large ADDR messages do not hold it for long.
+    const uint256 key{WITH_LOCK(cs, return nKey)};
+    std::vector<NewTablePos> positions{
+        GetNewTablePositions(key, vAddr, source)};
+
     LOCK(cs);
+    if (nKey != key) {
+        // The table was cleared or loaded in the meantime.
+        positions = GetNewTablePositions(nKey, vAddr, source);
+    }
     Check();
-    auto ret = Add_(vAddr, source, time_penalty);
+    auto ret = Add_(vAddr, positions, source, time_penalty);
     Check();
     return ret;
 }
@@ -1272,6 +1347,8 @@ void AddrManImpl::Clear() {
             vvTried[bucket][entry] = -1;
         }
     }
+    m_new_occupancy.Clear();
+    m_tried_occupancy.Clear();
 
     nIdCount = 0;
     nTried = 0;
@@ -15,6 +15,8 @@
 #include <uint256.h>
 #include <util/time.h>
 
+#include <array>
+#include <cassert>
 #include <cstdint>
 #include <optional>
 #include <set>
@@ -106,6 +108,51 @@ public:
     double GetChance(NodeSeconds now = Now<NodeSeconds>()) const;
 };
 
+/**
+ * Index of the non-empty buckets of an address table, so that one of them can
+ * be picked at random in constant time however sparse the table is.
+ */
+template <int BUCKET_COUNT> class BucketOccupancy {
+public:
+    BucketOccupancy() { Clear(); }
+
+    //! Account for a position of the bucket becoming occupied.
+    void Add(int bucket) {
+        if (m_num_entries[bucket]++ == 0) {
+            m_nonempty_index[bucket] = m_nonempty_buckets.size();
+            m_nonempty_buckets.push_back(bucket);
+        }
+    }
+
+    //! Account for a position of the bucket becoming free.
+    void Remove(int bucket) {
+        assert(m_num_entries[bucket] > 0);
+        if (--m_num_entries[bucket] == 0) {
+            const int index{m_nonempty_index[bucket]};
+            m_nonempty_buckets[index] = m_nonempty_buckets.back();
+            m_nonempty_index[m_nonempty_buckets[index]] = index;
+            m_nonempty_buckets.pop_back();
+        }
+    }
+
+    void Clear() {
+        m_num_entries.fill(0);
+        m_nonempty_buckets.clear();
+    }
+
+    int NumEntries(int bucket) const { return m_num_entries[bucket]; }
+    size_t NumNonEmptyBuckets() const { return m_nonempty_buckets.size(); }
+    int GetNonEmptyBucket(size_t index) const {
+        return m_nonempty_buckets[index];
+    }
+
+private:
+    std::array<int, BUCKET_COUNT> m_num_entries;
+    //! Position of each non-empty bucket in m_nonempty_buckets
+    std::array<int, BUCKET_COUNT> m_nonempty_index;
+    std::vector<int> m_nonempty_buckets;
+};
+
 class AddrManImpl {
 public:
     AddrManImpl(std::vector<bool> &&asmap, int32_t consistency_check_ratio);
@@ -221,6 +268,11 @@ private:
     //! list of "new" buckets
     int vvNew[ADDRMAN_NEW_BUCKET_COUNT][ADDRMAN_BUCKET_SIZE] GUARDED_BY(cs);
 
+    //! non-empty buckets of vvTried and vvNew, for Select_()
+    BucketOccupancy<ADDRMAN_TRIED_BUCKET_COUNT>
+        m_tried_occupancy GUARDED_BY(cs);
+    BucketOccupancy<ADDRMAN_NEW_BUCKET_COUNT> m_new_occupancy GUARDED_BY(cs);
+
     //! last time Good was called (memory only)
     NodeSeconds m_last_good GUARDED_BY(cs);
 
@@ -263,6 +315,12 @@ private:
     AddrInfo *Create(const CAddress &addr, const CNetAddr &addrSource,
                      int *pnId = nullptr) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
+    //! Set a position of vvTried, keeping m_tried_occupancy up to date.
+    void SetTried(int bucket, int pos, int nId) EXCLUSIVE_LOCKS_REQUIRED(cs);
+
+    //! Set a position of vvNew, keeping m_new_occupancy up to date.
+    void SetNew(int bucket, int pos, int nId) EXCLUSIVE_LOCKS_REQUIRED(cs);
+
     //! Swap two elements in vRandom.
     void SwapRandom(unsigned int nRandomPos1, unsigned int nRandomPos2) const
         EXCLUSIVE_LOCKS_REQUIRED(cs);
@@ -277,19 +335,39 @@ private:
     //! Move an entry from the "new" table(s) to the "tried" table
     void MakeTried(AddrInfo &info, int nId) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
+    //! Bucket and position in the "new" table of an address from a source.
+    struct NewTablePos {
+        int bucket;
+        int position;
+    };
+
+    /**
+     * Compute the positions in the "new" table of the routable addresses
+     * received from a source, with the given key. It only hashes, and is
+     * meant to be called without holding cs.
+     */
+    std::vector<NewTablePos>
+    GetNewTablePositions(const uint256 &key, const std::vector<CAddress> &vAddr,
+                         const CNetAddr &source) const;
+
     /**
      * Attempt to add a single address to addrman's new table.
-     * @see AddrMan::Add() for parameters.
+     * @param[in] new_pos  The position of the address from the source in the
+     *                     new table, for the current nKey.
+     * @see AddrMan::Add() for the other parameters.
      */
     bool AddSingle(const CAddress &addr, const CNetAddr &source,
-                   std::chrono::seconds time_penalty)
-        EXCLUSIVE_LOCKS_REQUIRED(cs);
+                   std::chrono::seconds time_penalty,
+                   const NewTablePos &new_pos) EXCLUSIVE_LOCKS_REQUIRED(cs);
 
     void Good_(const CService &addr, bool test_before_evict, NodeSeconds time)
         EXCLUSIVE_LOCKS_REQUIRED(cs);
 
-    bool Add_(const std::vector<CAddress> &vAddr, const CNetAddr &source,
-              std::chrono::seconds time_penalty) EXCLUSIVE_LOCKS_REQUIRED(cs);
+    //! @param[in] positions  The result of GetNewTablePositions() for nKey.
+    bool Add_(const std::vector<CAddress> &vAddr,
+              const std::vector<NewTablePos> &positions,
+              const CNetAddr &source, std::chrono::seconds time_penalty)
+        EXCLUSIVE_LOCKS_REQUIRED(cs);
 
     void Attempt_(const CService &addr, bool fCountFailure, NodeSeconds time)
         EXCLUSIVE_LOCKS_REQUIRED(cs);
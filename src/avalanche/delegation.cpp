@@ -7,6 +7,7 @@
 #include <avalanche/proof.h>
 #include <avalanche/validation.h>
 #include <hash.h>
+#include <pubkey.h>
 #include <streams.h>
 #include <util/strencodings.h>
 #include <util/translation.h>
@@ -79,6 +80,25 @@ bool Delegation::verify(DelegationState &state, CPubKey &auth) const {
                              "too-many-levels");
     }
 
+    if (levels.size() > 1) {
+        // Check all the levels at once, and only look for the invalid one if
+        // the batch fails.
+        SchnorrBatch batch;
+        reduceLevels(hash, levels, [&](const Level &l) {
+            batch.Add(*pauth, hash, l.sig);
+            pauth = &l.pubkey;
+            return true;
+        });
+
+        if (batch.Verify()) {
+            auth = *pauth;
+            return true;
+        }
+
+        hash = getProofId();
+        pauth = &proofMaster;
+    }
+
     bool ret = reduceLevels(hash, levels, [&](const Level &l) {
         if (!pauth->VerifySchnorr(hash, l.sig)) {
             return state.Invalid(DelegationResult::INVALID_SIGNATURE,
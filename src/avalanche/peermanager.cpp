@@ -12,6 +12,7 @@
 #include <common/args.h>
 #include <consensus/activation.h>
 #include <logging.h>
+#include <primitives/block.h>
 #include <random.h>
 #include <scheduler.h>
 #include <threadsafety.h>
@@ -93,11 +94,8 @@ bool PeerManager::addNodeToPeer(const PeerSet::iterator &it) {
         }
 
         // We need to allocate this peer.
-        p.index = uint32_t(slots.size());
         const Score score = p.getScore();
-        const uint64_t start = slotCount;
-        slots.emplace_back(start, score, it->peerid);
-        slotCount = start + score;
+        p.index = slots.insert(it->peerid, score);
 
         // Add to our allocated score when we allocate a new peer in the slots
         connectedPeersScore += score;
@@ -163,18 +161,11 @@ bool PeerManager::removeNodeFromPeer(const PeerSet::iterator &it,
         assert(removed);
     }
 
-    const size_t i = it->index;
+    const uint32_t i = it->index;
     assert(i < slots.size());
-    assert(connectedPeersScore >= slots[i].getScore());
-    connectedPeersScore -= slots[i].getScore();
-
-    if (i + 1 == slots.size()) {
-        slots.pop_back();
-        slotCount = slots.empty() ? 0 : slots.back().getStop();
-    } else {
-        fragmentation += slots[i].getScore();
-        slots[i] = slots[i].withPeerId(NO_PEER);
-    }
+    assert(connectedPeersScore >= slots.getScore(i));
+    connectedPeersScore -= slots.getScore(i);
+    slots.remove(i);
 
     return true;
 }
@@ -529,11 +520,9 @@ NodeId PeerManager::selectNode() {
     for (int retry = 0; retry < SELECT_NODE_MAX_RETRY; retry++) {
         const PeerId p = selectPeer();
 
-        // If we cannot find a peer, it may be due to the fact that it is
-        // unlikely due to high fragmentation, so compact and retry.
+        // There is no peer with nodes attached.
         if (p == NO_PEER) {
-            compact();
-            continue;
+            break;
         }
 
         // See if that peer has an available node.
@@ -552,15 +541,50 @@ NodeId PeerManager::selectNode() {
 }
 
 std::unordered_set<ProofRef, SaltedProofHasher> PeerManager::updatedBlockTip() {
+    const auto start{SteadyClock::now()};
+
     std::vector<ProofId> invalidProofIds;
     std::vector<ProofRef> newImmatures;
+    uint64_t checkedProofCount{0};
+    bool incremental{false};
 
     {
         LOCK(cs_main);
 
+        const CBlockIndex *tip = chainman.ActiveTip();
+        const BlockHash tipHash = tip ? tip->GetBlockHash() : BlockHash();
+        const int64_t tipMedianTimePast = tip ? tip->GetMedianTimePast() : 0;
+
+        // If the blocks connected since the last revalidation lead to the new
+        // tip, the stakes of the other proofs are still in the UTXO set and
+        // they can't become immature since no block was disconnected. In any
+        // other case, including when the tip did not change, all the proofs
+        // are checked against the UTXO set.
+        incremental = lastConnectedBlockHash &&
+                      *lastConnectedBlockHash == tipHash &&
+                      tipHash != lastRevalidationTipHash;
+
+        // Disable thread safety analysis here because it does not play nicely
+        // with the lambda
+        auto verify = [&](const ProofRef &proof, ProofValidationState &state)
+            NO_THREAD_SAFETY_ANALYSIS {
+                AssertLockHeld(cs_main);
+                if (incremental && !proofsToRevalidate.count(proof->getId())) {
+                    // Only the expiration is left to check.
+                    if (proof->isExpired(tipMedianTimePast)) {
+                        return state.Invalid(ProofValidationResult::EXPIRED,
+                                             "expired-proof");
+                    }
+                    return true;
+                }
+
+                ++checkedProofCount;
+                return proof->verify(stakeUtxoDustThreshold, chainman, state);
+            };
+
         for (const auto &p : peers) {
             ProofValidationState state;
-            if (!p.proof->verify(stakeUtxoDustThreshold, chainman, state)) {
+            if (!verify(p.proof, state)) {
                 if (isImmatureState(state)) {
                     newImmatures.push_back(p.proof);
                 }
@@ -578,7 +602,7 @@ std::unordered_set<ProofRef, SaltedProofHasher> PeerManager::updatedBlockTip() {
             [&](const ProofRef &proof) NO_THREAD_SAFETY_ANALYSIS {
                 AssertLockHeld(cs_main);
                 ProofValidationState state;
-                if (!proof->verify(stakeUtxoDustThreshold, chainman, state)) {
+                if (!verify(proof, state)) {
                     invalidProofIds.push_back(proof->getId());
 
                     LogPrint(
@@ -588,6 +612,10 @@ std::unordered_set<ProofRef, SaltedProofHasher> PeerManager::updatedBlockTip() {
                         proof->getId().GetHex(), state.ToString());
                 }
             });
+
+        lastRevalidationTipHash = tipHash;
+        lastConnectedBlockHash = tipHash;
+        proofsToRevalidate.clear();
     }
 
     // Remove the invalid proofs before the immature rescan. This makes it
@@ -603,9 +631,47 @@ std::unordered_set<ProofRef, SaltedProofHasher> PeerManager::updatedBlockTip() {
         immatureProofPool.addProofIfPreferred(p);
     }
 
+    const auto duration{
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            SteadyClock::now() - start)};
+    proofRevalidationStats.count++;
+    proofRevalidationStats.totalDuration += duration;
+    proofRevalidationStats.lastDuration = duration;
+    proofRevalidationStats.lastCheckedProofCount = checkedProofCount;
+    proofRevalidationStats.lastIncremental = incremental;
+
     return registeredProofs;
 }
 
+void PeerManager::blockConnected(const CBlock &block) {
+    if (!lastConnectedBlockHash ||
+        block.hashPrevBlock != *lastConnectedBlockHash) {
+        // We missed some blocks, all the proofs will be revalidated.
+        lastConnectedBlockHash.reset();
+        return;
+    }
+    lastConnectedBlockHash = block.GetHash();
+
+    for (const auto &tx : block.vtx) {
+        if (tx->IsCoinBase()) {
+            continue;
+        }
+
+        for (const CTxIn &txin : tx->vin) {
+            for (const ProofPool *pool :
+                 {&validProofPool, &danglingProofPool}) {
+                if (const ProofRef proof = pool->getProof(txin.prevout)) {
+                    proofsToRevalidate.insert(proof->getId());
+                }
+            }
+        }
+    }
+}
+
+void PeerManager::blockDisconnected() {
+    lastConnectedBlockHash.reset();
+}
+
 ProofRef PeerManager::getProof(const ProofId &proofid) const {
     ProofRef proof;
 
@@ -743,79 +809,37 @@ bool PeerManager::removePeer(const PeerId peerid) {
 }
 
 PeerId PeerManager::selectPeer() const {
-    if (slots.empty() || slotCount == 0) {
+    const uint64_t max = slots.getTotalScore();
+    if (max == 0) {
         return NO_PEER;
     }
 
-    const uint64_t max = slotCount;
-    for (int retry = 0; retry < SELECT_PEER_MAX_RETRY; retry++) {
-        size_t i = selectPeerImpl(slots, GetRand(max), max);
-        if (i != NO_PEER) {
-            return i;
-        }
-    }
-
-    return NO_PEER;
+    return slots.select(GetRand(max));
 }
 
-uint64_t PeerManager::compact() {
-    // There is nothing to compact.
-    if (fragmentation == 0) {
-        return 0;
-    }
-
-    std::vector<Slot> newslots;
-    newslots.reserve(peers.size());
-
-    uint64_t prevStop = 0;
-    uint32_t i = 0;
-    for (auto it = peers.begin(); it != peers.end(); it++) {
-        if (it->node_count == 0) {
-            continue;
-        }
-
-        newslots.emplace_back(prevStop, it->getScore(), it->peerid);
-        prevStop = slots[i].getStop();
-        if (!peers.modify(it, [&](Peer &p) { p.index = i++; })) {
-            return 0;
-        }
+bool PeerManager::verify() const {
+    // The slots scores must add up.
+    if (!slots.verify()) {
+        return false;
     }
 
-    slots = std::move(newslots);
-
-    const uint64_t saved = slotCount - prevStop;
-    slotCount = prevStop;
-    fragmentation = 0;
-
-    return saved;
-}
-
-bool PeerManager::verify() const {
-    uint64_t prevStop = 0;
     Score scoreFromSlots = 0;
-    for (size_t i = 0; i < slots.size(); i++) {
-        const Slot &s = slots[i];
+    for (uint32_t i = 0; i < slots.size(); i++) {
+        const PeerId peerid = slots.getPeerId(i);
 
-        // Slots must be in correct order.
-        if (s.getStart() < prevStop) {
-            return false;
-        }
-
-        prevStop = s.getStop();
-
-        // If this is a dead slot, then nothing more needs to be checked.
-        if (s.getPeerId() == NO_PEER) {
+        // If this is a free slot, then nothing more needs to be checked.
+        if (peerid == NO_PEER) {
             continue;
         }
 
         // We have a live slot, verify index.
-        auto it = peers.find(s.getPeerId());
+        auto it = peers.find(peerid);
         if (it == peers.end() || it->index != i) {
             return false;
         }
 
         // Accumulate score across slots
-        scoreFromSlots += slots[i].getScore();
+        scoreFromSlots += slots.getScore(i);
     }
 
     // Score across slots must be the same as our allocated score
@@ -883,12 +907,12 @@ bool PeerManager::verify() const {
 
         scoreFromPeersWithNodes += p.getScore();
         // The index must point to a slot refering to this peer.
-        if (p.index >= slots.size() || slots[p.index].getPeerId() != p.peerid) {
+        if (p.index >= slots.size() || slots.getPeerId(p.index) != p.peerid) {
             return false;
         }
 
         // If the score do not match, same thing.
-        if (slots[p.index].getScore() != p.getScore()) {
+        if (slots.getScore(p.index) != p.getScore()) {
             return false;
         }
 
@@ -924,63 +948,6 @@ bool PeerManager::verify() const {
     });
 }
 
-PeerId selectPeerImpl(const std::vector<Slot> &slots, const uint64_t slot,
-                      const uint64_t max) {
-    assert(slot <= max);
-
-    size_t begin = 0, end = slots.size();
-    uint64_t bottom = 0, top = max;
-
-    // Try to find the slot using dichotomic search.
-    while ((end - begin) > 8) {
-        // The slot we picked in not allocated.
-        if (slot < bottom || slot >= top) {
-            return NO_PEER;
-        }
-
-        // Guesstimate the position of the slot.
-        size_t i = begin + ((slot - bottom) * (end - begin) / (top - bottom));
-        assert(begin <= i && i < end);
-
-        // We have a match.
-        if (slots[i].contains(slot)) {
-            return slots[i].getPeerId();
-        }
-
-        // We undershooted.
-        if (slots[i].precedes(slot)) {
-            begin = i + 1;
-            if (begin >= end) {
-                return NO_PEER;
-            }
-
-            bottom = slots[begin].getStart();
-            continue;
-        }
-
-        // We overshooted.
-        if (slots[i].follows(slot)) {
-            end = i;
-            top = slots[end].getStart();
-            continue;
-        }
-
-        // We have an unalocated slot.
-        return NO_PEER;
-    }
-
-    // Enough of that nonsense, let fallback to linear search.
-    for (size_t i = begin; i < end; i++) {
-        // We have a match.
-        if (slots[i].contains(slot)) {
-            return slots[i].getPeerId();
-        }
-    }
-
-    // We failed to find a slot, retry.
-    return NO_PEER;
-}
-
 void PeerManager::addUnbroadcastProof(const ProofId &proofid) {
     // The proof should be bound to a peer
     if (isBoundToPeer(proofid)) {
@@ -1336,6 +1303,15 @@ bool PeerManager::loadPeersFromFile(
         return false;
     }
 
+    struct PeerEntry {
+        ProofRef proof;
+        bool hasFinalized;
+        int64_t registrationTime;
+        int64_t nextPossibleConflictTime;
+    };
+    std::vector<PeerEntry> entries;
+    bool success = true;
+
     try {
         uint64_t version;
         file >> version;
@@ -1349,49 +1325,59 @@ bool PeerManager::loadPeersFromFile(
         uint64_t numPeers;
         file >> numPeers;
 
-        auto &peersByProofId = peers.get<by_proofid>();
-
         for (uint64_t i = 0; i < numPeers; i++) {
-            ProofRef proof;
-            bool hasFinalized;
-            int64_t registrationTime;
-            int64_t nextPossibleConflictTime;
-
-            file >> proof;
-            file >> hasFinalized;
-            file >> registrationTime;
-            file >> nextPossibleConflictTime;
-
-            if (registerProof(proof)) {
-                auto it = peersByProofId.find(proof->getId());
-                if (it == peersByProofId.end()) {
-                    // Should never happen
-                    continue;
-                }
-
-                // We don't modify any key so we don't need to rehash.
-                // If the modify fails, it means we don't get the full benefit
-                // from the file but we still added our peer to the set. The
-                // non-overridden fields will be set the normal way.
-                peersByProofId.modify(it, [&](Peer &p) {
-                    p.hasFinalized = hasFinalized;
-                    p.registration_time =
-                        std::chrono::seconds{registrationTime};
-                    p.nextPossibleConflictTime =
-                        std::chrono::seconds{nextPossibleConflictTime};
-                });
-
-                registeredProofs.insert(proof);
-            }
+            PeerEntry entry;
+            file >> entry.proof;
+            file >> entry.hasFinalized;
+            file >> entry.registrationTime;
+            file >> entry.nextPossibleConflictTime;
+            entries.push_back(std::move(entry));
         }
     } catch (const std::exception &e) {
         LogPrint(BCLog::AVALANCHE,
                  "Failed to read the avalanche peers file data on disk: %s.\n",
                  e.what());
-        return false;
+        // Still register the peers read so far.
+        success = false;
     }
 
-    return true;
+    // Verify the signatures of all the proofs at once rather than one by one
+    // as they get registered.
+    std::vector<ProofRef> proofs;
+    proofs.reserve(entries.size());
+    for (const PeerEntry &entry : entries) {
+        proofs.push_back(entry.proof);
+    }
+    Proof::BatchVerifySignatures(proofs, stakeUtxoDustThreshold,
+                                 /*verifyEachOnFailure=*/true);
+
+    auto &peersByProofId = peers.get<by_proofid>();
+    for (const PeerEntry &entry : entries) {
+        const ProofRef &proof = entry.proof;
+        if (registerProof(proof)) {
+            auto it = peersByProofId.find(proof->getId());
+            if (it == peersByProofId.end()) {
+                // Should never happen
+                continue;
+            }
+
+            // We don't modify any key so we don't need to rehash.
+            // If the modify fails, it means we don't get the full benefit
+            // from the file but we still added our peer to the set. The
+            // non-overridden fields will be set the normal way.
+            peersByProofId.modify(it, [&](Peer &p) {
+                p.hasFinalized = entry.hasFinalized;
+                p.registration_time =
+                    std::chrono::seconds{entry.registrationTime};
+                p.nextPossibleConflictTime =
+                    std::chrono::seconds{entry.nextPossibleConflictTime};
+            });
+
+            registeredProofs.insert(proof);
+        }
+    }
+
+    return success;
 }
 
 } // namespace avalanche
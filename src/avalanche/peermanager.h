@@ -6,12 +6,14 @@
 #define BITCOIN_AVALANCHE_PEERMANAGER_H
 
 #include <avalanche/node.h>
+#include <avalanche/peerscoretree.h>
 #include <avalanche/proof.h>
 #include <avalanche/proofpool.h>
 #include <avalanche/proofradixtreeadapter.h>
 #include <coins.h>
 #include <common/bloom.h>
 #include <consensus/validation.h>
+#include <primitives/blockhash.h>
 #include <pubkey.h>
 #include <radix.h>
 #include <util/hasher.h>
@@ -28,8 +30,10 @@
 #include <chrono>
 #include <cstdint>
 #include <memory>
+#include <optional>
 #include <vector>
 
+class CBlock;
 class ChainstateManager;
 class CScheduler;
 
@@ -49,36 +53,18 @@ namespace {
     struct TestPeerManager;
 }
 
-struct Slot {
-private:
-    uint64_t start;
-    Score score;
-    PeerId peerid;
-
-public:
-    Slot(uint64_t startIn, Score scoreIn, PeerId peeridIn)
-        : start(startIn), score(scoreIn), peerid(peeridIn) {}
-
-    Slot withStart(uint64_t startIn) const {
-        return Slot(startIn, score, peerid);
-    }
-    Slot withScore(uint64_t scoreIn) const {
-        return Slot(start, scoreIn, peerid);
-    }
-    Slot withPeerId(PeerId peeridIn) const {
-        return Slot(start, score, peeridIn);
-    }
-
-    uint64_t getStart() const { return start; }
-    uint64_t getStop() const { return start + score; }
-    Score getScore() const { return score; }
-    PeerId getPeerId() const { return peerid; }
-
-    bool contains(uint64_t slot) const {
-        return getStart() <= slot && slot < getStop();
-    }
-    bool precedes(uint64_t slot) const { return slot >= getStop(); }
-    bool follows(uint64_t slot) const { return getStart() > slot; }
+/**
+ * Statistics about the revalidation of the proofs when the chain tip changes.
+ */
+struct ProofRevalidationStats {
+    //! Number of times the proofs have been revalidated.
+    uint64_t count{0};
+    std::chrono::microseconds totalDuration{0};
+    std::chrono::microseconds lastDuration{0};
+    //! Number of proofs checked against the UTXO set the last time.
+    uint64_t lastCheckedProofCount{0};
+    //! Whether only the proofs affected by the new blocks were checked.
+    bool lastIncremental{false};
 };
 
 struct Peer {
@@ -160,9 +146,11 @@ class ProofRegistrationState : public ValidationState<ProofRegistrationResult> {
 namespace bmi = boost::multi_index;
 
 class PeerManager {
-    std::vector<Slot> slots;
-    uint64_t slotCount = 0;
-    uint64_t fragmentation = 0;
+    /**
+     * The peers with nodes attached, which can be selected for polling with a
+     * probability proportional to their score.
+     */
+    PeerScoreTree slots;
 
     /**
      * Several nodes can make an avalanche peer. In this case, all nodes are
@@ -224,7 +212,6 @@ class PeerManager {
                 bmi::member<PendingNode, NodeId, &PendingNode::nodeid>>>>;
     PendingNodeSet pendingNodes;
 
-    static constexpr int SELECT_PEER_MAX_RETRY = 3;
     static constexpr int SELECT_NODE_MAX_RETRY = 3;
 
     /**
@@ -296,6 +283,19 @@ class PeerManager {
 
     std::unordered_set<ProofId, SaltedProofIdHasher> manualFlakyProofids;
 
+    /**
+     * The chain tip the proofs were last revalidated at, and the last of the
+     * blocks connected on top of it since then, unset if this chain of blocks
+     * is unknown, e.g. after a block was disconnected. If this chain leads to
+     * the new tip, only the proofs staking outputs spent by these blocks need
+     * to be checked against the UTXO set again.
+     */
+    BlockHash lastRevalidationTipHash;
+    std::optional<BlockHash> lastConnectedBlockHash;
+    std::unordered_set<ProofId, SaltedProofIdHasher> proofsToRevalidate;
+
+    ProofRevalidationStats proofRevalidationStats;
+
 public:
     static constexpr size_t MAX_REMOTE_PROOFS{100};
 
@@ -428,6 +428,21 @@ public:
      */
     std::unordered_set<ProofRef, SaltedProofHasher> updatedBlockTip();
 
+    /**
+     * Keep track of the proofs staking outputs spent by a block connected to
+     * the active chain, so they are revalidated at the next tip update.
+     */
+    void blockConnected(const CBlock &block);
+    /**
+     * A block has been disconnected from the active chain, so all the proofs
+     * need to be revalidated at the next tip update.
+     */
+    void blockDisconnected();
+
+    ProofRevalidationStats getProofRevalidationStats() const {
+        return proofRevalidationStats;
+    }
+
     /**
      * Proof broadcast API.
      */
@@ -487,20 +502,13 @@ public:
      */
     PeerId selectPeer() const;
 
-    /**
-     * Trigger maintenance of internal data structures.
-     * Returns how much slot space was saved after compaction.
-     */
-    uint64_t compact();
-
     /**
      * Perform consistency check on internal data structures.
      */
     bool verify() const;
 
     // Accessors.
-    uint64_t getSlotCount() const { return slotCount; }
-    uint64_t getFragmentation() const { return fragmentation; }
+    uint64_t getSlotCount() const { return slots.getTotalScore(); }
 
     const ProofPool &getValidProofPool() const { return validProofPool; }
     const ProofPool &getConflictingProofPool() const {
@@ -561,12 +569,6 @@ private:
     friend struct ::avalanche::TestPeerManager;
 };
 
-/**
- * Internal methods that are exposed for testing purposes.
- */
-PeerId selectPeerImpl(const std::vector<Slot> &slots, const uint64_t slot,
-                      const uint64_t max);
-
 } // namespace avalanche
 
 #endif // BITCOIN_AVALANCHE_PEERMANAGER_H
@@ -0,0 +1,149 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <avalanche/peerscoretree.h>
+
+#include <algorithm>
+#include <cassert>
+
+namespace avalanche {
+
+static size_t lowbit(size_t i) {
+    return i & (~i + 1);
+}
+
+uint64_t PeerScoreTree::getPrefixScore(size_t count) const {
+    uint64_t score = 0;
+    for (size_t i = count; i > 0; i -= lowbit(i)) {
+        score += tree[i];
+    }
+    return score;
+}
+
+uint32_t PeerScoreTree::insert(PeerId peerid, uint64_t score) {
+    if (!freeIndexes.empty()) {
+        const uint32_t index = freeIndexes.back();
+        freeIndexes.pop_back();
+
+        entries[index].peerid = peerid;
+        update(index, score);
+        return index;
+    }
+
+    const uint32_t index = uint32_t(entries.size());
+    entries.push_back({peerid, score});
+
+    // The new node covers the new entry and the ones before it down to its
+    // lowest bit.
+    const size_t i = entries.size();
+    tree.push_back(score + getPrefixScore(i - 1) -
+                   getPrefixScore(i - lowbit(i)));
+    totalScore += score;
+
+    return index;
+}
+
+void PeerScoreTree::remove(uint32_t index) {
+    assert(index < entries.size());
+    assert(entries[index].peerid != NO_PEER);
+
+    update(index, 0);
+    entries[index].peerid = NO_PEER;
+    freeIndexes.push_back(index);
+}
+
+void PeerScoreTree::update(uint32_t index, uint64_t score) {
+    assert(index < entries.size());
+
+    // The scores are unsigned, so the tree nodes may wrap around temporarily.
+    const uint64_t oldScore = entries[index].score;
+    for (size_t i = size_t(index) + 1; i < tree.size(); i += lowbit(i)) {
+        tree[i] -= oldScore;
+        tree[i] += score;
+    }
+
+    totalScore -= oldScore;
+    totalScore += score;
+    entries[index].score = score;
+}
+
+PeerId PeerScoreTree::select(uint64_t point) const {
+    if (point >= totalScore) {
+        return NO_PEER;
+    }
+
+    // Descend the tree to count the entries which end at or before the point.
+    // The next one contains it.
+    size_t step = 1;
+    while (step * 2 <= entries.size()) {
+        step *= 2;
+    }
+
+    size_t count = 0;
+    for (; step > 0; step /= 2) {
+        if (count + step <= entries.size() && tree[count + step] <= point) {
+            count += step;
+            point -= tree[count];
+        }
+    }
+
+    assert(count < entries.size());
+    return entries[count].peerid;
+}
+
+bool PeerScoreTree::verify() const {
+    if (tree.size() != entries.size() + 1) {
+        return false;
+    }
+
+    uint64_t scoreFromEntries = 0;
+    size_t freeCount = 0;
+    for (size_t i = 0; i < entries.size(); i++) {
+        const Entry &e = entries[i];
+        if (e.peerid == NO_PEER) {
+            // A free slot must not be selectable.
+            if (e.score != 0) {
+                return false;
+            }
+
+            freeCount++;
+        }
+
+        scoreFromEntries += e.score;
+
+        // Each node must sum the scores of the entries it covers.
+        const size_t node = i + 1;
+        uint64_t nodeScore = 0;
+        for (size_t j = node - lowbit(node); j < node; j++) {
+            nodeScore += entries[j].score;
+        }
+
+        if (tree[node] != nodeScore) {
+            return false;
+        }
+    }
+
+    if (scoreFromEntries != totalScore) {
+        return false;
+    }
+
+    // Every free slot must be available for reuse, once.
+    if (freeIndexes.size() != freeCount) {
+        return false;
+    }
+
+    std::vector<uint32_t> sortedFreeIndexes{freeIndexes};
+    std::sort(sortedFreeIndexes.begin(), sortedFreeIndexes.end());
+    for (size_t i = 0; i < sortedFreeIndexes.size(); i++) {
+        const uint32_t index = sortedFreeIndexes[i];
+        if (index >= entries.size() || entries[index].peerid != NO_PEER ||
+            (i > 0 && index == sortedFreeIndexes[i - 1])) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+} // namespace avalanche
@@ -0,0 +1,77 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_AVALANCHE_PEERSCORETREE_H
+#define BITCOIN_AVALANCHE_PEERSCORETREE_H
+
+#include <avalanche/node.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace avalanche {
+
+/**
+ * Scores of the peers to select from, in a Fenwick tree so a peer can be
+ * picked with a probability proportional to its score in O(log n).
+ *
+ * Each peer gets a slot which it keeps until it is removed. The slots of the
+ * removed peers are reused by the next peers inserted, so there is never any
+ * hole to compact.
+ */
+class PeerScoreTree {
+    struct Entry {
+        PeerId peerid;
+        uint64_t score;
+    };
+    std::vector<Entry> entries;
+
+    /**
+     * The Fenwick tree, 1-based: tree[i] is the sum of the scores of the
+     * entries in [i - lowbit(i), i).
+     */
+    std::vector<uint64_t> tree{0};
+
+    std::vector<uint32_t> freeIndexes;
+    uint64_t totalScore = 0;
+
+    uint64_t getPrefixScore(size_t count) const;
+
+public:
+    /**
+     * Add a peer and return the index of its slot.
+     */
+    uint32_t insert(PeerId peerid, uint64_t score);
+
+    /**
+     * Free the slot of a peer, it will never be selected again.
+     */
+    void remove(uint32_t index);
+
+    void update(uint32_t index, uint64_t score);
+
+    /**
+     * Select the peer owning the given point when the slots are laid out one
+     * after the other, or NO_PEER if the point is past the total score.
+     */
+    PeerId select(uint64_t point) const;
+
+    PeerId getPeerId(uint32_t index) const { return entries[index].peerid; }
+    uint64_t getScore(uint32_t index) const { return entries[index].score; }
+    uint64_t getTotalScore() const { return totalScore; }
+
+    /**
+     * Number of slots, including the free ones.
+     */
+    size_t size() const { return entries.size(); }
+
+    /**
+     * Perform consistency check on the tree and the free slots.
+     */
+    bool verify() const;
+};
+
+} // namespace avalanche
+
+#endif // BITCOIN_AVALANCHE_PEERSCORETREE_H
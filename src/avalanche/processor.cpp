@@ -54,6 +54,30 @@ static const uint256 GetVoteItemId(const AnyVoteItem &item) {
                       item);
 }
 
+VoteRecordStore::Shard &VoteRecordStore::getShard(const AnyVoteItem &item,
+                                                  uint256 &id) {
+    id = GetVoteItemId(item);
+    return shards[item.index() * SHARDS_PER_TYPE +
+                  shardHasher(id) % SHARDS_PER_TYPE];
+}
+
+const VoteRecordStore::Shard &
+VoteRecordStore::getShard(const AnyVoteItem &item, uint256 &id) const {
+    return const_cast<VoteRecordStore *>(this)->getShard(item, id);
+}
+
+std::optional<VoteRecord> VoteRecordStore::get(const AnyVoteItem &item) const {
+    uint256 id;
+    const Shard &shard = getShard(item, id);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.records.find(id);
+    if (it == shard.records.end()) {
+        return std::nullopt;
+    }
+
+    return it->second.second;
+}
+
 static bool VerifyProof(const Amount &stakeUtxoDustThreshold,
                         const Proof &proof, bilingual_str &error) {
     ProofValidationState proof_state;
@@ -133,6 +157,16 @@ public:
 
     void updatedBlockTip() override { m_processor->updatedBlockTip(); }
 
+    void blockConnected(const CBlock &block, int height) override {
+        m_processor->withPeerManager(
+            [&](PeerManager &pm) { pm.blockConnected(block); });
+    }
+
+    void blockDisconnected(const CBlock &block, int height) override {
+        m_processor->withPeerManager(
+            [](PeerManager &pm) { pm.blockDisconnected(); });
+    }
+
     void transactionAddedToMempool(const CTransactionRef &tx,
                                    uint64_t mempool_sequence) override {
         m_processor->transactionAddedToMempool(tx);
@@ -427,9 +461,11 @@ bool Processor::addToReconcile(const AnyVoteItem &item) {
     // the calls or we get a deadlock.
     const bool accepted = getLocalAcceptance(item);
 
-    return voteRecords.getWriteView()
-        ->insert(std::make_pair(item, VoteRecord(accepted)))
-        .second;
+    return voteRecords.insert(
+        item, VoteRecord(accepted),
+        [&](const AnyVoteItem &voteItem, const VoteRecord &voteRecord) {
+            updatePollQueue(voteItem, voteRecord);
+        });
 }
 
 bool Processor::reconcileOrFinalize(const ProofRef &proof) {
@@ -456,13 +492,8 @@ bool Processor::isAccepted(const AnyVoteItem &item) const {
         return false;
     }
 
-    auto r = voteRecords.getReadView();
-    auto it = r->find(item);
-    if (it == r.end()) {
-        return false;
-    }
-
-    return it->second.isAccepted();
+    const std::optional<VoteRecord> voteRecord = voteRecords.get(item);
+    return voteRecord && voteRecord->isAccepted();
 }
 
 int Processor::getConfidence(const AnyVoteItem &item) const {
@@ -470,13 +501,12 @@ int Processor::getConfidence(const AnyVoteItem &item) const {
         return -1;
     }
 
-    auto r = voteRecords.getReadView();
-    auto it = r->find(item);
-    if (it == r.end()) {
+    const std::optional<VoteRecord> voteRecord = voteRecords.get(item);
+    if (!voteRecord) {
         return -1;
     }
 
-    return it->second.getConfidence();
+    return voteRecord->getConfidence();
 }
 
 bool Processor::isRecentlyFinalized(const uint256 &itemId) const {
@@ -595,47 +625,53 @@ bool Processor::registerVotes(NodeId nodeid, const Response &response,
         responseItems.insert(std::make_pair(std::move(item), votes[i]));
     }
 
-    auto voteRecordsWriteView = voteRecords.getWriteView();
-
-    // Register votes.
+    // Register votes. Only the shard of each item is locked, so the votes
+    // for other items can be registered concurrently.
     for (const auto &p : responseItems) {
         auto item = p.first;
         const Vote &v = p.second;
 
-        auto it = voteRecordsWriteView->find(item);
-        if (it == voteRecordsWriteView.end()) {
-            // We are not voting on that item anymore.
-            continue;
-        }
-
-        auto &vr = it->second;
-        if (!vr.registerVote(nodeid, v.GetError())) {
-            if (vr.isStale(staleVoteThreshold, staleVoteFactor)) {
-                updates.emplace_back(std::move(item), VoteStatus::Stale);
+        std::optional<VoteStatus> status;
+        voteRecords.modify(item, [&](const AnyVoteItem &voteItem,
+                                     VoteRecord &vr) {
+            const bool changed = vr.registerVote(nodeid, v.GetError());
+            // The vote freed an inflight request, so the item can be polled
+            // again.
+            updatePollQueue(voteItem, vr);
+
+            if (!changed) {
+                if (vr.isStale(staleVoteThreshold, staleVoteFactor)) {
+                    status = VoteStatus::Stale;
+
+                    // Just drop stale votes. If we see this item again, we'll
+                    // do a new vote.
+                    WITH_LOCK(cs_pollQueue, pollQueue.erase(voteItem));
+                    return false;
+                }
+                // This vote did not provide any extra information, move on.
+                return true;
+            }
 
-                // Just drop stale votes. If we see this item again, we'll
-                // do a new vote.
-                voteRecordsWriteView->erase(it);
+            if (!vr.hasFinalized()) {
+                // This item has not been finalized, so we have nothing more to
+                // do.
+                status = vr.isAccepted() ? VoteStatus::Accepted
+                                         : VoteStatus::Rejected;
+                return true;
             }
-            // This vote did not provide any extra information, move on.
-            continue;
-        }
 
-        if (!vr.hasFinalized()) {
-            // This item has not been finalized, so we have nothing more to
-            // do.
-            updates.emplace_back(std::move(item), vr.isAccepted()
-                                                      ? VoteStatus::Accepted
-                                                      : VoteStatus::Rejected);
-            continue;
-        }
+            // We just finalized a vote. If it is valid, then let the caller
+            // know. Either way, remove the item from the map.
+            status =
+                vr.isAccepted() ? VoteStatus::Finalized : VoteStatus::Invalid;
+            WITH_LOCK(cs_pollQueue, pollQueue.erase(voteItem));
+            return false;
+        });
 
-        // We just finalized a vote. If it is valid, then let the caller
-        // know. Either way, remove the item from the map.
-        updates.emplace_back(std::move(item), vr.isAccepted()
-                                                  ? VoteStatus::Finalized
-                                                  : VoteStatus::Invalid);
-        voteRecordsWriteView->erase(it);
+        // If there is no record, we are not voting on that item anymore.
+        if (status) {
+            updates.emplace_back(std::move(item), *status);
+        }
     }
 
     // FIXME This doesn't belong here as it has nothing to do with vote
@@ -1182,7 +1218,6 @@ void Processor::clearTimedoutRequests() {
     }
 
     // In flight request accounting.
-    auto voteRecordsWriteView = voteRecords.getWriteView();
     for (const auto &p : timedout_items) {
         auto item = getVoteItemFromInv(p.first);
 
@@ -1190,30 +1225,63 @@ void Processor::clearTimedoutRequests() {
             continue;
         }
 
-        auto it = voteRecordsWriteView->find(item);
-        if (it == voteRecordsWriteView.end()) {
-            continue;
-        }
+        voteRecords.modify(item, [&](const AnyVoteItem &voteItem,
+                                     VoteRecord &voteRecord) {
+            voteRecord.clearInflightRequest(p.second);
+            updatePollQueue(voteItem, voteRecord);
+            return true;
+        });
+    }
+}
 
-        it->second.clearInflightRequest(p.second);
+void Processor::updatePollQueue(const AnyVoteItem &item,
+                                const VoteRecord &voteRecord) {
+    LOCK(cs_pollQueue);
+    if (voteRecord.shouldPoll()) {
+        pollQueue.insert(item);
+    } else {
+        pollQueue.erase(item);
     }
 }
 
-std::vector<CInv> Processor::getInvsForNextPoll(bool forPoll) {
-    std::vector<CInv> invs;
+void Processor::sweepVoteRecords() {
+    // Resume the sweep where the last one stopped, so all the vote records get
+    // checked in turn without checking them all at every poll.
+    auto [shardIndex, bucket] = WITH_LOCK(
+        cs_pollQueue, return std::make_pair(nextSweptShard, nextSweptBucket));
+
+    const size_t count =
+        std::min(AVALANCHE_MAX_SWEPT_VOTE_RECORDS, voteRecords.size());
+    size_t swept = 0;
+    // Visiting one more shard than there are lets the sweep finish the shard
+    // it started in the middle of.
+    for (size_t i = 0; i <= VoteRecordStore::NUM_SHARDS && swept < count;
+         i++) {
+        swept += voteRecords.sweep(
+            shardIndex, bucket, count - swept,
+            [&](const AnyVoteItem &item, const VoteRecord &voteRecord) {
+                if (isWorthPolling(item)) {
+                    return true;
+                }
 
-    {
-        // First remove all items that are not worth polling.
-        auto w = voteRecords.getWriteView();
-        for (auto it = w->begin(); it != w->end();) {
-            if (!isWorthPolling(it->first)) {
-                it = w->erase(it);
-            } else {
-                ++it;
-            }
+                WITH_LOCK(cs_pollQueue, pollQueue.erase(item));
+                return false;
+            });
+        if (bucket != 0) {
+            // The budget is spent in the middle of this shard.
+            break;
         }
+        shardIndex = (shardIndex + 1) % VoteRecordStore::NUM_SHARDS;
     }
 
+    LOCK(cs_pollQueue);
+    nextSweptShard = shardIndex;
+    nextSweptBucket = bucket;
+}
+
+std::vector<CInv> Processor::getInvsForNextPoll(bool forPoll) {
+    std::vector<CInv> invs;
+
     auto buildInvFromVoteItem = variant::overloaded{
         [](const ProofRef &proof) {
             return CInv(MSG_AVA_PROOF, proof->getId());
@@ -1224,22 +1292,49 @@ std::vector<CInv> Processor::getInvsForNextPoll(bool forPoll) {
         [](const CTransactionRef &tx) { return CInv(MSG_TX, tx->GetHash()); },
     };
 
-    auto r = voteRecords.getReadView();
-    for (const auto &[item, voteRecord] : r) {
-        if (invs.size() >= AVALANCHE_MAX_ELEMENT_POLL) {
-            // Make sure we do not produce more invs than specified by the
-            // protocol.
-            return invs;
+    // Remove some of the items that are not worth polling anymore. The items
+    // polled below are checked regardless.
+    sweepVoteRecords();
+
+    std::optional<AnyVoteItem> item;
+    while (invs.size() < AVALANCHE_MAX_ELEMENT_POLL) {
+        // The worthiness check takes other locks, so don't hold cs_pollQueue
+        // while doing it. The queue entry of an item can only be changed by
+        // another thread while we don't hold the lock of its shard, and the
+        // next item is looked up from the last one so this doesn't matter.
+        {
+            LOCK(cs_pollQueue);
+            auto queueIt =
+                item ? pollQueue.upper_bound(*item) : pollQueue.begin();
+            if (queueIt == pollQueue.end()) {
+                break;
+            }
+            item.emplace(*queueIt);
         }
 
-        const bool shouldPoll =
-            forPoll ? voteRecord.registerPoll() : voteRecord.shouldPoll();
-
-        if (!shouldPoll) {
-            continue;
-        }
+        voteRecords.modify(
+            *item,
+            [&](const AnyVoteItem &voteItem, VoteRecord &voteRecord) {
+                if (!isWorthPolling(voteItem)) {
+                    WITH_LOCK(cs_pollQueue, pollQueue.erase(voteItem));
+                    return false;
+                }
 
-        invs.emplace_back(std::visit(buildInvFromVoteItem, item));
+                const bool shouldPoll = forPoll ? voteRecord.registerPoll()
+                                                : voteRecord.shouldPoll();
+                if (shouldPoll) {
+                    updatePollQueue(voteItem, voteRecord);
+                    invs.emplace_back(
+                        std::visit(buildInvFromVoteItem, voteItem));
+                }
+                return true;
+            },
+            [&] {
+                // The record was dropped after the item was taken from the
+                // queue. This runs under the lock of the item's shard, so a
+                // record added again concurrently can't lose its queue entry.
+                WITH_LOCK(cs_pollQueue, pollQueue.erase(*item));
+            });
     }
 
     return invs;
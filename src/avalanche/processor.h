@@ -22,6 +22,7 @@
 #include <net.h>
 #include <primitives/transaction.h>
 #include <rwcollection.h>
+#include <util/hasher.h>
 #include <util/variant.h>
 #include <validationinterface.h>
 
@@ -31,10 +32,14 @@
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index_container.hpp>
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <cstdint>
 #include <memory>
+#include <optional>
+#include <set>
+#include <shared_mutex>
 #include <unordered_map>
 #include <variant>
 #include <vector>
@@ -52,6 +57,12 @@ struct bilingual_str;
  */
 static constexpr size_t AVALANCHE_MAX_ELEMENT_POLL = 16;
 
+/**
+ * Maximum number of vote records checked for being still worth polling each
+ * time the items to poll are selected.
+ */
+static constexpr size_t AVALANCHE_MAX_SWEPT_VOTE_RECORDS = 1024;
+
 /**
  * How long before we consider that a query timed out.
  */
@@ -138,6 +149,164 @@ struct VoteMapComparator {
 };
 using VoteMap = std::map<AnyVoteItem, VoteRecord, VoteMapComparator>;
 
+/**
+ * Order in which the items are polled: blocks come first as they are the most
+ * urgent to finalize, then proofs and transactions. Items of the same type are
+ * ordered like in the vote map.
+ */
+struct PollPriorityComparator {
+    static int getTypePriority(const AnyVoteItem &item) {
+        return std::visit(variant::overloaded{
+                              [](const CBlockIndex *) { return 0; },
+                              [](const ProofRef &) { return 1; },
+                              [](const CTransactionRef &) { return 2; },
+                          },
+                          item);
+    }
+
+    bool operator()(const AnyVoteItem &lhs, const AnyVoteItem &rhs) const {
+        const int lhsPriority = getTypePriority(lhs);
+        const int rhsPriority = getTypePriority(rhs);
+        if (lhsPriority != rhsPriority) {
+            return lhsPriority < rhsPriority;
+        }
+
+        return VoteMapComparator()(lhs, rhs);
+    }
+};
+using PollQueue = std::set<AnyVoteItem, PollPriorityComparator>;
+
+/**
+ * Vote records by item id, split into shards by item type and id hash. Each
+ * shard has its own lock, so the votes for items in different shards can be
+ * registered concurrently and the readers of a shard don't block each other.
+ *
+ * The callbacks are run while holding the lock of the item's shard, and must
+ * not access the records of other items.
+ */
+class VoteRecordStore {
+public:
+    static constexpr size_t SHARDS_PER_TYPE = 16;
+    static constexpr size_t NUM_SHARDS =
+        std::variant_size_v<AnyVoteItem> * SHARDS_PER_TYPE;
+
+private:
+    struct Shard {
+        mutable std::shared_mutex mutex;
+        std::unordered_map<uint256, std::pair<AnyVoteItem, VoteRecord>,
+                           SaltedUint256Hasher>
+            records;
+    };
+    std::array<Shard, NUM_SHARDS> shards;
+
+    /** Picks the shard of an item independently of the hash maps buckets. */
+    const SaltedUint256Hasher shardHasher;
+
+    std::atomic<size_t> count{0};
+
+    Shard &getShard(const AnyVoteItem &item, uint256 &id);
+    const Shard &getShard(const AnyVoteItem &item, uint256 &id) const;
+
+public:
+    /**
+     * Add a record for the item unless there is one already. On insertion,
+     * onInserted(item, record) is called with the record in the store.
+     */
+    template <typename F>
+    bool insert(const AnyVoteItem &item, const VoteRecord &voteRecord,
+                F &&onInserted) {
+        uint256 id;
+        Shard &shard = getShard(item, id);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto [it, inserted] = shard.records.try_emplace(id, item, voteRecord);
+        if (!inserted) {
+            return false;
+        }
+
+        count++;
+        onInserted(it->second.first, it->second.second);
+        return true;
+    }
+
+    /**
+     * Call f(item, record) on the record of the item if there is one, and
+     * remove the record if it returns false. Otherwise call onMissing(), so
+     * the absence of the record is acted upon before it can be added again.
+     * Returns whether a record was found.
+     */
+    template <typename F, typename M>
+    bool modify(const AnyVoteItem &item, F &&f, M &&onMissing) {
+        uint256 id;
+        Shard &shard = getShard(item, id);
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.records.find(id);
+        if (it == shard.records.end()) {
+            onMissing();
+            return false;
+        }
+
+        if (!f(it->second.first, it->second.second)) {
+            shard.records.erase(it);
+            count--;
+        }
+        return true;
+    }
+
+    template <typename F> bool modify(const AnyVoteItem &item, F &&f) {
+        return modify(item, std::forward<F>(f), [] {});
+    }
+
+    /** Copy of the record of the item, if any. */
+    std::optional<VoteRecord> get(const AnyVoteItem &item) const;
+
+    /**
+     * Call f(item, record) on the records of a shard from the hash map bucket
+     * at cursor onward, and remove the ones for which it returns false. Stops
+     * before checking more than maxChecked records, unless a single bucket
+     * holds more, and leaves cursor at the bucket to resume from. The cursor
+     * is reset to 0 once the end of the shard is reached. Returns the number
+     * of records checked.
+     */
+    template <typename F>
+    size_t sweep(size_t shardIndex, size_t &cursor, size_t maxChecked,
+                 F &&f) {
+        Shard &shard = shards[shardIndex];
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        size_t checked = 0;
+        std::vector<uint256> removed;
+        // The bucket count only changes on insertion, which can't happen
+        // while we hold the lock. A cursor left past the end by a rehash
+        // just finishes the shard.
+        for (; cursor < shard.records.bucket_count(); cursor++) {
+            const size_t bucketSize = shard.records.bucket_size(cursor);
+            if (checked > 0 && checked + bucketSize > maxChecked) {
+                return checked;
+            }
+
+            checked += bucketSize;
+            for (auto it = shard.records.begin(cursor);
+                 it != shard.records.end(cursor); ++it) {
+                const auto &[item, voteRecord] = it->second;
+                if (!f(item, voteRecord)) {
+                    removed.push_back(it->first);
+                }
+            }
+
+            // Erasing doesn't rehash, so the cursor stays valid.
+            for (const uint256 &id : removed) {
+                shard.records.erase(id);
+                count--;
+            }
+            removed.clear();
+        }
+
+        cursor = 0;
+        return checked;
+    }
+
+    size_t size() const { return count; }
+};
+
 struct query_timeout {};
 
 namespace {
@@ -155,7 +324,23 @@ class Processor final : public NetEventsInterface {
     /**
      * Items to run avalanche on.
      */
-    RWCollection<VoteMap> voteRecords;
+    VoteRecordStore voteRecords;
+
+    /**
+     * Items from voteRecords which can be polled, i.e. have room for more
+     * inflight requests, by polling priority. An item is only added or removed
+     * while holding the lock of its voteRecords shard. Whether the items are
+     * still worth polling is checked lazily when they are about to be polled.
+     */
+    mutable Mutex cs_pollQueue;
+    PollQueue pollQueue GUARDED_BY(cs_pollQueue);
+
+    /**
+     * The voteRecords shard and hash map bucket where the next sweep for the
+     * items no longer worth polling starts.
+     */
+    size_t nextSweptShard GUARDED_BY(cs_pollQueue){0};
+    size_t nextSweptBucket GUARDED_BY(cs_pollQueue){0};
 
     /**
      * Keep track of peers and queries sent.
@@ -270,14 +455,15 @@ public:
                   bilingual_str &error);
 
     bool addToReconcile(const AnyVoteItem &item)
-        EXCLUSIVE_LOCKS_REQUIRED(!cs_finalizedItems);
+        EXCLUSIVE_LOCKS_REQUIRED(!cs_finalizedItems, !cs_pollQueue);
     /**
      * Wrapper around the addToReconcile for proofs that adds back the
      * finalization flag to the peer if it is not polled due to being recently
      * finalized.
      */
     bool reconcileOrFinalize(const ProofRef &proof)
-        EXCLUSIVE_LOCKS_REQUIRED(!cs_peerManager, !cs_finalizedItems);
+        EXCLUSIVE_LOCKS_REQUIRED(!cs_peerManager, !cs_finalizedItems,
+                                 !cs_pollQueue);
     bool isAccepted(const AnyVoteItem &item) const;
     int getConfidence(const AnyVoteItem &item) const;
 
@@ -291,7 +477,8 @@ public:
                        std::vector<VoteItemUpdate> &updates, int &banscore,
                        std::string &error)
         EXCLUSIVE_LOCKS_REQUIRED(!cs_peerManager, !cs_finalizedItems,
-                                 !cs_invalidatedBlocks, !cs_finalizationTip);
+                                 !cs_invalidatedBlocks, !cs_finalizationTip,
+                                 !cs_pollQueue);
 
     template <typename Callable>
     auto withPeerManager(Callable &&func) const
@@ -385,15 +572,23 @@ public:
 private:
     void updatedBlockTip()
         EXCLUSIVE_LOCKS_REQUIRED(!cs_peerManager, !cs_finalizedItems,
-                                 !cs_finalizationTip, !cs_stakeContenderCache);
+                                 !cs_finalizationTip, !cs_stakeContenderCache,
+                                 !cs_pollQueue);
     void transactionAddedToMempool(const CTransactionRef &tx)
-        EXCLUSIVE_LOCKS_REQUIRED(!cs_finalizedItems);
+        EXCLUSIVE_LOCKS_REQUIRED(!cs_finalizedItems, !cs_pollQueue);
     void runEventLoop()
         EXCLUSIVE_LOCKS_REQUIRED(!cs_peerManager, !cs_stakingRewards,
-                                 !cs_finalizedItems);
-    void clearTimedoutRequests() EXCLUSIVE_LOCKS_REQUIRED(!cs_peerManager);
+                                 !cs_finalizedItems, !cs_pollQueue);
+    void clearTimedoutRequests()
+        EXCLUSIVE_LOCKS_REQUIRED(!cs_peerManager, !cs_pollQueue);
     std::vector<CInv> getInvsForNextPoll(bool forPoll = true)
-        EXCLUSIVE_LOCKS_REQUIRED(!cs_peerManager, !cs_finalizedItems);
+        EXCLUSIVE_LOCKS_REQUIRED(!cs_peerManager, !cs_finalizedItems,
+                                 !cs_pollQueue);
+    void sweepVoteRecords()
+        EXCLUSIVE_LOCKS_REQUIRED(!cs_peerManager, !cs_finalizedItems,
+                                 !cs_pollQueue);
+    void updatePollQueue(const AnyVoteItem &item, const VoteRecord &voteRecord)
+        EXCLUSIVE_LOCKS_REQUIRED(!cs_pollQueue);
     bool sendHelloInternal(CNode *pfrom)
         EXCLUSIVE_LOCKS_REQUIRED(cs_delayedAvahelloNodeIds);
     AnyVoteItem getVoteItemFromInv(const CInv &inv) const
@@ -119,8 +119,54 @@ static bool IsStandardPayoutScript(const CScript &scriptPubKey) {
     return IsStandard(scriptPubKey, MAX_OP_RETURN_RELAY, scriptType);
 }
 
-bool Proof::verify(const Amount &stakeUtxoDustThreshold,
-                   ProofValidationState &state) const {
+void Proof::addSignatures(SchnorrBatch &batch) const {
+    batch.Add(master, limitedProofId, signature);
+
+    const StakeCommitment commitment = getStakeCommitment();
+    for (const SignedStake &ss : stakes) {
+        const Stake &s = ss.getStake();
+        batch.Add(s.getPubkey(), s.getHash(commitment), ss.getSignature());
+    }
+}
+
+void Proof::BatchVerifySignatures(const std::vector<ProofRef> &proofs,
+                                  const Amount &stakeUtxoDustThreshold,
+                                  bool verifyEachOnFailure) {
+    std::vector<ProofRef> unverified;
+    SchnorrBatch batch;
+    for (const ProofRef &proof : proofs) {
+        // The proofs that are invalid regardless of their signatures are left
+        // for verify() to reject without looking at their signatures.
+        ProofValidationState state;
+        if (proof && !proof->signaturesVerified &&
+            proof->verifyStructure(stakeUtxoDustThreshold, state)) {
+            proof->addSignatures(batch);
+            unverified.push_back(proof);
+        }
+    }
+
+    if (batch.Verify()) {
+        for (const ProofRef &proof : unverified) {
+            proof->signaturesVerified = true;
+        }
+        return;
+    }
+
+    if (!verifyEachOnFailure) {
+        return;
+    }
+
+    for (const ProofRef &proof : unverified) {
+        batch.clear();
+        proof->addSignatures(batch);
+        if (batch.Verify()) {
+            proof->signaturesVerified = true;
+        }
+    }
+}
+
+bool Proof::verifyStructure(const Amount &stakeUtxoDustThreshold,
+                            ProofValidationState &state) const {
     if (stakes.empty()) {
         return state.Invalid(ProofValidationResult::NO_STAKE, "no-stake");
     }
@@ -136,11 +182,6 @@ bool Proof::verify(const Amount &stakeUtxoDustThreshold,
                              "payout-script-non-standard");
     }
 
-    if (!master.VerifySchnorr(limitedProofId, signature)) {
-        return state.Invalid(ProofValidationResult::INVALID_PROOF_SIGNATURE,
-                             "invalid-proof-signature");
-    }
-
     StakeId prevId = uint256::ZERO;
     std::unordered_set<COutPoint, SaltedOutpointHasher> utxos;
     for (const SignedStake &ss : stakes) {
@@ -162,15 +203,45 @@ bool Proof::verify(const Amount &stakeUtxoDustThreshold,
             return state.Invalid(ProofValidationResult::DUPLICATE_STAKE,
                                  "duplicated-stake");
         }
+    }
 
-        if (!ss.verify(getStakeCommitment())) {
-            return state.Invalid(
-                ProofValidationResult::INVALID_STAKE_SIGNATURE,
-                "invalid-stake-signature",
-                strprintf("TxId: %s", s.getUTXO().GetTxId().ToString()));
+    return true;
+}
+
+bool Proof::verify(const Amount &stakeUtxoDustThreshold,
+                   ProofValidationState &state) const {
+    if (!verifyStructure(stakeUtxoDustThreshold, state)) {
+        // state is set by verifyStructure.
+        return false;
+    }
+
+    if (signaturesVerified) {
+        return true;
+    }
+
+    // Check all the signatures at once, and only look for the invalid one if
+    // the batch fails.
+    SchnorrBatch batch;
+    addSignatures(batch);
+    if (!batch.Verify()) {
+        if (!master.VerifySchnorr(limitedProofId, signature)) {
+            return state.Invalid(ProofValidationResult::INVALID_PROOF_SIGNATURE,
+                                 "invalid-proof-signature");
+        }
+
+        const StakeCommitment commitment = getStakeCommitment();
+        for (const SignedStake &ss : stakes) {
+            if (!ss.verify(commitment)) {
+                return state.Invalid(
+                    ProofValidationResult::INVALID_STAKE_SIGNATURE,
+                    "invalid-stake-signature",
+                    strprintf("TxId: %s",
+                              ss.getStake().getUTXO().GetTxId().ToString()));
+            }
         }
     }
 
+    signaturesVerified = true;
     return true;
 }
 
@@ -186,7 +257,7 @@ bool Proof::verify(const Amount &stakeUtxoDustThreshold,
     const CBlockIndex *activeTip = chainman.ActiveTip();
     const int64_t tipMedianTimePast =
         activeTip ? activeTip->GetMedianTimePast() : 0;
-    if (expirationTime > 0 && tipMedianTimePast >= expirationTime) {
+    if (isExpired(tipMedianTimePast)) {
         return state.Invalid(ProofValidationResult::EXPIRED, "expired-proof");
     }
 
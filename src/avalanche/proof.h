@@ -16,6 +16,7 @@
 #include <validation.h> // For ChainstateManager and cs_main
 
 #include <array>
+#include <atomic>
 #include <cstdint>
 #include <optional>
 #include <vector>
@@ -115,6 +116,24 @@ class Proof {
     Score score;
     void computeScore();
 
+    /**
+     * The signatures never change, so once they are verified there is no need
+     * to verify them again when the proof is revalidated.
+     */
+    mutable std::atomic<bool> signaturesVerified{false};
+
+    /**
+     * Add the master signature and the signatures of all the stakes.
+     */
+    void addSignatures(SchnorrBatch &batch) const;
+
+    /**
+     * The checks that don't involve the signatures, so they are cheap enough
+     * to run before verifying any of them.
+     */
+    bool verifyStructure(const Amount &stakeUtxoDustThreshold,
+                         ProofValidationState &state) const;
+
     IMPLEMENT_RCU_REFCOUNT(uint64_t);
 
 public:
@@ -138,7 +157,8 @@ public:
           payoutScriptPubKey(std::move(other.payoutScriptPubKey)),
           signature(std::move(other.signature)),
           limitedProofId(std::move(other.limitedProofId)),
-          proofid(std::move(other.proofid)), score(other.score) {}
+          proofid(std::move(other.proofid)), score(other.score),
+          signaturesVerified(other.signaturesVerified.load()) {}
 
     /**
      * Deserialization constructor.
@@ -152,6 +172,7 @@ public:
         READWRITE(obj.payoutScriptPubKey, obj.signature);
         SER_READ(obj, obj.computeProofId());
         SER_READ(obj, obj.computeScore());
+        SER_READ(obj, obj.signaturesVerified = false);
     }
 
     static bool FromHex(Proof &proof, const std::string &hexProof,
@@ -160,6 +181,20 @@ public:
 
     static Score amountToScore(Amount amount);
 
+    /**
+     * Verify the signatures of many proofs at once, so the subsequent calls to
+     * verify() don't have to. The proofs that fail the checks not involving
+     * the signatures are skipped. If the whole batch is not valid, the proofs
+     * are left unverified unless verifyEachOnFailure is set, in which case
+     * they are batched one by one and the invalid ones are left for verify()
+     * to report. Don't set it for untrusted input, as a single invalid proof
+     * would then cost verifying all the signatures twice.
+     */
+    static void
+    BatchVerifySignatures(const std::vector<RCUPtr<const Proof>> &proofs,
+                          const Amount &stakeUtxoDustThreshold,
+                          bool verifyEachOnFailure);
+
     uint64_t getSequence() const { return sequence; }
     int64_t getExpirationTime() const { return expirationTime; }
     const CPubKey &getMaster() const { return master; }
@@ -174,6 +209,14 @@ public:
     };
     Score getScore() const { return score; }
     Amount getStakedAmount() const;
+    bool hasVerifiedSignatures() const { return signaturesVerified; }
+
+    /**
+     * Whether the proof is expired at a tip with this median time past.
+     */
+    bool isExpired(int64_t tipMedianTimePast) const {
+        return expirationTime > 0 && tipMedianTimePast >= expirationTime;
+    }
 
     bool verify(const Amount &stakeUtxoDustThreshold,
                 ProofValidationState &state) const;
@@ -204,143 +204,6 @@ struct NoCoolDownFixture : public PeerManagerFixture {
 
 BOOST_FIXTURE_TEST_SUITE(peermanager_tests, PeerManagerFixture)
 
-BOOST_AUTO_TEST_CASE(select_peer_linear) {
-    // No peers.
-    BOOST_CHECK_EQUAL(selectPeerImpl({}, 0, 0), NO_PEER);
-    BOOST_CHECK_EQUAL(selectPeerImpl({}, 1, 3), NO_PEER);
-
-    // One peer
-    const std::vector<Slot> oneslot = {{100, 100, 23}};
-
-    // Undershoot
-    BOOST_CHECK_EQUAL(selectPeerImpl(oneslot, 0, 300), NO_PEER);
-    BOOST_CHECK_EQUAL(selectPeerImpl(oneslot, 42, 300), NO_PEER);
-    BOOST_CHECK_EQUAL(selectPeerImpl(oneslot, 99, 300), NO_PEER);
-
-    // Nailed it
-    BOOST_CHECK_EQUAL(selectPeerImpl(oneslot, 100, 300), 23);
-    BOOST_CHECK_EQUAL(selectPeerImpl(oneslot, 142, 300), 23);
-    BOOST_CHECK_EQUAL(selectPeerImpl(oneslot, 199, 300), 23);
-
-    // Overshoot
-    BOOST_CHECK_EQUAL(selectPeerImpl(oneslot, 200, 300), NO_PEER);
-    BOOST_CHECK_EQUAL(selectPeerImpl(oneslot, 242, 300), NO_PEER);
-    BOOST_CHECK_EQUAL(selectPeerImpl(oneslot, 299, 300), NO_PEER);
-
-    // Two peers
-    const std::vector<Slot> twoslots = {{100, 100, 69}, {300, 100, 42}};
-
-    // Undershoot
-    BOOST_CHECK_EQUAL(selectPeerImpl(twoslots, 0, 500), NO_PEER);
-    BOOST_CHECK_EQUAL(selectPeerImpl(twoslots, 42, 500), NO_PEER);
-    BOOST_CHECK_EQUAL(selectPeerImpl(twoslots, 99, 500), NO_PEER);
-
-    // First entry
-    BOOST_CHECK_EQUAL(selectPeerImpl(twoslots, 100, 500), 69);
-    BOOST_CHECK_EQUAL(selectPeerImpl(twoslots, 142, 500), 69);
-    BOOST_CHECK_EQUAL(selectPeerImpl(twoslots, 199, 500), 69);
-
-    // In between
-    BOOST_CHECK_EQUAL(selectPeerImpl(twoslots, 200, 500), NO_PEER);
-    BOOST_CHECK_EQUAL(selectPeerImpl(twoslots, 242, 500), NO_PEER);
-    BOOST_CHECK_EQUAL(selectPeerImpl(twoslots, 299, 500), NO_PEER);
-
-    // Second entry
-    BOOST_CHECK_EQUAL(selectPeerImpl(twoslots, 300, 500), 42);
-    BOOST_CHECK_EQUAL(selectPeerImpl(twoslots, 342, 500), 42);
-    BOOST_CHECK_EQUAL(selectPeerImpl(twoslots, 399, 500), 42);
-
-    // Overshoot
-    BOOST_CHECK_EQUAL(selectPeerImpl(twoslots, 400, 500), NO_PEER);
-    BOOST_CHECK_EQUAL(selectPeerImpl(twoslots, 442, 500), NO_PEER);
-    BOOST_CHECK_EQUAL(selectPeerImpl(twoslots, 499, 500), NO_PEER);
-}
-
-BOOST_AUTO_TEST_CASE(select_peer_dichotomic) {
-    std::vector<Slot> slots;
-
-    // 100 peers of size 1 with 1 empty element apart.
-    uint64_t max = 1;
-    for (int i = 0; i < 100; i++) {
-        slots.emplace_back(max, 1, i);
-        max += 2;
-    }
-
-    BOOST_CHECK_EQUAL(selectPeerImpl(slots, 4, max), NO_PEER);
-
-    // Check that we get what we expect.
-    for (int i = 0; i < 100; i++) {
-        BOOST_CHECK_EQUAL(selectPeerImpl(slots, 2 * i, max), NO_PEER);
-        BOOST_CHECK_EQUAL(selectPeerImpl(slots, 2 * i + 1, max), i);
-    }
-
-    BOOST_CHECK_EQUAL(selectPeerImpl(slots, max, max), NO_PEER);
-
-    // Update the slots to be heavily skewed toward the last element.
-    slots[99] = slots[99].withScore(101);
-    max = slots[99].getStop();
-    BOOST_CHECK_EQUAL(max, 300);
-
-    for (int i = 0; i < 100; i++) {
-        BOOST_CHECK_EQUAL(selectPeerImpl(slots, 2 * i, max), NO_PEER);
-        BOOST_CHECK_EQUAL(selectPeerImpl(slots, 2 * i + 1, max), i);
-    }
-
-    BOOST_CHECK_EQUAL(selectPeerImpl(slots, 200, max), 99);
-    BOOST_CHECK_EQUAL(selectPeerImpl(slots, 256, max), 99);
-    BOOST_CHECK_EQUAL(selectPeerImpl(slots, 299, max), 99);
-    BOOST_CHECK_EQUAL(selectPeerImpl(slots, 300, max), NO_PEER);
-
-    // Update the slots to be heavily skewed toward the first element.
-    for (int i = 0; i < 100; i++) {
-        slots[i] = slots[i].withStart(slots[i].getStart() + 100);
-    }
-
-    slots[0] = Slot(1, slots[0].getStop() - 1, slots[0].getPeerId());
-    slots[99] = slots[99].withScore(1);
-    max = slots[99].getStop();
-    BOOST_CHECK_EQUAL(max, 300);
-
-    BOOST_CHECK_EQUAL(selectPeerImpl(slots, 0, max), NO_PEER);
-    BOOST_CHECK_EQUAL(selectPeerImpl(slots, 1, max), 0);
-    BOOST_CHECK_EQUAL(selectPeerImpl(slots, 42, max), 0);
-
-    for (int i = 0; i < 100; i++) {
-        BOOST_CHECK_EQUAL(selectPeerImpl(slots, 100 + 2 * i + 1, max), i);
-        BOOST_CHECK_EQUAL(selectPeerImpl(slots, 100 + 2 * i + 2, max), NO_PEER);
-    }
-}
-
-BOOST_AUTO_TEST_CASE(select_peer_random) {
-    for (int c = 0; c < 1000; c++) {
-        size_t size = InsecureRandBits(10) + 1;
-        std::vector<Slot> slots;
-        slots.reserve(size);
-
-        uint64_t max = InsecureRandBits(3);
-        auto next = [&]() {
-            uint64_t r = max;
-            max += InsecureRandBits(3);
-            return r;
-        };
-
-        for (size_t i = 0; i < size; i++) {
-            const uint64_t start = next();
-            const Score score = InsecureRandBits(3);
-            max += score;
-            slots.emplace_back(start, score, i);
-        }
-
-        for (int k = 0; k < 100; k++) {
-            uint64_t s = max > 0 ? InsecureRandRange(max) : 0;
-            auto i = selectPeerImpl(slots, s, max);
-            // /!\ Because of the way we construct the vector, the peer id is
-            // always the index. This might not be the case in practice.
-            BOOST_CHECK(i == NO_PEER || slots[i].contains(s));
-        }
-    }
-}
-
 static void addNodeWithScore(Chainstate &active_chainstate,
                              avalanche::PeerManager &pm, NodeId node,
                              Score score) {
@@ -403,7 +266,6 @@ BOOST_AUTO_TEST_CASE(remove_peer) {
     }
 
     BOOST_CHECK_EQUAL(pm.getSlotCount(), 40000);
-    BOOST_CHECK_EQUAL(pm.getFragmentation(), 0);
 
     for (int i = 0; i < 100; i++) {
         PeerId p = pm.selectPeer();
@@ -413,14 +275,8 @@ BOOST_AUTO_TEST_CASE(remove_peer) {
 
     // Remove one peer, it nevers show up now.
     BOOST_CHECK(pm.removePeer(peerids[2]));
-    BOOST_CHECK_EQUAL(pm.getSlotCount(), 40000);
-    BOOST_CHECK_EQUAL(pm.getFragmentation(), 10000);
-
-    // Make sure we compact to never get NO_PEER.
-    BOOST_CHECK_EQUAL(pm.compact(), 10000);
     BOOST_CHECK(pm.verify());
     BOOST_CHECK_EQUAL(pm.getSlotCount(), 30000);
-    BOOST_CHECK_EQUAL(pm.getFragmentation(), 0);
 
     for (int i = 0; i < 100; i++) {
         PeerId p = pm.selectPeer();
@@ -434,23 +290,16 @@ BOOST_AUTO_TEST_CASE(remove_peer) {
         BOOST_CHECK(pm.addNode(InsecureRand32(), p->getId()));
     }
 
+    // The slot of the removed peer is reused.
     BOOST_CHECK_EQUAL(pm.getSlotCount(), 70000);
-    BOOST_CHECK_EQUAL(pm.getFragmentation(), 0);
+    BOOST_CHECK(pm.verify());
 
     BOOST_CHECK(pm.removePeer(peerids[0]));
-    BOOST_CHECK_EQUAL(pm.getSlotCount(), 70000);
-    BOOST_CHECK_EQUAL(pm.getFragmentation(), 10000);
-
-    // Removing the last entry do not increase fragmentation.
-    BOOST_CHECK(pm.removePeer(peerids[7]));
     BOOST_CHECK_EQUAL(pm.getSlotCount(), 60000);
-    BOOST_CHECK_EQUAL(pm.getFragmentation(), 10000);
 
-    // Make sure we compact to never get NO_PEER.
-    BOOST_CHECK_EQUAL(pm.compact(), 10000);
+    BOOST_CHECK(pm.removePeer(peerids[7]));
     BOOST_CHECK(pm.verify());
     BOOST_CHECK_EQUAL(pm.getSlotCount(), 50000);
-    BOOST_CHECK_EQUAL(pm.getFragmentation(), 0);
 
     for (int i = 0; i < 100; i++) {
         PeerId p = pm.selectPeer();
@@ -465,7 +314,7 @@ BOOST_AUTO_TEST_CASE(remove_peer) {
     BOOST_CHECK(!pm.removePeer(NO_PEER));
 }
 
-BOOST_AUTO_TEST_CASE(compact_slots) {
+BOOST_AUTO_TEST_CASE(remove_all_peers) {
     ChainstateManager &chainman = *Assert(m_node.chainman);
     avalanche::PeerManager pm(PROOF_DUST_THRESHOLD, chainman);
 
@@ -483,17 +332,12 @@ BOOST_AUTO_TEST_CASE(compact_slots) {
         pm.removePeer(p);
     }
 
-    BOOST_CHECK_EQUAL(pm.getSlotCount(), 30000);
-    BOOST_CHECK_EQUAL(pm.getFragmentation(), 30000);
+    BOOST_CHECK(pm.verify());
+    BOOST_CHECK_EQUAL(pm.getSlotCount(), 0);
 
     for (int i = 0; i < 100; i++) {
         BOOST_CHECK_EQUAL(pm.selectPeer(), NO_PEER);
     }
-
-    BOOST_CHECK_EQUAL(pm.compact(), 30000);
-    BOOST_CHECK(pm.verify());
-    BOOST_CHECK_EQUAL(pm.getSlotCount(), 0);
-    BOOST_CHECK_EQUAL(pm.getFragmentation(), 0);
 }
 
 BOOST_AUTO_TEST_CASE(node_crud) {
@@ -3234,4 +3078,99 @@ BOOST_AUTO_TEST_CASE(dangling_proof_invalidation) {
     BOOST_CHECK(!pm.isDangling(proof->getId()));
 }
 
+BOOST_AUTO_TEST_CASE(incremental_proof_revalidation) {
+    ChainstateManager &chainman = *Assert(m_node.chainman);
+    Chainstate &active_chainstate = chainman.ActiveChainstate();
+    avalanche::PeerManager pm(PROOF_DUST_THRESHOLD, chainman);
+
+    std::vector<COutPoint> outpoints;
+    std::vector<ProofRef> proofs;
+    for (size_t i = 0; i < 3; i++) {
+        const CKey key = CKey::MakeCompressedKey();
+        outpoints.push_back(createUtxo(active_chainstate, key));
+        proofs.push_back(buildProofWithSequence(key, {outpoints.back()}, 1));
+        BOOST_CHECK(pm.registerProof(proofs.back()));
+    }
+
+    const int64_t tipTime =
+        WITH_LOCK(chainman.GetMutex(), return chainman.ActiveTip())
+            ->GetBlockTime();
+    const CKey key = CKey::MakeCompressedKey();
+    const auto proofToExpire =
+        buildProof(key, {{createUtxo(active_chainstate, key),
+                          PROOF_DUST_THRESHOLD}},
+                   key, 1, 100, false, tipTime + 1);
+    BOOST_CHECK(pm.registerProof(proofToExpire));
+
+    auto checkLastRevalidation = [&](bool incremental,
+                                     uint64_t checkedProofCount) {
+        const auto stats = pm.getProofRevalidationStats();
+        BOOST_CHECK_EQUAL(stats.lastIncremental, incremental);
+        BOOST_CHECK_EQUAL(stats.lastCheckedProofCount, checkedProofCount);
+    };
+
+    // The peer manager doesn't know how the UTXO set changed yet, so all the
+    // proofs are checked
+    pm.updatedBlockTip();
+    checkLastRevalidation(false, 4);
+
+    // Connect a block spending the stake of the first proof. The block hash
+    // only commits to the header, so adding the transaction spending the
+    // stake after the fact doesn't prevent the block to connect to the tip.
+    CBlock block = CreateAndProcessBlock({}, CScript());
+    WITH_LOCK(cs_main,
+              active_chainstate.CoinsTip().SpendCoin(outpoints[0]));
+    CMutableTransaction spendTx;
+    spendTx.vin.emplace_back(outpoints[0]);
+    spendTx.vout.emplace_back(PROOF_DUST_THRESHOLD, CScript() << OP_TRUE);
+    block.vtx.push_back(MakeTransactionRef(std::move(spendTx)));
+    pm.blockConnected(block);
+
+    // Only the proof spent by the block is checked against the UTXO set
+    pm.updatedBlockTip();
+    checkLastRevalidation(true, 1);
+    BOOST_CHECK(!pm.exists(proofs[0]->getId()));
+    BOOST_CHECK(pm.isBoundToPeer(proofs[1]->getId()));
+    BOOST_CHECK(pm.isBoundToPeer(proofs[2]->getId()));
+    BOOST_CHECK(pm.isBoundToPeer(proofToExpire->getId()));
+
+    // If the tip did not change, the UTXO set changed for some other reason so
+    // all the proofs are checked
+    WITH_LOCK(cs_main,
+              active_chainstate.CoinsTip().SpendCoin(outpoints[1]));
+    pm.updatedBlockTip();
+    checkLastRevalidation(false, 3);
+    BOOST_CHECK(!pm.exists(proofs[1]->getId()));
+    BOOST_CHECK(pm.isBoundToPeer(proofs[2]->getId()));
+
+    // The expiration is checked for all the proofs
+    for (int64_t i = 0; i < 6; i++) {
+        SetMockTime(proofToExpire->getExpirationTime() + i);
+        pm.blockConnected(CreateAndProcessBlock({}, CScript()));
+    }
+    BOOST_CHECK_EQUAL(
+        WITH_LOCK(chainman.GetMutex(), return chainman.ActiveTip())
+            ->GetMedianTimePast(),
+        proofToExpire->getExpirationTime());
+    pm.updatedBlockTip();
+    checkLastRevalidation(true, 0);
+    BOOST_CHECK(!pm.exists(proofToExpire->getId()));
+    BOOST_CHECK(pm.isBoundToPeer(proofs[2]->getId()));
+
+    // All the proofs are checked after a block is disconnected
+    pm.blockConnected(CreateAndProcessBlock({}, CScript()));
+    pm.blockDisconnected();
+    pm.updatedBlockTip();
+    checkLastRevalidation(false, 1);
+
+    // Or if a block was missed
+    CreateAndProcessBlock({}, CScript());
+    pm.blockConnected(CreateAndProcessBlock({}, CScript()));
+    pm.updatedBlockTip();
+    checkLastRevalidation(false, 1);
+    BOOST_CHECK(pm.isBoundToPeer(proofs[2]->getId()));
+
+    BOOST_CHECK_EQUAL(pm.getProofRevalidationStats().count, 6);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
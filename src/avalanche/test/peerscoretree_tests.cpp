@@ -0,0 +1,186 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <avalanche/peerscoretree.h>
+
+#include <test/util/random.h>
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+#include <map>
+#include <vector>
+
+using namespace avalanche;
+
+BOOST_FIXTURE_TEST_SUITE(peerscoretree_tests, BasicTestingSetup)
+
+BOOST_AUTO_TEST_CASE(select_peer) {
+    PeerScoreTree tree;
+
+    // No peers.
+    BOOST_CHECK_EQUAL(tree.getTotalScore(), 0);
+    BOOST_CHECK_EQUAL(tree.select(0), NO_PEER);
+    BOOST_CHECK_EQUAL(tree.select(1), NO_PEER);
+    BOOST_CHECK(tree.verify());
+
+    // One peer
+    BOOST_CHECK_EQUAL(tree.insert(23, 100), 0);
+    BOOST_CHECK_EQUAL(tree.getTotalScore(), 100);
+    BOOST_CHECK(tree.verify());
+
+    BOOST_CHECK_EQUAL(tree.select(0), 23);
+    BOOST_CHECK_EQUAL(tree.select(42), 23);
+    BOOST_CHECK_EQUAL(tree.select(99), 23);
+
+    // Overshoot
+    BOOST_CHECK_EQUAL(tree.select(100), NO_PEER);
+    BOOST_CHECK_EQUAL(tree.select(142), NO_PEER);
+
+    // Two peers
+    BOOST_CHECK_EQUAL(tree.insert(42, 200), 1);
+    BOOST_CHECK_EQUAL(tree.getTotalScore(), 300);
+    BOOST_CHECK(tree.verify());
+
+    BOOST_CHECK_EQUAL(tree.select(0), 23);
+    BOOST_CHECK_EQUAL(tree.select(99), 23);
+    BOOST_CHECK_EQUAL(tree.select(100), 42);
+    BOOST_CHECK_EQUAL(tree.select(299), 42);
+    BOOST_CHECK_EQUAL(tree.select(300), NO_PEER);
+
+    // Removing the first peer gives all the slots to the second one.
+    tree.remove(0);
+    BOOST_CHECK_EQUAL(tree.getTotalScore(), 200);
+    BOOST_CHECK_EQUAL(tree.getPeerId(0), NO_PEER);
+    BOOST_CHECK_EQUAL(tree.getScore(0), 0);
+    BOOST_CHECK(tree.verify());
+
+    BOOST_CHECK_EQUAL(tree.select(0), 42);
+    BOOST_CHECK_EQUAL(tree.select(199), 42);
+    BOOST_CHECK_EQUAL(tree.select(200), NO_PEER);
+
+    // The free slot is reused.
+    BOOST_CHECK_EQUAL(tree.insert(69, 50), 0);
+    BOOST_CHECK_EQUAL(tree.size(), 2);
+    BOOST_CHECK_EQUAL(tree.getTotalScore(), 250);
+    BOOST_CHECK(tree.verify());
+
+    BOOST_CHECK_EQUAL(tree.select(0), 69);
+    BOOST_CHECK_EQUAL(tree.select(49), 69);
+    BOOST_CHECK_EQUAL(tree.select(50), 42);
+    BOOST_CHECK_EQUAL(tree.select(249), 42);
+
+    // Update a score.
+    tree.update(1, 10);
+    BOOST_CHECK_EQUAL(tree.getTotalScore(), 60);
+    BOOST_CHECK(tree.verify());
+
+    BOOST_CHECK_EQUAL(tree.select(49), 69);
+    BOOST_CHECK_EQUAL(tree.select(50), 42);
+    BOOST_CHECK_EQUAL(tree.select(59), 42);
+    BOOST_CHECK_EQUAL(tree.select(60), NO_PEER);
+}
+
+BOOST_AUTO_TEST_CASE(select_peer_skewed) {
+    PeerScoreTree tree;
+
+    // 100 peers of score 1 with a free slot apart.
+    for (int i = 0; i < 200; i++) {
+        BOOST_CHECK_EQUAL(tree.insert(i, 1), i);
+    }
+    for (int i = 0; i < 100; i++) {
+        tree.remove(2 * i);
+    }
+    BOOST_CHECK_EQUAL(tree.getTotalScore(), 100);
+    BOOST_CHECK(tree.verify());
+
+    for (int i = 0; i < 100; i++) {
+        BOOST_CHECK_EQUAL(tree.select(i), 2 * i + 1);
+    }
+    BOOST_CHECK_EQUAL(tree.select(100), NO_PEER);
+
+    // Make the last peer heavily skewed.
+    tree.update(199, 101);
+    BOOST_CHECK_EQUAL(tree.getTotalScore(), 200);
+    BOOST_CHECK(tree.verify());
+
+    for (int i = 0; i < 99; i++) {
+        BOOST_CHECK_EQUAL(tree.select(i), 2 * i + 1);
+    }
+    BOOST_CHECK_EQUAL(tree.select(99), 199);
+    BOOST_CHECK_EQUAL(tree.select(156), 199);
+    BOOST_CHECK_EQUAL(tree.select(199), 199);
+    BOOST_CHECK_EQUAL(tree.select(200), NO_PEER);
+
+    // Then the first one.
+    tree.update(199, 1);
+    tree.update(1, 101);
+    BOOST_CHECK_EQUAL(tree.getTotalScore(), 200);
+    BOOST_CHECK(tree.verify());
+
+    BOOST_CHECK_EQUAL(tree.select(0), 1);
+    BOOST_CHECK_EQUAL(tree.select(42), 1);
+    BOOST_CHECK_EQUAL(tree.select(100), 1);
+    for (int i = 1; i < 100; i++) {
+        BOOST_CHECK_EQUAL(tree.select(100 + i), 2 * i + 1);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(select_peer_random) {
+    for (int c = 0; c < 100; c++) {
+        PeerScoreTree tree;
+        std::map<uint32_t, std::pair<PeerId, uint64_t>> live;
+        PeerId nextPeerId = 0;
+
+        for (int k = 0; k < 200; k++) {
+            // Randomly insert, remove or update the peers.
+            switch (InsecureRandRange(3)) {
+                case 0: {
+                    const uint64_t score = InsecureRandBits(3);
+                    const uint32_t index = tree.insert(nextPeerId, score);
+                    BOOST_CHECK(live.emplace(index, std::make_pair(
+                                                        nextPeerId, score))
+                                    .second);
+                    nextPeerId++;
+                    break;
+                }
+                case 1:
+                    if (!live.empty()) {
+                        auto it = std::next(live.begin(),
+                                            InsecureRandRange(live.size()));
+                        tree.remove(it->first);
+                        live.erase(it);
+                    }
+                    break;
+                case 2:
+                    if (!live.empty()) {
+                        auto it = std::next(live.begin(),
+                                            InsecureRandRange(live.size()));
+                        it->second.second = InsecureRandBits(3);
+                        tree.update(it->first, it->second.second);
+                    }
+                    break;
+            }
+        }
+
+        BOOST_CHECK(tree.verify());
+
+        // The slots are laid out by index.
+        uint64_t start = 0;
+        for (const auto &[index, peer] : live) {
+            const auto &[peerid, score] = peer;
+            BOOST_CHECK_EQUAL(tree.getPeerId(index), peerid);
+            BOOST_CHECK_EQUAL(tree.getScore(index), score);
+            for (uint64_t s = start; s < start + score; s++) {
+                BOOST_CHECK_EQUAL(tree.select(s), peerid);
+            }
+            start += score;
+        }
+
+        BOOST_CHECK_EQUAL(tree.getTotalScore(), start);
+        BOOST_CHECK_EQUAL(tree.select(start), NO_PEER);
+    }
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -26,8 +26,10 @@
 #include <boost/mpl/list.hpp>
 #include <boost/test/unit_test.hpp>
 
+#include <atomic>
 #include <functional>
 #include <limits>
+#include <thread>
 #include <type_traits>
 #include <vector>
 
@@ -63,8 +65,11 @@ namespace {
 
         static void addVoteRecord(Processor &p, AnyVoteItem &item,
                                   VoteRecord &voteRecord) {
-            p.voteRecords.getWriteView()->insert(
-                std::make_pair(item, voteRecord));
+            p.voteRecords.insert(item, voteRecord,
+                                 [&](const AnyVoteItem &voteItem,
+                                     const VoteRecord &record) {
+                                     p.updatePollQueue(voteItem, record);
+                                 });
         }
 
         static void setFinalizationTip(Processor &p,
@@ -2056,6 +2061,184 @@ BOOST_AUTO_TEST_CASE(vote_map_comparator) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(poll_priority) {
+    BlockProvider blockProvider(this);
+    ProofProvider proofProvider(this);
+    TxProvider txProvider(this);
+
+    // Mine the block before adding the transaction to the mempool, which only
+    // has random inputs.
+    const auto pindex = blockProvider.buildVoteItem();
+    const auto proof = proofProvider.buildVoteItem();
+    const auto tx = txProvider.buildVoteItem();
+
+    // Add the items by increasing priority
+    BOOST_CHECK(addToReconcile(tx));
+    BOOST_CHECK(addToReconcile(proof));
+    BOOST_CHECK(addToReconcile(pindex));
+
+    // Blocks are polled first, then proofs and transactions
+    auto invs = getInvsForNextPoll();
+    BOOST_CHECK_EQUAL(invs.size(), 3);
+    BOOST_CHECK_EQUAL(invs[0].type, MSG_BLOCK);
+    BOOST_CHECK(invs[0].hash == pindex->GetBlockHash());
+    BOOST_CHECK_EQUAL(invs[1].type, MSG_AVA_PROOF);
+    BOOST_CHECK(invs[1].hash == proof->getId());
+    BOOST_CHECK_EQUAL(invs[2].type, MSG_TX);
+    BOOST_CHECK(invs[2].hash == tx->GetId());
+
+    // Items no longer worth polling are dropped
+    blockProvider.invalidateItem(pindex);
+    invs = getInvsForNextPoll();
+    BOOST_CHECK_EQUAL(invs.size(), 2);
+    BOOST_CHECK_EQUAL(invs[0].type, MSG_AVA_PROOF);
+    BOOST_CHECK_EQUAL(invs[1].type, MSG_TX);
+    BOOST_CHECK(!m_processor->isAccepted(pindex));
+    BOOST_CHECK_EQUAL(m_processor->getConfidence(pindex), -1);
+}
+
+BOOST_AUTO_TEST_CASE(concurrent_vote_registration) {
+    TxProvider provider(this);
+    auto avanodes = ConnectNodes();
+
+    std::vector<CTransactionRef> txs;
+    for (size_t i = 0; i < AVALANCHE_MAX_ELEMENT_POLL; i++) {
+        txs.push_back(provider.buildVoteItem());
+        BOOST_CHECK(addToReconcile(txs.back()));
+    }
+    const std::vector<Vote> votes =
+        provider.buildVotesForItems(0, std::vector<CTransactionRef>(txs));
+
+    // While the votes are registered, the confidence of the items can only
+    // increase until they are finalized and removed. Boost checks are not
+    // thread safe, so the readers only report whether they saw an error.
+    std::atomic<bool> done{false};
+    std::atomic<bool> readError{false};
+    std::vector<std::thread> readers;
+    for (int i = 0; i < 2; i++) {
+        readers.emplace_back([&] {
+            std::vector<int> lastConfidence(txs.size(), 0);
+            while (!done) {
+                for (size_t j = 0; j < txs.size(); j++) {
+                    // The records are never added back, so the item was
+                    // accepted if it still has a confidence afterwards.
+                    const bool accepted = m_processor->isAccepted(txs[j]);
+                    const int confidence = m_processor->getConfidence(txs[j]);
+                    if (confidence == -1) {
+                        lastConfidence[j] = -1;
+                        continue;
+                    }
+
+                    if (lastConfidence[j] == -1 ||
+                        confidence < lastConfidence[j] || !accepted) {
+                        readError = true;
+                    }
+                    lastConfidence[j] = confidence;
+                }
+
+                if (getInvsForNextPoll().size() > AVALANCHE_MAX_ELEMENT_POLL) {
+                    readError = true;
+                }
+            }
+        });
+    }
+
+    std::map<TxId, int> finalized;
+    for (int i = 0; i < 2 * AVALANCHE_FINALIZATION_SCORE &&
+                    finalized.size() < txs.size();
+         i++) {
+        // Poll all the nodes, then register their votes concurrently.
+        std::vector<std::pair<NodeId, uint64_t>> polls;
+        for (size_t j = 0; j < avanodes.size(); j++) {
+            polls.emplace_back(getSuitableNodeToQuery(), getRound());
+            runEventLoop();
+        }
+
+        std::atomic<int> failures{0};
+        std::vector<std::vector<VoteItemUpdate>> updates(polls.size());
+        std::vector<std::thread> voters;
+        for (size_t j = 0; j < polls.size(); j++) {
+            voters.emplace_back([&, j] {
+                const auto &[nodeid, round] = polls[j];
+                if (!registerVotes(nodeid, {round, 0, votes}, updates[j])) {
+                    failures++;
+                }
+            });
+        }
+        for (std::thread &voter : voters) {
+            voter.join();
+        }
+        BOOST_CHECK_EQUAL(failures, 0);
+
+        for (size_t j = 0; j < polls.size(); j++) {
+            for (const auto &update : updates[j]) {
+                if (update.getStatus() == VoteStatus::Finalized) {
+                    finalized[provider.fromAnyVoteItem(update.getVoteItem())
+                                  ->GetId()]++;
+                }
+            }
+        }
+    }
+
+    done = true;
+    for (std::thread &reader : readers) {
+        reader.join();
+    }
+    BOOST_CHECK(!readError);
+
+    // Each item got finalized exactly once.
+    BOOST_CHECK_EQUAL(finalized.size(), txs.size());
+    for (const auto &tx : txs) {
+        BOOST_CHECK_EQUAL(finalized[tx->GetId()], 1);
+        BOOST_CHECK(!m_processor->isAccepted(tx));
+        BOOST_CHECK_EQUAL(m_processor->getConfidence(tx), -1);
+    }
+    BOOST_CHECK(getInvsForNextPoll().empty());
+}
+
+BOOST_AUTO_TEST_CASE(vote_record_store_sweep) {
+    VoteRecordStore store;
+    std::set<TxId> txids;
+    for (uint32_t i = 0; i < 1000; i++) {
+        CMutableTransaction mtx;
+        mtx.nLockTime = i;
+        const CTransactionRef tx = MakeTransactionRef(mtx);
+        txids.insert(tx->GetId());
+        BOOST_CHECK(store.insert(tx, VoteRecord(true),
+                                 [](const AnyVoteItem &, const VoteRecord &) {
+                                 }));
+    }
+
+    // A bounded sweep resumes where it stopped, and goes through each record
+    // exactly once. The odd records are removed on the way.
+    constexpr size_t maxChecked = 10;
+    std::map<TxId, int> checked;
+    for (size_t shardIndex = 0; shardIndex < VoteRecordStore::NUM_SHARDS;
+         shardIndex++) {
+        size_t cursor = 0;
+        do {
+            size_t count = 0;
+            const size_t swept = store.sweep(
+                shardIndex, cursor, maxChecked,
+                [&](const AnyVoteItem &item, const VoteRecord &) {
+                    const CTransactionRef &tx =
+                        std::get<const CTransactionRef>(item);
+                    count++;
+                    checked[tx->GetId()]++;
+                    return tx->nLockTime % 2 == 0;
+                });
+            BOOST_CHECK_EQUAL(swept, count);
+            BOOST_CHECK_LE(swept, maxChecked);
+        } while (cursor != 0);
+    }
+
+    BOOST_CHECK_EQUAL(checked.size(), txids.size());
+    for (const auto &[txid, count] : checked) {
+        BOOST_CHECK_EQUAL(count, 1);
+    }
+    BOOST_CHECK_EQUAL(store.size(), txids.size() / 2);
+}
+
 BOOST_AUTO_TEST_CASE(block_reconcile_initial_vote) {
     auto &chainman = Assert(m_node.chainman);
     Chainstate &chainstate = chainman->ActiveChainstate();
@@ -873,6 +873,110 @@ BOOST_AUTO_TEST_CASE(verify) {
     }
 }
 
+BOOST_AUTO_TEST_CASE(batch_verify_signatures) {
+    auto key = CKey::MakeCompressedKey();
+    const Amount value = 2 * PROOF_DUST_THRESHOLD;
+
+    auto buildProof = [&](const Amount &amount) {
+        ProofBuilder pb(0, 0, key, UNSPENDABLE_ECREG_PAYOUT_SCRIPT);
+        BOOST_CHECK(pb.addUTXO(COutPoint(TxId(InsecureRand256()), 0), amount,
+                               10, false, key));
+        return pb.build();
+    };
+
+    const ProofRef valid1 = buildProof(value);
+    const ProofRef valid2 = buildProof(value);
+
+    // Same stakes but the master signature is wrong
+    const ProofRef badSignature = ProofRef::make(
+        valid1->getSequence(), valid1->getExpirationTime(),
+        valid1->getMaster(), valid1->getStakes(), valid1->getPayoutScript(),
+        SchnorrSig{});
+
+    // Valid signatures but the stake is dust
+    const ProofRef dust = buildProof(PROOF_DUST_THRESHOLD - 1 * SATOSHI);
+
+    // Valid signatures but the stake is duplicated
+    ProofBuilder pb(0, 0, key, UNSPENDABLE_ECREG_PAYOUT_SCRIPT);
+    BOOST_CHECK(pb.addUTXO(COutPoint(TxId(InsecureRand256()), 0), value, 10,
+                           false, key));
+    const ProofRef duplicated = TestProofBuilder::buildDuplicatedStakes(pb);
+
+    const std::vector<ProofRef> proofs{valid1,     badSignature, ProofRef(),
+                                       dust,       duplicated,   valid2};
+
+    // Without the fallback, a failed batch leaves all the proofs unverified
+    Proof::BatchVerifySignatures(proofs, PROOF_DUST_THRESHOLD,
+                                 /*verifyEachOnFailure=*/false);
+    for (const ProofRef &proof : proofs) {
+        BOOST_CHECK(!proof || !proof->hasVerifiedSignatures());
+    }
+
+    Proof::BatchVerifySignatures(proofs, PROOF_DUST_THRESHOLD,
+                                 /*verifyEachOnFailure=*/true);
+
+    // Only the valid proofs are marked verified, even though the batch failed
+    BOOST_CHECK(valid1->hasVerifiedSignatures());
+    BOOST_CHECK(valid2->hasVerifiedSignatures());
+    BOOST_CHECK(!badSignature->hasVerifiedSignatures());
+    BOOST_CHECK(!dust->hasVerifiedSignatures());
+    BOOST_CHECK(!duplicated->hasVerifiedSignatures());
+
+    // The invalid proofs are still rejected for the right reason
+    auto checkVerify = [](const ProofRef &proof,
+                          ProofValidationResult expected) {
+        ProofValidationState state;
+        BOOST_CHECK_EQUAL(proof->verify(PROOF_DUST_THRESHOLD, state),
+                          expected == ProofValidationResult::NONE);
+        BOOST_CHECK(state.GetResult() == expected);
+    };
+    checkVerify(valid1, ProofValidationResult::NONE);
+    checkVerify(valid2, ProofValidationResult::NONE);
+    checkVerify(badSignature, ProofValidationResult::INVALID_PROOF_SIGNATURE);
+    checkVerify(dust, ProofValidationResult::DUST_THRESHOLD);
+    checkVerify(duplicated, ProofValidationResult::DUPLICATE_STAKE);
+
+    // The structural checks don't depend on the signatures being verified
+    BOOST_CHECK(!dust->hasVerifiedSignatures());
+    ProofValidationState state;
+    BOOST_CHECK(dust->verify(Amount::zero(), state));
+    BOOST_CHECK(dust->hasVerifiedSignatures());
+
+    // A batch of valid proofs marks them all at once
+    const ProofRef valid3 = buildProof(value);
+    const ProofRef valid4 = buildProof(value);
+    Proof::BatchVerifySignatures({valid3, valid4}, PROOF_DUST_THRESHOLD,
+                                 /*verifyEachOnFailure=*/false);
+    BOOST_CHECK(valid3->hasVerifiedSignatures());
+    BOOST_CHECK(valid4->hasVerifiedSignatures());
+}
+
+BOOST_AUTO_TEST_CASE(deserialization_resets_verified_signatures) {
+    auto key = CKey::MakeCompressedKey();
+    ProofBuilder pb(0, 0, key, UNSPENDABLE_ECREG_PAYOUT_SCRIPT);
+    BOOST_CHECK(pb.addUTXO(COutPoint(TxId(InsecureRand256()), 0),
+                           2 * PROOF_DUST_THRESHOLD, 10, false, key));
+    const ProofRef valid = pb.build();
+
+    const ProofRef badSignature = ProofRef::make(
+        valid->getSequence(), valid->getExpirationTime(), valid->getMaster(),
+        valid->getStakes(), valid->getPayoutScript(), SchnorrSig{});
+
+    Proof p;
+    bilingual_str error;
+    BOOST_CHECK(Proof::FromHex(p, valid->ToHex(), error));
+    ProofValidationState state;
+    BOOST_CHECK(p.verify(PROOF_DUST_THRESHOLD, state));
+    BOOST_CHECK(p.hasVerifiedSignatures());
+
+    // Reusing the verified object does not skip the new signatures
+    BOOST_CHECK(Proof::FromHex(p, badSignature->ToHex(), error));
+    BOOST_CHECK(!p.hasVerifiedSignatures());
+    BOOST_CHECK(!p.verify(PROOF_DUST_THRESHOLD, state));
+    BOOST_CHECK(state.GetResult() ==
+                ProofValidationResult::INVALID_PROOF_SIGNATURE);
+}
+
 BOOST_AUTO_TEST_CASE(deterministic_proofid) {
     auto key = CKey::MakeCompressedKey();
 
@@ -22,6 +22,23 @@ static constexpr size_t NUM_ADDRESSES_PER_SOURCE = 256;
 static std::vector<CAddress> g_sources;
 static std::vector<std::vector<CAddress>> g_addresses;
 
+static CAddress RandAddr(FastRandomContext &rng) {
+    in6_addr addr;
+    memcpy(&addr, rng.randbytes(sizeof(addr)).data(), sizeof(addr));
+
+    uint16_t port;
+    memcpy(&port, rng.randbytes(sizeof(port)).data(), sizeof(port));
+    if (port == 0) {
+        port = 1;
+    }
+
+    CAddress ret(CService(addr, port), NODE_NETWORK);
+
+    ret.nTime = Now<NodeSeconds>();
+
+    return ret;
+}
+
 static void CreateAddresses() {
     // already created
     if (g_sources.size() > 0) {
@@ -30,28 +47,11 @@ static void CreateAddresses() {
 
     FastRandomContext rng(uint256(std::vector<uint8_t>(32, 123)));
 
-    auto randAddr = [&rng]() {
-        in6_addr addr;
-        memcpy(&addr, rng.randbytes(sizeof(addr)).data(), sizeof(addr));
-
-        uint16_t port;
-        memcpy(&port, rng.randbytes(sizeof(port)).data(), sizeof(port));
-        if (port == 0) {
-            port = 1;
-        }
-
-        CAddress ret(CService(addr, port), NODE_NETWORK);
-
-        ret.nTime = Now<NodeSeconds>();
-
-        return ret;
-    };
-
     for (size_t source_i = 0; source_i < NUM_SOURCES; ++source_i) {
-        g_sources.emplace_back(randAddr());
+        g_sources.emplace_back(RandAddr(rng));
         g_addresses.emplace_back();
         for (size_t addr_i = 0; addr_i < NUM_ADDRESSES_PER_SOURCE; ++addr_i) {
-            g_addresses[source_i].emplace_back(randAddr());
+            g_addresses[source_i].emplace_back(RandAddr(rng));
         }
     }
 }
@@ -94,6 +94,81 @@ static void AddrManSelect(benchmark::Bench &bench) {
     });
 }
 
+/**
+ * Select from a table with a few addresses, so nearly all the buckets are
+ * empty.
+ */
+static void AddrManSelectFromSparse(benchmark::Bench &bench) {
+    AddrMan addrman(/*asmap=*/std::vector<bool>(),
+                    /*consistency_check_ratio=*/0);
+
+    FastRandomContext rng(uint256(std::vector<uint8_t>(32, 42)));
+    const CAddress source{RandAddr(rng)};
+    for (int i = 0; i < 4; ++i) {
+        const CAddress addr{RandAddr(rng)};
+        addrman.Add({addr}, source);
+        addrman.Good(addr);
+        addrman.Add({RandAddr(rng)}, source);
+    }
+
+    bench.run([&] {
+        const auto &address = addrman.Select();
+        assert(address.first.GetPort() > 0);
+    });
+}
+
+/** Select from a table filled with addresses received from many sources. */
+static void AddrManSelectFromLarge(benchmark::Bench &bench) {
+    AddrMan addrman(/*asmap=*/std::vector<bool>(),
+                    /*consistency_check_ratio=*/0);
+
+    FastRandomContext rng(uint256(std::vector<uint8_t>(32, 42)));
+    for (int source_i = 0; source_i < 1024; ++source_i) {
+        const CAddress source{RandAddr(rng)};
+        std::vector<CAddress> addresses;
+        for (int addr_i = 0; addr_i < 64; ++addr_i) {
+            addresses.push_back(RandAddr(rng));
+        }
+        addrman.Add(addresses, source);
+        addrman.Good(addresses.front());
+    }
+
+    bench.run([&] {
+        const auto &address = addrman.Select();
+        assert(address.first.GetPort() > 0);
+    });
+}
+
+/**
+ * Receive full ADDR messages from many peers into a large table, as during an
+ * address storm. The messages are replayed, so after the first round their
+ * addresses are already known, as is mostly the case for relayed addresses.
+ */
+static void AddrManAddStorm(benchmark::Bench &bench) {
+    static constexpr size_t NUM_MESSAGES{64};
+    static constexpr size_t NUM_ADDRESSES_PER_MESSAGE{1000};
+
+    AddrMan addrman(/*asmap=*/std::vector<bool>(),
+                    /*consistency_check_ratio=*/0);
+    FillAddrMan(addrman);
+
+    FastRandomContext rng(uint256(std::vector<uint8_t>(32, 42)));
+    std::vector<CAddress> sources;
+    std::vector<std::vector<CAddress>> messages(NUM_MESSAGES);
+    for (auto &message : messages) {
+        sources.push_back(RandAddr(rng));
+        for (size_t i = 0; i < NUM_ADDRESSES_PER_MESSAGE; ++i) {
+            message.push_back(RandAddr(rng));
+        }
+    }
+
+    size_t next_message{0};
+    bench.batch(NUM_ADDRESSES_PER_MESSAGE).unit("addr").run([&] {
+        addrman.Add(messages[next_message], sources[next_message]);
+        next_message = (next_message + 1) % NUM_MESSAGES;
+    });
+}
+
 static void AddrManGetAddr(benchmark::Bench &bench) {
     AddrMan addrman(/* asmap= */ std::vector<bool>(),
                     /* consistency_check_ratio= */ 0);
@@ -140,5 +215,8 @@ static void AddrManAddThenGood(benchmark::Bench &bench) {
 
 BENCHMARK(AddrManAdd);
 BENCHMARK(AddrManSelect);
+BENCHMARK(AddrManSelectFromSparse);
+BENCHMARK(AddrManSelectFromLarge);
+BENCHMARK(AddrManAddStorm);
 BENCHMARK(AddrManGetAddr);
 BENCHMARK(AddrManAddThenGood);
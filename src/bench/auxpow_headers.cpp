@@ -0,0 +1,62 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <node/blockstorage.h>
+#include <validation.h>
+
+#include <test/util/setup_common.h>
+
+#include <vector>
+
+/** Number of headers in a full headers message. */
+static constexpr size_t HEADERS_PER_MESSAGE{2000};
+static constexpr size_t NUM_AUXPOW_BLOCKS{200};
+
+/**
+ * Build the headers of a full headers message made of merge-mined blocks, the
+ * way getheaders is served, either through the auxpow header cache or by
+ * reading every header back from the block files.
+ */
+static void ServeAuxPowHeaders(benchmark::Bench &bench, bool from_disk) {
+    auto testing_setup{MakeNoLogFileContext<TestChain100Setup>()};
+    ChainstateManager &chainman{*testing_setup->m_node.chainman};
+
+    std::vector<const CBlockIndex *> indices;
+    for (uint32_t i = 0; i < NUM_AUXPOW_BLOCKS; ++i) {
+        testing_setup->CreateAndProcessAuxPowBlock(
+            {}, CScript() << OP_1, /*parentChainId=*/42,
+            /*mergeMineNonce=*/i, {}, {});
+        indices.push_back(WITH_LOCK(cs_main, return chainman.ActiveTip()));
+    }
+
+    std::vector<CBlockHeader> headers;
+    headers.reserve(HEADERS_PER_MESSAGE);
+    bench.batch(HEADERS_PER_MESSAGE).unit("header").run([&] {
+        headers.clear();
+        for (size_t i = 0; i < HEADERS_PER_MESSAGE; ++i) {
+            const CBlockIndex &index{*indices[i % indices.size()]};
+            if (from_disk) {
+                CBlockHeader header;
+                bool ok{chainman.m_blockman.ReadBlockHeaderFromDisk(header,
+                                                                    index)};
+                assert(ok);
+                headers.push_back(std::move(header));
+            } else {
+                headers.push_back(index.GetBlockHeader(chainman.m_blockman));
+            }
+        }
+    });
+}
+
+static void ServeAuxPowHeadersCached(benchmark::Bench &bench) {
+    ServeAuxPowHeaders(bench, /*from_disk=*/false);
+}
+
+static void ServeAuxPowHeadersFromDisk(benchmark::Bench &bench) {
+    ServeAuxPowHeaders(bench, /*from_disk=*/true);
+}
+
+BENCHMARK(ServeAuxPowHeadersCached);
+BENCHMARK(ServeAuxPowHeadersFromDisk);
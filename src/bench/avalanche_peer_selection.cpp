@@ -0,0 +1,45 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <avalanche/peerscoretree.h>
+#include <bench/bench.h>
+#include <random.h>
+
+#include <cassert>
+#include <vector>
+
+static constexpr int NUM_PEERS{10000};
+
+/**
+ * Select the peers to poll while peers keep connecting and disconnecting: each
+ * selection is preceded by the removal of a random peer and the insertion of a
+ * new one.
+ */
+static void AvalanchePeerSelection(benchmark::Bench &bench) {
+    FastRandomContext rng{/*fDeterministic=*/true};
+
+    // Random scores from 1 to 1024 stake units
+    auto randScore = [&]() { return (rng.randrange(1024) + 1) * 10000; };
+
+    avalanche::PeerScoreTree tree;
+    std::vector<uint32_t> indexes;
+    indexes.reserve(NUM_PEERS);
+    PeerId nextPeerId = 0;
+    for (int i = 0; i < NUM_PEERS; ++i) {
+        indexes.push_back(tree.insert(nextPeerId++, randScore()));
+    }
+
+    bench.run([&] {
+        uint32_t &index = indexes[rng.randrange(indexes.size())];
+        tree.remove(index);
+        index = tree.insert(nextPeerId++, randScore());
+
+        const PeerId peerid{tree.select(rng.randrange(tree.getTotalScore()))};
+        assert(peerid != NO_PEER);
+    });
+
+    assert(tree.size() == NUM_PEERS);
+}
+
+BENCHMARK(AvalanchePeerSelection);
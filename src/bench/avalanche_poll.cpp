@@ -0,0 +1,77 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <avalanche/processor.h>
+#include <bench/bench.h>
+#include <chainparamsbase.h>
+#include <kernel/cs_main.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <test/util/setup_common.h>
+#include <txmempool.h>
+#include <util/check.h>
+#include <util/translation.h>
+
+#include <cassert>
+#include <memory>
+#include <vector>
+
+namespace avalanche {
+namespace {
+    struct AvalancheTest {
+        static std::vector<CInv> getInvsForNextPoll(Processor &p) {
+            return p.getInvsForNextPoll(/*forPoll=*/false);
+        }
+    };
+} // namespace
+} // namespace avalanche
+
+static constexpr int NUM_VOTE_RECORDS{100000};
+
+/**
+ * Select the items to poll among many transactions pending preconsensus.
+ */
+static void AvalanchePoll(benchmark::Bench &bench) {
+    const TestingSetup test_setup{
+        CBaseChainParams::REGTEST,
+        /*extra_args=*/
+        {
+            "-nodebuglogfile",
+            "-nodebug",
+        },
+    };
+    const node::NodeContext &node = test_setup.m_node;
+    CTxMemPool &pool = *Assert(node.mempool);
+
+    bilingual_str error;
+    auto processor = avalanche::Processor::MakeProcessor(
+        *node.args, *node.chain, /*connman=*/nullptr, *Assert(node.chainman),
+        &pool, *node.scheduler, error);
+    assert(processor);
+
+    TestMemPoolEntryHelper entry;
+    for (int i = 0; i < NUM_VOTE_RECORDS; ++i) {
+        CMutableTransaction mtx;
+        mtx.vin.resize(1);
+        mtx.vin[0].scriptSig = CScript() << i;
+        mtx.vout.resize(1);
+        mtx.vout[0].scriptPubKey = CScript() << OP_TRUE;
+        mtx.vout[0].nValue = COIN;
+        const CTransactionRef tx{MakeTransactionRef(mtx)};
+        {
+            LOCK2(cs_main, pool.cs);
+            pool.addUnchecked(entry.FromTx(tx));
+        }
+        const bool added{processor->addToReconcile(tx)};
+        assert(added);
+    }
+
+    bench.run([&] {
+        const auto invs{
+            avalanche::AvalancheTest::getInvsForNextPoll(*processor)};
+        assert(invs.size() == AVALANCHE_MAX_ELEMENT_POLL);
+    });
+}
+
+BENCHMARK(AvalanchePoll);
@@ -0,0 +1,156 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <avalanche/processor.h>
+#include <avalanche/proof.h>
+#include <avalanche/proofbuilder.h>
+#include <avalanche/protocol.h>
+#include <avalanche/validation.h>
+#include <bench/bench.h>
+#include <hash.h>
+#include <key.h>
+#include <pubkey.h>
+#include <random.h>
+#include <script/standard.h>
+#include <streams.h>
+#include <test/util/setup_common.h>
+#include <version.h>
+
+#include <cassert>
+#include <vector>
+
+static constexpr int NUM_RESPONSES{1000};
+static constexpr int NUM_PROOFS{5000};
+
+/**
+ * Verify the signatures of avalanche responses from as many peers, each
+ * carrying a full poll worth of votes.
+ */
+static void AvalancheResponseSignatures(benchmark::Bench &bench,
+                                        bool batched) {
+    const auto testing_setup = MakeNoLogFileContext<const BasicTestingSetup>();
+    FastRandomContext rng{/*fDeterministic=*/true};
+
+    struct SignedResponse {
+        CPubKey pubkey;
+        uint256 hash;
+        SchnorrSig sig;
+    };
+    std::vector<SignedResponse> responses;
+    responses.reserve(NUM_RESPONSES);
+    for (int i = 0; i < NUM_RESPONSES; ++i) {
+        std::vector<avalanche::Vote> votes;
+        for (size_t j = 0; j < AVALANCHE_MAX_ELEMENT_POLL; ++j) {
+            votes.emplace_back(0, rng.rand256());
+        }
+        const avalanche::Response response{uint64_t(i), 0, std::move(votes)};
+
+        HashWriter hasher{};
+        hasher << response;
+        const uint256 hash{hasher.GetHash()};
+
+        const CKey key{CKey::MakeCompressedKey()};
+        SchnorrSig sig;
+        const bool signed_ok{key.SignSchnorr(hash, sig)};
+        assert(signed_ok);
+        responses.push_back({key.GetPubKey(), hash, sig});
+    }
+
+    bench.batch(NUM_RESPONSES).unit("response").run([&] {
+        if (batched) {
+            SchnorrBatch batch;
+            for (const SignedResponse &response : responses) {
+                batch.Add(response.pubkey, response.hash, response.sig);
+            }
+            const std::vector<bool> valid{batch.VerifyEach()};
+            assert(valid == std::vector<bool>(NUM_RESPONSES, true));
+            return;
+        }
+
+        for (const SignedResponse &response : responses) {
+            const bool valid{
+                response.pubkey.VerifySchnorr(response.hash, response.sig)};
+            assert(valid);
+        }
+    });
+}
+
+/**
+ * Verify proofs with a single stake, as when they are loaded from the
+ * avalanche peers file at startup.
+ */
+static void AvalancheProofSignatures(benchmark::Bench &bench, bool batched) {
+    const auto testing_setup = MakeNoLogFileContext<const BasicTestingSetup>();
+    FastRandomContext rng{/*fDeterministic=*/true};
+
+    // The proofs remember their signatures are verified, so they are
+    // deserialized again for each run.
+    CDataStream serializedProofs(SER_NETWORK, PROTOCOL_VERSION);
+    for (int i = 0; i < NUM_PROOFS; ++i) {
+        const CKey key{CKey::MakeCompressedKey()};
+        avalanche::ProofBuilder pb(
+            0, 0, key, GetScriptForDestination(PKHash(key.GetPubKey())));
+        const bool added{pb.addUTXO(COutPoint(TxId(rng.rand256()), 0),
+                                    avalanche::PROOF_DUST_THRESHOLD,
+                                    /*height=*/10, /*is_coinbase=*/false,
+                                    key)};
+        assert(added);
+        serializedProofs << pb.build();
+    }
+
+    bench.batch(NUM_PROOFS).unit("proof").run([&] {
+        CDataStream ss{serializedProofs};
+        std::vector<avalanche::ProofRef> proofs(NUM_PROOFS);
+        for (avalanche::ProofRef &proof : proofs) {
+            ss >> proof;
+        }
+
+        if (batched) {
+            avalanche::Proof::BatchVerifySignatures(
+                proofs, avalanche::PROOF_DUST_THRESHOLD,
+                /*verifyEachOnFailure=*/true);
+            for (const avalanche::ProofRef &proof : proofs) {
+                avalanche::ProofValidationState state;
+                const bool valid{
+                    proof->verify(avalanche::PROOF_DUST_THRESHOLD, state)};
+                assert(valid);
+            }
+            return;
+        }
+
+        // verify() batches the signatures of each proof, so check them one
+        // by one instead.
+        for (const avalanche::ProofRef &proof : proofs) {
+            bool valid{proof->getMaster().VerifySchnorr(
+                proof->getLimitedId(), proof->getSignature())};
+            const avalanche::StakeCommitment commitment{
+                proof->getStakeCommitment()};
+            for (const avalanche::SignedStake &ss : proof->getStakes()) {
+                valid &= ss.verify(commitment);
+            }
+            assert(valid);
+        }
+    });
+}
+
+static void AvalancheResponseSignaturesSerial(benchmark::Bench &bench) {
+    AvalancheResponseSignatures(bench, /*batched=*/false);
+}
+
+static void AvalancheResponseSignaturesBatched(benchmark::Bench &bench) {
+    AvalancheResponseSignatures(bench, /*batched=*/true);
+}
+
+static void AvalancheProofSignaturesSerial(benchmark::Bench &bench) {
+    AvalancheProofSignatures(bench, /*batched=*/false);
+}
+
+static void AvalancheProofSignaturesBatched(benchmark::Bench &bench) {
+    AvalancheProofSignatures(bench, /*batched=*/true);
+}
+
+BENCHMARK(AvalancheResponseSignaturesSerial);
+BENCHMARK(AvalancheResponseSignaturesBatched);
+BENCHMARK(AvalancheProofSignaturesSerial);
+BENCHMARK(AvalancheProofSignaturesBatched);
@@ -6,6 +6,7 @@
 
 #include <clientversion.h>
 #include <common/args.h>
+#include <crypto/scrypt.h>
 #include <crypto/sha256.h>
 #include <util/fs.h>
 #include <util/strencodings.h>
@@ -65,6 +66,7 @@ int main(int argc, char **argv) {
     ArgsManager argsman;
     SetupBenchArgs(argsman);
     SHA256AutoDetect();
+    ScryptAutoDetect();
     std::string error;
     if (!argsman.ParseParameters(argc, argv, error)) {
         tfm::format(std::cerr, "Error parsing command line arguments: %s\n",
@@ -5,6 +5,7 @@
 #include <bench/bench.h>
 #include <config.h>
 #include <consensus/validation.h>
+#include <node/miner.h>
 #include <script/standard.h>
 #include <test/util/mining.h>
 #include <test/util/setup_common.h>
@@ -54,3 +55,93 @@ static void AssembleBlock(benchmark::Bench &bench) {
 }
 
 BENCHMARK(AssembleBlock);
+
+// Assemble blocks out of a mempool of about ten thousand transactions: each
+// mature coinbase is split into many outputs which are then spent by their own
+// transaction.
+static void AssembleBlockLargeMempool(benchmark::Bench &bench,
+                                      bool from_scratch) {
+    const auto test_setup = MakeNoLogFileContext<const TestingSetup>();
+    const Config &config = test_setup->m_node.chainman->GetConfig();
+    CTxMemPool &mempool = *test_setup->m_node.mempool;
+
+    const CScript redeemScript = CScript() << OP_DROP << OP_TRUE;
+    const CScript SCRIPT_PUB =
+        CScript() << OP_HASH160 << ToByteVector(CScriptID(redeemScript))
+                  << OP_EQUAL;
+
+    const CScript scriptSig = CScript() << std::vector<uint8_t>(100, 0xff)
+                                        << ToByteVector(redeemScript);
+
+    constexpr size_t NUM_BLOCKS{200};
+    constexpr size_t NUM_OUTPUTS{100};
+    std::vector<CTxIn> coinbases;
+    for (size_t b = 0; b < NUM_BLOCKS; ++b) {
+        coinbases.push_back(
+            MineBlock(config, test_setup->m_node, SCRIPT_PUB));
+    }
+    coinbases.resize(NUM_BLOCKS - REGTEST_COINBASE_MATURITY + 1);
+
+    {
+        LOCK(::cs_main);
+        ChainstateManager &chainman = *test_setup->m_node.chainman;
+
+        auto submit = [&](const CMutableTransaction &tx) {
+            const MempoolAcceptResult res =
+                chainman.ProcessTransaction(MakeTransactionRef(tx));
+            assert(res.m_result_type == MempoolAcceptResult::ResultType::VALID);
+        };
+
+        for (CTxIn &coinbase : coinbases) {
+            const Amount value = chainman.ActiveChainstate()
+                                     .CoinsTip()
+                                     .AccessCoin(coinbase.prevout)
+                                     .GetTxOut()
+                                     .nValue;
+            CMutableTransaction split;
+            coinbase.scriptSig = scriptSig;
+            split.vin.push_back(coinbase);
+            const Amount output_value =
+                (value - COIN / 10) / int64_t(NUM_OUTPUTS);
+            for (size_t n = 0; n < NUM_OUTPUTS; ++n) {
+                split.vout.emplace_back(output_value, SCRIPT_PUB);
+            }
+            submit(split);
+
+            const TxId split_id = split.GetId();
+            for (uint32_t n = 0; n < NUM_OUTPUTS; ++n) {
+                CMutableTransaction spend;
+                spend.vin.emplace_back(COutPoint(split_id, n), scriptSig);
+                // Vary the fees so that the transactions are not selected in
+                // the order they entered the mempool.
+                spend.vout.emplace_back(
+                    output_value - int64_t(n % 7 + 1) * (COIN / 100),
+                    SCRIPT_PUB);
+                submit(spend);
+            }
+        }
+    }
+
+    bench.run([&] {
+        if (from_scratch) {
+            WITH_LOCK(mempool.cs, mempool.m_template_candidates.Invalidate());
+        }
+        Chainstate &chainstate =
+            test_setup->m_node.chainman->ActiveChainstate();
+        const auto blocktemplate =
+            node::BlockAssembler{config, chainstate, &mempool}.CreateNewBlock(
+                SCRIPT_PUB);
+        assert(blocktemplate->block.vtx.size() > 1);
+    });
+}
+
+static void AssembleBlockLargeMempoolIncremental(benchmark::Bench &bench) {
+    AssembleBlockLargeMempool(bench, /*from_scratch=*/false);
+}
+
+static void AssembleBlockLargeMempoolFromScratch(benchmark::Bench &bench) {
+    AssembleBlockLargeMempool(bench, /*from_scratch=*/true);
+}
+
+BENCHMARK(AssembleBlockLargeMempoolIncremental);
+BENCHMARK(AssembleBlockLargeMempoolFromScratch);
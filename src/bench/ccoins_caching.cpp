@@ -5,8 +5,10 @@
 #include <bench/bench.h>
 #include <coins.h>
 #include <policy/policy.h>
+#include <random.h>
 #include <script/signingprovider.h>
 #include <test/util/transaction_utils.h>
+#include <txdb.h>
 
 #include <vector>
 
@@ -51,3 +53,57 @@ static void CCoinsCaching(benchmark::Bench &bench) {
 }
 
 BENCHMARK(CCoinsCaching);
+
+// Flush a synthetic cache of a few million dirty coins, about the size of a
+// -dbcache flush during IBD, to an in-memory coins database.
+static void CCoinsViewDBFlush(benchmark::Bench &bench, int threads) {
+    static constexpr uint32_t NUM_TXS{500'000};
+    static constexpr uint32_t OUTPUTS_PER_TX{4};
+
+    CCoinsViewDB db{
+        {.path = "bench", .cache_bytes = 1 << 23, .memory_only = true}, {}};
+
+    FastRandomContext rng(true);
+    CCoinsMapMemoryResource resource;
+    CCoinsMap coins{0, CCoinsMap::hasher{}, CCoinsMap::key_equal{},
+                    &resource};
+    coins.reserve(NUM_TXS * OUTPUTS_PER_TX);
+    for (uint32_t i = 0; i < NUM_TXS; ++i) {
+        const TxId txid{rng.rand256()};
+        for (uint32_t n = 0; n < OUTPUTS_PER_TX; ++n) {
+            CScript script;
+            script << OP_DUP << OP_HASH160 << rng.randbytes(20)
+                   << OP_EQUALVERIFY << OP_CHECKSIG;
+            Coin coin{CTxOut{int64_t(rng.randrange(100'000)) * COIN, script},
+                      i, false};
+            coins.emplace(std::piecewise_construct,
+                          std::forward_as_tuple(txid, n),
+                          std::forward_as_tuple(std::move(coin),
+                                                CCoinsCacheEntry::DIRTY));
+        }
+    }
+
+    if (threads > 0) {
+        StartCoinsDBWriteWorkerThreads(threads);
+    }
+    // Coins are not erased so that every iteration writes the whole map.
+    bench.epochs(2).epochIterations(1).run([&] {
+        bool success = db.BatchWrite(coins, BlockHash{rng.rand256()},
+                                     /*erase=*/false);
+        assert(success);
+    });
+    if (threads > 0) {
+        StopCoinsDBWriteWorkerThreads();
+    }
+}
+
+static void CCoinsViewDBFlushSingleThread(benchmark::Bench &bench) {
+    CCoinsViewDBFlush(bench, 0);
+}
+
+static void CCoinsViewDBFlushParallel(benchmark::Bench &bench) {
+    CCoinsViewDBFlush(bench, 3);
+}
+
+BENCHMARK(CCoinsViewDBFlushSingleThread);
+BENCHMARK(CCoinsViewDBFlushParallel);
@@ -5,6 +5,7 @@
 #include <bench/bench.h>
 #include <checkqueue.h>
 #include <common/system.h>
+#include <crypto/sha256.h>
 #include <key.h>
 #include <prevector.h>
 #include <pubkey.h>
@@ -63,3 +64,76 @@ static void CCheckQueueSpeedPrevectorJob(benchmark::Bench &bench) {
     ECC_Stop();
 }
 BENCHMARK(CCheckQueueSpeedPrevectorJob);
+
+// This Benchmark sweeps the number of threads and the cost of each check, to
+// measure how the queue scales with the number of workers and how much of the
+// time is spent handing out work rather than doing it.
+template <int THREADS, int CHECK_ROUNDS>
+static void CCheckQueueSweep(benchmark::Bench &bench) {
+    struct HashJob {
+        uint8_t data[CSHA256::OUTPUT_SIZE]{};
+        bool operator()() {
+            for (int i = 0; i < CHECK_ROUNDS; ++i) {
+                CSHA256().Write(data, sizeof(data)).Finalize(data);
+            }
+            return true;
+        }
+    };
+    CCheckQueue<HashJob> queue{QUEUE_BATCH_SIZE};
+    // The master thread counts towards the threads
+    queue.StartWorkerThreads(THREADS - 1);
+
+    bench.minEpochIterations(10)
+        .batch(BATCH_SIZE * BATCHES)
+        .unit("job")
+        .run([&] {
+            CCheckQueueControl<HashJob> control(&queue);
+            for (size_t i = 0; i < BATCHES; ++i) {
+                control.Add(std::vector<HashJob>(BATCH_SIZE));
+            }
+            control.Wait();
+        });
+    queue.StopWorkerThreads();
+}
+
+static void CCheckQueueSweep1ThreadCheap(benchmark::Bench &bench) {
+    CCheckQueueSweep<1, 1>(bench);
+}
+static void CCheckQueueSweep2ThreadsCheap(benchmark::Bench &bench) {
+    CCheckQueueSweep<2, 1>(bench);
+}
+static void CCheckQueueSweep4ThreadsCheap(benchmark::Bench &bench) {
+    CCheckQueueSweep<4, 1>(bench);
+}
+static void CCheckQueueSweep8ThreadsCheap(benchmark::Bench &bench) {
+    CCheckQueueSweep<8, 1>(bench);
+}
+static void CCheckQueueSweep16ThreadsCheap(benchmark::Bench &bench) {
+    CCheckQueueSweep<16, 1>(bench);
+}
+static void CCheckQueueSweep1ThreadExpensive(benchmark::Bench &bench) {
+    CCheckQueueSweep<1, 100>(bench);
+}
+static void CCheckQueueSweep2ThreadsExpensive(benchmark::Bench &bench) {
+    CCheckQueueSweep<2, 100>(bench);
+}
+static void CCheckQueueSweep4ThreadsExpensive(benchmark::Bench &bench) {
+    CCheckQueueSweep<4, 100>(bench);
+}
+static void CCheckQueueSweep8ThreadsExpensive(benchmark::Bench &bench) {
+    CCheckQueueSweep<8, 100>(bench);
+}
+static void CCheckQueueSweep16ThreadsExpensive(benchmark::Bench &bench) {
+    CCheckQueueSweep<16, 100>(bench);
+}
+
+BENCHMARK(CCheckQueueSweep1ThreadCheap);
+BENCHMARK(CCheckQueueSweep2ThreadsCheap);
+BENCHMARK(CCheckQueueSweep4ThreadsCheap);
+BENCHMARK(CCheckQueueSweep8ThreadsCheap);
+BENCHMARK(CCheckQueueSweep16ThreadsCheap);
+BENCHMARK(CCheckQueueSweep1ThreadExpensive);
+BENCHMARK(CCheckQueueSweep2ThreadsExpensive);
+BENCHMARK(CCheckQueueSweep4ThreadsExpensive);
+BENCHMARK(CCheckQueueSweep8ThreadsExpensive);
+BENCHMARK(CCheckQueueSweep16ThreadsExpensive);
@@ -0,0 +1,86 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <invrequest.h>
+#include <primitives/txid.h>
+#include <random.h>
+
+#include <cassert>
+#include <chrono>
+#include <vector>
+
+static constexpr int NUM_PEERS{100};
+static constexpr int NUM_INVIDS{10000};
+
+/**
+ * Run the life cycle of many invids announced by every peer, like transactions
+ * relayed through the network: all the peers announce them, they are requested
+ * from a preferred peer which replies NOTFOUND for half of them and lets the
+ * other requests time out, then they are requested again from other peers, and
+ * finally they are all received.
+ */
+static void InvRequest(benchmark::Bench &bench,
+                       InvRequestTrackerImplType type) {
+    FastRandomContext rng{/*fDeterministic=*/true};
+    std::vector<TxId> invids;
+    invids.reserve(NUM_INVIDS);
+    for (int i = 0; i < NUM_INVIDS; ++i) {
+        invids.emplace_back(rng.rand256());
+    }
+
+    InvRequestTracker<TxId> tracker{/*deterministic=*/true, type};
+    std::chrono::microseconds now{1};
+
+    bench.epochs(2)
+        .epochIterations(1)
+        .batch(NUM_PEERS * NUM_INVIDS)
+        .unit("announcement")
+        .run([&] {
+            for (const TxId &invid : invids) {
+                for (NodeId peer = 0; peer < NUM_PEERS; ++peer) {
+                    const bool preferred{peer % 8 == 0};
+                    tracker.ReceivedInv(
+                        peer, invid, preferred,
+                        now + (preferred ? std::chrono::seconds{0}
+                                         : std::chrono::seconds{2}));
+                }
+            }
+
+            // The first peers the invids are requested from answer NOTFOUND
+            // half of the time.
+            for (int round = 0; round < 2; ++round) {
+                now += std::chrono::seconds{3};
+                for (NodeId peer = 0; peer < NUM_PEERS; ++peer) {
+                    const auto requestable =
+                        tracker.GetRequestable(peer, now, nullptr);
+                    for (size_t i = 0; i < requestable.size(); ++i) {
+                        tracker.RequestedData(peer, requestable[i],
+                                              now + std::chrono::seconds{60});
+                        if (round == 0 && i % 2 == 0) {
+                            tracker.ReceivedResponse(peer, requestable[i]);
+                        }
+                    }
+                }
+                // Let the unanswered requests time out.
+                now += std::chrono::seconds{60};
+            }
+
+            for (const TxId &invid : invids) {
+                tracker.ForgetInvId(invid);
+            }
+            assert(tracker.Size() == 0);
+        });
+}
+
+static void InvRequestOrdered(benchmark::Bench &bench) {
+    InvRequest(bench, InvRequestTrackerImplType::ORDERED);
+}
+
+static void InvRequestFlat(benchmark::Bench &bench) {
+    InvRequest(bench, InvRequestTrackerImplType::FLAT);
+}
+
+BENCHMARK(InvRequestOrdered);
+BENCHMARK(InvRequestFlat);
@@ -0,0 +1,109 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <config.h>
+#include <net.h>
+#include <net_processing.h>
+#include <netmessagemaker.h>
+#include <protocol.h>
+#include <validation.h>
+#include <version.h>
+
+#include <test/util/net.h>
+#include <test/util/setup_common.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/** Number of peers sending messages concurrently. */
+static constexpr int NUM_PEERS{8};
+/** Number of getdata and ping messages received from each peer. */
+static constexpr int NUM_MESSAGES_PER_PEER{10};
+
+static void ProcessMessages(benchmark::Bench &bench, int num_workers) {
+    const auto testing_setup = MakeNoLogFileContext<const TestingSetup>();
+    const Config &config = testing_setup->m_node.chainman->GetConfig();
+    ConnmanTestMsg &connman =
+        static_cast<ConnmanTestMsg &>(*testing_setup->m_node.connman);
+
+    LOCK(NetEventsInterface::g_msgproc_mutex);
+
+    std::vector<std::unique_ptr<CNode>> nodes;
+    for (NodeId id = 0; id < NUM_PEERS; ++id) {
+        // The replies are sent successfully and dropped.
+        nodes.push_back(std::make_unique<CNode>(
+            id, std::make_shared<StaticContentsSock>(std::string{}),
+            CAddress{CService{CNetAddr{in_addr{0x0100000a + uint32_t(id)}},
+                              7777},
+                     NODE_NETWORK},
+            /*nKeyedNetGroupIn=*/0, /*nLocalHostNonceIn=*/0,
+            /*nLocalExtraEntropyIn=*/0, CAddress{}, /*addrNameIn=*/"",
+            ConnectionType::INBOUND, /*inbound_onion=*/false));
+        connman.Handshake(*nodes.back(), /*successfully_connected=*/true,
+                          /*remote_services=*/ServiceFlags(NODE_NETWORK),
+                          /*local_services=*/ServiceFlags(NODE_NETWORK),
+                          /*version=*/PROTOCOL_VERSION, /*relay_txs=*/true);
+    }
+
+    connman.StartMessageWorkers(num_workers);
+
+    // Serving a block read from disk stands for the expensive messages, the
+    // pings for the cheap ones.
+    const CNetMsgMaker msg_maker{PROTOCOL_VERSION};
+    const CSerializedNetMsg getdata{msg_maker.Make(
+        NetMsgType::GETDATA,
+        std::vector<CInv>{
+            CInv{MSG_BLOCK, config.GetChainParams().GenesisBlock().GetHash()}})};
+    const CSerializedNetMsg ping{
+        msg_maker.Make(NetMsgType::PING, uint64_t{0})};
+
+    bench.batch(NUM_PEERS * NUM_MESSAGES_PER_PEER * 2)
+        .unit("message")
+        .run([&] {
+            for (const auto &node : nodes) {
+                for (int i = 0; i < NUM_MESSAGES_PER_PEER; ++i) {
+                    CSerializedNetMsg msg{getdata.Copy()};
+                    (void)connman.ReceiveMsgFrom(*node, msg);
+                    msg = ping.Copy();
+                    (void)connman.ReceiveMsgFrom(*node, msg);
+                }
+            }
+
+            // A node is referenced while one of its messages is being
+            // processed by a worker thread.
+            bool done{false};
+            while (!done) {
+                done = true;
+                for (const auto &node : nodes) {
+                    connman.ProcessMessagesOnce(*node);
+                    done &= node->GetRefCount() == 0 &&
+                            WITH_LOCK(node->cs_vProcessMsg,
+                                      return node->vProcessMsg.empty());
+                }
+            }
+        });
+
+    connman.StopMessageWorkers();
+    for (const auto &node : nodes) {
+        testing_setup->m_node.peerman->FinalizeNode(config, *node);
+    }
+}
+
+static void ProcessMessagesNoWorker(benchmark::Bench &bench) {
+    ProcessMessages(bench, /*num_workers=*/0);
+}
+
+static void ProcessMessagesOneWorker(benchmark::Bench &bench) {
+    ProcessMessages(bench, /*num_workers=*/1);
+}
+
+static void ProcessMessagesFourWorkers(benchmark::Bench &bench) {
+    ProcessMessages(bench, /*num_workers=*/4);
+}
+
+BENCHMARK(ProcessMessagesNoWorker);
+BENCHMARK(ProcessMessagesOneWorker);
+BENCHMARK(ProcessMessagesFourWorkers);
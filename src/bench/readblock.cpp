@@ -0,0 +1,91 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <bench/data.h>
+#include <node/blockstorage.h>
+#include <streams.h>
+#include <validation.h>
+#include <version.h>
+
+#include <test/util/setup_common.h>
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * Compare reading an already validated block through its CBlockIndex, which
+ * skips the PoW check, with an untrusted read of the same position that
+ * re-hashes the header.
+ */
+static void ReadBlockFromDisk(benchmark::Bench &bench, bool trusted) {
+    const auto testing_setup{MakeNoLogFileContext<const TestChain100Setup>()};
+    ChainstateManager &chainman{*testing_setup->m_node.chainman};
+
+    const CBlockIndex *tip{WITH_LOCK(cs_main, return chainman.ActiveTip())};
+    const FlatFilePos pos{WITH_LOCK(cs_main, return tip->GetBlockPos())};
+
+    bench.run([&] {
+        CBlock block;
+        bool ok{trusted ? chainman.m_blockman.ReadBlockFromDisk(block, *tip)
+                        : chainman.m_blockman.ReadBlockFromDisk(block, pos)};
+        assert(ok);
+    });
+}
+
+static void ReadBlockFromDiskTrusted(benchmark::Bench &bench) {
+    ReadBlockFromDisk(bench, /*trusted=*/true);
+}
+
+static void ReadBlockFromDiskUntrusted(benchmark::Bench &bench) {
+    ReadBlockFromDisk(bench, /*trusted=*/false);
+}
+
+BENCHMARK(ReadBlockFromDiskTrusted);
+BENCHMARK(ReadBlockFromDiskUntrusted);
+
+/**
+ * Compare serving a large block by reading it and serializing it again with
+ * reading its serialization from disk as is.
+ */
+static void ServeBlockFromDisk(benchmark::Bench &bench, bool raw) {
+    const auto testing_setup{MakeNoLogFileContext<const TestingSetup>()};
+    ChainstateManager &chainman{*testing_setup->m_node.chainman};
+
+    CBlock block;
+    CDataStream stream(benchmark::data::block413567, SER_NETWORK,
+                       PROTOCOL_VERSION);
+    stream >> block;
+    const FlatFilePos pos{WITH_LOCK(
+        cs_main, return chainman.m_blockman.SaveBlockToDisk(
+                     block, 0, chainman.ActiveChain(), nullptr))};
+    assert(!pos.IsNull());
+
+    bench.unit("block").run([&] {
+        std::vector<uint8_t> data;
+        if (raw) {
+            bool ok{chainman.m_blockman.ReadRawBlockFromDisk(
+                data, pos, /*check_pow=*/false)};
+            assert(ok);
+        } else {
+            CBlock read;
+            bool ok{chainman.m_blockman.ReadBlockFromDisk(read, pos,
+                                                          /*check_pow=*/false)};
+            assert(ok);
+            CVectorWriter{SER_NETWORK, PROTOCOL_VERSION, data, 0} << read;
+        }
+        ankerl::nanobench::doNotOptimizeAway(data);
+    });
+}
+
+static void ServeBlockFromDiskDeserialized(benchmark::Bench &bench) {
+    ServeBlockFromDisk(bench, /*raw=*/false);
+}
+
+static void ServeBlockFromDiskRaw(benchmark::Bench &bench) {
+    ServeBlockFromDisk(bench, /*raw=*/true);
+}
+
+BENCHMARK(ServeBlockFromDiskDeserialized);
+BENCHMARK(ServeBlockFromDiskRaw);
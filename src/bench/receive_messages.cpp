@@ -0,0 +1,132 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <avalanche/protocol.h>
+#include <bench/bench.h>
+#include <config.h>
+#include <net.h>
+#include <netmessagemaker.h>
+#include <primitives/transaction.h>
+#include <protocol.h>
+#include <random.h>
+#include <script/script.h>
+#include <span.h>
+#include <version.h>
+
+#include <test/util/setup_common.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/** Number of each of the tx, inv and avapoll messages in the stream. */
+static constexpr int NUM_MESSAGES_PER_TYPE{100};
+/** The stream is received in chunks of the size of a TCP segment. */
+static constexpr size_t CHUNK_SIZE{1448};
+
+/**
+ * Build the wire serialization of a stream of messages typical of a node
+ * relaying transactions and polled by avalanche.
+ */
+static std::vector<uint8_t> MakeMessageStream(const Config &config) {
+    const CNetMsgMaker msg_maker{PROTOCOL_VERSION};
+    V1TransportSerializer serializer;
+    std::vector<uint8_t> stream;
+    auto append = [&](CSerializedNetMsg &&msg) {
+        std::vector<uint8_t> header;
+        serializer.prepareForTransport(config, msg, header);
+        stream.insert(stream.end(), header.begin(), header.end());
+        stream.insert(stream.end(), msg.data.begin(), msg.data.end());
+    };
+
+    for (int i = 0; i < NUM_MESSAGES_PER_TYPE; ++i) {
+        // A P2PKH transaction spending one input to two outputs.
+        CMutableTransaction tx;
+        tx.vin.emplace_back(COutPoint{TxId{GetRandHash()}, 0});
+        tx.vin[0].scriptSig = CScript() << std::vector<uint8_t>(72)
+                                        << std::vector<uint8_t>(33);
+        for (int j = 0; j < 2; ++j) {
+            tx.vout.emplace_back(COIN, CScript() << OP_DUP << OP_HASH160
+                                                 << std::vector<uint8_t>(20)
+                                                 << OP_EQUALVERIFY
+                                                 << OP_CHECKSIG);
+        }
+        append(msg_maker.Make(NetMsgType::TX, CTransaction{tx}));
+
+        std::vector<CInv> invs;
+        for (int j = 0; j < 8; ++j) {
+            invs.emplace_back(MSG_TX, GetRandHash());
+        }
+        append(msg_maker.Make(NetMsgType::INV, invs));
+
+        invs.clear();
+        for (int j = 0; j < 16; ++j) {
+            invs.emplace_back(MSG_TX, GetRandHash());
+        }
+        append(msg_maker.Make(NetMsgType::AVAPOLL,
+                              avalanche::Poll{uint64_t(i), invs}));
+    }
+
+    return stream;
+}
+
+static void ReceiveMessages(benchmark::Bench &bench, bool use_pool) {
+    const auto testing_setup = MakeNoLogFileContext<const BasicTestingSetup>();
+    const Config &config = GetConfig();
+
+    CNode node{/*id=*/0,
+               /*sock=*/nullptr,
+               /*addrIn=*/CAddress{},
+               /*nKeyedNetGroupIn=*/0,
+               /*nLocalHostNonceIn=*/0,
+               /*nLocalExtraEntropyIn=*/0,
+               /*addrBindIn=*/CAddress{},
+               /*addrNameIn=*/"",
+               /*conn_type_in=*/ConnectionType::INBOUND,
+               /*inbound_onion=*/false,
+               CNodeOptions{
+                   .recv_buffer_pool =
+                       use_pool ? std::make_shared<RecvBufferPool>() : nullptr,
+               }};
+    node.SetCommonVersion(PROTOCOL_VERSION);
+
+    const std::vector<uint8_t> stream{MakeMessageStream(config)};
+
+    bench.batch(3 * NUM_MESSAGES_PER_TYPE).unit("message").run([&] {
+        Span<const uint8_t> bytes{stream};
+        while (!bytes.empty()) {
+            const Span<const uint8_t> chunk{
+                bytes.first(std::min(CHUNK_SIZE, bytes.size()))};
+            bool complete{false};
+            const bool connected{node.ReceiveMsgBytes(config, chunk, complete)};
+            assert(connected);
+            if (complete) {
+                node.MarkReceivedMsgsForProcessing(
+                    DEFAULT_MAXRECEIVEBUFFER * 1000);
+            }
+            bytes = bytes.subspan(chunk.size());
+        }
+
+        // Processing the messages is left out, they are only destroyed.
+        LOCK(node.cs_vProcessMsg);
+        assert(node.vProcessMsg.size() == 3 * NUM_MESSAGES_PER_TYPE);
+        while (!node.vProcessMsg.empty()) {
+            node.vProcessMsg.pop_front();
+        }
+        node.nProcessQueueSize = 0;
+    });
+}
+
+static void ReceiveMessagesPooled(benchmark::Bench &bench) {
+    ReceiveMessages(bench, /*use_pool=*/true);
+}
+
+static void ReceiveMessagesUnpooled(benchmark::Bench &bench) {
+    ReceiveMessages(bench, /*use_pool=*/false);
+}
+
+BENCHMARK(ReceiveMessagesPooled);
+BENCHMARK(ReceiveMessagesUnpooled);
@@ -0,0 +1,68 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <crypto/scrypt.h>
+#include <random.h>
+
+#include <array>
+#include <vector>
+
+static constexpr size_t HEADER_SIZE = 80;
+
+/** Hash n random headers one at a time. */
+static void ScryptSerial(benchmark::Bench &bench, size_t n) {
+    FastRandomContext rng(true);
+    std::vector<std::vector<uint8_t>> inputs;
+    for (size_t i = 0; i < n; ++i) {
+        inputs.push_back(rng.randbytes(HEADER_SIZE));
+    }
+    std::array<uint8_t, 32> hash;
+    bench.batch(n).unit("header").run([&] {
+        for (const auto &input : inputs) {
+            scrypt_1024_1_1_256(input.data(), hash.data());
+        }
+    });
+}
+
+/** Hash n random headers through the multi-lane API. */
+static void ScryptMulti(benchmark::Bench &bench, size_t n) {
+    FastRandomContext rng(true);
+    std::vector<std::vector<uint8_t>> inputs;
+    std::vector<std::array<uint8_t, 32>> hashes(n);
+    std::vector<const uint8_t *> input_ptrs;
+    std::vector<uint8_t *> output_ptrs;
+    for (size_t i = 0; i < n; ++i) {
+        inputs.push_back(rng.randbytes(HEADER_SIZE));
+    }
+    for (size_t i = 0; i < n; ++i) {
+        input_ptrs.push_back(inputs[i].data());
+        output_ptrs.push_back(hashes[i].data());
+    }
+    bench.batch(n).unit("header").run([&] {
+        scrypt_1024_1_1_256_multi(input_ptrs.data(), output_ptrs.data(), n);
+    });
+}
+
+static void Scrypt_1(benchmark::Bench &bench) {
+    ScryptSerial(bench, 1);
+}
+static void ScryptMulti_4(benchmark::Bench &bench) {
+    ScryptMulti(bench, 4);
+}
+static void ScryptMulti_8(benchmark::Bench &bench) {
+    ScryptMulti(bench, 8);
+}
+static void Scrypt_2000(benchmark::Bench &bench) {
+    ScryptSerial(bench, 2000);
+}
+static void ScryptMulti_2000(benchmark::Bench &bench) {
+    ScryptMulti(bench, 2000);
+}
+
+BENCHMARK(Scrypt_1);
+BENCHMARK(ScryptMulti_4);
+BENCHMARK(ScryptMulti_8);
+BENCHMARK(Scrypt_2000);
+BENCHMARK(ScryptMulti_2000);
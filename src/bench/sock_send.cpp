@@ -0,0 +1,73 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <compat.h>
+#include <protocol.h>
+#include <span.h>
+#include <util/sock.h>
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+// Windows does not have socketpair(2).
+#ifndef WIN32
+
+/** Number of queued messages, each made of a header and a payload buffer. */
+static constexpr size_t NUM_MESSAGES{50};
+/** Size of an inv message payload announcing a few transactions. */
+static constexpr size_t PAYLOAD_SIZE{181};
+
+static void SockSendQueuedMessages(benchmark::Bench &bench, bool send_many) {
+    int s[2];
+    const int ret{socketpair(AF_UNIX, SOCK_STREAM, 0, s)};
+    assert(ret == 0);
+    const Sock sender(s[0]);
+    const Sock receiver(s[1]);
+
+    std::vector<std::vector<uint8_t>> queue;
+    size_t total_size{0};
+    for (size_t i = 0; i < NUM_MESSAGES; ++i) {
+        queue.emplace_back(CMessageHeader::HEADER_SIZE, uint8_t(i));
+        queue.emplace_back(PAYLOAD_SIZE, uint8_t(i));
+        total_size += CMessageHeader::HEADER_SIZE + PAYLOAD_SIZE;
+    }
+    std::vector<Span<const uint8_t>> bufs(queue.begin(), queue.end());
+    std::array<uint8_t, 64 * 1024> recv_buf;
+
+    bench.batch(total_size).unit("byte").run([&] {
+        size_t sent{0};
+        if (send_many) {
+            sent = sender.SendMany(bufs, MSG_NOSIGNAL);
+        } else {
+            for (const auto &buf : bufs) {
+                sent += sender.Send(buf.data(), buf.size(), MSG_NOSIGNAL);
+            }
+        }
+        assert(sent == total_size);
+
+        size_t received{0};
+        while (received < total_size) {
+            const ssize_t len{
+                receiver.Recv(recv_buf.data(), recv_buf.size(), 0)};
+            assert(len > 0);
+            received += len;
+        }
+    });
+}
+
+static void SockSendQueuedMessagesOneByOne(benchmark::Bench &bench) {
+    SockSendQueuedMessages(bench, /*send_many=*/false);
+}
+
+static void SockSendQueuedMessagesGathered(benchmark::Bench &bench) {
+    SockSendQueuedMessages(bench, /*send_many=*/true);
+}
+
+BENCHMARK(SockSendQueuedMessagesOneByOne);
+BENCHMARK(SockSendQueuedMessagesGathered);
+
+#endif // WIN32
@@ -0,0 +1,82 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <compat.h>
+#include <util/fs_helpers.h>
+#include <util/sock.h>
+#include <util/sockwaitset.h>
+
+#include <cassert>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+// Windows does not have socketpair(2).
+#ifndef WIN32
+
+static constexpr size_t NUM_SOCKETS{1000};
+static constexpr size_t NUM_ACTIVE_SOCKETS{10};
+
+/**
+ * Simulate a node with many mostly idle peers: NUM_SOCKETS connected sockets,
+ * only NUM_ACTIVE_SOCKETS of which have data ready to be received.
+ */
+struct IdleSockets {
+    std::vector<std::shared_ptr<const Sock>> waited;
+    std::vector<std::unique_ptr<Sock>> peers;
+
+    IdleSockets() {
+        RaiseFileDescriptorLimit(2 * NUM_SOCKETS + 64);
+        for (size_t i = 0; i < NUM_SOCKETS; ++i) {
+            int s[2];
+            const int ret{socketpair(AF_UNIX, SOCK_STREAM, 0, s)};
+            assert(ret == 0);
+            waited.push_back(std::make_shared<const Sock>(s[0]));
+            peers.push_back(std::make_unique<Sock>(s[1]));
+        }
+        // The data is never read, so these stay ready for every wait.
+        for (size_t i = 0; i < NUM_SOCKETS;
+             i += NUM_SOCKETS / NUM_ACTIVE_SOCKETS) {
+            const ssize_t sent{peers[i]->Send("a", 1, 0)};
+            assert(sent == 1);
+        }
+    }
+};
+
+static void SockWaitManyIdle(benchmark::Bench &bench) {
+    const IdleSockets sockets;
+
+    bench.run([&] {
+        // Like the socket handler used to, build the set from scratch for
+        // every wait.
+        Sock::EventsPerSock events_per_sock;
+        for (const auto &sock : sockets.waited) {
+            events_per_sock.emplace(sock, Sock::Events{Sock::RECV});
+        }
+        const bool ok{sockets.waited.front()->WaitMany(
+            std::chrono::milliseconds{0}, events_per_sock)};
+        assert(ok);
+    });
+}
+
+static void SockWaitSetIdle(benchmark::Bench &bench) {
+    const IdleSockets sockets;
+    const std::unique_ptr<SockWaitSet> wait_set{MakeSockWaitSet()};
+    for (const auto &sock : sockets.waited) {
+        wait_set->Set(sock, Sock::RECV);
+    }
+
+    Sock::EventsPerSock events_per_sock;
+    bench.run([&] {
+        const bool ok{
+            wait_set->Wait(std::chrono::milliseconds{0}, events_per_sock)};
+        assert(ok);
+    });
+}
+
+BENCHMARK(SockWaitManyIdle);
+BENCHMARK(SockWaitSetIdle);
+
+#endif // WIN32
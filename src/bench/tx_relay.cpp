@@ -0,0 +1,110 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <bench/bench.h>
+#include <config.h>
+#include <kernel/mempool_entry.h>
+#include <net.h>
+#include <net_processing.h>
+#include <primitives/transaction.h>
+#include <script/script.h>
+#include <txmempool.h>
+#include <util/time.h>
+#include <validation.h>
+#include <version.h>
+
+#include <test/util/net.h>
+#include <test/util/setup_common.h>
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+/**
+ * Number of transactions entering the mempool between two announcements to
+ * the peers. It stays below the number of transactions announced at once so
+ * that every peer is sent all of them.
+ */
+static constexpr int NUM_TXS_PER_TICK{30};
+
+/**
+ * Announce the transactions entering the mempool to num_peers peers, as the
+ * message handler thread does.
+ */
+static void RelayTransactions(benchmark::Bench &bench, int num_peers) {
+    const auto testing_setup = MakeNoLogFileContext<const TestingSetup>();
+    const Config &config = testing_setup->m_node.chainman->GetConfig();
+    ConnmanTestMsg &connman =
+        static_cast<ConnmanTestMsg &>(*testing_setup->m_node.connman);
+    PeerManager &peerman = *testing_setup->m_node.peerman;
+    CTxMemPool &mempool = *testing_setup->m_node.mempool;
+
+    LOCK(NetEventsInterface::g_msgproc_mutex);
+
+    std::vector<std::unique_ptr<CNode>> nodes;
+    for (NodeId id = 0; id < num_peers; ++id) {
+        // The announcements are sent successfully and dropped.
+        nodes.push_back(std::make_unique<CNode>(
+            id, std::make_shared<StaticContentsSock>(std::string{}),
+            CAddress{CService{CNetAddr{in_addr{0x0100000a + uint32_t(id)}},
+                              7777},
+                     NODE_NETWORK},
+            /*nKeyedNetGroupIn=*/0, /*nLocalHostNonceIn=*/0,
+            /*nLocalExtraEntropyIn=*/0, CAddress{}, /*addrNameIn=*/"",
+            ConnectionType::INBOUND, /*inbound_onion=*/false));
+        connman.Handshake(*nodes.back(), /*successfully_connected=*/true,
+                          /*remote_services=*/ServiceFlags(NODE_NETWORK),
+                          /*local_services=*/ServiceFlags(NODE_NETWORK),
+                          /*version=*/PROTOCOL_VERSION, /*relay_txs=*/true);
+    }
+
+    uint32_t tx_counter{0};
+    int64_t mock_time{GetTime()};
+    bench.batch(num_peers * NUM_TXS_PER_TICK)
+        .unit("announcement")
+        .run([&] {
+            for (int i = 0; i < NUM_TXS_PER_TICK; ++i) {
+                CMutableTransaction tx;
+                tx.vin.resize(1);
+                tx.vin[0].scriptSig = CScript() << CScriptNum(++tx_counter);
+                tx.vout.resize(1);
+                tx.vout[0].scriptPubKey = CScript() << OP_TRUE;
+                tx.vout[0].nValue = COIN;
+                const CTransactionRef txref{MakeTransactionRef(tx)};
+                {
+                    LOCK2(cs_main, mempool.cs);
+                    LockPoints lp;
+                    mempool.addUnchecked(CTxMemPoolEntryRef::make(
+                        txref, 1000 * SATOSHI, /*time=*/0, /*height=*/1,
+                        /*sigChecks=*/1, lp));
+                }
+                peerman.RelayTransaction(txref->GetId());
+            }
+
+            // Make sure every peer is due an announcement.
+            mock_time += 60 * 60;
+            SetMockTime(mock_time);
+            for (const auto &node : nodes) {
+                peerman.SendMessages(config, node.get());
+            }
+
+            mempool.clear();
+        });
+
+    for (const auto &node : nodes) {
+        peerman.FinalizeNode(config, *node);
+    }
+    SetMockTime(0);
+}
+
+static void RelayTransactionsTo10Peers(benchmark::Bench &bench) {
+    RelayTransactions(bench, /*num_peers=*/10);
+}
+
+static void RelayTransactionsTo100Peers(benchmark::Bench &bench) {
+    RelayTransactions(bench, /*num_peers=*/100);
+}
+
+BENCHMARK(RelayTransactionsTo10Peers);
+BENCHMARK(RelayTransactionsTo100Peers);
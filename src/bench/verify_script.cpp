@@ -7,14 +7,19 @@
 #if defined(HAVE_CONSENSUS_LIB)
 #include <script/bitcoinconsensus.h>
 #endif
+#include <policy/policy.h>
 #include <script/interpreter.h>
 #include <script/script.h>
 #include <script/script_error.h>
 #include <script/standard.h>
 #include <streams.h>
+#include <validation.h>
+
+#include <test/util/setup_common.h>
 #include <test/util/transaction_utils.h>
 
 #include <array>
+#include <vector>
 
 static void VerifyNestedIfScript(benchmark::Bench &bench) {
     std::vector<std::vector<uint8_t>> stack;
@@ -39,3 +44,84 @@ static void VerifyNestedIfScript(benchmark::Bench &bench) {
 }
 
 BENCHMARK(VerifyNestedIfScript);
+
+// Verify the scripts of a block made of Schnorr signed P2PKH spends, on a
+// single thread so only the cost per signature is measured.
+static void VerifySchnorrP2PKHBlock(benchmark::Bench &bench, bool batched) {
+    const auto testing_setup = MakeNoLogFileContext<const BasicTestingSetup>();
+    const uint32_t flags = SCRIPT_VERIFY_P2SH | SCRIPT_VERIFY_STRICTENC |
+                           SCRIPT_ENABLE_SIGHASH_FORKID |
+                           SCRIPT_VERIFY_NULLFAIL;
+    const Amount amount = 1000 * SATOSHI;
+    const SigHashType sighash_type = SigHashType().withForkId();
+    const size_t n_txs = 250;
+    const size_t n_inputs_per_tx = 4;
+
+    std::vector<CTransactionRef> txs;
+    std::vector<CScript> scriptPubKeys;
+    for (size_t i = 0; i < n_txs; ++i) {
+        CKey key;
+        key.MakeNewKey(true);
+        const CPubKey pubkey = key.GetPubKey();
+        scriptPubKeys.push_back(GetScriptForDestination(PKHash(pubkey)));
+
+        CMutableTransaction mtx;
+        mtx.vin.resize(n_inputs_per_tx);
+        for (size_t j = 0; j < n_inputs_per_tx; ++j) {
+            mtx.vin[j].prevout = COutPoint(TxId(GetRandHash()), j);
+        }
+        mtx.vout.emplace_back(amount, CScript() << OP_1);
+        for (size_t j = 0; j < n_inputs_per_tx; ++j) {
+            std::vector<uint8_t> sig;
+            bool signed_ok = key.SignSchnorr(
+                SignatureHash(scriptPubKeys.back(), CTransaction(mtx), j,
+                              sighash_type, amount),
+                sig);
+            assert(signed_ok);
+            sig.push_back(uint8_t(sighash_type.getRawSigHashType()));
+            mtx.vin[j].scriptSig = CScript() << sig << ToByteVector(pubkey);
+        }
+        txs.push_back(MakeTransactionRef(std::move(mtx)));
+    }
+    std::vector<PrecomputedTransactionData> txdata;
+    for (const CTransactionRef &tx : txs) {
+        txdata.emplace_back(*tx);
+    }
+
+    bench.unit("txin").batch(n_txs * n_inputs_per_tx).run([&] {
+        std::vector<CScriptCheck> checks;
+        for (size_t i = 0; i < n_txs; ++i) {
+            for (size_t j = 0; j < n_inputs_per_tx; ++j) {
+                checks.emplace_back(CTxOut(amount, scriptPubKeys[i]), *txs[i],
+                                    j, flags, false, txdata[i]);
+            }
+        }
+        if (batched) {
+            const size_t group_size = 32;
+            for (size_t i = 0; i < checks.size(); i += group_size) {
+                std::vector<CScriptCheck> group(
+                    std::make_move_iterator(checks.begin() + i),
+                    std::make_move_iterator(
+                        checks.begin() + std::min(i + group_size, checks.size())));
+                bool ret = CBatchedScriptCheck(std::move(group))();
+                assert(ret);
+            }
+        } else {
+            for (CScriptCheck &check : checks) {
+                bool ret = check();
+                assert(ret);
+            }
+        }
+    });
+}
+
+static void VerifySchnorrP2PKHBlockIndividually(benchmark::Bench &bench) {
+    VerifySchnorrP2PKHBlock(bench, /*batched=*/false);
+}
+
+static void VerifySchnorrP2PKHBlockBatched(benchmark::Bench &bench) {
+    VerifySchnorrP2PKHBlock(bench, /*batched=*/true);
+}
+
+BENCHMARK(VerifySchnorrP2PKHBlockIndividually);
+BENCHMARK(VerifySchnorrP2PKHBlockBatched);
@@ -316,6 +316,8 @@ epilogue:
     }
     StopScriptCheckWorkerThreads();
     StopPowCheckWorkerThreads();
+    StopCoinPrefetchWorkerThreads();
+    StopCoinsDBWriteWorkerThreads();
 
     GetMainSignals().FlushBackgroundCallbacks();
     {
@@ -35,13 +35,6 @@ std::string CBlockIndex::ToString() const {
 CBlockHeader
 CBlockIndex::GetBlockHeader(const node::BlockManager &blockman) const {
     CBlockHeader block;
-    if (VersionHasAuxPow(nVersion)) {
-        if (!blockman.ReadBlockHeaderFromDisk(block, *this)) {
-            throw std::ios_base::failure(
-                "Failed reading AuxPow CBlockIndex header from disk");
-        }
-        return block;
-    }
     block.nVersion = nVersion;
     if (pprev) {
         block.hashPrevBlock = pprev->GetBlockHash();
@@ -50,6 +43,14 @@ CBlockIndex::GetBlockHeader(const node::BlockManager &blockman) const {
     block.nTime = nTime;
     block.nBits = nBits;
     block.nNonce = nNonce;
+    if (VersionHasAuxPow(nVersion)) {
+        // The auxpow is not part of the block index
+        block.auxpow = blockman.GetAuxPow(*this);
+        if (!block.auxpow) {
+            throw std::ios_base::failure(
+                "Failed reading AuxPow CBlockIndex header from disk");
+        }
+    }
     return block;
 }
 
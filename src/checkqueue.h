@@ -10,7 +10,12 @@
 #include <util/threadnames.h>
 
 #include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <iterator>
+#include <memory>
+#include <thread>
 #include <vector>
 
 template <typename T> class CCheckQueueControl;
@@ -24,10 +29,23 @@ template <typename T> class CCheckQueueControl;
  * queue, where they are processed by N-1 worker threads. When the master is
  * done adding work, it temporarily joins the worker pool as an N'th worker,
  * until all jobs are done.
+ *
+ * Every worker, including the master, owns a deque of pending checks. The
+ * master spreads the checks it adds over these deques, and a worker whose own
+ * deque runs dry steals from the others, so the threads only contend on the
+ * deques they actually share work through. The first failing check is
+ * broadcast to all workers, which then skip the remaining checks.
  */
 template <typename T> class CCheckQueue {
 private:
-    //! Mutex to protect the inner state
+    //! The checks owned by one worker, which other workers may steal from.
+    struct WorkerQueue {
+        Mutex m_mutex;
+        //! Its owner takes from the back, thieves take from the front.
+        std::deque<T> m_checks GUARDED_BY(m_mutex);
+    };
+
+    //! Mutex to protect the sleeping and stopping of the worker threads
     Mutex m_mutex;
 
     //! Worker threads block on this when out of work
@@ -36,25 +54,28 @@ private:
     //! Master thread blocks on this when out of work
     std::condition_variable m_master_cv;
 
-    //! The queue of elements to be processed.
-    //! As the order of booleans doesn't matter, it is used as a LIFO (stack)
-    std::vector<T> queue GUARDED_BY(m_mutex);
-
-    //! The number of workers (including the master) that are idle.
-    int nIdle GUARDED_BY(m_mutex){0};
+    //! One queue per worker; the master owns the first one. Only resized
+    //! while no worker threads are running.
+    std::vector<std::unique_ptr<WorkerQueue>> m_queues;
 
-    //! The total number of workers (including the master).
-    int nTotal GUARDED_BY(m_mutex){0};
-
-    //! The temporary evaluation result.
-    bool fAllOk GUARDED_BY(m_mutex){true};
+    //! The number of checks sitting in the worker queues.
+    std::atomic<int64_t> m_queued{0};
 
     /**
      * Number of verifications that haven't completed yet.
      * This includes elements that are no longer queued, but still in the
      * worker's own batches.
      */
-    unsigned int nTodo GUARDED_BY(m_mutex){0};
+    std::atomic<int64_t> m_todo{0};
+
+    //! The number of worker threads that are asleep.
+    std::atomic<int> m_idle{0};
+
+    //! Set by the first failing check, until the master collects the result.
+    std::atomic<bool> m_failed{false};
+
+    //! The queue the master adds its next checks to. Only used by the master.
+    size_t m_next_queue{0};
 
     //! The maximum number of elements to be processed in one batch
     const unsigned int nBatchSize;
@@ -62,74 +83,72 @@ private:
     std::vector<std::thread> m_worker_threads;
     bool m_request_stop GUARDED_BY(m_mutex){false};
 
-    /** Internal function that does bulk of the verification work. */
-    bool Loop(bool fMaster) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex) {
-        std::condition_variable &cond = fMaster ? m_master_cv : m_worker_cv;
+    /**
+     * Move a batch of checks into vChecks, preferably from the back of the
+     * worker's own queue and otherwise from the front of another one.
+     * Batches are half of the queue they are taken from, so they get smaller
+     * as the work runs out and all workers finish approximately together.
+     */
+    bool Acquire(size_t id, std::vector<T> &vChecks) {
+        for (size_t i = 0; i < m_queues.size(); ++i) {
+            const bool own = i == 0;
+            WorkerQueue &queue = *m_queues[(id + i) % m_queues.size()];
+            LOCK(queue.m_mutex);
+            if (queue.m_checks.empty()) {
+                continue;
+            }
+            const size_t nNow =
+                std::min<size_t>(nBatchSize, (queue.m_checks.size() + 1) / 2);
+            auto start_it = own ? queue.m_checks.end() - nNow
+                                : queue.m_checks.begin();
+            auto end_it = start_it + nNow;
+            vChecks.assign(std::make_move_iterator(start_it),
+                           std::make_move_iterator(end_it));
+            queue.m_checks.erase(start_it, end_it);
+            m_queued -= nNow;
+            return true;
+        }
+        return false;
+    }
+
+    /** Execute and destroy a batch of checks, then mark them as done. */
+    void Run(std::vector<T> &vChecks) {
+        for (T &check : vChecks) {
+            if (m_failed.load(std::memory_order_relaxed)) {
+                break;
+            }
+            if (!check()) {
+                m_failed = true;
+            }
+        }
+        const int64_t nDone = vChecks.size();
+        vChecks.clear();
+        if (m_todo.fetch_sub(nDone) == nDone) {
+            // We processed the last element; inform the master it can exit
+            // and return the result
+            WITH_LOCK(m_mutex, m_master_cv.notify_one());
+        }
+    }
+
+    /** Loop of the worker threads, until they are asked to stop. */
+    void WorkerLoop(size_t id) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex) {
         std::vector<T> vChecks;
         vChecks.reserve(nBatchSize);
-        unsigned int nNow = 0;
-        bool fOk = true;
-        do {
-            {
-                WAIT_LOCK(m_mutex, lock);
-                // first do the clean-up of the previous loop run (allowing us
-                // to do it in the same critsect)
-                if (nNow) {
-                    fAllOk &= fOk;
-                    nTodo -= nNow;
-                    if (nTodo == 0 && !fMaster) {
-                        // We processed the last element; inform the master it
-                        // can exit and return the result
-                        m_master_cv.notify_one();
-                    }
-                } else {
-                    // first iteration
-                    nTotal++;
-                }
-                // logically, the do loop starts here
-                while (queue.empty() && !m_request_stop) {
-                    if (fMaster && nTodo == 0) {
-                        nTotal--;
-                        bool fRet = fAllOk;
-                        // reset the status for new work later
-                        fAllOk = true;
-                        // return the current status
-                        return fRet;
-                    }
-                    nIdle++;
-                    cond.wait(lock); // wait
-                    nIdle--;
-                }
-                if (m_request_stop) {
-                    return false;
-                }
-
-                // Decide how many work units to process now.
-                // * Do not try to do everything at once, but aim for
-                // increasingly smaller batches so all workers finish
-                // approximately simultaneously.
-                // * Try to account for idle jobs which will instantly start
-                // helping.
-                // * Don't do batches smaller than 1 (duh), or larger than
-                // nBatchSize.
-                nNow = std::max(
-                    1U, std::min(nBatchSize, (unsigned int)queue.size() /
-                                                 (nTotal + nIdle + 1)));
-                auto start_it = queue.end() - nNow;
-                vChecks.assign(std::make_move_iterator(start_it),
-                               std::make_move_iterator(queue.end()));
-                queue.erase(start_it, queue.end());
-                // Check whether we need to do work at all
-                fOk = fAllOk;
+        while (true) {
+            if (Acquire(id, vChecks)) {
+                Run(vChecks);
+                continue;
             }
-            // execute work
-            for (T &check : vChecks) {
-                if (fOk) {
-                    fOk = check();
-                }
+            WAIT_LOCK(m_mutex, lock);
+            ++m_idle;
+            m_worker_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+                return m_request_stop || m_queued > 0;
+            });
+            --m_idle;
+            if (m_request_stop) {
+                return;
             }
-            vChecks.clear();
-        } while (true);
+        }
     }
 
 public:
@@ -137,23 +156,23 @@ public:
     Mutex m_control_mutex;
 
     //! Create a new check queue
-    explicit CCheckQueue(unsigned int nBatchSizeIn)
-        : nBatchSize(nBatchSizeIn) {}
+    explicit CCheckQueue(unsigned int nBatchSizeIn) : nBatchSize(nBatchSizeIn) {
+        m_queues.push_back(std::make_unique<WorkerQueue>());
+    }
 
     //! Create a pool of new worker threads.
     void StartWorkerThreads(const int threads_num)
         EXCLUSIVE_LOCKS_REQUIRED(!m_mutex) {
-        {
-            LOCK(m_mutex);
-            nIdle = 0;
-            nTotal = 0;
-            fAllOk = true;
-        }
         assert(m_worker_threads.empty());
+        m_failed = false;
+        m_queues.resize(1);
+        for (int n = 0; n < threads_num; ++n) {
+            m_queues.push_back(std::make_unique<WorkerQueue>());
+        }
         for (int n = 0; n < threads_num; ++n) {
             m_worker_threads.emplace_back([this, n]() {
                 util::ThreadRename(strprintf("scriptch.%i", n));
-                Loop(false /* worker thread */);
+                WorkerLoop(n + 1);
             });
         }
     }
@@ -161,19 +180,51 @@ public:
     //! Wait until execution finishes, and return whether all evaluations were
     //! successful.
     bool Wait() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex) {
-        return Loop(true /* master thread */);
+        std::vector<T> vChecks;
+        vChecks.reserve(nBatchSize);
+        while (Acquire(0, vChecks)) {
+            Run(vChecks);
+        }
+        {
+            WAIT_LOCK(m_mutex, lock);
+            m_master_cv.wait(lock, [&] { return m_todo == 0; });
+        }
+        // reset the status for new work later
+        return !m_failed.exchange(false);
     }
 
     //! Add a batch of checks to the queue
     void Add(std::vector<T> &&vChecks) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex) {
-        LOCK(m_mutex);
-        queue.insert(queue.end(), std::make_move_iterator(vChecks.begin()),
-                     std::make_move_iterator(vChecks.end()));
-        nTodo += vChecks.size();
-        if (vChecks.size() == 1) {
-            m_worker_cv.notify_one();
-        } else if (vChecks.size() > 1) {
-            m_worker_cv.notify_all();
+        if (vChecks.empty()) {
+            return;
+        }
+        const size_t nChecks = vChecks.size();
+        m_todo += nChecks;
+        m_queued += nChecks;
+
+        // Spread the checks over the worker queues in contiguous slices,
+        // continuing where the previous call left off so that many small
+        // batches get distributed as well.
+        const size_t nSlice =
+            (nChecks + m_queues.size() - 1) / m_queues.size();
+        for (size_t begin = 0; begin < nChecks; begin += nSlice) {
+            const size_t end = std::min(begin + nSlice, nChecks);
+            WorkerQueue &queue = *m_queues[m_next_queue];
+            m_next_queue = (m_next_queue + 1) % m_queues.size();
+            LOCK(queue.m_mutex);
+            queue.m_checks.insert(
+                queue.m_checks.end(),
+                std::make_move_iterator(vChecks.begin() + begin),
+                std::make_move_iterator(vChecks.begin() + end));
+        }
+
+        if (m_idle > 0) {
+            LOCK(m_mutex);
+            if (nChecks == 1) {
+                m_worker_cv.notify_one();
+            } else {
+                m_worker_cv.notify_all();
+            }
         }
     }
 
@@ -185,9 +236,14 @@ public:
             t.join();
         }
         m_worker_threads.clear();
+        m_queues.resize(1);
+        m_next_queue = 0;
         WITH_LOCK(m_mutex, m_request_stop = false);
     }
 
+    //! Whether any worker threads are running besides the master
+    bool HasThreads() const { return !m_worker_threads.empty(); }
+
     ~CCheckQueue() { assert(m_worker_threads.empty()); }
 };
 
@@ -60,8 +60,10 @@ size_t CCoinsViewBacked::EstimateSize() const {
 
 CCoinsViewCache::CCoinsViewCache(CCoinsView *baseIn, bool deterministic)
     : CCoinsViewBacked(baseIn), m_deterministic(deterministic),
+      m_cache_coins_memory_resource(
+          std::make_unique<CCoinsMapMemoryResource>()),
       cacheCoins(0, SaltedOutpointHasher(/*deterministic=*/deterministic),
-                 CCoinsMap::key_equal{}, &m_cache_coins_memory_resource),
+                 CCoinsMap::key_equal{}, m_cache_coins_memory_resource.get()),
       cachedCoinsUsage(0) {}
 
 size_t CCoinsViewCache::DynamicMemoryUsage() const {
@@ -153,6 +155,17 @@ void CCoinsViewCache::EmplaceCoinInternalDANGER(COutPoint &&outpoint,
         std::forward_as_tuple(std::move(coin), CCoinsCacheEntry::DIRTY));
 }
 
+void CCoinsViewCache::PrefetchCoin(const COutPoint &outpoint, Coin &&coin) {
+    assert(!coin.IsSpent());
+    auto [it, inserted] =
+        cacheCoins.emplace(std::piecewise_construct,
+                           std::forward_as_tuple(outpoint),
+                           std::forward_as_tuple(std::move(coin)));
+    if (inserted) {
+        cachedCoinsUsage += it->second.coin.DynamicMemoryUsage();
+    }
+}
+
 void AddCoins(CCoinsViewCache &cache, const CTransaction &tx, int nHeight,
               bool check_for_overwrite) {
     bool fCoinbase = tx.IsCoinBase();
@@ -327,6 +340,22 @@ bool CCoinsViewCache::Sync() {
     return fOk;
 }
 
+CCoinsMapDetached CCoinsViewCache::Detach() {
+    const size_t usage{DynamicMemoryUsage()};
+    // Moving the map keeps its nodes in the memory resource, which therefore
+    // goes along with it.
+    CCoinsMapDetached detached{std::move(m_cache_coins_memory_resource),
+                               std::move(cacheCoins), hashBlock, usage};
+    cachedCoinsUsage = 0;
+    cacheCoins.~CCoinsMap();
+    m_cache_coins_memory_resource =
+        std::make_unique<CCoinsMapMemoryResource>();
+    ::new (&cacheCoins)
+        CCoinsMap{0, SaltedOutpointHasher{/*deterministic=*/m_deterministic},
+                  CCoinsMap::key_equal{}, m_cache_coins_memory_resource.get()};
+    return detached;
+}
+
 void CCoinsViewCache::Uncache(const COutPoint &outpoint) {
     CCoinsMap::iterator it = cacheCoins.find(outpoint);
     if (it != cacheCoins.end() && it->second.flags == 0) {
@@ -361,11 +390,11 @@ void CCoinsViewCache::ReallocateCache() {
     // Cache should be empty when we're calling this.
     assert(cacheCoins.size() == 0);
     cacheCoins.~CCoinsMap();
-    m_cache_coins_memory_resource.~CCoinsMapMemoryResource();
-    ::new (&m_cache_coins_memory_resource) CCoinsMapMemoryResource{};
+    m_cache_coins_memory_resource =
+        std::make_unique<CCoinsMapMemoryResource>();
     ::new (&cacheCoins)
         CCoinsMap{0, SaltedOutpointHasher{/*deterministic=*/m_deterministic},
-                  CCoinsMap::key_equal{}, &m_cache_coins_memory_resource};
+                  CCoinsMap::key_equal{}, m_cache_coins_memory_resource.get()};
 }
 
 void CCoinsViewCache::SanityCheck() const {
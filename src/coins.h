@@ -16,6 +16,7 @@
 #include <cassert>
 #include <cstdint>
 #include <functional>
+#include <memory>
 #include <unordered_map>
 
 /**
@@ -139,6 +140,18 @@ using CCoinsMap = std::unordered_map<
 
 using CCoinsMapMemoryResource = CCoinsMap::allocator_type::ResourceType;
 
+/**
+ * The contents of a CCoinsViewCache moved out by CCoinsViewCache::Detach(),
+ * along with the memory resource they are allocated from.
+ */
+struct CCoinsMapDetached {
+    std::unique_ptr<CCoinsMapMemoryResource> resource;
+    CCoinsMap coins;
+    BlockHash hashBlock;
+    //! Memory usage of coins, as reported by the cache.
+    size_t usage;
+};
+
 /** Cursor for iterating over CoinsView state */
 class CCoinsViewCursor {
 public:
@@ -228,7 +241,8 @@ protected:
      * declared as "const".
      */
     mutable BlockHash hashBlock;
-    mutable CCoinsMapMemoryResource m_cache_coins_memory_resource{};
+    mutable std::unique_ptr<CCoinsMapMemoryResource>
+        m_cache_coins_memory_resource;
     mutable CCoinsMap cacheCoins;
 
     /* Cached dynamic memory usage for the inner Coin objects. */
@@ -289,6 +303,15 @@ public:
      */
     void EmplaceCoinInternalDANGER(COutPoint &&outpoint, Coin &&coin);
 
+    /**
+     * Insert an unspent coin that was read from the backing view ahead of
+     * time. The entry is not marked dirty, so this is equivalent to the lookup
+     * a later cache miss would have done. Has no effect if the outpoint is
+     * already cached.
+     * @sa Chainstate::ConnectBlock()
+     */
+    void PrefetchCoin(const COutPoint &outpoint, Coin &&coin);
+
     /**
      * Spend a coin. Pass moveto in order to get the deleted data.
      * If no unspent output exists for the passed outpoint, this call has no
@@ -313,6 +336,13 @@ public:
      */
     bool Sync();
 
+    /**
+     * Move the whole content of this cache out, without writing it to its
+     * base, and leave the cache empty. The caller takes over the
+     * responsibility of writing the dirty entries to the base.
+     */
+    CCoinsMapDetached Detach();
+
     /**
      * Removes the UTXO with the given outpoint from the cache, if it is not
      * modified.
@@ -97,6 +97,7 @@ typedef char *sockopt_arg_type;
 // https://github.com/bitcoin/bitcoin/pull/14336#issuecomment-437384408
 #if defined(__linux__)
 #define USE_POLL
+#define USE_EPOLL
 #endif
 
 static bool inline IsSelectableSocket(const SOCKET &s) {
@@ -27,8 +27,13 @@
  * online backup system.
  */
 
-#include <crypto/hmac_sha256.h>
 #include <crypto/scrypt.h>
+
+#include <compat/cpuid.h>
+#include <crypto/hmac_sha256.h>
+
+#include <cassert>
+#include <memory>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
@@ -283,3 +288,186 @@ void scrypt_1024_1_1_256(const uint8_t *input, uint8_t *output) {
     memset(scratchpad, 0, sizeof(scratchpad));
     scrypt_1024_1_1_256_sp(input, output, scratchpad);
 }
+
+namespace scrypt_sse2 {
+void ROMix_4way(uint32_t *words, uint8_t *scratchpad);
+}
+
+namespace scrypt_avx2 {
+void ROMix_8way(uint32_t *words, uint8_t *scratchpad);
+}
+
+namespace {
+
+/**
+ * Multi-lane ROMix kernels operate on interleaved words: word k of lane l is
+ * stored at words[k * LANES + l]. The scratchpad is 64-byte aligned and holds
+ * 128 KiB per lane.
+ */
+typedef void (*ROMixType)(uint32_t *, uint8_t *);
+
+ROMixType ROMix_4way = nullptr;
+ROMixType ROMix_8way = nullptr;
+
+uint8_t *GetMultiScratchpad() {
+    // Allocated once per thread on first use, as it is too large to live on
+    // the stack.
+    thread_local std::unique_ptr<uint8_t[]> scratchpad{
+        new uint8_t[SCRYPT_MAX_LANES * 131072 + 63]};
+    return (uint8_t *)(((uintptr_t)(scratchpad.get()) + 63) & ~(uintptr_t)(63));
+}
+
+template <size_t LANES>
+void ScryptLanes(ROMixType romix, const uint8_t *const *inputs,
+                 uint8_t *const *outputs) {
+    uint8_t B[LANES][128];
+    uint32_t X[32 * LANES];
+
+    for (size_t l = 0; l < LANES; ++l) {
+        PBKDF2_SHA256(inputs[l], 80, inputs[l], 80, 1, B[l], 128);
+        for (size_t k = 0; k < 32; ++k) {
+            X[k * LANES + l] = le32dec(&B[l][4 * k]);
+        }
+    }
+
+    romix(X, GetMultiScratchpad());
+
+    for (size_t l = 0; l < LANES; ++l) {
+        for (size_t k = 0; k < 32; ++k) {
+            le32enc(&B[l][4 * k], X[k * LANES + l]);
+        }
+        PBKDF2_SHA256(inputs[l], 80, B[l], 128, 1, outputs[l], 32);
+    }
+}
+
+/**
+ * Run the last n < LANES inputs through a LANES-wide kernel, repeating the
+ * final input in the unused lanes and discarding their output.
+ */
+template <size_t LANES>
+void ScryptLanesPartial(ROMixType romix, const uint8_t *const *inputs,
+                        uint8_t *const *outputs, size_t n) {
+    const uint8_t *padded_inputs[LANES];
+    uint8_t *padded_outputs[LANES];
+    uint8_t discard[32];
+    for (size_t l = 0; l < LANES; ++l) {
+        padded_inputs[l] = inputs[l < n ? l : n - 1];
+        padded_outputs[l] = l < n ? outputs[l] : discard;
+    }
+    ScryptLanes<LANES>(romix, padded_inputs, padded_outputs);
+}
+
+bool SelfTest() {
+    uint8_t inputs[SCRYPT_MAX_LANES][80];
+    uint8_t expected[SCRYPT_MAX_LANES][32];
+    uint8_t results[SCRYPT_MAX_LANES][32];
+    const uint8_t *input_ptrs[SCRYPT_MAX_LANES];
+    uint8_t *output_ptrs[SCRYPT_MAX_LANES];
+
+    for (size_t i = 0; i < SCRYPT_MAX_LANES; ++i) {
+        for (size_t j = 0; j < 80; ++j) {
+            inputs[i][j] = uint8_t(i * 80 + j);
+        }
+        scrypt_1024_1_1_256(inputs[i], expected[i]);
+        input_ptrs[i] = inputs[i];
+        output_ptrs[i] = results[i];
+    }
+
+    // Cover the full width as well as the partial paths.
+    for (size_t n : {SCRYPT_MAX_LANES, size_t(5), size_t(3)}) {
+        memset(results, 0, sizeof(results));
+        scrypt_1024_1_1_256_multi(input_ptrs, output_ptrs, n);
+        for (size_t i = 0; i < n; ++i) {
+            if (memcmp(results[i], expected[i], 32) != 0) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+#if defined(USE_ASM) &&                                                        \
+    (defined(__x86_64__) || defined(__amd64__) || defined(__i386__))
+/** Check whether the OS has enabled AVX registers. */
+bool AVXEnabled() {
+    uint32_t a, d;
+    __asm__("xgetbv" : "=a"(a), "=d"(d) : "c"(0));
+    return (a & 6) == 6;
+}
+#endif
+} // namespace
+
+void scrypt_1024_1_1_256_multi(const uint8_t *const *inputs,
+                               uint8_t *const *outputs, size_t n) {
+    size_t i = 0;
+    if (ROMix_8way) {
+        for (; n - i >= 8; i += 8) {
+            ScryptLanes<8>(ROMix_8way, inputs + i, outputs + i);
+        }
+        if (n - i > 4 || (n - i > 1 && !ROMix_4way)) {
+            ScryptLanesPartial<8>(ROMix_8way, inputs + i, outputs + i, n - i);
+            return;
+        }
+    }
+    if (ROMix_4way) {
+        for (; n - i >= 4; i += 4) {
+            ScryptLanes<4>(ROMix_4way, inputs + i, outputs + i);
+        }
+        if (n - i > 1) {
+            ScryptLanesPartial<4>(ROMix_4way, inputs + i, outputs + i, n - i);
+            return;
+        }
+    }
+    for (; i < n; ++i) {
+        scrypt_1024_1_1_256(inputs[i], outputs[i]);
+    }
+}
+
+std::string ScryptAutoDetect() {
+    std::string ret = "standard";
+#if defined(USE_ASM) && defined(HAVE_GETCPUID)
+    bool have_sse2 = false;
+    bool have_xsave = false;
+    bool have_avx = false;
+    bool have_avx2 = false;
+    bool enabled_avx = false;
+
+    (void)AVXEnabled;
+    (void)have_sse2;
+    (void)have_avx;
+    (void)have_xsave;
+    (void)have_avx2;
+    (void)enabled_avx;
+
+    uint32_t eax, ebx, ecx, edx;
+    GetCPUID(1, 0, eax, ebx, ecx, edx);
+    have_sse2 = (edx >> 26) & 1;
+    have_xsave = (ecx >> 27) & 1;
+    have_avx = (ecx >> 28) & 1;
+    if (have_xsave && have_avx) {
+        enabled_avx = AVXEnabled();
+    }
+    if (have_avx) {
+        GetCPUID(7, 0, eax, ebx, ecx, edx);
+        have_avx2 = (ebx >> 5) & 1;
+    }
+
+#if defined(ENABLE_SSE2) && !defined(BUILD_BITCOIN_INTERNAL)
+    if (have_sse2) {
+        ROMix_4way = scrypt_sse2::ROMix_4way;
+        ret = "sse2(4way)";
+    }
+#endif
+
+#if defined(ENABLE_AVX2) && !defined(BUILD_BITCOIN_INTERNAL)
+    if (have_avx2 && have_avx && enabled_avx) {
+        ROMix_8way = scrypt_avx2::ROMix_8way;
+        ret += ",avx2(8way)";
+    }
+#endif
+#endif
+
+    assert(SelfTest());
+    return ret;
+}
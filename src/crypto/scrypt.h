@@ -9,9 +9,28 @@
 #include <stdint.h>
 #include <stdlib.h>
 
+#include <string>
+
 static const int SCRYPT_SCRATCHPAD_SIZE = 131072 + 63;
 
+/** Widest number of inputs hashed together by scrypt_1024_1_1_256_multi. */
+static const size_t SCRYPT_MAX_LANES = 8;
+
 void scrypt_1024_1_1_256(const uint8_t *input, uint8_t *output);
+
+/**
+ * Hash n 80-byte inputs, writing 32 bytes to each of outputs. Groups of
+ * inputs are run through interleaved 8-way (AVX2) or 4-way (SSE2) kernels
+ * when ScryptAutoDetect() enabled them, falling back to one at a time.
+ */
+void scrypt_1024_1_1_256_multi(const uint8_t *const *inputs,
+                               uint8_t *const *outputs, size_t n);
+
+/**
+ * Autodetect the best available multi-lane scrypt implementation.
+ * Returns the name of the implementation.
+ */
+std::string ScryptAutoDetect();
 void scrypt_1024_1_1_256_sp_generic(const uint8_t *input, uint8_t *output,
                                     uint8_t *scratchpad);
 
@@ -0,0 +1,118 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef ENABLE_AVX2
+
+#include <cstdint>
+#include <immintrin.h>
+
+namespace scrypt_avx2 {
+namespace {
+
+    __m256i inline Add(__m256i x, __m256i y) {
+        return _mm256_add_epi32(x, y);
+    }
+    __m256i inline Xor(__m256i x, __m256i y) {
+        return _mm256_xor_si256(x, y);
+    }
+    template <int n> __m256i inline Rotl(__m256i x) {
+        return _mm256_or_si256(_mm256_slli_epi32(x, n),
+                               _mm256_srli_epi32(x, 32 - n));
+    }
+
+    /** Salsa20/8 core on 8 interleaved lanes, one 32-bit word per lane. */
+    void inline XorSalsa8(__m256i B[16], const __m256i Bx[16]) {
+        __m256i x[16];
+        for (int i = 0; i < 16; ++i) {
+            x[i] = B[i] = Xor(B[i], Bx[i]);
+        }
+        for (int i = 0; i < 8; i += 2) {
+            // Operate on columns.
+            x[4] = Xor(x[4], Rotl<7>(Add(x[0], x[12])));
+            x[9] = Xor(x[9], Rotl<7>(Add(x[5], x[1])));
+            x[14] = Xor(x[14], Rotl<7>(Add(x[10], x[6])));
+            x[3] = Xor(x[3], Rotl<7>(Add(x[15], x[11])));
+
+            x[8] = Xor(x[8], Rotl<9>(Add(x[4], x[0])));
+            x[13] = Xor(x[13], Rotl<9>(Add(x[9], x[5])));
+            x[2] = Xor(x[2], Rotl<9>(Add(x[14], x[10])));
+            x[7] = Xor(x[7], Rotl<9>(Add(x[3], x[15])));
+
+            x[12] = Xor(x[12], Rotl<13>(Add(x[8], x[4])));
+            x[1] = Xor(x[1], Rotl<13>(Add(x[13], x[9])));
+            x[6] = Xor(x[6], Rotl<13>(Add(x[2], x[14])));
+            x[11] = Xor(x[11], Rotl<13>(Add(x[7], x[3])));
+
+            x[0] = Xor(x[0], Rotl<18>(Add(x[12], x[8])));
+            x[5] = Xor(x[5], Rotl<18>(Add(x[1], x[13])));
+            x[10] = Xor(x[10], Rotl<18>(Add(x[6], x[2])));
+            x[15] = Xor(x[15], Rotl<18>(Add(x[11], x[7])));
+
+            // Operate on rows.
+            x[1] = Xor(x[1], Rotl<7>(Add(x[0], x[3])));
+            x[6] = Xor(x[6], Rotl<7>(Add(x[5], x[4])));
+            x[11] = Xor(x[11], Rotl<7>(Add(x[10], x[9])));
+            x[12] = Xor(x[12], Rotl<7>(Add(x[15], x[14])));
+
+            x[2] = Xor(x[2], Rotl<9>(Add(x[1], x[0])));
+            x[7] = Xor(x[7], Rotl<9>(Add(x[6], x[5])));
+            x[8] = Xor(x[8], Rotl<9>(Add(x[11], x[10])));
+            x[13] = Xor(x[13], Rotl<9>(Add(x[12], x[15])));
+
+            x[3] = Xor(x[3], Rotl<13>(Add(x[2], x[1])));
+            x[4] = Xor(x[4], Rotl<13>(Add(x[7], x[6])));
+            x[9] = Xor(x[9], Rotl<13>(Add(x[8], x[11])));
+            x[14] = Xor(x[14], Rotl<13>(Add(x[13], x[12])));
+
+            x[0] = Xor(x[0], Rotl<18>(Add(x[3], x[2])));
+            x[5] = Xor(x[5], Rotl<18>(Add(x[4], x[7])));
+            x[10] = Xor(x[10], Rotl<18>(Add(x[9], x[8])));
+            x[15] = Xor(x[15], Rotl<18>(Add(x[14], x[13])));
+        }
+        for (int i = 0; i < 16; ++i) {
+            B[i] = Add(B[i], x[i]);
+        }
+    }
+
+} // namespace
+
+void ROMix_8way(uint32_t *words, uint8_t *scratchpad) {
+    __m256i *V = (__m256i *)scratchpad;
+    const int *Vw = (const int *)scratchpad;
+    const __m256i mask = _mm256_set1_epi32(1023);
+    const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i X[32];
+
+    for (int k = 0; k < 32; ++k) {
+        X[k] = _mm256_loadu_si256((const __m256i *)&words[8 * k]);
+    }
+
+    for (int i = 0; i < 1024; ++i) {
+        for (int k = 0; k < 32; ++k) {
+            _mm256_store_si256(&V[i * 32 + k], X[k]);
+        }
+        XorSalsa8(&X[0], &X[16]);
+        XorSalsa8(&X[16], &X[0]);
+    }
+
+    for (int i = 0; i < 1024; ++i) {
+        // Every lane reads its own, data dependent, row of the scratchpad:
+        // word k of lane l in row j lives at index (j * 32 + k) * 8 + l.
+        const __m256i idx = Add(
+            _mm256_slli_epi32(_mm256_and_si256(X[16], mask), 8), lanes);
+        for (int k = 0; k < 32; ++k) {
+            X[k] = Xor(X[k], _mm256_i32gather_epi32(&Vw[8 * k], idx, 4));
+        }
+        XorSalsa8(&X[0], &X[16]);
+        XorSalsa8(&X[16], &X[0]);
+    }
+
+    for (int k = 0; k < 32; ++k) {
+        _mm256_storeu_si256((__m256i *)&words[8 * k], X[k]);
+    }
+}
+
+} // namespace scrypt_avx2
+
+#endif
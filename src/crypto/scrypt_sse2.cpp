@@ -0,0 +1,119 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifdef ENABLE_SSE2
+
+#include <cstdint>
+#include <emmintrin.h>
+
+namespace scrypt_sse2 {
+namespace {
+
+    __m128i inline Add(__m128i x, __m128i y) {
+        return _mm_add_epi32(x, y);
+    }
+    __m128i inline Xor(__m128i x, __m128i y) {
+        return _mm_xor_si128(x, y);
+    }
+    template <int n> __m128i inline Rotl(__m128i x) {
+        return _mm_or_si128(_mm_slli_epi32(x, n), _mm_srli_epi32(x, 32 - n));
+    }
+
+    /** Salsa20/8 core on 4 interleaved lanes, one 32-bit word per lane. */
+    void inline XorSalsa8(__m128i B[16], const __m128i Bx[16]) {
+        __m128i x[16];
+        for (int i = 0; i < 16; ++i) {
+            x[i] = B[i] = Xor(B[i], Bx[i]);
+        }
+        for (int i = 0; i < 8; i += 2) {
+            // Operate on columns.
+            x[4] = Xor(x[4], Rotl<7>(Add(x[0], x[12])));
+            x[9] = Xor(x[9], Rotl<7>(Add(x[5], x[1])));
+            x[14] = Xor(x[14], Rotl<7>(Add(x[10], x[6])));
+            x[3] = Xor(x[3], Rotl<7>(Add(x[15], x[11])));
+
+            x[8] = Xor(x[8], Rotl<9>(Add(x[4], x[0])));
+            x[13] = Xor(x[13], Rotl<9>(Add(x[9], x[5])));
+            x[2] = Xor(x[2], Rotl<9>(Add(x[14], x[10])));
+            x[7] = Xor(x[7], Rotl<9>(Add(x[3], x[15])));
+
+            x[12] = Xor(x[12], Rotl<13>(Add(x[8], x[4])));
+            x[1] = Xor(x[1], Rotl<13>(Add(x[13], x[9])));
+            x[6] = Xor(x[6], Rotl<13>(Add(x[2], x[14])));
+            x[11] = Xor(x[11], Rotl<13>(Add(x[7], x[3])));
+
+            x[0] = Xor(x[0], Rotl<18>(Add(x[12], x[8])));
+            x[5] = Xor(x[5], Rotl<18>(Add(x[1], x[13])));
+            x[10] = Xor(x[10], Rotl<18>(Add(x[6], x[2])));
+            x[15] = Xor(x[15], Rotl<18>(Add(x[11], x[7])));
+
+            // Operate on rows.
+            x[1] = Xor(x[1], Rotl<7>(Add(x[0], x[3])));
+            x[6] = Xor(x[6], Rotl<7>(Add(x[5], x[4])));
+            x[11] = Xor(x[11], Rotl<7>(Add(x[10], x[9])));
+            x[12] = Xor(x[12], Rotl<7>(Add(x[15], x[14])));
+
+            x[2] = Xor(x[2], Rotl<9>(Add(x[1], x[0])));
+            x[7] = Xor(x[7], Rotl<9>(Add(x[6], x[5])));
+            x[8] = Xor(x[8], Rotl<9>(Add(x[11], x[10])));
+            x[13] = Xor(x[13], Rotl<9>(Add(x[12], x[15])));
+
+            x[3] = Xor(x[3], Rotl<13>(Add(x[2], x[1])));
+            x[4] = Xor(x[4], Rotl<13>(Add(x[7], x[6])));
+            x[9] = Xor(x[9], Rotl<13>(Add(x[8], x[11])));
+            x[14] = Xor(x[14], Rotl<13>(Add(x[13], x[12])));
+
+            x[0] = Xor(x[0], Rotl<18>(Add(x[3], x[2])));
+            x[5] = Xor(x[5], Rotl<18>(Add(x[4], x[7])));
+            x[10] = Xor(x[10], Rotl<18>(Add(x[9], x[8])));
+            x[15] = Xor(x[15], Rotl<18>(Add(x[14], x[13])));
+        }
+        for (int i = 0; i < 16; ++i) {
+            B[i] = Add(B[i], x[i]);
+        }
+    }
+
+} // namespace
+
+void ROMix_4way(uint32_t *words, uint8_t *scratchpad) {
+    __m128i *V = (__m128i *)scratchpad;
+    const uint32_t *Vw = (const uint32_t *)scratchpad;
+    __m128i X[32];
+
+    for (int k = 0; k < 32; ++k) {
+        X[k] = _mm_loadu_si128((const __m128i *)&words[4 * k]);
+    }
+
+    for (int i = 0; i < 1024; ++i) {
+        for (int k = 0; k < 32; ++k) {
+            _mm_store_si128(&V[i * 32 + k], X[k]);
+        }
+        XorSalsa8(&X[0], &X[16]);
+        XorSalsa8(&X[16], &X[0]);
+    }
+
+    alignas(16) uint32_t x16[4];
+    for (int i = 0; i < 1024; ++i) {
+        // Every lane reads its own, data dependent, row of the scratchpad.
+        _mm_store_si128((__m128i *)x16, X[16]);
+        const uint32_t *row0 = &Vw[(x16[0] & 1023) * 128 + 0];
+        const uint32_t *row1 = &Vw[(x16[1] & 1023) * 128 + 1];
+        const uint32_t *row2 = &Vw[(x16[2] & 1023) * 128 + 2];
+        const uint32_t *row3 = &Vw[(x16[3] & 1023) * 128 + 3];
+        for (int k = 0; k < 32; ++k) {
+            X[k] = Xor(X[k], _mm_setr_epi32(row0[4 * k], row1[4 * k],
+                                            row2[4 * k], row3[4 * k]));
+        }
+        XorSalsa8(&X[0], &X[16]);
+        XorSalsa8(&X[16], &X[0]);
+    }
+
+    for (int k = 0; k < 32; ++k) {
+        _mm_storeu_si128((__m128i *)&words[4 * k], X[k]);
+    }
+}
+
+} // namespace scrypt_sse2
+
+#endif
@@ -114,6 +114,7 @@
 #include <thread>
 #include <vector>
 
+using kernel::DEFAULT_AUXPOW_HEADER_CACHE_MB;
 using kernel::DEFAULT_STOPAFTERBLOCKIMPORT;
 using kernel::DumpMempool;
 using kernel::ValidationCacheSizes;
@@ -280,6 +281,8 @@ void Shutdown(NodeContext &node) {
     }
     StopScriptCheckWorkerThreads();
     StopPowCheckWorkerThreads();
+    StopCoinPrefetchWorkerThreads();
+    StopCoinsDBWriteWorkerThreads();
 
     // After the threads that potentially access these pointers have been
     // stopped, destruct and reset all to nullptr.
@@ -498,6 +501,11 @@ void SetupServerArgs(NodeContext &node) {
             defaultChainParams->GetConsensus().defaultAssumeValid.GetHex(),
             testnetChainParams->GetConsensus().defaultAssumeValid.GetHex()),
         ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg("-auxpowheadercache=<n>",
+                   strprintf("Maximum memory used to keep the auxpow of "
+                             "merge-mined block headers, in MiB (default: %d)",
+                             DEFAULT_AUXPOW_HEADER_CACHE_MB),
+                   ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-blocksdir=<dir>",
                    "Specify directory to hold blocks subdirectory for *.dat "
                    "files (default: <datadir>)",
@@ -590,6 +598,30 @@ void SetupServerArgs(NodeContext &node) {
                   -GetNumCores(), MAX_SCRIPTCHECK_THREADS,
                   DEFAULT_SCRIPTCHECK_THREADS),
         ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg(
+        "-parprefetch=<n>",
+        strprintf("Set the number of threads reading the coins spent by a "
+                  "block before connecting it (%u to %d, 0 = auto, <0 = "
+                  "leave that many cores free, default: %d)",
+                  -GetNumCores(), MAX_COINPREFETCH_THREADS,
+                  DEFAULT_COINPREFETCH_THREADS),
+        ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg(
+        "-pardbwrite=<n>",
+        strprintf("Set the number of threads serializing the coins written "
+                  "to the database when flushing the coins cache (%u to %d, 0 "
+                  "= auto, <0 = leave that many cores free, default: %d)",
+                  -GetNumCores(), MAX_COINSDB_WRITE_THREADS,
+                  DEFAULT_COINSDB_WRITE_THREADS),
+        ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
+    argsman.AddArg(
+        "-parmsgproc=<n>",
+        strprintf("Set the number of threads processing the P2P messages "
+                  "that do not need the message handler thread, such as "
+                  "pings and block requests (%u to %d, 0 = auto, <0 = leave "
+                  "that many cores free, default: %d)",
+                  -GetNumCores(), MAX_MSGPROC_THREADS, DEFAULT_MSGPROC_THREADS),
+        ArgsManager::ALLOW_ANY, OptionsCategory::OPTIONS);
     argsman.AddArg("-persistmempool",
                    strprintf("Whether to save the mempool on shutdown and load "
                              "on restart (default: %u)",
@@ -2146,6 +2178,36 @@ bool AppInitMain(Config &config, RPCServer &rpcServer,
         StartPowCheckWorkerThreads(script_threads);
     }
 
+    int prefetch_threads =
+        args.GetIntArg("-parprefetch", DEFAULT_COINPREFETCH_THREADS);
+    if (prefetch_threads <= 0) {
+        // Same semantics as -par
+        prefetch_threads += GetNumCores();
+    }
+    prefetch_threads =
+        std::min(std::max(prefetch_threads - 1, 0), MAX_COINPREFETCH_THREADS);
+
+    LogPrintf("Coin prefetching uses %d additional threads\n",
+              prefetch_threads);
+    if (prefetch_threads >= 1) {
+        StartCoinPrefetchWorkerThreads(prefetch_threads);
+    }
+
+    int dbwrite_threads =
+        args.GetIntArg("-pardbwrite", DEFAULT_COINSDB_WRITE_THREADS);
+    if (dbwrite_threads <= 0) {
+        // Same semantics as -par
+        dbwrite_threads += GetNumCores();
+    }
+    dbwrite_threads =
+        std::min(std::max(dbwrite_threads - 1, 0), MAX_COINSDB_WRITE_THREADS);
+
+    LogPrintf("Coins database writes use %d additional threads\n",
+              dbwrite_threads);
+    if (dbwrite_threads >= 1) {
+        StartCoinsDBWriteWorkerThreads(dbwrite_threads);
+    }
+
     assert(!node.scheduler);
     node.scheduler = std::make_unique<CScheduler>();
 
@@ -2794,6 +2856,19 @@ bool AppInitMain(Config &config, RPCServer &rpcServer,
         1024 * 1024 *
         args.GetIntArg("-maxuploadtarget", DEFAULT_MAX_UPLOAD_TARGET);
     connOptions.m_peer_connect_timeout = peer_connect_timeout;
+
+    int msgproc_threads =
+        args.GetIntArg("-parmsgproc", DEFAULT_MSGPROC_THREADS);
+    if (msgproc_threads <= 0) {
+        // Same semantics as -par
+        msgproc_threads += GetNumCores();
+    }
+    // The message handler thread counts as one
+    connOptions.m_msgproc_threads =
+        std::min(std::max(msgproc_threads - 1, 0), MAX_MSGPROC_THREADS);
+    LogPrintf("P2P message processing uses %d additional threads\n",
+              connOptions.m_msgproc_threads);
+
     connOptions.whitelist_forcerelay =
         args.GetBoolArg("-whitelistforcerelay", DEFAULT_WHITELISTFORCERELAY);
     connOptions.whitelist_relay =
@@ -7,15 +7,21 @@
 #include <crypto/siphash.h>
 #include <net.h>
 #include <random.h>
+#include <util/hasher.h>
 
 #include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index_container.hpp>
 
+#include <algorithm>
 #include <cassert>
 #include <chrono>
 #include <functional>
+#include <limits>
+#include <map>
+#include <optional>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 namespace {
 
@@ -309,11 +315,14 @@ bool operator==(const PeerInfo &a, const PeerInfo &b) {
 };
 
 /**
- * (Re)compute the PeerInfo map from the index. Only used for sanity checking.
+ * (Re)compute the PeerInfo map from the announcements. Only used for sanity
+ * checking.
  */
-std::unordered_map<NodeId, PeerInfo> RecomputePeerInfo(const Index &index) {
+template <typename Announcements>
+std::unordered_map<NodeId, PeerInfo>
+RecomputePeerInfo(const Announcements &anns) {
     std::unordered_map<NodeId, PeerInfo> ret;
-    for (const Announcement &ann : index) {
+    for (const Announcement &ann : anns) {
         PeerInfo &info = ret[ann.m_peer];
         ++info.m_total;
         info.m_requested += (ann.GetState() == State::REQUESTED);
@@ -323,10 +332,11 @@ std::unordered_map<NodeId, PeerInfo> RecomputePeerInfo(const Index &index) {
 }
 
 /** Compute the InvIdInfo map. Only used for sanity checking. */
+template <typename Announcements>
 std::map<uint256, InvIdInfo>
-ComputeInvIdInfo(const Index &index, const PriorityComputer &computer) {
+ComputeInvIdInfo(const Announcements &anns, const PriorityComputer &computer) {
     std::map<uint256, InvIdInfo> ret;
-    for (const Announcement &ann : index) {
+    for (const Announcement &ann : anns) {
         InvIdInfo &info = ret[ann.m_invid];
         // Classify how many announcements of each state we have for this invid.
         info.m_candidate_delayed +=
@@ -350,6 +360,72 @@ ComputeInvIdInfo(const Index &index, const PriorityComputer &computer) {
     return ret;
 }
 
+/**
+ * Check the invariants on the announcements of each invid. Only used for
+ * sanity checking.
+ */
+template <typename Announcements>
+void SanityCheckInvIds(const Announcements &anns,
+                       const PriorityComputer &computer) {
+    // Calculate per-invid statistics from the announcements, and validate
+    // invariants.
+    for (auto &item : ComputeInvIdInfo(anns, computer)) {
+        InvIdInfo &info = item.second;
+
+        // Cannot have only COMPLETED peer (invid should have been forgotten
+        // already)
+        assert(info.m_candidate_delayed + info.m_candidate_ready +
+                   info.m_candidate_best + info.m_requested >
+               0);
+
+        // Can have at most 1 CANDIDATE_BEST/REQUESTED peer
+        assert(info.m_candidate_best + info.m_requested <= 1);
+
+        // If there are any CANDIDATE_READY announcements, there must be
+        // exactly one CANDIDATE_BEST or REQUESTED announcement.
+        if (info.m_candidate_ready > 0) {
+            assert(info.m_candidate_best + info.m_requested == 1);
+        }
+
+        // If there is both a CANDIDATE_READY and a CANDIDATE_BEST
+        // announcement, the CANDIDATE_BEST one must be at least as good
+        // (equal or higher priority) as the best CANDIDATE_READY.
+        if (info.m_candidate_ready && info.m_candidate_best) {
+            assert(info.m_priority_candidate_best >=
+                   info.m_priority_best_candidate_ready);
+        }
+
+        // No invid can have been announced by the same peer twice.
+        std::sort(info.m_peers.begin(), info.m_peers.end());
+        assert(
+            std::adjacent_find(info.m_peers.begin(), info.m_peers.end()) ==
+            info.m_peers.end());
+    }
+}
+
+/**
+ * Check that the states of the announcements are consistent with a point in
+ * time. Only used for sanity checking.
+ */
+template <typename Announcements>
+void SanityCheckTimePoint(const Announcements &anns,
+                          std::chrono::microseconds now) {
+    for (const Announcement &ann : anns) {
+        if (ann.IsWaiting()) {
+            // REQUESTED and CANDIDATE_DELAYED must have a time in the
+            // future (they should have been converted to
+            // COMPLETED/CANDIDATE_READY respectively).
+            assert(ann.m_time > now);
+        } else if (ann.IsSelectable()) {
+            // CANDIDATE_READY and CANDIDATE_BEST cannot have a time in the
+            // future (they should have remained CANDIDATE_DELAYED, or
+            // should have been converted back to it if time went
+            // backwards).
+            assert(ann.m_time <= now);
+        }
+    }
+}
+
 } // namespace
 
 /** Actual implementation for InvRequestTracker's data structure. */
@@ -375,59 +451,12 @@ public:
         // invariant that no PeerInfo announcements with m_total==0 exist.
         assert(m_peerinfo == RecomputePeerInfo(m_index));
 
-        // Calculate per-invid statistics from m_index, and validate
-        // invariants.
-        for (auto &item : ComputeInvIdInfo(m_index, m_computer)) {
-            InvIdInfo &info = item.second;
-
-            // Cannot have only COMPLETED peer (invid should have been forgotten
-            // already)
-            assert(info.m_candidate_delayed + info.m_candidate_ready +
-                       info.m_candidate_best + info.m_requested >
-                   0);
-
-            // Can have at most 1 CANDIDATE_BEST/REQUESTED peer
-            assert(info.m_candidate_best + info.m_requested <= 1);
-
-            // If there are any CANDIDATE_READY announcements, there must be
-            // exactly one CANDIDATE_BEST or REQUESTED announcement.
-            if (info.m_candidate_ready > 0) {
-                assert(info.m_candidate_best + info.m_requested == 1);
-            }
-
-            // If there is both a CANDIDATE_READY and a CANDIDATE_BEST
-            // announcement, the CANDIDATE_BEST one must be at least as good
-            // (equal or higher priority) as the best CANDIDATE_READY.
-            if (info.m_candidate_ready && info.m_candidate_best) {
-                assert(info.m_priority_candidate_best >=
-                       info.m_priority_best_candidate_ready);
-            }
-
-            // No invid can have been announced by the same peer twice.
-            std::sort(info.m_peers.begin(), info.m_peers.end());
-            assert(
-                std::adjacent_find(info.m_peers.begin(), info.m_peers.end()) ==
-                info.m_peers.end());
-        }
+        SanityCheckInvIds(m_index, m_computer);
     }
 
     void PostGetRequestableSanityCheck(std::chrono::microseconds now) const {
-        for (const Announcement &ann : m_index) {
-            if (ann.IsWaiting()) {
-                // REQUESTED and CANDIDATE_DELAYED must have a time in the
-                // future (they should have been converted to
-                // COMPLETED/CANDIDATE_READY respectively).
-                assert(ann.m_time > now);
-            } else if (ann.IsSelectable()) {
-                // CANDIDATE_READY and CANDIDATE_BEST cannot have a time in the
-                // future (they should have remained CANDIDATE_DELAYED, or
-                // should have been converted back to it if time went
-                // backwards).
-                assert(ann.m_time <= now);
-            }
-        }
+        SanityCheckTimePoint(m_index, now);
     }
-
 private:
     //! Wrapper around Index::...::erase that keeps m_peerinfo up to date.
     template <typename Tag> Iter<Tag> Erase(Iter<Tag> it) {
@@ -859,7 +888,673 @@ public:
     }
 };
 
+namespace {
+
+//! Index of an announcement in the vector of FlatInvRequestTrackerImpl.
+using Slot = uint32_t;
+
+//! Marker for the absence of an announcement.
+constexpr Slot NO_SLOT{std::numeric_limits<Slot>::max()};
+
+/** An announcement and where it is referenced from. */
+struct FlatAnnouncement {
+    //! The announcement, if the slot is in use.
+    std::optional<Announcement> m_ann;
+    //! The priority of the announcement, computed once.
+    Priority m_priority{0};
+    //! Position of the slot in FlatInvIdEntry::m_slots.
+    uint32_t m_invid_pos{0};
+    //! Position of the slot in FlatPeerEntry::m_slots.
+    uint32_t m_peer_pos{0};
+    //! Position of the slot in FlatPeerEntry::m_best, if CANDIDATE_BEST.
+    uint32_t m_best_pos{0};
+    //! Generation of the last timer pushed for the slot. The timers of the
+    //! older generations are stale.
+    uint32_t m_timer_gen{0};
+};
+
+/** The announcements of an invid. */
+struct FlatInvIdEntry {
+    //! Slots of all the announcements for this invid.
+    std::vector<Slot> m_slots;
+    //! Slot of the CANDIDATE_BEST or REQUESTED announcement, if any.
+    Slot m_selected{NO_SLOT};
+    //! Number of announcements for this invid that are not COMPLETED.
+    size_t m_non_completed{0};
+};
+
+/** The announcements of a peer. */
+struct FlatPeerEntry {
+    PeerInfo m_info;
+    //! Slots of all the announcements from this peer.
+    std::vector<Slot> m_slots;
+    //! Slots of the CANDIDATE_BEST announcements from this peer.
+    std::vector<Slot> m_best;
+};
+
+/** The time an announcement is waiting for, or was ready at. */
+struct Timer {
+    std::chrono::microseconds m_time;
+    Slot m_slot;
+    uint32_t m_gen;
+};
+
+/**
+ * A binary heap of timers. Timers are not removed when their announcement
+ * changes, they are skipped when they reach the top and are found to be
+ * stale.
+ */
+template <typename Compare> class TimerHeap {
+    std::vector<Timer> m_timers;
+
+public:
+    bool empty() const { return m_timers.empty(); }
+    size_t size() const { return m_timers.size(); }
+    const Timer &top() const { return m_timers.front(); }
+
+    void push(const Timer &timer) {
+        m_timers.push_back(timer);
+        std::push_heap(m_timers.begin(), m_timers.end(), Compare{});
+    }
+
+    void pop() {
+        std::pop_heap(m_timers.begin(), m_timers.end(), Compare{});
+        m_timers.pop_back();
+    }
+
+    //! Drop the stale timers.
+    template <typename Pred> void compact(Pred is_current) {
+        m_timers.erase(std::remove_if(m_timers.begin(), m_timers.end(),
+                                      [&](const Timer &timer) {
+                                          return !is_current(timer);
+                                      }),
+                       m_timers.end());
+        std::make_heap(m_timers.begin(), m_timers.end(), Compare{});
+    }
+
+    template <typename Pred> size_t count(Pred is_current) const {
+        return std::count_if(m_timers.begin(), m_timers.end(), is_current);
+    }
+};
+
+struct LaterTime {
+    bool operator()(const Timer &a, const Timer &b) const {
+        return a.m_time > b.m_time;
+    }
+};
+
+struct EarlierTime {
+    bool operator()(const Timer &a, const Timer &b) const {
+        return a.m_time < b.m_time;
+    }
+};
+
+} // namespace
+
+/**
+ * Implementation for InvRequestTracker's data structure that stores the
+ * announcements in a vector, and references them by position from hash tables
+ * of the invids and of the peers.
+ *
+ * Compared to InvRequestTrackerImpl, there is no node to allocate per
+ * announcement and per index, and looking up an announcement is a hash table
+ * lookup followed by a scan of the few announcements of its invid instead of
+ * a walk down a tree. Selecting the best CANDIDATE_READY announcement of an
+ * invid is linear in its number of announcements, which is bounded by the
+ * number of peers.
+ *
+ * The CANDIDATE_DELAYED and REQUESTED announcements are found by the time
+ * they wait for in a min-heap, and the CANDIDATE_READY and CANDIDATE_BEST ones
+ * by their reqtime in a max-heap, in case the time goes backwards. See
+ * SanityCheck() for the invariants.
+ */
+class FlatInvRequestTrackerImpl : public InvRequestTrackerImplInterface {
+    using InvIdMap =
+        std::unordered_map<uint256, FlatInvIdEntry, SaltedUint256Hasher>;
+
+    //! The current sequence number. Increases for every announcement. This is
+    //! used to sort invid returned by GetRequestable in announcement order.
+    SequenceNumber m_current_sequence{0};
+
+    //! This tracker's priority computer.
+    const PriorityComputer m_computer;
+
+    //! All the announcements, and the slots that are free for reuse.
+    std::vector<FlatAnnouncement> m_anns;
+    std::vector<Slot> m_free_slots;
+
+    InvIdMap m_invids;
+    std::unordered_map<NodeId, FlatPeerEntry> m_peers;
+
+    //! Timers of the CANDIDATE_DELAYED and REQUESTED announcements, earliest
+    //! first.
+    TimerHeap<LaterTime> m_waiting;
+    //! Timers of the CANDIDATE_READY and CANDIDATE_BEST announcements, latest
+    //! first.
+    TimerHeap<EarlierTime> m_selectable;
+
+    //! Remove an element from a vector of slots by swapping it with the last
+    //! one, and update the position of the moved slot.
+    template <typename Pos>
+    void SwapRemove(std::vector<Slot> &slots, uint32_t pos, Pos position_of) {
+        assert(pos < slots.size());
+        slots[pos] = slots.back();
+        position_of(m_anns[slots[pos]]) = pos;
+        slots.pop_back();
+    }
+
+    bool IsCurrentWaiting(const Timer &timer) const {
+        const FlatAnnouncement &fann = m_anns[timer.m_slot];
+        return fann.m_ann && fann.m_timer_gen == timer.m_gen &&
+               fann.m_ann->IsWaiting();
+    }
+
+    bool IsCurrentSelectable(const Timer &timer) const {
+        const FlatAnnouncement &fann = m_anns[timer.m_slot];
+        return fann.m_ann && fann.m_timer_gen == timer.m_gen &&
+               fann.m_ann->IsSelectable();
+    }
+
+    //! Start a new timer for an announcement that became IsWaiting() or
+    //! IsSelectable(), making its previous one stale.
+    void PushTimer(Slot slot) {
+        FlatAnnouncement &fann = m_anns[slot];
+        const Timer timer{fann.m_ann->m_time, slot, ++fann.m_timer_gen};
+        // Don't let the stale timers outnumber the announcements.
+        const size_t max_timers{2 * Size() + 16};
+        if (fann.m_ann->IsWaiting()) {
+            m_waiting.push(timer);
+            if (m_waiting.size() > max_timers) {
+                m_waiting.compact([this](const Timer &t) {
+                    return IsCurrentWaiting(t);
+                });
+            }
+        } else {
+            assert(fann.m_ann->IsSelectable());
+            m_selectable.push(timer);
+            if (m_selectable.size() > max_timers) {
+                m_selectable.compact([this](const Timer &t) {
+                    return IsCurrentSelectable(t);
+                });
+            }
+        }
+    }
+
+    //! Find the announcement of an invid from a peer.
+    Slot FindSlot(const FlatInvIdEntry &entry, NodeId peer) const {
+        for (const Slot slot : entry.m_slots) {
+            if (m_anns[slot].m_ann->m_peer == peer) {
+                return slot;
+            }
+        }
+        return NO_SLOT;
+    }
+
+    //! Change the state of an announcement, keeping the accounting of its
+    //! invid and peer up to date.
+    void SetState(FlatInvIdEntry &entry, Slot slot, State new_state) {
+        FlatAnnouncement &fann = m_anns[slot];
+        const State old_state = fann.m_ann->GetState();
+        FlatPeerEntry &peer = m_peers.find(fann.m_ann->m_peer)->second;
+
+        peer.m_info.m_completed -= old_state == State::COMPLETED;
+        peer.m_info.m_requested -= old_state == State::REQUESTED;
+        entry.m_non_completed += old_state == State::COMPLETED;
+        if (old_state == State::CANDIDATE_BEST) {
+            SwapRemove(peer.m_best, fann.m_best_pos,
+                       [](FlatAnnouncement &f) -> uint32_t & {
+                           return f.m_best_pos;
+                       });
+        }
+        if (entry.m_selected == slot) {
+            entry.m_selected = NO_SLOT;
+        }
+
+        fann.m_ann->SetState(new_state);
+
+        peer.m_info.m_completed += new_state == State::COMPLETED;
+        peer.m_info.m_requested += new_state == State::REQUESTED;
+        entry.m_non_completed -= new_state == State::COMPLETED;
+        if (new_state == State::CANDIDATE_BEST) {
+            fann.m_best_pos = peer.m_best.size();
+            peer.m_best.push_back(slot);
+        }
+        if (fann.m_ann->IsSelected()) {
+            entry.m_selected = slot;
+        }
+    }
+
+    //! Remove an announcement from its peer, and the peer if it has no
+    //! announcement left, then free its slot.
+    void RemoveFromPeerAndFree(Slot slot) {
+        FlatAnnouncement &fann = m_anns[slot];
+        auto peer_it = m_peers.find(fann.m_ann->m_peer);
+        FlatPeerEntry &peer = peer_it->second;
+        peer.m_info.m_completed -= fann.m_ann->GetState() == State::COMPLETED;
+        peer.m_info.m_requested -= fann.m_ann->GetState() == State::REQUESTED;
+        if (fann.m_ann->GetState() == State::CANDIDATE_BEST) {
+            SwapRemove(peer.m_best, fann.m_best_pos,
+                       [](FlatAnnouncement &f) -> uint32_t & {
+                           return f.m_best_pos;
+                       });
+        }
+        SwapRemove(
+            peer.m_slots, fann.m_peer_pos,
+            [](FlatAnnouncement &f) -> uint32_t & { return f.m_peer_pos; });
+        if (--peer.m_info.m_total == 0) {
+            m_peers.erase(peer_it);
+        }
+
+        fann.m_ann.reset();
+        m_free_slots.push_back(slot);
+    }
+
+    //! Delete an announcement, which must not be IsSelected() unless all the
+    //! announcements of its invid are deleted.
+    void Erase(InvIdMap::iterator it, Slot slot) {
+        FlatInvIdEntry &entry = it->second;
+        entry.m_non_completed -=
+            m_anns[slot].m_ann->GetState() != State::COMPLETED;
+        if (entry.m_selected == slot) {
+            entry.m_selected = NO_SLOT;
+        }
+        SwapRemove(
+            entry.m_slots, m_anns[slot].m_invid_pos,
+            [](FlatAnnouncement &f) -> uint32_t & { return f.m_invid_pos; });
+        RemoveFromPeerAndFree(slot);
+        if (entry.m_slots.empty()) {
+            m_invids.erase(it);
+        }
+    }
+
+    //! Delete all the announcements of an invid.
+    void EraseInvId(InvIdMap::iterator it) {
+        for (const Slot slot : it->second.m_slots) {
+            RemoveFromPeerAndFree(slot);
+        }
+        m_invids.erase(it);
+    }
+
+    //! Convert the best CANDIDATE_READY announcement of an invid, if any, into
+    //! CANDIDATE_BEST.
+    void SelectBestReady(FlatInvIdEntry &entry) {
+        Slot best{NO_SLOT};
+        for (const Slot slot : entry.m_slots) {
+            if (m_anns[slot].m_ann->GetState() == State::CANDIDATE_READY &&
+                (best == NO_SLOT ||
+                 m_anns[slot].m_priority > m_anns[best].m_priority)) {
+                best = slot;
+            }
+        }
+        if (best != NO_SLOT) {
+            SetState(entry, best, State::CANDIDATE_BEST);
+        }
+    }
+
+    //! Convert a CANDIDATE_DELAYED announcement into a CANDIDATE_READY. If this
+    //! makes it the new best CANDIDATE_READY (and no REQUESTED exists) and
+    //! better than the CANDIDATE_BEST (if any), it becomes the new
+    //! CANDIDATE_BEST.
+    void PromoteCandidateReady(FlatInvIdEntry &entry, Slot slot) {
+        assert(m_anns[slot].m_ann->GetState() == State::CANDIDATE_DELAYED);
+        SetState(entry, slot, State::CANDIDATE_READY);
+        PushTimer(slot);
+
+        const Slot selected = entry.m_selected;
+        if (selected == NO_SLOT) {
+            SetState(entry, slot, State::CANDIDATE_BEST);
+        } else if (m_anns[selected].m_ann->GetState() ==
+                       State::CANDIDATE_BEST &&
+                   m_anns[slot].m_priority > m_anns[selected].m_priority) {
+            SetState(entry, selected, State::CANDIDATE_READY);
+            SetState(entry, slot, State::CANDIDATE_BEST);
+        }
+    }
+
+    //! Change the state of an announcement to something non-IsSelected(). If it
+    //! was IsSelected(), the next best announcement will be marked
+    //! CANDIDATE_BEST.
+    void ChangeAndReselect(FlatInvIdEntry &entry, Slot slot,
+                           State new_state) {
+        assert(new_state == State::COMPLETED ||
+               new_state == State::CANDIDATE_DELAYED);
+        if (m_anns[slot].m_ann->IsSelected()) {
+            SelectBestReady(entry);
+        }
+        SetState(entry, slot, new_state);
+        if (new_state == State::CANDIDATE_DELAYED) {
+            PushTimer(slot);
+        }
+    }
+
+    /**
+     * Convert any announcement to a COMPLETED one. If there are no
+     * non-COMPLETED announcements left for this invid, they are deleted. If
+     * this was a REQUESTED announcement, and there are other CANDIDATEs left,
+     * the best one is made CANDIDATE_BEST. Returns whether the announcement
+     * still exists.
+     */
+    bool MakeCompleted(InvIdMap::iterator it, Slot slot) {
+        if (m_anns[slot].m_ann->GetState() == State::COMPLETED) {
+            return true;
+        }
+
+        if (it->second.m_non_completed == 1) {
+            // This is the last non-COMPLETED announcement for this invid.
+            // Delete all.
+            EraseInvId(it);
+            return false;
+        }
+
+        ChangeAndReselect(it->second, slot, State::COMPLETED);
+        return true;
+    }
+
+    //! Make the data structure consistent with a given point in time. See
+    //! InvRequestTrackerImpl::SetTimePoint().
+    void SetTimePoint(std::chrono::microseconds now,
+                      ClearExpiredFun clearExpired,
+                      EmplaceExpiredFun emplaceExpired) {
+        clearExpired();
+        // The order in which the timers that have passed are handled doesn't
+        // matter: the resulting states only depend on 'now'.
+        while (!m_waiting.empty()) {
+            const Timer timer = m_waiting.top();
+            if (!IsCurrentWaiting(timer)) {
+                m_waiting.pop();
+                continue;
+            }
+            if (timer.m_time > now) {
+                break;
+            }
+            m_waiting.pop();
+
+            const Announcement &ann = *m_anns[timer.m_slot].m_ann;
+            auto it = m_invids.find(ann.m_invid);
+            if (ann.GetState() == State::CANDIDATE_DELAYED) {
+                PromoteCandidateReady(it->second, timer.m_slot);
+            } else {
+                emplaceExpired(ann.m_peer, ann.m_invid);
+                MakeCompleted(it, timer.m_slot);
+            }
+        }
+
+        while (!m_selectable.empty()) {
+            const Timer timer = m_selectable.top();
+            if (!IsCurrentSelectable(timer)) {
+                m_selectable.pop();
+                continue;
+            }
+            if (timer.m_time <= now) {
+                break;
+            }
+            m_selectable.pop();
+
+            auto it = m_invids.find(m_anns[timer.m_slot].m_ann->m_invid);
+            ChangeAndReselect(it->second, timer.m_slot,
+                              State::CANDIDATE_DELAYED);
+        }
+    }
+
+    //! The announcements in use, for the sanity checks.
+    std::vector<std::reference_wrapper<const Announcement>>
+    GetAnnouncements() const {
+        std::vector<std::reference_wrapper<const Announcement>> anns;
+        for (const FlatAnnouncement &fann : m_anns) {
+            if (fann.m_ann) {
+                anns.emplace_back(*fann.m_ann);
+            }
+        }
+        return anns;
+    }
+
+public:
+    explicit FlatInvRequestTrackerImpl(bool deterministic)
+        : m_computer(deterministic) {}
+
+    FlatInvRequestTrackerImpl(const FlatInvRequestTrackerImpl &) = delete;
+    FlatInvRequestTrackerImpl &
+    operator=(const FlatInvRequestTrackerImpl &) = delete;
+
+    void SanityCheck() const {
+        const auto anns = GetAnnouncements();
+        assert(anns.size() == Size());
+
+        std::unordered_map<NodeId, PeerInfo> peerinfo;
+        for (const auto &[peer, peer_entry] : m_peers) {
+            peerinfo.emplace(peer, peer_entry.m_info);
+            assert(peer_entry.m_slots.size() == peer_entry.m_info.m_total);
+            for (uint32_t pos = 0; pos < peer_entry.m_slots.size(); ++pos) {
+                const FlatAnnouncement &fann = m_anns[peer_entry.m_slots[pos]];
+                assert(fann.m_ann && fann.m_ann->m_peer == peer);
+                assert(fann.m_peer_pos == pos);
+            }
+            for (uint32_t pos = 0; pos < peer_entry.m_best.size(); ++pos) {
+                const FlatAnnouncement &fann = m_anns[peer_entry.m_best[pos]];
+                assert(fann.m_ann->m_peer == peer);
+                assert(fann.m_ann->GetState() == State::CANDIDATE_BEST);
+                assert(fann.m_best_pos == pos);
+            }
+        }
+        // This also checks that no peer without announcements is kept.
+        assert(peerinfo == RecomputePeerInfo(anns));
+
+        size_t num_best{0};
+        size_t num_slots{0};
+        for (const auto &[invid, entry] : m_invids) {
+            assert(!entry.m_slots.empty());
+            size_t non_completed{0};
+            Slot selected{NO_SLOT};
+            for (uint32_t pos = 0; pos < entry.m_slots.size(); ++pos) {
+                const FlatAnnouncement &fann = m_anns[entry.m_slots[pos]];
+                assert(fann.m_ann && fann.m_ann->m_invid == invid);
+                assert(fann.m_invid_pos == pos);
+                assert(fann.m_priority == m_computer(*fann.m_ann));
+                non_completed += fann.m_ann->GetState() != State::COMPLETED;
+                num_best += fann.m_ann->GetState() == State::CANDIDATE_BEST;
+                if (fann.m_ann->IsSelected()) {
+                    selected = entry.m_slots[pos];
+                }
+            }
+            assert(entry.m_non_completed == non_completed);
+            assert(entry.m_selected == selected);
+            num_slots += entry.m_slots.size();
+        }
+        assert(num_slots == anns.size());
+        size_t num_peer_best{0};
+        for (const auto &[peer, peer_entry] : m_peers) {
+            num_peer_best += peer_entry.m_best.size();
+        }
+        assert(num_best == num_peer_best);
+
+        // Every IsWaiting() and IsSelectable() announcement has a timer.
+        size_t num_waiting{0};
+        size_t num_selectable{0};
+        for (const Announcement &ann : anns) {
+            num_waiting += ann.IsWaiting();
+            num_selectable += ann.IsSelectable();
+        }
+        assert(m_waiting.count([this](const Timer &t) {
+            return IsCurrentWaiting(t);
+        }) == num_waiting);
+        assert(m_selectable.count([this](const Timer &t) {
+            return IsCurrentSelectable(t);
+        }) == num_selectable);
+
+        SanityCheckInvIds(anns, m_computer);
+    }
+
+    void PostGetRequestableSanityCheck(std::chrono::microseconds now) const {
+        SanityCheckTimePoint(GetAnnouncements(), now);
+    }
+
+    void DisconnectedPeer(NodeId peer) {
+        for (auto peer_it = m_peers.find(peer); peer_it != m_peers.end();
+             peer_it = m_peers.find(peer)) {
+            // Each iteration deletes this announcement, either alone or with
+            // all the others of its invid, which can't include another one
+            // from this peer.
+            const Slot slot = peer_it->second.m_slots.back();
+            auto it = m_invids.find(m_anns[slot].m_ann->m_invid);
+            if (MakeCompleted(it, slot)) {
+                Erase(it, slot);
+            }
+        }
+    }
+
+    void ForgetInvId(const uint256 &invid) {
+        auto it = m_invids.find(invid);
+        if (it != m_invids.end()) {
+            EraseInvId(it);
+        }
+    }
+
+    void ReceivedInv(NodeId peer, const uint256 &invid, bool preferred,
+                     std::chrono::microseconds reqtime) {
+        auto [it, inserted] = m_invids.try_emplace(invid);
+        FlatInvIdEntry &entry = it->second;
+        if (!inserted && FindSlot(entry, peer) != NO_SLOT) {
+            return;
+        }
+
+        Slot slot;
+        if (m_free_slots.empty()) {
+            slot = m_anns.size();
+            m_anns.emplace_back();
+        } else {
+            slot = m_free_slots.back();
+            m_free_slots.pop_back();
+        }
+        FlatAnnouncement &fann = m_anns[slot];
+        fann.m_ann.emplace(invid, peer, preferred, reqtime,
+                           m_current_sequence++);
+        fann.m_priority = m_computer(*fann.m_ann);
+
+        fann.m_invid_pos = entry.m_slots.size();
+        entry.m_slots.push_back(slot);
+        ++entry.m_non_completed;
+
+        FlatPeerEntry &peer_entry = m_peers[peer];
+        fann.m_peer_pos = peer_entry.m_slots.size();
+        peer_entry.m_slots.push_back(slot);
+        ++peer_entry.m_info.m_total;
+
+        PushTimer(slot);
+    }
+
+    std::vector<uint256> GetRequestable(NodeId peer,
+                                        std::chrono::microseconds now,
+                                        ClearExpiredFun clearExpired,
+                                        EmplaceExpiredFun emplaceExpired) {
+        SetTimePoint(now, clearExpired, emplaceExpired);
+
+        auto peer_it = m_peers.find(peer);
+        if (peer_it == m_peers.end()) {
+            return {};
+        }
+
+        // Sort the CANDIDATE_BEST announcements by sequence number.
+        std::vector<const Announcement *> selected;
+        selected.reserve(peer_it->second.m_best.size());
+        for (const Slot slot : peer_it->second.m_best) {
+            selected.push_back(&*m_anns[slot].m_ann);
+        }
+        std::sort(selected.begin(), selected.end(),
+                  [](const Announcement *a, const Announcement *b) {
+                      return a->m_sequence < b->m_sequence;
+                  });
+
+        std::vector<uint256> ret;
+        ret.reserve(selected.size());
+        std::transform(selected.begin(), selected.end(),
+                       std::back_inserter(ret),
+                       [](const Announcement *ann) { return ann->m_invid; });
+        return ret;
+    }
+
+    void RequestedData(NodeId peer, const uint256 &invid,
+                       std::chrono::microseconds expiry) {
+        auto it = m_invids.find(invid);
+        if (it == m_invids.end()) {
+            return;
+        }
+        FlatInvIdEntry &entry = it->second;
+        const Slot slot = FindSlot(entry, peer);
+        if (slot == NO_SLOT) {
+            return;
+        }
+
+        const State state = m_anns[slot].m_ann->GetState();
+        if (state != State::CANDIDATE_BEST) {
+            if (state != State::CANDIDATE_DELAYED &&
+                state != State::CANDIDATE_READY) {
+                // Already requested or completed.
+                return;
+            }
+
+            // See InvRequestTrackerImpl::RequestedData() for why the
+            // IsSelected() announcement, if any, is converted this way.
+            const Slot selected = entry.m_selected;
+            if (selected != NO_SLOT) {
+                SetState(entry, selected,
+                         m_anns[selected].m_ann->GetState() ==
+                                 State::CANDIDATE_BEST
+                             ? State::CANDIDATE_READY
+                             : State::COMPLETED);
+            }
+        }
+
+        m_anns[slot].m_ann->m_time = expiry;
+        SetState(entry, slot, State::REQUESTED);
+        PushTimer(slot);
+    }
+
+    void ReceivedResponse(NodeId peer, const uint256 &invid) {
+        auto it = m_invids.find(invid);
+        if (it == m_invids.end()) {
+            return;
+        }
+        const Slot slot = FindSlot(it->second, peer);
+        if (slot != NO_SLOT) {
+            MakeCompleted(it, slot);
+        }
+    }
+
+    size_t CountInFlight(NodeId peer) const {
+        auto it = m_peers.find(peer);
+        return it == m_peers.end() ? 0 : it->second.m_info.m_requested;
+    }
+
+    size_t CountCandidates(NodeId peer) const {
+        auto it = m_peers.find(peer);
+        if (it == m_peers.end()) {
+            return 0;
+        }
+        const PeerInfo &info = it->second.m_info;
+        return info.m_total - info.m_requested - info.m_completed;
+    }
+
+    size_t Count(NodeId peer) const {
+        auto it = m_peers.find(peer);
+        return it == m_peers.end() ? 0 : it->second.m_info.m_total;
+    }
+
+    size_t Size() const { return m_anns.size() - m_free_slots.size(); }
+
+    uint64_t ComputePriority(const uint256 &invid, NodeId peer,
+                             bool preferred) const {
+        return uint64_t{m_computer(invid, peer, preferred)};
+    }
+};
+
 std::unique_ptr<InvRequestTrackerImplInterface>
-InvRequestTrackerImplInterface::BuildImpl(bool deterministic) {
-    return std::make_unique<InvRequestTrackerImpl>(deterministic);
+InvRequestTrackerImplInterface::BuildImpl(bool deterministic,
+                                          InvRequestTrackerImplType type) {
+    switch (type) {
+        case InvRequestTrackerImplType::ORDERED:
+            return std::make_unique<InvRequestTrackerImpl>(deterministic);
+        case InvRequestTrackerImplType::FLAT:
+            return std::make_unique<FlatInvRequestTrackerImpl>(deterministic);
+    }
+    assert(false);
 }
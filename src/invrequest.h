@@ -114,9 +114,23 @@
  *   announcements.
  * - CPU usage is generally logarithmic in the total number of tracked
  *   announcements, plus the number of announcements affected by an operation
- *   (amortized O(1) per announcement).
+ *   (amortized O(1) per announcement). With the FLAT implementation, only the
+ *   timers are kept sorted, and an operation on an invid is linear in the
+ *   number of announcements for it, which is at most the number of peers.
  */
 
+/**
+ * The data structures the announcements can be stored in. Both behave
+ * identically, they only differ in performance.
+ */
+enum class InvRequestTrackerImplType {
+    //! A boost multi_index container with an ordered index per lookup.
+    ORDERED,
+    //! Flat vectors of announcements, with hash tables by invid and by peer
+    //! and heaps of the times to wait for.
+    FLAT,
+};
+
 // Avoid littering this header file with implementation details.
 class InvRequestTrackerImplInterface {
     template <class InvId> friend class InvRequestTracker;
@@ -125,7 +139,7 @@ class InvRequestTrackerImplInterface {
     // This is a hack that allows for hiding the concrete implementation details
     // from the callsite.
     static std::unique_ptr<InvRequestTrackerImplInterface>
-    BuildImpl(bool deterministic);
+    BuildImpl(bool deterministic, InvRequestTrackerImplType type);
 
 public:
     using ClearExpiredFun = const std::function<void()> &;
@@ -168,8 +182,11 @@ template <class InvId> class InvRequestTracker {
 
 public:
     //! Construct a InvRequestTracker.
-    explicit InvRequestTracker(bool deterministic = false)
-        : m_impl{InvRequestTrackerImplInterface::BuildImpl(deterministic)} {}
+    explicit InvRequestTracker(
+        bool deterministic = false,
+        InvRequestTrackerImplType type = InvRequestTrackerImplType::FLAT)
+        : m_impl{InvRequestTrackerImplInterface::BuildImpl(deterministic,
+                                                           type)} {}
     ~InvRequestTracker() = default;
 
     // Conceptually, the data structure consists of a collection of
@@ -7,6 +7,7 @@
 
 #include <util/fs.h>
 
+#include <cstddef>
 #include <cstdint>
 
 class CChainParams;
@@ -14,6 +15,8 @@ class CChainParams;
 namespace kernel {
 
 static constexpr bool DEFAULT_STOPAFTERBLOCKIMPORT{false};
+/** Default for -auxpowheadercache, in MiB */
+static constexpr int64_t DEFAULT_AUXPOW_HEADER_CACHE_MB{32};
 
 /**
  * An options struct for `BlockManager`, more ergonomically referred to as
@@ -24,6 +27,7 @@ struct BlockManagerOpts {
     uint64_t prune_target{0};
     bool fast_prune{false};
     bool stop_after_block_import{DEFAULT_STOPAFTERBLOCKIMPORT};
+    size_t auxpow_header_cache_bytes{DEFAULT_AUXPOW_HEADER_CACHE_MB << 20};
     const fs::path blocks_dir;
 };
 
@@ -4,4 +4,4 @@
 
 #include <sync.h>
 
-RecursiveMutex cs_main;
+HeldTimeRecursiveMutex cs_main;
@@ -16,7 +16,10 @@
  *
  * The transaction pool has a separate lock to allow reading from it and the
  * chainstate at the same time.
+ *
+ * The time each thread holds it is accounted for, so the time spent in
+ * validation can be attributed to the network messages that triggered it.
  */
-extern RecursiveMutex cs_main;
+extern HeldTimeRecursiveMutex cs_main;
 
 #endif // BITCOIN_KERNEL_CS_MAIN_H
@@ -141,6 +141,11 @@ void DisconnectedBlockTransactions::removeForBlock(
     const std::vector<CTransactionRef> &vtx, CTxMemPool &pool) {
     AssertLockHeld(pool.cs);
 
+    // The block template candidates were selected for the previous tip. Drop
+    // them before the transactions in the block are removed, which would
+    // otherwise leave their descendants selected without them.
+    pool.m_template_candidates.Invalidate();
+
     if (pool.mapTx.empty() && pool.mapDeltas.empty()) {
         // fast-path for IBD and/or when mempool is empty; there is no need to
         // do any of the set-up work below which eats precious cycles.
@@ -556,7 +556,10 @@ CNode *CConnman::ConnectNode(CAddress addrConnect, const char *pszDest,
         id, std::move(sock), addrConnect, CalculateKeyedNetGroup(addrConnect),
         nonce, extra_entropy, addr_bind, pszDest ? pszDest : "", conn_type,
         /* inbound_onion */ false,
-        CNodeOptions{.permission_flags = permission_flags});
+        CNodeOptions{
+            .permission_flags = permission_flags,
+            .recv_buffer_pool = m_recv_buffer_pool,
+        });
     pnode->AddRef();
 
     // We're making a new connection, harvest entropy from the time (and our
@@ -691,6 +694,7 @@ bool CNode::ReceiveMsgBytes(const Config &config, Span<const uint8_t> msg_bytes,
                             bool &complete) {
     complete = false;
     const auto time = GetTime<std::chrono::microseconds>();
+    const auto steady_time{SteadyClock::now()};
     LOCK(cs_vRecv);
     m_last_recv = std::chrono::duration_cast<std::chrono::seconds>(time);
     nRecvBytes += msg_bytes.size();
@@ -704,6 +708,7 @@ bool CNode::ReceiveMsgBytes(const Config &config, Span<const uint8_t> msg_bytes,
         if (m_deserializer->Complete()) {
             // decompose a transport agnostic CNetMessage from the deserializer
             CNetMessage msg = m_deserializer->GetMessage(config, time);
+            msg.m_steady_time = steady_time;
 
             // Store received bytes per message command to prevent a memory DOS,
             // only allow valid commands.
@@ -725,6 +730,75 @@ bool CNode::ReceiveMsgBytes(const Config &config, Span<const uint8_t> msg_bytes,
     return true;
 }
 
+void CNode::MarkReceivedMsgsForProcessing(size_t recv_flood_size) {
+    LOCK(cs_vProcessMsg);
+    // vRecvMsg contains only completed CNetMessage, the single possible
+    // partially deserialized message is held by the TransportDeserializer.
+    while (!vRecvMsg.empty()) {
+        nProcessQueueSize += vRecvMsg.front().m_raw_message_size;
+        vProcessMsg.push_back(vRecvMsg.take_front());
+    }
+    fPauseRecv = nProcessQueueSize > recv_flood_size;
+}
+
+/** Index of the smallest size class whose buffers can hold size bytes. */
+static size_t RecvBufferSizeClass(size_t size) {
+    size_t size_class{0};
+    while ((RecvBufferPool::MIN_BUFFER_SIZE << size_class) < size) {
+        ++size_class;
+    }
+    return size_class;
+}
+
+CDataStream RecvBufferPool::Acquire(size_t size, int type, int version) {
+    if (size > MAX_BUFFER_SIZE) {
+        return CDataStream{type, version};
+    }
+
+    const size_t size_class{RecvBufferSizeClass(size)};
+    {
+        LOCK(m_mutex);
+        auto &buffers = m_buffers[size_class];
+        if (!buffers.empty()) {
+            CDataStream stream{std::move(buffers.back())};
+            buffers.pop_back();
+            m_pooled_bytes -= stream.capacity();
+            stream.SetType(type);
+            stream.SetVersion(version);
+            return stream;
+        }
+    }
+
+    CDataStream stream{type, version};
+    stream.reserve(MIN_BUFFER_SIZE << size_class);
+    return stream;
+}
+
+void RecvBufferPool::Release(CDataStream &&stream) {
+    stream.clear();
+    const size_t capacity{stream.capacity()};
+    if (capacity < MIN_BUFFER_SIZE || capacity >= 2 * MAX_BUFFER_SIZE) {
+        return;
+    }
+
+    // File the buffer under the largest size class it can serve.
+    size_t size_class{RecvBufferSizeClass(capacity)};
+    if ((MIN_BUFFER_SIZE << size_class) > capacity) {
+        --size_class;
+    }
+
+    LOCK(m_mutex);
+    if (m_pooled_bytes + capacity > MAX_POOLED_BYTES) {
+        return;
+    }
+    m_buffers[size_class].push_back(std::move(stream));
+    m_pooled_bytes += capacity;
+}
+
+size_t RecvBufferPool::GetPooledBytes() const {
+    return WITH_LOCK(m_mutex, return m_pooled_bytes);
+}
+
 int V1TransportDeserializer::readHeader(const Config &config,
                                         Span<const uint8_t> msg_bytes) {
     // copy data to temporary parsing buffer
@@ -754,6 +828,10 @@ int V1TransportDeserializer::readHeader(const Config &config,
 
     // switch state to reading message data
     in_data = true;
+    if (m_recv_buffer_pool && hdr.nMessageSize > 0) {
+        vRecv = m_recv_buffer_pool->Acquire(
+            hdr.nMessageSize, vRecv.GetType(), vRecv.GetVersion());
+    }
 
     return nCopy;
 }
@@ -787,7 +865,7 @@ CNetMessage
 V1TransportDeserializer::GetMessage(const Config &config,
                                     const std::chrono::microseconds time) {
     // decompose a single CNetMessage from the TransportDeserializer
-    CNetMessage msg(std::move(vRecv));
+    CNetMessage msg(std::move(vRecv), m_recv_buffer_pool);
 
     // store state about valid header, netmagic and checksum
     msg.m_valid_header = hdr.IsValid(config);
@@ -846,21 +924,35 @@ void V1TransportSerializer::prepareForTransport(const Config &config,
 std::pair<size_t, bool> CConnman::SocketSendData(CNode &node) const {
     size_t nSentSize = 0;
     size_t nMsgCount = 0;
+    std::vector<Span<const uint8_t>> bufs;
+
+    while (nMsgCount < node.vSendMsg.size()) {
+        // Send as many of the queued messages as possible in one call.
+        assert(node.vSendMsg[nMsgCount].size() > node.nSendOffset);
+        bufs.clear();
+        size_t nBufsSize = 0;
+        for (auto it = node.vSendMsg.begin() + nMsgCount;
+             it != node.vSendMsg.end() && bufs.size() < Sock::MAX_SEND_BUFFERS;
+             ++it) {
+            Span<const uint8_t> buf{*it};
+            if (bufs.empty()) {
+                buf = buf.subspan(node.nSendOffset);
+            }
+            bufs.push_back(buf);
+            nBufsSize += buf.size();
+        }
 
-    for (const auto &data : node.vSendMsg) {
-        assert(data.size() > node.nSendOffset);
-        int nBytes = 0;
-
+        ssize_t nBytes = 0;
         {
             LOCK(node.m_sock_mutex);
             if (!node.m_sock) {
                 break;
             }
 
-            nBytes = node.m_sock->Send(
-                reinterpret_cast<const char *>(data.data()) + node.nSendOffset,
-                data.size() - node.nSendOffset, MSG_NOSIGNAL | MSG_DONTWAIT);
+            nBytes =
+                node.m_sock->SendMany(bufs, MSG_NOSIGNAL | MSG_DONTWAIT);
         }
+        ++nTotalSendCalls;
 
         if (nBytes == 0) {
             // couldn't send anything at all
@@ -880,20 +972,31 @@ std::pair<size_t, bool> CConnman::SocketSendData(CNode &node) const {
             break;
         }
 
-        assert(nBytes > 0);
         node.m_last_send = GetTime<std::chrono::seconds>();
         node.nSendBytes += nBytes;
-        node.nSendOffset += nBytes;
         nSentSize += nBytes;
-        if (node.nSendOffset != data.size()) {
-            // could not send full message; stop sending more
-            break;
-        }
 
-        node.nSendOffset = 0;
-        node.nSendSize -= data.size();
+        // Skip the messages that were fully sent, and remember where to resume
+        // the one that was partially sent if any.
+        size_t nBytesLeft = nBytes;
+        while (nBytesLeft > 0) {
+            const size_t nMsgLeft =
+                node.vSendMsg[nMsgCount].size() - node.nSendOffset;
+            if (nBytesLeft < nMsgLeft) {
+                node.nSendOffset += nBytesLeft;
+                break;
+            }
+            nBytesLeft -= nMsgLeft;
+            node.nSendOffset = 0;
+            node.nSendSize -= node.vSendMsg[nMsgCount].size();
+            nMsgCount++;
+        }
         node.fPauseSend = node.nSendSize > nSendBufferMaxSize;
-        nMsgCount++;
+
+        if (size_t(nBytes) != nBufsSize) {
+            // could not send everything; stop sending more
+            break;
+        }
     }
 
     node.vSendMsg.erase(node.vSendMsg.begin(),
@@ -1394,6 +1497,7 @@ void CConnman::CreateNodeFromAcceptedSocket(std::unique_ptr<Sock> &&sock,
         CNodeOptions{
             .permission_flags = permission_flags,
             .prefer_evict = discouraged,
+            .recv_buffer_pool = m_recv_buffer_pool,
         });
     pnode->AddRef();
     for (auto interface : m_msgproc) {
@@ -1406,6 +1510,7 @@ void CConnman::CreateNodeFromAcceptedSocket(std::unique_ptr<Sock> &&sock,
         LOCK(m_nodes_mutex);
         m_nodes.push_back(pnode);
     }
+    QueueWaitUpdate(*pnode);
 
     // We received a new connection, harvest entropy from the time (and our peer
     // count)
@@ -1490,6 +1595,10 @@ void CConnman::DisconnectNodes() {
 
                 // close socket and cleanup
                 pnode->CloseSocketDisconnect();
+                if (pnode->m_wait_sock && m_wait_set) {
+                    m_wait_set->Set(pnode->m_wait_sock, 0);
+                }
+                pnode->m_wait_sock.reset();
 
                 // hold in disconnected pool until all refs are released
                 pnode->Release();
@@ -1570,30 +1679,48 @@ bool CConnman::InactivityCheck(const CNode &node) const {
     return false;
 }
 
-Sock::EventsPerSock CConnman::GenerateWaitSockets(Span<CNode *const> nodes) {
-    Sock::EventsPerSock events_per_sock;
-
-    for (const ListenSocket &hListenSocket : vhListenSocket) {
-        events_per_sock.emplace(hListenSocket.sock, Sock::Events{Sock::RECV});
+void CConnman::QueueWaitUpdate(CNode &node) {
+    if (node.m_wait_update_queued.exchange(true)) {
+        return;
     }
+    // The node is deleted only once it has been updated.
+    node.AddRef();
+    LOCK(m_wait_updates_mutex);
+    m_wait_updates.push_back(&node);
+}
+
+void CConnman::UpdateWaitSockets() {
+    std::vector<CNode *> nodes;
+    WITH_LOCK(m_wait_updates_mutex, nodes.swap(m_wait_updates));
 
     for (CNode *pnode : nodes) {
+        // Any change from now on queues the node again.
+        pnode->m_wait_update_queued = false;
+
         bool select_recv = !pnode->fPauseRecv;
         bool select_send =
             WITH_LOCK(pnode->cs_vSend, return !pnode->vSendMsg.empty());
-        if (!select_recv && !select_send) {
-            continue;
-        }
+        std::shared_ptr<const Sock> sock =
+            WITH_LOCK(pnode->m_sock_mutex, return pnode->m_sock);
 
-        LOCK(pnode->m_sock_mutex);
-        if (pnode->m_sock) {
-            Sock::Event event =
+        Sock::Event event = 0;
+        if (sock) {
+            event =
                 (select_send ? Sock::SEND : 0) | (select_recv ? Sock::RECV : 0);
-            events_per_sock.emplace(pnode->m_sock, Sock::Events{event});
         }
-    }
+        if (sock != pnode->m_wait_sock || event != pnode->m_wait_events) {
+            if (pnode->m_wait_sock && pnode->m_wait_sock != sock) {
+                m_wait_set->Set(pnode->m_wait_sock, 0);
+            }
+            if (sock) {
+                m_wait_set->Set(sock, event);
+            }
+            pnode->m_wait_sock = event ? std::move(sock) : nullptr;
+            pnode->m_wait_events = event;
+        }
 
-    return events_per_sock;
+        pnode->Release();
+    }
 }
 
 void CConnman::SocketHandler() {
@@ -1609,10 +1736,8 @@ void CConnman::SocketHandler() {
         // listening sockets in one call ("readiness" as in poll(2) or
         // select(2)). If none are ready, wait for a short while and return
         // empty sets.
-        events_per_sock = GenerateWaitSockets(snap.Nodes());
-        if (events_per_sock.empty() ||
-            !events_per_sock.begin()->first->WaitMany(timeout,
-                                                      events_per_sock)) {
+        UpdateWaitSockets();
+        if (!m_wait_set->Wait(timeout, events_per_sock)) {
             interruptNet.sleep_for(timeout);
         }
 
@@ -1655,6 +1780,14 @@ void CConnman::SocketHandlerConnected(
             // Send data
             auto [bytes_sent, data_left] =
                 WITH_LOCK(pnode->cs_vSend, return SocketSendData(*pnode));
+            if (!data_left) {
+                // Stop waiting for the socket to be writable.
+                QueueWaitUpdate(*pnode);
+            }
+            if (!pnode->fPauseSend &&
+                pnode->m_wake_msghand_on_send.exchange(false)) {
+                WakeMessageHandler();
+            }
             if (bytes_sent) {
                 RecordBytesSent(bytes_sent);
 
@@ -1692,22 +1825,10 @@ void CConnman::SocketHandlerConnected(
                 }
                 RecordBytesRecv(nBytes);
                 if (notify) {
-                    size_t nSizeAdded = 0;
-                    auto it(pnode->vRecvMsg.begin());
-                    for (; it != pnode->vRecvMsg.end(); ++it) {
-                        // vRecvMsg contains only completed CNetMessage
-                        // the single possible partially deserialized message
-                        // are held by TransportDeserializer
-                        nSizeAdded += it->m_raw_message_size;
-                    }
-                    {
-                        LOCK(pnode->cs_vProcessMsg);
-                        pnode->vProcessMsg.splice(pnode->vProcessMsg.end(),
-                                                  pnode->vRecvMsg,
-                                                  pnode->vRecvMsg.begin(), it);
-                        pnode->nProcessQueueSize += nSizeAdded;
-                        pnode->fPauseRecv =
-                            pnode->nProcessQueueSize > nReceiveFloodSize;
+                    const bool pause_recv{pnode->fPauseRecv};
+                    pnode->MarkReceivedMsgsForProcessing(nReceiveFloodSize);
+                    if (pnode->fPauseRecv != pause_recv) {
+                        QueueWaitUpdate(*pnode);
                     }
                     WakeMessageHandler();
                 }
@@ -2466,6 +2587,7 @@ void CConnman::OpenNetworkConnection(const CAddress &addrConnect,
         LOCK(m_nodes_mutex);
         m_nodes.push_back(pnode);
     }
+    QueueWaitUpdate(*pnode);
 }
 
 Mutex NetEventsInterface::g_msgproc_mutex;
@@ -2521,6 +2643,21 @@ void CConnman::ThreadMessageHandler() {
     }
 }
 
+bool CConnman::ProcessMessageInBackground(CNode &node,
+                                          std::function<void()> task) {
+    node.AddRef();
+    const bool submitted{
+        m_msgproc_workers.Submit([this, &node, task = std::move(task)]() {
+            task();
+            node.Release();
+            WakeMessageHandler();
+        })};
+    if (!submitted) {
+        node.Release();
+    }
+    return submitted;
+}
+
 void CConnman::ThreadI2PAcceptIncoming() {
     static constexpr auto err_wait_begin = 1s;
     static constexpr auto err_wait_cap = 5min;
@@ -2838,6 +2975,11 @@ bool CConnman::Start(CScheduler &scheduler, const Options &connOptions) {
     }
 
     // Send and receive from sockets, accept connections
+    m_wait_set = MakeSockWaitSet();
+    LogPrintf("Using %s to wait for socket events\n", m_wait_set->GetName());
+    for (const ListenSocket &listen_socket : vhListenSocket) {
+        m_wait_set->Set(listen_socket.sock, Sock::RECV);
+    }
     threadSocketHandler = std::thread(&util::TraceThread, "net",
                                       [this] { ThreadSocketHandler(); });
 
@@ -2872,6 +3014,7 @@ bool CConnman::Start(CScheduler &scheduler, const Options &connOptions) {
     }
 
     // Process messages
+    m_msgproc_workers.Start(m_msgproc_threads);
     threadMessageHandler = std::thread(&util::TraceThread, "msghand",
                                        [this] { ThreadMessageHandler(); });
 
@@ -2936,6 +3079,9 @@ void CConnman::StopThreads() {
     if (threadMessageHandler.joinable()) {
         threadMessageHandler.join();
     }
+    // After the message handler, which is the only thread submitting work to
+    // the message processing workers.
+    m_msgproc_workers.Stop();
     if (threadOpenConnections.joinable()) {
         threadOpenConnections.join();
     }
@@ -2980,6 +3126,9 @@ void CConnman::StopNodes() {
         DeleteNode(pnode);
     }
     m_nodes_disconnected.clear();
+    // All the nodes are deleted, references included.
+    WITH_LOCK(m_wait_updates_mutex, m_wait_updates.clear());
+    m_wait_set.reset();
     vhListenSocket.clear();
     semOutbound.reset();
     semAddnode.reset();
@@ -3250,6 +3399,10 @@ uint64_t CConnman::GetTotalBytesSent() const {
     return nTotalBytesSent;
 }
 
+uint64_t CConnman::GetTotalSendCalls() const {
+    return nTotalSendCalls;
+}
+
 ServiceFlags CConnman::GetLocalServices() const {
     return nLocalServices;
 }
@@ -3321,7 +3474,8 @@ CNode::CNode(NodeId idIn, std::shared_ptr<Sock> sock, const CAddress &addrIn,
 
     m_deserializer = std::make_unique<V1TransportDeserializer>(
         V1TransportDeserializer(GetConfig().GetChainParams().NetMagic(),
-                                SER_NETWORK, INIT_PROTO_VERSION));
+                                SER_NETWORK, INIT_PROTO_VERSION,
+                                std::move(node_opts.recv_buffer_pool)));
     m_serializer =
         std::make_unique<V1TransportSerializer>(V1TransportSerializer());
 }
@@ -3349,6 +3503,7 @@ void CConnman::PushMessage(CNode *pnode, CSerializedNetMsg &&msg) {
     size_t nTotalSize = nMessageSize + serializedHeader.size();
 
     size_t nBytesSent = 0;
+    bool queued_first{false};
     {
         LOCK(pnode->cs_vSend);
         bool optimisticSend(pnode->vSendMsg.empty());
@@ -3366,10 +3521,16 @@ void CConnman::PushMessage(CNode *pnode, CSerializedNetMsg &&msg) {
         }
 
         // If write queue empty, attempt "optimistic write"
-        bool data_left;
+        bool data_left{true};
         if (optimisticSend) {
             std::tie(nBytesSent, data_left) = SocketSendData(*pnode);
         }
+        // The socket handler only waits for the socket to be writable while
+        // there is data left to send.
+        queued_first = optimisticSend && data_left;
+    }
+    if (queued_first) {
+        QueueWaitUpdate(*pnode);
     }
     if (nBytesSent) {
         RecordBytesSent(nBytesSent);
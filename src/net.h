@@ -33,8 +33,12 @@
 #include <uint256.h>
 #include <util/check.h>
 #include <util/sock.h>
+#include <util/ringqueue.h>
+#include <util/sockwaitset.h>
+#include <util/threadpool.h>
 #include <util/time.h>
 
+#include <array>
 #include <atomic>
 #include <condition_variable>
 #include <cstdint>
@@ -102,6 +106,13 @@ static const bool DEFAULT_DNSSEED = true;
 static const bool DEFAULT_FIXEDSEEDS = true;
 static const size_t DEFAULT_MAXRECEIVEBUFFER = 5 * 1000;
 static const size_t DEFAULT_MAXSENDBUFFER = 1 * 1000;
+/**
+ * Maximum number of threads processing the messages that can be processed
+ * concurrently with the message handler thread.
+ */
+static constexpr int MAX_MSGPROC_THREADS{15};
+/** -parmsgproc default (number of message processing threads, 0 = auto) */
+static constexpr int DEFAULT_MSGPROC_THREADS{0};
 
 struct AddedNodeInfo {
     std::string strAddedNode;
@@ -322,6 +333,50 @@ struct CNodeStats {
     std::optional<double> m_availabilityScore;
 };
 
+/**
+ * A pool of buffers for the payload of the received messages, so that
+ * receiving a message does not allocate in the common case.
+ *
+ * The idle buffers are sorted by capacity into power-of-two size classes. A
+ * buffer of the smallest class fitting the payload is taken when its header is
+ * received, and given back once the message has been processed. The pool is
+ * shared by all the peers and can be used from any thread.
+ */
+class RecvBufferPool {
+public:
+    /** Capacity of the buffers of the smallest size class. */
+    static constexpr size_t MIN_BUFFER_SIZE{256};
+    /**
+     * Capacity of the buffers of the largest size class. The buffers for
+     * larger payloads are not pooled.
+     */
+    static constexpr size_t MAX_BUFFER_SIZE{256 * 1024};
+    /** Maximum total capacity of the idle buffers held by the pool. */
+    static constexpr size_t MAX_POOLED_BYTES{4 * 1024 * 1024};
+
+    /**
+     * Get an empty stream able to hold size bytes without reallocating, unless
+     * size exceeds MAX_BUFFER_SIZE.
+     */
+    CDataStream Acquire(size_t size, int type, int version)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    /** Give back the buffer of a stream that is no longer used. */
+    void Release(CDataStream &&stream) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Total capacity of the idle buffers held by the pool. */
+    size_t GetPooledBytes() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    static constexpr size_t NUM_SIZE_CLASSES{11};
+    static_assert((MIN_BUFFER_SIZE << (NUM_SIZE_CLASSES - 1)) ==
+                  MAX_BUFFER_SIZE);
+
+    mutable Mutex m_mutex;
+    std::array<std::vector<CDataStream>, NUM_SIZE_CLASSES>
+        m_buffers GUARDED_BY(m_mutex);
+    size_t m_pooled_bytes GUARDED_BY(m_mutex){0};
+};
+
 /**
  * Transport protocol agnostic message container.
  * Ideally it should only contain receive time, payload,
@@ -331,8 +386,12 @@ class CNetMessage {
 public:
     //! received message data
     CDataStream m_recv;
+    //! pool the m_recv buffer is given back to when the message is destroyed
+    std::shared_ptr<RecvBufferPool> m_recv_buffer_pool;
     //! time of message receipt
     std::chrono::microseconds m_time{0};
+    //! time of message receipt, not mockable, to measure how long it waits
+    SteadyClock::time_point m_steady_time{};
     bool m_valid_netmagic = false;
     bool m_valid_header = false;
     bool m_valid_checksum = false;
@@ -342,7 +401,17 @@ public:
     uint32_t m_raw_message_size{0};
     std::string m_type;
 
-    CNetMessage(CDataStream &&recv_in) : m_recv(std::move(recv_in)) {}
+    CNetMessage(CDataStream &&recv_in,
+                std::shared_ptr<RecvBufferPool> recv_buffer_pool = nullptr)
+        : m_recv(std::move(recv_in)),
+          m_recv_buffer_pool(std::move(recv_buffer_pool)) {}
+    ~CNetMessage() {
+        if (m_recv_buffer_pool) {
+            m_recv_buffer_pool->Release(std::move(m_recv));
+        }
+    }
+    CNetMessage(CNetMessage &&) = default;
+    CNetMessage &operator=(CNetMessage &&) = default;
 
     void SetVersion(int nVersionIn) { m_recv.SetVersion(nVersionIn); }
 };
@@ -379,6 +448,8 @@ private:
     CMessageHeader hdr;
     // Received message data.
     CDataStream vRecv;
+    // Pool the message data buffers are taken from, if any.
+    const std::shared_ptr<RecvBufferPool> m_recv_buffer_pool;
     uint32_t nHdrPos;
     uint32_t nDataPos;
 
@@ -400,9 +471,11 @@ private:
 public:
     V1TransportDeserializer(
         const CMessageHeader::MessageMagic &pchMessageStartIn, int nTypeIn,
-        int nVersionIn)
+        int nVersionIn,
+        std::shared_ptr<RecvBufferPool> recv_buffer_pool = nullptr)
         : hdrbuf(nTypeIn, nVersionIn), hdr(pchMessageStartIn),
-          vRecv(nTypeIn, nVersionIn) {
+          vRecv(nTypeIn, nVersionIn),
+          m_recv_buffer_pool(std::move(recv_buffer_pool)) {
         Reset();
     }
 
@@ -454,6 +527,7 @@ public:
 struct CNodeOptions {
     NetPermissionFlags permission_flags = NetPermissionFlags::None;
     bool prefer_evict = false;
+    std::shared_ptr<RecvBufferPool> recv_buffer_pool = nullptr;
 };
 
 /** Information about a peer */
@@ -489,7 +563,7 @@ public:
     Mutex cs_vRecv;
 
     RecursiveMutex cs_vProcessMsg;
-    std::list<CNetMessage> vProcessMsg GUARDED_BY(cs_vProcessMsg);
+    RingQueue<CNetMessage> vProcessMsg GUARDED_BY(cs_vProcessMsg);
     size_t nProcessQueueSize{0};
 
     uint64_t nRecvBytes GUARDED_BY(cs_vRecv){0};
@@ -533,6 +607,9 @@ public:
     const uint64_t nKeyedNetGroup;
     std::atomic_bool fPauseRecv{false};
     std::atomic_bool fPauseSend{false};
+    //! Wake the message handler up once fPauseSend clears, because it has
+    //! requests of this node left to serve.
+    std::atomic_bool m_wake_msghand_on_send{false};
 
     bool IsOutboundOrBlockRelayConn() const {
         switch (m_conn_type) {
@@ -743,6 +820,14 @@ public:
     bool ReceiveMsgBytes(const Config &config, Span<const uint8_t> msg_bytes,
                          bool &complete) EXCLUSIVE_LOCKS_REQUIRED(!cs_vRecv);
 
+    /**
+     * Move the messages deserialized by ReceiveMsgBytes() to the process
+     * queue, and pause receiving if the queue exceeds recv_flood_size bytes.
+     * Only called by the thread receiving the data.
+     */
+    void MarkReceivedMsgsForProcessing(size_t recv_flood_size)
+        EXCLUSIVE_LOCKS_REQUIRED(!cs_vProcessMsg);
+
     void SetCommonVersion(int greatest_common_version) {
         Assume(m_greatest_common_version == INIT_PROTO_VERSION);
         m_greatest_common_version = greatest_common_version;
@@ -779,7 +864,12 @@ private:
     std::atomic<int> m_greatest_common_version{INIT_PROTO_VERSION};
 
     // Used only by SocketHandler thread
-    std::list<CNetMessage> vRecvMsg;
+    RingQueue<CNetMessage> vRecvMsg;
+    //! Socket and events this node is registered with in the wait set.
+    std::shared_ptr<const Sock> m_wait_sock;
+    Sock::Event m_wait_events{0};
+    //! Whether the node is queued for CConnman::UpdateWaitSockets().
+    std::atomic_bool m_wait_update_queued{false};
 
     // Our address, as reported by the peer
     mutable Mutex m_addr_local_mutex;
@@ -885,6 +975,8 @@ public:
         bool m_i2p_accept_incoming = true;
         bool whitelist_forcerelay = DEFAULT_WHITELISTFORCERELAY;
         bool whitelist_relay = DEFAULT_WHITELISTRELAY;
+        //! Number of message processing worker threads
+        int m_msgproc_threads = 0;
     };
 
     void Init(const Options &connOptions)
@@ -914,6 +1006,7 @@ public:
         nReceiveFloodSize = connOptions.nReceiveFloodSize;
         m_peer_connect_timeout =
             std::chrono::seconds{connOptions.m_peer_connect_timeout};
+        m_msgproc_threads = connOptions.m_msgproc_threads;
         {
             LOCK(cs_totalBytesSent);
             nMaxOutboundLimit = connOptions.nMaxOutboundLimit;
@@ -1074,6 +1167,8 @@ public:
 
     uint64_t GetTotalBytesRecv() const;
     uint64_t GetTotalBytesSent() const;
+    /** Number of send system calls made, to compare with the bytes sent. */
+    uint64_t GetTotalSendCalls() const;
 
     /** Get a unique deterministic randomizer. */
     CSipHasher GetDeterministicRandomizer(uint64_t id) const;
@@ -1082,6 +1177,30 @@ public:
 
     void WakeMessageHandler() EXCLUSIVE_LOCKS_REQUIRED(!mutexMsgProc);
 
+    /**
+     * Have the socket handler thread update the events it waits for on the
+     * node's socket. Must be called whenever the node's send queue becomes
+     * empty or non-empty, or fPauseRecv changes.
+     */
+    void QueueWaitUpdate(CNode &node)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_wait_updates_mutex);
+
+    /**
+     * Run a task processing a message of node on one of the message
+     * processing worker threads, concurrently with the message handler
+     * thread. The node is referenced until the task completes, after which the
+     * message handler thread is woken up.
+     * @return false if there is no worker thread, in which case the task is
+     *     not run.
+     */
+    bool ProcessMessageInBackground(CNode &node, std::function<void()> task)
+        EXCLUSIVE_LOCKS_REQUIRED(!mutexMsgProc);
+
+    /** Whether ProcessMessageInBackground() has worker threads to run on. */
+    bool CanProcessMessagesInBackground() const {
+        return m_msgproc_workers.WorkersCount() > 0;
+    }
+
     /**
      * Return true if we should disconnect the peer for failing an inactivity
      * check.
@@ -1144,11 +1263,11 @@ private:
     bool InactivityCheck(const CNode &node) const;
 
     /**
-     * Generate a collection of sockets to check for IO readiness.
-     * @param[in] nodes Select from these nodes' sockets.
-     * @return sockets to check for readiness
+     * Update the sockets to check for IO readiness in m_wait_set for the nodes
+     * queued by QueueWaitUpdate(). A node is only re-registered when its
+     * socket or the events it waits for changed.
      */
-    Sock::EventsPerSock GenerateWaitSockets(Span<CNode *const> nodes);
+    void UpdateWaitSockets() EXCLUSIVE_LOCKS_REQUIRED(!m_wait_updates_mutex);
 
     /**
      * Check connected and listening sockets for IO readiness and process them
@@ -1227,6 +1346,7 @@ private:
     mutable RecursiveMutex cs_totalBytesSent;
     std::atomic<uint64_t> nTotalBytesRecv{0};
     uint64_t nTotalBytesSent GUARDED_BY(cs_totalBytesSent){0};
+    mutable std::atomic<uint64_t> nTotalSendCalls{0};
 
     // outbound limit & stats
     uint64_t nMaxOutboundTotalBytesSentInCycle GUARDED_BY(cs_totalBytesSent){0};
@@ -1245,8 +1365,22 @@ private:
 
     unsigned int nSendBufferMaxSize{0};
     unsigned int nReceiveFloodSize{0};
+    /** Buffers for the payload of the messages received from all the nodes */
+    const std::shared_ptr<RecvBufferPool> m_recv_buffer_pool{
+        std::make_shared<RecvBufferPool>()};
 
     std::vector<ListenSocket> vhListenSocket;
+    /**
+     * Sockets of the listening sockets and connected nodes waited on by the
+     * SocketHandler thread.
+     */
+    std::unique_ptr<SockWaitSet> m_wait_set;
+    /**
+     * Nodes whose registration in m_wait_set may be stale, each holding a
+     * reference until it is updated.
+     */
+    Mutex m_wait_updates_mutex;
+    std::vector<CNode *> m_wait_updates GUARDED_BY(m_wait_updates_mutex);
     std::atomic<bool> fNetworkActive{true};
     bool fAddressesInitialized{false};
     AddrMan &addrman;
@@ -1363,6 +1497,10 @@ private:
     std::thread threadMessageHandler;
     std::thread threadI2PAcceptIncoming;
 
+    int m_msgproc_threads{0};
+    /** Worker threads for ProcessMessageInBackground() */
+    ThreadPool m_msgproc_workers{"msgproc"};
+
     /**
      * flag for deciding to connect to an extra outbound peer, in excess of
      * m_max_outbound_full_relay. This takes the place of a feeler connection.
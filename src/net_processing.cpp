@@ -56,6 +56,8 @@
 #include <future>
 #include <memory>
 #include <numeric>
+#include <optional>
+#include <set>
 #include <typeinfo>
 
 /** How long to cache transactions in mapRelay for normal relay */
@@ -186,6 +188,29 @@ static const unsigned int MAX_GETDATA_SZ = 1000;
  * Number of blocks that can be requested at any given time from a single peer.
  */
 static const int MAX_BLOCKS_IN_TRANSIT_PER_PEER = 16;
+/**
+ * Number of blocks that can be requested at any given time from the slowest
+ * peers. The limit for a peer scales with its measured block download rate
+ * relative to the fastest peer, between this and
+ * MAX_BLOCKS_IN_TRANSIT_PER_PEER.
+ */
+static const int MIN_BLOCKS_IN_TRANSIT_PER_PEER = 2;
+/**
+ * Minimum time the block validation is waiting on before it is requested from
+ * another peer than the one it is in flight from.
+ */
+static constexpr auto BLOCK_REREQUEST_MIN_WAIT{1s};
+/**
+ * How much longer than expected a block must be in flight, or how much faster
+ * than the peer it is in flight from another peer is expected to be, for the
+ * block to be requested again from that other peer.
+ */
+static constexpr int BLOCK_REREQUEST_FACTOR{2};
+/**
+ * Weight of a new measurement in the moving averages of the block download
+ * rate and latency of a peer.
+ */
+static constexpr double BLOCK_DOWNLOAD_STATS_WEIGHT{0.25};
 /**
  * Default time during which a peer must stall block download progress before
  * being disconnected. The actual timeout is increased temporarily if peers are
@@ -317,6 +342,129 @@ struct QueuedBlock {
     const CBlockIndex *pindex;
     /** Optional, used for CMPCTBLOCK downloads */
     std::unique_ptr<PartiallyDownloadedBlock> partialBlock;
+    /** When the block was requested */
+    std::chrono::microseconds m_request_time{0us};
+};
+
+/**
+ * A transaction to announce, resolved from the mempool once for all the peers
+ * it is announced to.
+ */
+struct TxAnnouncement {
+    CTransactionRef tx;
+    Amount fee;
+    size_t vsize;
+    /** Order of entry into the mempool, which is a topological order */
+    uint64_t entry_id;
+};
+
+/**
+ * The transactions relayed between two rounds of the message handler,
+ * stamped with the round. Batches are immutable and shared by all the peers,
+ * which hold references to the announcements they still have to send.
+ */
+struct TxAnnouncementBatch {
+    uint64_t epoch;
+    std::vector<TxAnnouncement> announcements;
+};
+
+/** Points into a TxAnnouncementBatch, which it keeps alive. */
+using TxAnnouncementRef = std::shared_ptr<const TxAnnouncement>;
+
+/** Timings of the messages of one type received from all the peers. */
+struct MsgTimings {
+    DurationHistogram queue_wait;
+    DurationHistogram processing;
+    DurationHistogram cs_main;
+};
+
+/** Total timings of the messages of one type received from a peer. */
+struct PeerMsgTimings {
+    std::atomic<uint64_t> count{0};
+    std::atomic<uint64_t> queue_wait_micros{0};
+    std::atomic<uint64_t> processing_micros{0};
+    std::atomic<uint64_t> cs_main_micros{0};
+};
+
+/**
+ * Map the timings of each known message type, plus one entry for the unknown
+ * types. It is filled once, so it can be read and the timings updated without
+ * locking.
+ */
+template <typename Timings>
+std::map<std::string, Timings> MakeMsgTimingsMap() {
+    std::map<std::string, Timings> timings;
+    for (const std::string &msg_type : getAllNetMessageTypes()) {
+        timings[msg_type];
+    }
+    timings[NET_MESSAGE_COMMAND_OTHER];
+    return timings;
+}
+
+template <typename Timings>
+Timings &GetMsgTimings(std::map<std::string, Timings> &timings,
+                       const std::string &msg_type) {
+    auto it = timings.find(msg_type);
+    if (it == timings.end()) {
+        it = timings.find(NET_MESSAGE_COMMAND_OTHER);
+    }
+    assert(it != timings.end());
+    return it->second;
+}
+
+/**
+ * Measure the processing of a message, from the construction of the timer to
+ * its destruction, and record it along with the time the message waited to
+ * be processed and the time cs_main was held meanwhile.
+ */
+class MsgProcessingTimer {
+public:
+    MsgProcessingTimer(NodeId peer_id, const CNetMessage &msg,
+                       MsgTimings &timings, PeerMsgTimings &peer_timings)
+        : m_peer_id{peer_id}, m_msg_type{msg.m_type},
+          m_msg_size{msg.m_message_size},
+          m_receive_time{msg.m_steady_time}, m_timings{timings},
+          m_peer_timings{peer_timings} {}
+
+    ~MsgProcessingTimer() {
+        const auto now{SteadyClock::now()};
+        const auto queue_wait{
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                m_start - m_receive_time)};
+        const auto processing{
+            std::chrono::duration_cast<std::chrono::microseconds>(now -
+                                                                  m_start)};
+        const auto cs_main{
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                HeldTimeRecursiveMutex::GetThreadHeldTime() -
+                m_cs_main_start)};
+
+        m_timings.queue_wait.Record(queue_wait);
+        m_timings.processing.Record(processing);
+        m_timings.cs_main.Record(cs_main);
+        m_peer_timings.count.fetch_add(1, std::memory_order_relaxed);
+        m_peer_timings.queue_wait_micros.fetch_add(queue_wait.count(),
+                                                   std::memory_order_relaxed);
+        m_peer_timings.processing_micros.fetch_add(processing.count(),
+                                                   std::memory_order_relaxed);
+        m_peer_timings.cs_main_micros.fetch_add(cs_main.count(),
+                                                std::memory_order_relaxed);
+
+        TRACE6(net, processed_message, m_peer_id, m_msg_type.c_str(),
+               m_msg_size, queue_wait.count(), processing.count(),
+               cs_main.count());
+    }
+
+private:
+    const NodeId m_peer_id;
+    const std::string m_msg_type;
+    const uint32_t m_msg_size;
+    const SteadyClock::time_point m_receive_time;
+    MsgTimings &m_timings;
+    PeerMsgTimings &m_peer_timings;
+    const SteadyClock::time_point m_start{SteadyClock::now()};
+    const std::chrono::nanoseconds m_cs_main_start{
+        HeldTimeRecursiveMutex::GetThreadHeldTime()};
 };
 
 /**
@@ -442,11 +590,13 @@ struct Peer {
         CRollingBloomFilter m_tx_inventory_known_filter
             GUARDED_BY(m_tx_inventory_mutex){50000, 0.000001};
         /**
-         * Set of transaction ids we still have to announce. We use the
-         * mempool to sort transactions in dependency order before relay, so
-         * this does not have to be sorted.
+         * Transactions we still have to announce. The announcements carry the
+         * order of entry into the mempool, which is used to sort transactions
+         * in dependency order before relay, so this does not have to be
+         * sorted.
          */
-        std::set<TxId> m_tx_inventory_to_send GUARDED_BY(m_tx_inventory_mutex);
+        std::map<TxId, TxAnnouncementRef>
+            m_tx_inventory_to_send GUARDED_BY(m_tx_inventory_mutex);
         /**
          * Whether the peer has requested us to send our complete mempool. Only
          * permitted if the peer has NetPermissionFlags::Mempool.
@@ -597,6 +747,27 @@ struct Peer {
     /** Work queue of items requested by this peer **/
     std::deque<CInv> m_getdata_requests GUARDED_BY(m_getdata_requests_mutex);
 
+    /** Protects the state of the messages processed in the background */
+    Mutex m_background_msg_mutex;
+    /**
+     * Whether a message from this peer is being processed by a message
+     * processing worker thread. The next messages wait for it to complete, so
+     * the messages from a peer are processed in order.
+     */
+    bool m_background_msg_busy GUARDED_BY(m_background_msg_mutex){false};
+    /**
+     * Message handed back by a worker thread after processing the part of it
+     * that can run concurrently, to be processed before the next ones.
+     */
+    std::optional<CNetMessage>
+        m_background_msg GUARDED_BY(m_background_msg_mutex);
+    /**
+     * Hash and signature of the avalanche response whose signature was
+     * verified by a worker thread, so it is not verified again.
+     */
+    std::optional<std::pair<uint256, SchnorrSig>>
+        m_verified_ava_response GUARDED_BY(m_background_msg_mutex);
+
     /** Time of the last getheaders message to this peer */
     NodeClock::time_point m_last_getheaders_timestamp
         GUARDED_BY(NetEventsInterface::g_msgproc_mutex){};
@@ -629,6 +800,10 @@ struct Peer {
     bool m_prefers_headers GUARDED_BY(NetEventsInterface::g_msgproc_mutex){
         false};
 
+    /** Timings of the messages processed from this peer, by type */
+    std::map<std::string, PeerMsgTimings> m_msg_timings{
+        MakeMsgTimingsMap<PeerMsgTimings>()};
+
     explicit Peer(NodeId id, ServiceFlags our_services, bool fRelayProofs)
         : m_id(id), m_our_services{our_services},
           m_proof_relay(fRelayProofs ? std::make_unique<ProofRelay>()
@@ -667,6 +842,14 @@ struct CNodeState {
     //! When the first entry in vBlocksInFlight started downloading. Don't care
     //! when vBlocksInFlight is empty.
     std::chrono::microseconds m_downloading_since{0us};
+    //! Moving average of the rate at which this peer sends the blocks we
+    //! request, in bytes per second, or 0 if it did not send any yet.
+    double m_block_download_rate{0};
+    //! Moving average of the time this peer takes to send a block requested
+    //! while no other block was in flight from it.
+    std::chrono::microseconds m_block_download_latency{0us};
+    //! When this peer last sent a block we requested.
+    std::chrono::microseconds m_last_block_download_time{0us};
     //! Whether we consider this a preferred download peer.
     bool fPreferredDownload{false};
     /**
@@ -757,7 +940,7 @@ public:
         EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex);
     void FinalizeNode(const Config &config, const CNode &node) override
         EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex, !cs_proofrequest,
-                                 !m_headers_presync_mutex);
+                                 !m_headers_presync_mutex, !m_tx_relay_mutex);
     bool ProcessMessages(const Config &config, CNode *pfrom,
                          std::atomic<bool> &interrupt) override
         EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex,
@@ -768,7 +951,7 @@ public:
         EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex,
                                  !m_recent_confirmed_transactions_mutex,
                                  !m_most_recent_block_mutex, !cs_proofrequest,
-                                 g_msgproc_mutex);
+                                 !m_tx_relay_mutex, g_msgproc_mutex);
 
     /** Implement PeerManager */
     void StartScheduledTasks(CScheduler &scheduler) override;
@@ -778,10 +961,12 @@ public:
                const CBlockIndex &block_index) override;
     bool GetNodeStateStats(NodeId nodeid, CNodeStateStats &stats) const override
         EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex);
+    std::map<std::string, NetMsgTimingStats>
+    GetNetMsgTimingStats() const override;
     bool IgnoresIncomingTxs() override { return m_opts.ignore_incoming_txs; }
     void SendPings() override EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex);
     void RelayTransaction(const TxId &txid) override
-        EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex);
+        EXCLUSIVE_LOCKS_REQUIRED(!m_tx_relay_mutex, !m_peer_mutex);
     void RelayProof(const avalanche::ProofId &proofid) override
         EXCLUSIVE_LOCKS_REQUIRED(!m_peer_mutex);
     void SetBestHeight(int height) override { m_best_height = height; };
@@ -1194,6 +1379,24 @@ private:
      */
     std::map<NodeId, PeerRef> m_peer_map GUARDED_BY(m_peer_mutex);
 
+    /** Protects m_txs_to_relay. */
+    Mutex m_tx_relay_mutex;
+    /** Transactions to relay, to be resolved into the next batch. */
+    std::vector<TxId> m_txs_to_relay GUARDED_BY(m_tx_relay_mutex);
+    /** Epoch of the last TxAnnouncementBatch. */
+    uint64_t m_tx_relay_epoch
+        GUARDED_BY(NetEventsInterface::g_msgproc_mutex){0};
+
+    /**
+     * Look the transactions relayed since the previous call up in the
+     * mempool, all at once, and queue the resulting batch of announcements
+     * to each peer. The peers then filter their announcements without
+     * looking them up again.
+     */
+    void ProcessTxRelayBatch()
+        EXCLUSIVE_LOCKS_REQUIRED(NetEventsInterface::g_msgproc_mutex,
+                                 !m_tx_relay_mutex, !m_peer_mutex);
+
     /** Map maintaining per-node state. */
     std::map<NodeId, CNodeState> m_node_states GUARDED_BY(cs_main);
 
@@ -1399,13 +1602,57 @@ private:
 
     /**
      * Update pindexLastCommonBlock and add not-in-flight missing successors to
-     * vBlocks, until it has at most count entries.
+     * vBlocks, until it has at most count entries. The first missing block in
+     * flight is added as well if this peer can be expected to send it sooner
+     * than the peer it is in flight from, see ShouldRequestStuckBlock().
      */
     void FindNextBlocksToDownload(NodeId nodeid, unsigned int count,
                                   std::vector<const CBlockIndex *> &vBlocks,
                                   NodeId &nodeStaller)
         EXCLUSIVE_LOCKS_REQUIRED(cs_main);
 
+    /**
+     * Whether to request from nodeid the block in flight from a single other
+     * peer that the block validation is waiting on. This is the case when the
+     * block is late compared to the download rate and latency measured for
+     * that peer, or when nodeid is expected to send it much sooner.
+     */
+    bool ShouldRequestStuckBlock(NodeId nodeid, const CBlockIndex &block)
+        EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+    /**
+     * Time the peer is expected to take to send a block requested now, given
+     * the blocks already in flight from it, or nullopt if the peer did not
+     * send any block yet.
+     */
+    std::optional<std::chrono::microseconds>
+    ExpectedBlockDownloadTime(const CNodeState &state,
+                              size_t blocks_ahead) const
+        EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+    /**
+     * Number of blocks that can be in flight from the peer, scaled by its
+     * download rate relative to the fastest peer.
+     */
+    size_t GetMaxBlocksInFlight(const CNodeState &state) const
+        EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+    /**
+     * Update the download rate and latency of the peer with a block of size
+     * bytes it sent in response to our request.
+     */
+    void RecordBlockDownload(NodeId nodeid, const BlockHash &hash, size_t size)
+        EXCLUSIVE_LOCKS_REQUIRED(cs_main);
+
+    /** Moving average of the size of the blocks we requested, in bytes. */
+    double m_block_size_estimate GUARDED_BY(cs_main){0};
+
+    /**
+     * The non-zero download rates of all the peers, so the fastest one is
+     * known without iterating m_node_states.
+     */
+    std::multiset<double> m_block_download_rates GUARDED_BY(cs_main);
+
     /** Multimap used to preserve insertion order */
     typedef std::multimap<BlockHash,
                           std::pair<NodeId, std::list<QueuedBlock>::iterator>>
@@ -1432,6 +1679,104 @@ private:
                                  NetEventsInterface::g_msgproc_mutex)
             LOCKS_EXCLUDED(cs_main);
 
+    /**
+     * Add the items of a getdata message to the peer's getdata queue.
+     * @return false if the message is invalid.
+     */
+    bool QueueGetData(CNode &pfrom, Peer &peer, CDataStream &vRecv)
+        EXCLUSIVE_LOCKS_REQUIRED(peer.m_getdata_requests_mutex);
+
+    /** Handle a ping message by echoing its nonce back. */
+    void ProcessPing(CNode &pfrom, CDataStream &vRecv);
+
+    /** Handle a pong message, completing the outstanding ping if any. */
+    void ProcessPong(CNode &pfrom, Peer &peer, CDataStream &vRecv,
+                     std::chrono::microseconds time_received);
+
+    /**
+     * Hand the message over to a message processing worker thread if its type
+     * allows. Messages of these types only need the locks of the state they
+     * touch, so they can be processed concurrently with the messages of the
+     * other peers:
+     *  - ping and pong messages are processed entirely,
+     *  - the blocks at the front of the getdata queue are served, leaving the
+     *    other items to the message handler thread,
+     *  - the signature of avalanche responses is verified, then the message is
+     *    handed back to the message handler thread to register the votes.
+     * The next messages from the peer wait for the worker to complete.
+     * @return true if the message was handed over.
+     */
+    bool MaybeProcessMessageInBackground(
+        const Config &config, CNode &pfrom, const PeerRef &peer,
+        CNetMessage &msg, const std::atomic<bool> &interruptMsgProc)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex,
+                                 !m_ava_response_sigs_batch_mutex,
+                                 !m_pending_ava_response_sigs_mutex);
+
+    /**
+     * Hand the blocks at the front of the getdata queue over to a message
+     * processing worker thread, so the message handler thread only serves the
+     * other items. This resumes the serving that a worker stopped because the
+     * send buffer was full.
+     * @return true if the blocks were handed over.
+     */
+    bool MaybeServeBlocksInBackground(const Config &config, CNode &pfrom,
+                                      const PeerRef &peer,
+                                      const std::atomic<bool> &interruptMsgProc)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex);
+
+    /**
+     * Serve the blocks at the front of the getdata queue until the send buffer
+     * is full, in which case the message handler thread is woken up once it
+     * drains to hand the rest over again.
+     */
+    void ServeBlocksInBackground(const Config &config, CNode &pfrom,
+                                 Peer &peer,
+                                 const std::atomic<bool> &interruptMsgProc)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex,
+                                 peer.m_getdata_requests_mutex);
+
+    /** Body of the tasks run by MaybeProcessMessageInBackground(). */
+    void ProcessMessageInBackground(const Config &config, CNode &pfrom,
+                                    Peer &peer, CNetMessage &msg,
+                                    const std::atomic<bool> &interruptMsgProc)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex,
+                                 !m_ava_response_sigs_batch_mutex,
+                                 !m_pending_ava_response_sigs_mutex);
+
+    /** Signature of an avalanche response waiting to be verified. */
+    struct PendingAvaResponseSig {
+        /**
+         * The worker processing the response holds a reference to the peer
+         * until the signature is verified.
+         */
+        Peer *peer;
+        CPubKey pubkey;
+        uint256 hash;
+        SchnorrSig sig;
+    };
+    Mutex m_pending_ava_response_sigs_mutex;
+    std::vector<PendingAvaResponseSig>
+        m_pending_ava_response_sigs GUARDED_BY(m_pending_ava_response_sigs_mutex);
+    /**
+     * Held while verifying the pending avalanche response signatures, so a
+     * worker waits for the signature it queued to be verified before handing
+     * the response back.
+     */
+    Mutex m_ava_response_sigs_batch_mutex;
+
+    /**
+     * Verify the signatures of all the pending avalanche responses at once,
+     * including the ones queued by the other workers in the meantime.
+     */
+    void VerifyPendingAvaResponseSigs()
+        EXCLUSIVE_LOCKS_REQUIRED(!m_ava_response_sigs_batch_mutex,
+                                 !m_pending_ava_response_sigs_mutex);
+
+    /** Timings of the messages processed from all the peers, by type */
+    std::map<std::string, MsgTimings> m_msg_timings{
+        MakeMsgTimingsMap<MsgTimings>()};
+
     /** Process a new block. Perform any post-processing housekeeping */
     void ProcessBlock(const Config &config, CNode &node,
                       const std::shared_ptr<const CBlock> &block,
@@ -1503,7 +1848,8 @@ private:
     bool AlreadyHaveProof(const avalanche::ProofId &proofid);
     void ProcessGetBlockData(const Config &config, CNode &pfrom, Peer &peer,
                              const CInv &inv)
-        EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex);
+        LOCKS_EXCLUDED(cs_main)
+            EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex);
 
     /**
      * Validation logic for compact filters request handling.
@@ -1791,9 +2137,10 @@ bool PeerManagerImpl::BlockRequested(const Config &config, NodeId nodeid,
 
     std::list<QueuedBlock>::iterator it = state->vBlocksInFlight.insert(
         state->vBlocksInFlight.end(),
-        {&block, std::unique_ptr<PartiallyDownloadedBlock>(
-                     pit ? new PartiallyDownloadedBlock(config, &m_mempool)
-                         : nullptr)});
+        {&block,
+         std::unique_ptr<PartiallyDownloadedBlock>(
+             pit ? new PartiallyDownloadedBlock(config, &m_mempool) : nullptr),
+         GetTime<std::chrono::microseconds>()});
     if (state->vBlocksInFlight.size() == 1) {
         // We're starting a block download (batch) from this peer.
         state->m_downloading_since = GetTime<std::chrono::microseconds>();
@@ -2009,6 +2356,7 @@ void PeerManagerImpl::FindNextBlocksToDownload(
     int nMaxHeight =
         std::min<int>(state->pindexBestKnownBlock->nHeight, nWindowEnd + 1);
     NodeId waitingfor = -1;
+    const CBlockIndex *stuck_block{nullptr};
     while (pindexWalk->nHeight < nMaxHeight) {
         // Read up to 128 (or more, if more blocks than that are needed)
         // successors of pindexWalk (towards pindexBestKnownBlock) into
@@ -2043,6 +2391,11 @@ void PeerManagerImpl::FindNextBlocksToDownload(
                 // The block is not already downloaded, and not yet in flight.
                 if (pindex->nHeight > nWindowEnd) {
                     // We reached the end of the window.
+                    if (vBlocks.size() == 1 && vBlocks.front() == stuck_block) {
+                        // The window cannot move, leave the block to the
+                        // stalling logic that disconnects its peer.
+                        vBlocks.clear();
+                    }
                     if (vBlocks.size() == 0 && waitingfor != nodeid) {
                         // We aren't able to fetch anything, but we would be if
                         // the download window was one larger.
@@ -2059,11 +2412,131 @@ void PeerManagerImpl::FindNextBlocksToDownload(
                 waitingfor =
                     mapBlocksInFlight.lower_bound(pindex->GetBlockHash())
                         ->second.first;
+                if (vBlocks.empty() &&
+                    ShouldRequestStuckBlock(nodeid, *pindex)) {
+                    // The block validation is waiting on this block, get it
+                    // from this peer as well.
+                    stuck_block = pindex;
+                    vBlocks.push_back(pindex);
+                    if (vBlocks.size() == count) {
+                        return;
+                    }
+                }
             }
         }
     }
 }
 
+bool PeerManagerImpl::ShouldRequestStuckBlock(NodeId nodeid,
+                                              const CBlockIndex &block) {
+    const auto range = mapBlocksInFlight.equal_range(block.GetBlockHash());
+    if (range.first == range.second || std::next(range.first) != range.second) {
+        return false;
+    }
+    const auto &[holder, queued_it] = range.first->second;
+    if (holder == nodeid) {
+        return false;
+    }
+
+    const CNodeState &state = *Assert(State(nodeid));
+    const auto expected{
+        ExpectedBlockDownloadTime(state, state.vBlocksInFlight.size())};
+    if (!expected) {
+        // We don't know yet how fast this peer is.
+        return false;
+    }
+
+    const auto waited{GetTime<std::chrono::microseconds>() -
+                      queued_it->m_request_time};
+    if (waited < BLOCK_REREQUEST_MIN_WAIT ||
+        waited <= BLOCK_REREQUEST_FACTOR * *expected) {
+        return false;
+    }
+
+    const CNodeState &holder_state = *Assert(State(holder));
+    const auto holder_expected{ExpectedBlockDownloadTime(
+        holder_state,
+        std::distance(holder_state.vBlocksInFlight.cbegin(),
+                      std::list<QueuedBlock>::const_iterator{queued_it}))};
+    // The peer the block is in flight from is either late, or much slower
+    // than this one.
+    return !holder_expected ||
+           waited > BLOCK_REREQUEST_FACTOR * *holder_expected ||
+           *holder_expected - waited > BLOCK_REREQUEST_FACTOR * *expected;
+}
+
+std::optional<std::chrono::microseconds>
+PeerManagerImpl::ExpectedBlockDownloadTime(const CNodeState &state,
+                                           size_t blocks_ahead) const {
+    if (state.m_block_download_rate <= 0) {
+        return std::nullopt;
+    }
+    return state.m_block_download_latency +
+           std::chrono::microseconds{int64_t(
+               1'000'000 * blocks_ahead * m_block_size_estimate /
+               state.m_block_download_rate)};
+}
+
+size_t PeerManagerImpl::GetMaxBlocksInFlight(const CNodeState &state) const {
+    if (state.m_block_download_rate <= 0) {
+        return MAX_BLOCKS_IN_TRANSIT_PER_PEER;
+    }
+
+    // The rate of this peer is in the set, so it is not empty.
+    const double best_rate{*m_block_download_rates.rbegin()};
+    return std::clamp<size_t>(
+        std::ceil(MAX_BLOCKS_IN_TRANSIT_PER_PEER * state.m_block_download_rate /
+                  best_rate),
+        MIN_BLOCKS_IN_TRANSIT_PER_PEER, MAX_BLOCKS_IN_TRANSIT_PER_PEER);
+}
+
+void PeerManagerImpl::RecordBlockDownload(NodeId nodeid, const BlockHash &hash,
+                                          size_t size) {
+    auto range = mapBlocksInFlight.equal_range(hash);
+    while (range.first != range.second &&
+           range.first->second.first != nodeid) {
+        ++range.first;
+    }
+    if (range.first == range.second) {
+        // We did not request this block from this peer.
+        return;
+    }
+    const QueuedBlock &queued = *range.first->second.second;
+    CNodeState &state = *Assert(State(nodeid));
+
+    // If other blocks were in flight from this peer when this one was
+    // requested, it only started sending it after the previous one.
+    const auto now{GetTime<std::chrono::microseconds>()};
+    const bool pipelined{queued.m_request_time <
+                         state.m_last_block_download_time};
+    const auto duration{std::max<std::chrono::microseconds>(
+        now - std::max(queued.m_request_time, state.m_last_block_download_time),
+        1ms)};
+    state.m_last_block_download_time = now;
+
+    auto update_average = [](double average, double sample) {
+        return average == 0
+                   ? sample
+                   : average + (sample - average) * BLOCK_DOWNLOAD_STATS_WEIGHT;
+    };
+    if (state.m_block_download_rate > 0) {
+        m_block_download_rates.erase(
+            m_block_download_rates.find(state.m_block_download_rate));
+    }
+    state.m_block_download_rate = update_average(
+        state.m_block_download_rate, size / CountSecondsDouble(duration));
+    if (state.m_block_download_rate > 0) {
+        m_block_download_rates.insert(state.m_block_download_rate);
+    }
+    if (!pipelined) {
+        // The latency includes the time to send the block itself.
+        state.m_block_download_latency = std::chrono::microseconds{
+            int64_t(update_average(state.m_block_download_latency.count(),
+                                   duration.count()))};
+    }
+    m_block_size_estimate = update_average(m_block_size_estimate, size);
+}
+
 } // namespace
 
 template <class InvId>
@@ -2415,6 +2888,10 @@ void PeerManagerImpl::FinalizeNode(const Config &config, const CNode &node) {
                                     return peer->m_misbehavior_score);
             LOCK(m_peer_mutex);
             m_peer_map.erase(nodeid);
+            if (m_peer_map.empty()) {
+                // No peer is left to send the queued transactions to.
+                WITH_LOCK(m_tx_relay_mutex, m_txs_to_relay.clear());
+            }
         }
         CNodeState *state = State(nodeid);
         assert(state != nullptr);
@@ -2445,6 +2922,10 @@ void PeerManagerImpl::FinalizeNode(const Config &config, const CNode &node) {
         m_outbound_peers_with_protect_from_disconnect -=
             state->m_chain_sync.m_protect;
         assert(m_outbound_peers_with_protect_from_disconnect >= 0);
+        if (state->m_block_download_rate > 0) {
+            m_block_download_rates.erase(
+                m_block_download_rates.find(state->m_block_download_rate));
+        }
 
         m_node_states.erase(nodeid);
 
@@ -2453,6 +2934,7 @@ void PeerManagerImpl::FinalizeNode(const Config &config, const CNode &node) {
             assert(mapBlocksInFlight.empty());
             assert(m_num_preferred_download_peers == 0);
             assert(m_peers_downloading_from == 0);
+            assert(m_block_download_rates.empty());
             assert(m_outbound_peers_with_protect_from_disconnect == 0);
             assert(m_txrequest.Size() == 0);
             assert(m_mempool.withOrphanage([](const TxOrphanage &orphanage) {
@@ -2514,6 +2996,9 @@ bool PeerManagerImpl::GetNodeStateStats(NodeId nodeid,
                 stats.vHeightInFlight.push_back(queue.pindex->nHeight);
             }
         }
+        stats.m_block_download_rate = state->m_block_download_rate;
+        stats.m_block_download_latency = state->m_block_download_latency;
+        stats.m_max_blocks_in_flight = GetMaxBlocksInFlight(*state);
     }
 
     PeerRef peer = GetPeerRef(nodeid);
@@ -2555,10 +3040,34 @@ bool PeerManagerImpl::GetNodeStateStats(NodeId nodeid,
             stats.presync_height = peer->m_headers_sync->GetPresyncHeight();
         }
     }
+    for (const auto &[msg_type, timings] : peer->m_msg_timings) {
+        const uint64_t count{timings.count.load()};
+        if (count == 0) {
+            continue;
+        }
+        stats.m_msg_timings[msg_type] = PeerNetMsgTimingStats{
+            count, std::chrono::microseconds{timings.queue_wait_micros.load()},
+            std::chrono::microseconds{timings.processing_micros.load()},
+            std::chrono::microseconds{timings.cs_main_micros.load()}};
+    }
 
     return true;
 }
 
+std::map<std::string, NetMsgTimingStats>
+PeerManagerImpl::GetNetMsgTimingStats() const {
+    std::map<std::string, NetMsgTimingStats> stats;
+    for (const auto &[msg_type, timings] : m_msg_timings) {
+        NetMsgTimingStats msg_stats{timings.queue_wait.GetSnapshot(),
+                                    timings.processing.GetSnapshot(),
+                                    timings.cs_main.GetSnapshot()};
+        if (msg_stats.processing.count > 0) {
+            stats.emplace(msg_type, std::move(msg_stats));
+        }
+    }
+    return stats;
+}
+
 void PeerManagerImpl::AddToCompactExtraTransactions(const CTransactionRef &tx) {
     if (m_opts.max_extra_txs <= 0) {
         return;
@@ -3073,6 +3582,34 @@ void PeerManagerImpl::SendPings() {
 }
 
 void PeerManagerImpl::RelayTransaction(const TxId &txid) {
+    // The queue is only drained from SendMessages(), so nothing is queued
+    // while there is no peer to send to, as when the network is inactive.
+    if (WITH_LOCK(m_peer_mutex, return m_peer_map.empty())) {
+        return;
+    }
+    LOCK(m_tx_relay_mutex);
+    m_txs_to_relay.push_back(txid);
+}
+
+void PeerManagerImpl::ProcessTxRelayBatch() {
+    // Released before looking the transactions up, as transactions may be
+    // relayed while the mempool is locked.
+    const std::vector<TxId> txids{
+        WITH_LOCK(m_tx_relay_mutex,
+                  return std::exchange(m_txs_to_relay, {}))};
+    if (txids.empty()) {
+        return;
+    }
+
+    auto batch = std::make_shared<TxAnnouncementBatch>();
+    batch->epoch = ++m_tx_relay_epoch;
+    for (TxMempoolInfo &txinfo : m_mempool.infoMany(txids)) {
+        batch->announcements.push_back(TxAnnouncement{
+            std::move(txinfo.tx), txinfo.fee, txinfo.vsize, txinfo.m_entry_id});
+    }
+    LogPrint(BCLog::NETDEBUG, "Relaying batch %u of %u transactions\n",
+             batch->epoch, batch->announcements.size());
+
     LOCK(m_peer_mutex);
     for (auto &it : m_peer_map) {
         Peer &peer = *it.second;
@@ -3090,8 +3627,12 @@ void PeerManagerImpl::RelayTransaction(const TxId &txid) {
             continue;
         }
 
-        if (!tx_relay->m_tx_inventory_known_filter.contains(txid)) {
-            tx_relay->m_tx_inventory_to_send.insert(txid);
+        for (const TxAnnouncement &announcement : batch->announcements) {
+            const TxId &txid = announcement.tx->GetId();
+            if (!tx_relay->m_tx_inventory_known_filter.contains(txid)) {
+                tx_relay->m_tx_inventory_to_send.emplace(
+                    txid, TxAnnouncementRef{batch, &announcement});
+            }
         }
     }
 }
@@ -3208,72 +3749,128 @@ void PeerManagerImpl::ProcessGetBlockData(const Config &config, CNode &pfrom,
         }
     }
 
-    LOCK(cs_main);
-    const CBlockIndex *pindex = m_chainman.m_blockman.LookupBlockIndex(hash);
-    if (!pindex) {
-        return;
-    }
-    if (!BlockRequestAllowed(pindex)) {
-        LogPrint(BCLog::NET,
-                 "%s: ignoring request from peer=%i for old "
-                 "block that isn't in the main chain\n",
-                 __func__, pfrom.GetId());
-        return;
-    }
-    const CNetMsgMaker msgMaker(pfrom.GetCommonVersion());
-    // Disconnect node in case we have reached the outbound limit for serving
-    // historical blocks.
-    if (m_connman.OutboundTargetReached(true) &&
-        (((m_chainman.m_best_header != nullptr) &&
-          (m_chainman.m_best_header->GetBlockTime() - pindex->GetBlockTime() >
-           HISTORICAL_BLOCK_AGE)) ||
-         inv.IsMsgFilteredBlk()) &&
-        // nodes with the download permission may exceed target
-        !pfrom.HasPermission(NetPermissionFlags::Download)) {
-        LogPrint(BCLog::NET,
-                 "historical block serving limit reached, disconnect peer=%d\n",
-                 pfrom.GetId());
-        pfrom.fDisconnect = true;
-        return;
+    // Decide whether and how to serve the block under cs_main, then release it
+    // before reading the block from disk and sending it.
+    const CBlockIndex *pindex{nullptr};
+    const CBlockIndex *tip{nullptr};
+    bool send_compact_block{false};
+    {
+        LOCK(cs_main);
+        pindex = m_chainman.m_blockman.LookupBlockIndex(hash);
+        if (!pindex) {
+            return;
+        }
+        if (!BlockRequestAllowed(pindex)) {
+            LogPrint(BCLog::NET,
+                     "%s: ignoring request from peer=%i for old "
+                     "block that isn't in the main chain\n",
+                     __func__, pfrom.GetId());
+            return;
+        }
+        // Disconnect node in case we have reached the outbound limit for
+        // serving historical blocks.
+        if (m_connman.OutboundTargetReached(true) &&
+            (((m_chainman.m_best_header != nullptr) &&
+              (m_chainman.m_best_header->GetBlockTime() -
+                   pindex->GetBlockTime() >
+               HISTORICAL_BLOCK_AGE)) ||
+             inv.IsMsgFilteredBlk()) &&
+            // nodes with the download permission may exceed target
+            !pfrom.HasPermission(NetPermissionFlags::Download)) {
+            LogPrint(
+                BCLog::NET,
+                "historical block serving limit reached, disconnect peer=%d\n",
+                pfrom.GetId());
+            pfrom.fDisconnect = true;
+            return;
+        }
+        tip = m_chainman.ActiveChain().Tip();
+        // Avoid leaking prune-height by never sending blocks below the
+        // NODE_NETWORK_LIMITED threshold.
+        // Add two blocks buffer extension for possible races
+        if (!pfrom.HasPermission(NetPermissionFlags::NoBan) &&
+            ((((peer.m_our_services & NODE_NETWORK_LIMITED) ==
+               NODE_NETWORK_LIMITED) &&
+              ((peer.m_our_services & NODE_NETWORK) != NODE_NETWORK) &&
+              (tip->nHeight - pindex->nHeight >
+               (int)NODE_NETWORK_LIMITED_MIN_BLOCKS + 2)))) {
+            LogPrint(BCLog::NET,
+                     "Ignore block request below NODE_NETWORK_LIMITED "
+                     "threshold, disconnect peer=%d\n",
+                     pfrom.GetId());
+
+            // disconnect node and prevent it from stalling (would otherwise
+            // wait for the missing block)
+            pfrom.fDisconnect = true;
+            return;
+        }
+        // Pruned nodes may have deleted the block, so check whether it's
+        // available before trying to send.
+        if (!pindex->nStatus.hasData()) {
+            return;
+        }
+        // If a peer is asking for old blocks, we're almost guaranteed they
+        // won't have a useful mempool to match against a compact block, and
+        // we don't feel like constructing the object for them, so instead
+        // we respond with the full, non-compact block.
+        send_compact_block =
+            CanDirectFetch() &&
+            pindex->nHeight >= tip->nHeight - MAX_CMPCTBLOCK_DEPTH;
     }
-    // Avoid leaking prune-height by never sending blocks below the
-    // NODE_NETWORK_LIMITED threshold.
-    // Add two blocks buffer extension for possible races
-    if (!pfrom.HasPermission(NetPermissionFlags::NoBan) &&
-        ((((peer.m_our_services & NODE_NETWORK_LIMITED) ==
-           NODE_NETWORK_LIMITED) &&
-          ((peer.m_our_services & NODE_NETWORK) != NODE_NETWORK) &&
-          (m_chainman.ActiveChain().Tip()->nHeight - pindex->nHeight >
-           (int)NODE_NETWORK_LIMITED_MIN_BLOCKS + 2)))) {
-        LogPrint(BCLog::NET,
-                 "Ignore block request below NODE_NETWORK_LIMITED "
-                 "threshold, disconnect peer=%d\n",
-                 pfrom.GetId());
 
-        // disconnect node and prevent it from stalling (would otherwise wait
-        // for the missing block)
+    // The block may be pruned once cs_main is released, in which case the peer
+    // is disconnected as if the block was requested a bit later.
+    const auto readFailed = [&]() {
+        if (WITH_LOCK(cs_main,
+                      return m_chainman.m_blockman.IsBlockPruned(pindex))) {
+            LogPrint(BCLog::NET,
+                     "Block was pruned before it could be read, disconnect "
+                     "peer=%d\n",
+                     pfrom.GetId());
+        } else {
+            LogPrintf("Cannot load block from disk, disconnect peer=%d\n",
+                      pfrom.GetId());
+        }
         pfrom.fDisconnect = true;
-        return;
-    }
-    // Pruned nodes may have deleted the block, so check whether it's available
-    // before trying to send.
-    if (!pindex->nStatus.hasData()) {
-        return;
-    }
+    };
+
+    const CNetMsgMaker msgMaker(pfrom.GetCommonVersion());
     std::shared_ptr<const CBlock> pblock;
     if (a_recent_block && a_recent_block->GetHash() == pindex->GetBlockHash()) {
         pblock = a_recent_block;
-    } else {
+    } else if (!inv.IsMsgBlk()) {
         // Send block from disk
         std::shared_ptr<CBlock> pblockRead = std::make_shared<CBlock>();
         if (!m_chainman.m_blockman.ReadBlockFromDisk(*pblockRead, *pindex)) {
-            assert(!"cannot load block from disk");
+            readFailed();
+            return;
         }
         pblock = pblockRead;
     }
     if (inv.IsMsgBlk()) {
-        m_connman.PushMessage(&pfrom,
-                              msgMaker.Make(NetMsgType::BLOCK, *pblock));
+        if (pblock) {
+            m_connman.PushMessage(&pfrom,
+                                  msgMaker.Make(NetMsgType::BLOCK, *pblock));
+        } else {
+            // The network format of a block matches the format on disk, so
+            // send it as read from disk rather than deserializing it only to
+            // serialize it again.
+            CSerializedNetMsg msg;
+            msg.m_type = NetMsgType::BLOCK;
+            if (m_chainman.m_blockman.ReadRawBlockFromDisk(msg.data,
+                                                           *pindex)) {
+                m_connman.PushMessage(&pfrom, std::move(msg));
+            } else {
+                // Fall back to the regular read, which may still succeed.
+                CBlock block;
+                if (!m_chainman.m_blockman.ReadBlockFromDisk(block, *pindex)) {
+                    readFailed();
+                    return;
+                }
+                m_connman.PushMessage(&pfrom,
+                                      msgMaker.Make(NetMsgType::BLOCK, block));
+            }
+        }
     } else if (inv.IsMsgFilteredBlk()) {
         bool sendMerkleBlock = false;
         CMerkleBlock merkleBlock;
@@ -3306,14 +3903,8 @@ void PeerManagerImpl::ProcessGetBlockData(const Config &config, CNode &pfrom,
         // else
         // no response
     } else if (inv.IsMsgCmpctBlk()) {
-        // If a peer is asking for old blocks, we're almost guaranteed they
-        // won't have a useful mempool to match against a compact block, and
-        // we don't feel like constructing the object for them, so instead
-        // we respond with the full, non-compact block.
         int nSendFlags = 0;
-        if (CanDirectFetch() &&
-            pindex->nHeight >=
-                m_chainman.ActiveChain().Height() - MAX_CMPCTBLOCK_DEPTH) {
+        if (send_compact_block) {
             if (a_recent_compact_block &&
                 a_recent_compact_block->header.GetHash() ==
                     pindex->GetBlockHash()) {
@@ -3341,8 +3932,7 @@ void PeerManagerImpl::ProcessGetBlockData(const Config &config, CNode &pfrom,
             // we want it right after the last block so they don't wait for
             // other stuff first.
             std::vector<CInv> vInv;
-            vInv.push_back(CInv(
-                MSG_BLOCK, m_chainman.ActiveChain().Tip()->GetBlockHash()));
+            vInv.push_back(CInv(MSG_BLOCK, tip->GetBlockHash()));
             m_connman.PushMessage(&pfrom, msgMaker.Make(NetMsgType::INV, vInv));
             peer.m_continuation_block = BlockHash();
         }
@@ -3542,8 +4132,10 @@ void PeerManagerImpl::ProcessGetData(
     }
 
     // Only process one BLOCK item per call, since they're uncommon and can be
-    // expensive to process.
-    if (it != peer.m_getdata_requests.end() && !pfrom.fPauseSend) {
+    // expensive to process. If there are worker threads, the blocks are left
+    // for them to serve on the next call.
+    if (it != peer.m_getdata_requests.end() && !pfrom.fPauseSend &&
+        !(it->IsGenBlkMsg() && m_connman.CanProcessMessagesInBackground())) {
         const CInv &inv = *it++;
         if (inv.IsGenBlkMsg()) {
             ProcessGetBlockData(config, pfrom, peer, inv);
@@ -3572,6 +4164,29 @@ void PeerManagerImpl::ProcessGetData(
     }
 }
 
+bool PeerManagerImpl::QueueGetData(CNode &pfrom, Peer &peer,
+                                   CDataStream &vRecv) {
+    std::vector<CInv> vInv;
+    vRecv >> vInv;
+    if (vInv.size() > MAX_INV_SZ) {
+        Misbehaving(peer, 20,
+                    strprintf("getdata message size = %u", vInv.size()));
+        return false;
+    }
+
+    LogPrint(BCLog::NET, "received getdata (%u invsz) peer=%d\n", vInv.size(),
+             pfrom.GetId());
+
+    if (vInv.size() > 0) {
+        LogPrint(BCLog::NET, "received getdata for: %s peer=%d\n",
+                 vInv[0].ToString(), pfrom.GetId());
+    }
+
+    peer.m_getdata_requests.insert(peer.m_getdata_requests.end(), vInv.begin(),
+                                   vInv.end());
+    return true;
+}
+
 void PeerManagerImpl::SendBlockTransactions(
     CNode &pfrom, Peer &peer, const CBlock &block,
     const BlockTransactionsRequest &req) {
@@ -4742,6 +5357,89 @@ void PeerManagerImpl::ProcessBlock(const Config &config, CNode &node,
     }
 }
 
+void PeerManagerImpl::ProcessPing(CNode &pfrom, CDataStream &vRecv) {
+    const CNetMsgMaker msgMaker(pfrom.GetCommonVersion());
+    if (pfrom.GetCommonVersion() > BIP0031_VERSION) {
+        uint64_t nonce = 0;
+        vRecv >> nonce;
+        // Echo the message back with the nonce. This allows for two useful
+        // features:
+        //
+        // 1) A remote node can quickly check if the connection is
+        // operational.
+        // 2) Remote nodes can measure the latency of the network thread. If
+        // this node is overloaded it won't respond to pings quickly and the
+        // remote node can avoid sending us more work, like chain download
+        // requests.
+        //
+        // The nonce stops the remote getting confused between different
+        // pings: without it, if the remote node sends a ping once per
+        // second and this node takes 5 seconds to respond to each, the 5th
+        // ping the remote sends would appear to return very quickly.
+        m_connman.PushMessage(&pfrom,
+                              msgMaker.Make(NetMsgType::PONG, nonce));
+    }
+}
+
+void PeerManagerImpl::ProcessPong(CNode &pfrom, Peer &peer, CDataStream &vRecv,
+                                  std::chrono::microseconds time_received) {
+    const auto ping_end = time_received;
+    uint64_t nonce = 0;
+    size_t nAvail = vRecv.in_avail();
+    bool bPingFinished = false;
+    std::string sProblem;
+    // Pongs may be processed on a worker thread while the message handler
+    // thread sends a new ping, so only the ping checked here is cleared.
+    uint64_t nonce_sent{peer.m_ping_nonce_sent};
+
+    if (nAvail >= sizeof(nonce)) {
+        vRecv >> nonce;
+
+        // Only process pong message if there is an outstanding ping (old
+        // ping without nonce should never pong)
+        if (nonce_sent != 0) {
+            if (nonce == nonce_sent) {
+                // Matching pong received, this ping is no longer
+                // outstanding
+                bPingFinished = true;
+                const auto ping_time = ping_end - peer.m_ping_start.load();
+                if (ping_time.count() >= 0) {
+                    // Let connman know about this successful ping-pong
+                    pfrom.PongReceived(ping_time);
+                } else {
+                    // This should never happen
+                    sProblem = "Timing mishap";
+                }
+            } else {
+                // Nonce mismatches are normal when pings are overlapping
+                sProblem = "Nonce mismatch";
+                if (nonce == 0) {
+                    // This is most likely a bug in another implementation
+                    // somewhere; cancel this ping
+                    bPingFinished = true;
+                    sProblem = "Nonce zero";
+                }
+            }
+        } else {
+            sProblem = "Unsolicited pong without ping";
+        }
+    } else {
+        // This is most likely a bug in another implementation somewhere;
+        // cancel this ping
+        bPingFinished = true;
+        sProblem = "Short payload";
+    }
+
+    if (!(sProblem.empty())) {
+        LogPrint(BCLog::NET,
+                 "pong peer=%d: %s, %x expected, %x received, %u bytes\n",
+                 pfrom.GetId(), sProblem, nonce_sent, nonce, nAvail);
+    }
+    if (bPingFinished) {
+        peer.m_ping_nonce_sent.compare_exchange_strong(nonce_sent, 0);
+    }
+}
+
 void PeerManagerImpl::ProcessMessage(
     const Config &config, CNode &pfrom, const std::string &msg_type,
     CDataStream &vRecv, const std::chrono::microseconds time_received,
@@ -5358,29 +6056,10 @@ void PeerManagerImpl::ProcessMessage(
     }
 
     if (msg_type == NetMsgType::GETDATA) {
-        std::vector<CInv> vInv;
-        vRecv >> vInv;
-        if (vInv.size() > MAX_INV_SZ) {
-            Misbehaving(*peer, 20,
-                        strprintf("getdata message size = %u", vInv.size()));
-            return;
-        }
-
-        LogPrint(BCLog::NET, "received getdata (%u invsz) peer=%d\n",
-                 vInv.size(), pfrom.GetId());
-
-        if (vInv.size() > 0) {
-            LogPrint(BCLog::NET, "received getdata for: %s peer=%d\n",
-                     vInv[0].ToString(), pfrom.GetId());
-        }
-
-        {
-            LOCK(peer->m_getdata_requests_mutex);
-            peer->m_getdata_requests.insert(peer->m_getdata_requests.end(),
-                                            vInv.begin(), vInv.end());
+        LOCK(peer->m_getdata_requests_mutex);
+        if (QueueGetData(pfrom, *peer, vRecv)) {
             ProcessGetData(config, pfrom, *peer, interruptMsgProc);
         }
-
         return;
     }
 
@@ -6410,6 +7089,7 @@ void PeerManagerImpl::ProcessMessage(
             return;
         }
 
+        const size_t block_size{vRecv.size()};
         std::shared_ptr<CBlock> pblock = std::make_shared<CBlock>();
         vRecv >> *pblock;
 
@@ -6430,6 +7110,7 @@ void PeerManagerImpl::ProcessMessage(
             // Always process the block if we requested it, since we may
             // need it even when it's not a candidate for a new best tip.
             forceProcessing = IsBlockRequested(hash);
+            RecordBlockDownload(pfrom.GetId(), hash, block_size);
             RemoveBlockRequest(hash, pfrom.GetId());
             // mapBlockSource is only used for punishing peers and setting
             // which peers send us compact blocks, so the race between here and
@@ -6633,11 +7314,16 @@ void PeerManagerImpl::ProcessMessage(
         SchnorrSig sig;
         vRecv >> sig;
 
-        {
+        const uint256 hash{verifier.GetHash()};
+        // The signature may have been verified by a worker thread already.
+        const bool verified{WITH_LOCK(
+            peer->m_background_msg_mutex,
+            return std::exchange(peer->m_verified_ava_response,
+                                 std::nullopt) == std::make_pair(hash, sig))};
+        if (!verified) {
             LOCK(pfrom.cs_avalanche_pubkey);
             if (!pfrom.m_avalanche_pubkey.has_value() ||
-                !(*pfrom.m_avalanche_pubkey)
-                     .VerifySchnorr(verifier.GetHash(), sig)) {
+                !(*pfrom.m_avalanche_pubkey).VerifySchnorr(hash, sig)) {
                 Misbehaving(*peer, 100, "invalid-ava-response-signature");
                 return;
             }
@@ -7088,7 +7774,28 @@ void PeerManagerImpl::ProcessMessage(
             return;
         }
 
-        // If there are prefilled proofs, process them first
+        // If there are prefilled proofs, process them first. Their signatures
+        // are verified all at once beforehand, unless we are not going to
+        // validate them anyway. If the batch fails, the proofs are verified
+        // one by one as they are received and the peer is banned at the first
+        // invalid one, so it can't have us verify all of them twice.
+        if (!m_chainman.ActiveChainstate().IsInitialBlockDownload()) {
+            std::vector<avalanche::ProofRef> unknownProofs;
+            for (const auto &prefilledProof :
+                 compactProofs.getPrefilledProofs()) {
+                if (!AlreadyHaveProof(prefilledProof.proof->getId())) {
+                    unknownProofs.push_back(prefilledProof.proof);
+                }
+            }
+            avalanche::Proof::BatchVerifySignatures(
+                unknownProofs,
+                m_avalanche->withPeerManager(
+                    [](const avalanche::PeerManager &pm) {
+                        return pm.getStakeUtxoDustThreshold();
+                    }),
+                /*verifyEachOnFailure=*/false);
+        }
+
         std::set<uint32_t> prefilledIndexes;
         for (const auto &prefilledProof : compactProofs.getPrefilledProofs()) {
             if (!ReceivedAvalancheProof(pfrom, *peer, prefilledProof.proof)) {
@@ -7351,83 +8058,12 @@ void PeerManagerImpl::ProcessMessage(
     }
 
     if (msg_type == NetMsgType::PING) {
-        if (pfrom.GetCommonVersion() > BIP0031_VERSION) {
-            uint64_t nonce = 0;
-            vRecv >> nonce;
-            // Echo the message back with the nonce. This allows for two useful
-            // features:
-            //
-            // 1) A remote node can quickly check if the connection is
-            // operational.
-            // 2) Remote nodes can measure the latency of the network thread. If
-            // this node is overloaded it won't respond to pings quickly and the
-            // remote node can avoid sending us more work, like chain download
-            // requests.
-            //
-            // The nonce stops the remote getting confused between different
-            // pings: without it, if the remote node sends a ping once per
-            // second and this node takes 5 seconds to respond to each, the 5th
-            // ping the remote sends would appear to return very quickly.
-            m_connman.PushMessage(&pfrom,
-                                  msgMaker.Make(NetMsgType::PONG, nonce));
-        }
+        ProcessPing(pfrom, vRecv);
         return;
     }
 
     if (msg_type == NetMsgType::PONG) {
-        const auto ping_end = time_received;
-        uint64_t nonce = 0;
-        size_t nAvail = vRecv.in_avail();
-        bool bPingFinished = false;
-        std::string sProblem;
-
-        if (nAvail >= sizeof(nonce)) {
-            vRecv >> nonce;
-
-            // Only process pong message if there is an outstanding ping (old
-            // ping without nonce should never pong)
-            if (peer->m_ping_nonce_sent != 0) {
-                if (nonce == peer->m_ping_nonce_sent) {
-                    // Matching pong received, this ping is no longer
-                    // outstanding
-                    bPingFinished = true;
-                    const auto ping_time = ping_end - peer->m_ping_start.load();
-                    if (ping_time.count() >= 0) {
-                        // Let connman know about this successful ping-pong
-                        pfrom.PongReceived(ping_time);
-                    } else {
-                        // This should never happen
-                        sProblem = "Timing mishap";
-                    }
-                } else {
-                    // Nonce mismatches are normal when pings are overlapping
-                    sProblem = "Nonce mismatch";
-                    if (nonce == 0) {
-                        // This is most likely a bug in another implementation
-                        // somewhere; cancel this ping
-                        bPingFinished = true;
-                        sProblem = "Nonce zero";
-                    }
-                }
-            } else {
-                sProblem = "Unsolicited pong without ping";
-            }
-        } else {
-            // This is most likely a bug in another implementation somewhere;
-            // cancel this ping
-            bPingFinished = true;
-            sProblem = "Short payload";
-        }
-
-        if (!(sProblem.empty())) {
-            LogPrint(BCLog::NET,
-                     "pong peer=%d: %s, %x expected, %x received, %u bytes\n",
-                     pfrom.GetId(), sProblem, peer->m_ping_nonce_sent, nonce,
-                     nAvail);
-        }
-        if (bPingFinished) {
-            peer->m_ping_nonce_sent = 0;
-        }
+        ProcessPong(pfrom, *peer, vRecv, time_received);
         return;
     }
 
@@ -7622,6 +8258,181 @@ bool PeerManagerImpl::MaybeDiscourageAndDisconnect(CNode &pnode, Peer &peer) {
     return true;
 }
 
+bool PeerManagerImpl::MaybeProcessMessageInBackground(
+    const Config &config, CNode &pfrom, const PeerRef &peer, CNetMessage &msg,
+    const std::atomic<bool> &interruptMsgProc) {
+    if (!pfrom.fSuccessfullyConnected) {
+        return false;
+    }
+    if (msg.m_type != NetMsgType::PING && msg.m_type != NetMsgType::PONG &&
+        msg.m_type != NetMsgType::GETDATA &&
+        !(msg.m_type == NetMsgType::AVARESPONSE && m_avalanche)) {
+        return false;
+    }
+
+    WITH_LOCK(peer->m_background_msg_mutex,
+              peer->m_background_msg_busy = true);
+    // std::function needs a copyable callable.
+    auto pmsg = std::make_shared<CNetMessage>(std::move(msg));
+    const bool submitted{m_connman.ProcessMessageInBackground(
+        pfrom, [this, &config, &pfrom, peer, pmsg, &interruptMsgProc]()
+                   EXCLUSIVE_LOCKS_REQUIRED(
+                       !m_most_recent_block_mutex,
+                       !m_ava_response_sigs_batch_mutex,
+                       !m_pending_ava_response_sigs_mutex) {
+            ProcessMessageInBackground(config, pfrom, *peer, *pmsg,
+                                       interruptMsgProc);
+            LOCK(peer->m_background_msg_mutex);
+            if (pmsg->m_type == NetMsgType::AVARESPONSE) {
+                peer->m_background_msg = std::move(*pmsg);
+            }
+            peer->m_background_msg_busy = false;
+        })};
+    if (!submitted) {
+        msg = std::move(*pmsg);
+        WITH_LOCK(peer->m_background_msg_mutex,
+                  peer->m_background_msg_busy = false);
+    }
+    return submitted;
+}
+
+bool PeerManagerImpl::MaybeServeBlocksInBackground(
+    const Config &config, CNode &pfrom, const PeerRef &peer,
+    const std::atomic<bool> &interruptMsgProc) {
+    {
+        LOCK(peer->m_getdata_requests_mutex);
+        if (peer->m_getdata_requests.empty() ||
+            !peer->m_getdata_requests.front().IsGenBlkMsg()) {
+            return false;
+        }
+    }
+    if (pfrom.fPauseSend) {
+        // Try again once the send buffer drains. The flag is set before
+        // checking fPauseSend again, so the wake up can't be missed.
+        pfrom.m_wake_msghand_on_send = true;
+        if (pfrom.fPauseSend) {
+            return false;
+        }
+    }
+
+    WITH_LOCK(peer->m_background_msg_mutex,
+              peer->m_background_msg_busy = true);
+    const bool submitted{m_connman.ProcessMessageInBackground(
+        pfrom, [this, &config, &pfrom, peer, &interruptMsgProc]()
+                   EXCLUSIVE_LOCKS_REQUIRED(!m_most_recent_block_mutex) {
+            WITH_LOCK(peer->m_getdata_requests_mutex,
+                      ServeBlocksInBackground(config, pfrom, *peer,
+                                              interruptMsgProc));
+            WITH_LOCK(peer->m_background_msg_mutex,
+                      peer->m_background_msg_busy = false);
+        })};
+    if (!submitted) {
+        WITH_LOCK(peer->m_background_msg_mutex,
+                  peer->m_background_msg_busy = false);
+    }
+    return submitted;
+}
+
+void PeerManagerImpl::ServeBlocksInBackground(
+    const Config &config, CNode &pfrom, Peer &peer,
+    const std::atomic<bool> &interruptMsgProc) {
+    // The other items are left to the message handler thread.
+    while (!peer.m_getdata_requests.empty() &&
+           peer.m_getdata_requests.front().IsGenBlkMsg() && !interruptMsgProc) {
+        if (pfrom.fPauseSend) {
+            // The message handler thread is woken up once this task completes,
+            // and again once the send buffer drains, to hand the rest over.
+            pfrom.m_wake_msghand_on_send = true;
+            return;
+        }
+        const CInv inv{peer.m_getdata_requests.front()};
+        peer.m_getdata_requests.pop_front();
+        ProcessGetBlockData(config, pfrom, peer, inv);
+    }
+}
+
+void PeerManagerImpl::ProcessMessageInBackground(
+    const Config &config, CNode &pfrom, Peer &peer, CNetMessage &msg,
+    const std::atomic<bool> &interruptMsgProc) {
+    LogPrint(BCLog::NETDEBUG, "received: %s (%u bytes) peer=%d, background\n",
+             SanitizeString(msg.m_type), msg.m_recv.size(), pfrom.GetId());
+
+    // Avalanche responses are handed back to the message handler thread, and
+    // only timed there.
+    std::optional<MsgProcessingTimer> timer;
+    if (msg.m_type != NetMsgType::AVARESPONSE) {
+        timer.emplace(pfrom.GetId(), msg,
+                      GetMsgTimings(m_msg_timings, msg.m_type),
+                      GetMsgTimings(peer.m_msg_timings, msg.m_type));
+    }
+
+    try {
+        if (msg.m_type == NetMsgType::PING) {
+            ProcessPing(pfrom, msg.m_recv);
+        } else if (msg.m_type == NetMsgType::PONG) {
+            ProcessPong(pfrom, peer, msg.m_recv, msg.m_time);
+        } else if (msg.m_type == NetMsgType::GETDATA) {
+            LOCK(peer.m_getdata_requests_mutex);
+            if (QueueGetData(pfrom, peer, msg.m_recv)) {
+                ServeBlocksInBackground(config, pfrom, peer, interruptMsgProc);
+            }
+        } else if (msg.m_type == NetMsgType::AVARESPONSE) {
+            // Work on a copy, the message handler thread processes the
+            // message again once handed back.
+            CDataStream vRecv{msg.m_recv};
+            CHashVerifier<CDataStream> verifier(&vRecv);
+            avalanche::Response response;
+            verifier >> response;
+            SchnorrSig sig;
+            vRecv >> sig;
+
+            const std::optional<CPubKey> pubkey{WITH_LOCK(
+                pfrom.cs_avalanche_pubkey, return pfrom.m_avalanche_pubkey)};
+            if (pubkey) {
+                WITH_LOCK(m_pending_ava_response_sigs_mutex,
+                          m_pending_ava_response_sigs.push_back(
+                              {&peer, *pubkey, verifier.GetHash(), sig}));
+                VerifyPendingAvaResponseSigs();
+            }
+        }
+    } catch (const std::exception &e) {
+        LogPrint(BCLog::NET, "%s(%s, %u bytes): Exception '%s' (%s) caught\n",
+                 __func__, SanitizeString(msg.m_type), msg.m_message_size,
+                 e.what(), typeid(e).name());
+    }
+}
+
+void PeerManagerImpl::VerifyPendingAvaResponseSigs() {
+    // Either the signature queued by the caller is part of the batch being
+    // verified and it is done once the lock is acquired, or it is still
+    // pending and part of the next batch.
+    LOCK(m_ava_response_sigs_batch_mutex);
+
+    std::vector<PendingAvaResponseSig> pending;
+    WITH_LOCK(m_pending_ava_response_sigs_mutex,
+              pending.swap(m_pending_ava_response_sigs));
+    if (pending.empty()) {
+        return;
+    }
+
+    SchnorrBatch batch;
+    for (const PendingAvaResponseSig &entry : pending) {
+        batch.Add(entry.pubkey, entry.hash, entry.sig);
+    }
+
+    // The responses with an invalid signature are left for the message handler
+    // thread to verify again and punish the peer.
+    const std::vector<bool> valid{batch.VerifyEach()};
+    for (size_t i = 0; i < pending.size(); ++i) {
+        if (valid[i]) {
+            const PendingAvaResponseSig &entry = pending[i];
+            LOCK(entry.peer->m_background_msg_mutex);
+            entry.peer->m_verified_ava_response =
+                std::make_pair(entry.hash, entry.sig);
+        }
+    }
+}
+
 bool PeerManagerImpl::ProcessMessages(const Config &config, CNode *pfrom,
                                       std::atomic<bool> &interruptMsgProc) {
     AssertLockHeld(g_msgproc_mutex);
@@ -7641,6 +8452,18 @@ bool PeerManagerImpl::ProcessMessages(const Config &config, CNode *pfrom,
         return false;
     }
 
+    // Wait for the message processed in the background to complete, so the
+    // messages from a peer are processed in order.
+    if (WITH_LOCK(peer->m_background_msg_mutex,
+                  return peer->m_background_msg_busy)) {
+        return false;
+    }
+
+    if (MaybeServeBlocksInBackground(config, *pfrom, peer, interruptMsgProc)) {
+        // The worker thread wakes the message handler up once done.
+        return false;
+    }
+
     {
         LOCK(peer->m_getdata_requests_mutex);
         if (!peer->m_getdata_requests.empty()) {
@@ -7672,29 +8495,48 @@ bool PeerManagerImpl::ProcessMessages(const Config &config, CNode *pfrom,
         return false;
     }
 
-    std::list<CNetMessage> msgs;
+    std::optional<CNetMessage> next_msg;
+    {
+        // A message handed back by a worker thread comes first, it was
+        // already checked before it was handed over.
+        LOCK(peer->m_background_msg_mutex);
+        if (peer->m_background_msg) {
+            next_msg.emplace(std::move(*peer->m_background_msg));
+            peer->m_background_msg.reset();
+        }
+    }
+    const bool handed_back{next_msg.has_value()};
     {
         LOCK(pfrom->cs_vProcessMsg);
-        if (pfrom->vProcessMsg.empty()) {
-            return false;
+        if (handed_back) {
+            fMoreWork = !pfrom->vProcessMsg.empty();
+        } else {
+            if (pfrom->vProcessMsg.empty()) {
+                return false;
+            }
+            // Just take one message
+            next_msg.emplace(pfrom->vProcessMsg.take_front());
+            pfrom->nProcessQueueSize -= next_msg->m_raw_message_size;
+            const bool pause_recv{pfrom->nProcessQueueSize >
+                                  m_connman.GetReceiveFloodSize()};
+            if (pfrom->fPauseRecv.exchange(pause_recv) != pause_recv) {
+                m_connman.QueueWaitUpdate(*pfrom);
+            }
+            fMoreWork = !pfrom->vProcessMsg.empty();
         }
-        // Just take one message
-        msgs.splice(msgs.begin(), pfrom->vProcessMsg,
-                    pfrom->vProcessMsg.begin());
-        pfrom->nProcessQueueSize -= msgs.front().m_raw_message_size;
-        pfrom->fPauseRecv =
-            pfrom->nProcessQueueSize > m_connman.GetReceiveFloodSize();
-        fMoreWork = !pfrom->vProcessMsg.empty();
     }
-    CNetMessage &msg(msgs.front());
+    CNetMessage &msg(*next_msg);
 
-    TRACE6(net, inbound_message, pfrom->GetId(), pfrom->m_addr_name.c_str(),
-           pfrom->ConnectionTypeAsString().c_str(), msg.m_type.c_str(),
-           msg.m_recv.size(), msg.m_recv.data());
+    if (!handed_back) {
+        TRACE6(net, inbound_message, pfrom->GetId(),
+               pfrom->m_addr_name.c_str(),
+               pfrom->ConnectionTypeAsString().c_str(), msg.m_type.c_str(),
+               msg.m_recv.size(), msg.m_recv.data());
 
-    if (m_opts.capture_messages) {
-        CaptureMessage(pfrom->addr, msg.m_type, MakeUCharSpan(msg.m_recv),
-                       /*is_incoming=*/true);
+        if (m_opts.capture_messages) {
+            CaptureMessage(pfrom->addr, msg.m_type, MakeUCharSpan(msg.m_recv),
+                           /*is_incoming=*/true);
+        }
     }
 
     msg.SetVersion(pfrom->GetCommonVersion());
@@ -7736,8 +8578,20 @@ bool PeerManagerImpl::ProcessMessages(const Config &config, CNode *pfrom,
     }
 
     try {
-        ProcessMessage(config, *pfrom, msg.m_type, vRecv, msg.m_time,
-                       interruptMsgProc);
+        if (!handed_back &&
+            MaybeProcessMessageInBackground(config, *pfrom, peer, msg,
+                                            interruptMsgProc)) {
+            // The worker thread wakes the message handler up once done.
+            return false;
+        }
+
+        {
+            const MsgProcessingTimer timer{
+                pfrom->GetId(), msg, GetMsgTimings(m_msg_timings, msg.m_type),
+                GetMsgTimings(peer->m_msg_timings, msg.m_type)};
+            ProcessMessage(config, *pfrom, msg.m_type, vRecv, msg.m_time,
+                           interruptMsgProc);
+        }
         if (interruptMsgProc) {
             return false;
         }
@@ -8242,17 +9096,15 @@ void PeerManagerImpl::MaybeSendFeefilter(
 
 namespace {
 class CompareInvMempoolOrder {
-    CTxMemPool *mp;
-
 public:
-    explicit CompareInvMempoolOrder(CTxMemPool *_mempool) : mp(_mempool) {}
+    using Iterator = std::map<TxId, TxAnnouncementRef>::iterator;
 
-    bool operator()(std::set<TxId>::iterator a, std::set<TxId>::iterator b) {
+    bool operator()(Iterator a, Iterator b) const {
         /**
          * As std::make_heap produces a max-heap, we want the entries which
          * are topologically earlier to sort later.
          */
-        return mp->CompareTopologically(*b, *a);
+        return a->second->entry_id > b->second->entry_id;
     }
 };
 } // namespace
@@ -8583,6 +9435,8 @@ bool PeerManagerImpl::SendMessages(const Config &config, CNode *pto) {
     //
     // Message: inventory
     //
+    ProcessTxRelayBatch();
+
     std::vector<CInv> vInv;
     auto addInvAndMaybeFlush = [&](uint32_t type, const uint256 &hash) {
         vInv.emplace_back(type, hash);
@@ -8709,10 +9563,9 @@ bool PeerManagerImpl::SendMessages(const Config &config, CNode *pto) {
             // Determine transactions to relay
             if (fSendTrickle) {
                 // Produce a vector with all candidates for sending
-                std::vector<std::set<TxId>::iterator> vInvTx;
+                std::vector<CompareInvMempoolOrder::Iterator> vInvTx;
                 vInvTx.reserve(tx_relay->m_tx_inventory_to_send.size());
-                for (std::set<TxId>::iterator it =
-                         tx_relay->m_tx_inventory_to_send.begin();
+                for (auto it = tx_relay->m_tx_inventory_to_send.begin();
                      it != tx_relay->m_tx_inventory_to_send.end(); it++) {
                     vInvTx.push_back(it);
                 }
@@ -8722,7 +9575,7 @@ bool PeerManagerImpl::SendMessages(const Config &config, CNode *pto) {
                 // mempool, which is guaranteed to be a topological sort order.
                 // A heap is used so that not all items need sorting if only a
                 // few are being sent.
-                CompareInvMempoolOrder compareInvMempoolOrder(&m_mempool);
+                CompareInvMempoolOrder compareInvMempoolOrder;
                 std::make_heap(vInvTx.begin(), vInvTx.end(),
                                compareInvMempoolOrder);
                 // No reason to drain out at many times the network's
@@ -8730,6 +9583,9 @@ bool PeerManagerImpl::SendMessages(const Config &config, CNode *pto) {
                 // will draw much shorter delays.
                 unsigned int nRelayedTransactions = 0;
                 LOCK(tx_relay->m_bloom_filter_mutex);
+                // Only taken once, to check the transactions are still in the
+                // mempool.
+                LOCK(m_mempool.cs);
                 while (!vInvTx.empty() &&
                        nRelayedTransactions < INVENTORY_BROADCAST_MAX_PER_MB *
                                                   config.GetMaxBlockSize() /
@@ -8737,9 +9593,10 @@ bool PeerManagerImpl::SendMessages(const Config &config, CNode *pto) {
                     // Fetch the top element from the heap
                     std::pop_heap(vInvTx.begin(), vInvTx.end(),
                                   compareInvMempoolOrder);
-                    std::set<TxId>::iterator it = vInvTx.back();
+                    CompareInvMempoolOrder::Iterator it = vInvTx.back();
                     vInvTx.pop_back();
-                    const TxId txid = *it;
+                    const TxId txid = it->first;
+                    const TxAnnouncementRef announcement = it->second;
                     // Remove it from the to-be-sent set
                     tx_relay->m_tx_inventory_to_send.erase(it);
                     // Check if not in the filter already
@@ -8747,18 +9604,18 @@ bool PeerManagerImpl::SendMessages(const Config &config, CNode *pto) {
                         continue;
                     }
                     // Not in the mempool anymore? don't bother sending it.
-                    auto txinfo = m_mempool.info(txid);
-                    if (!txinfo.tx) {
+                    if (!m_mempool.exists(txid)) {
                         continue;
                     }
                     // Peer told you to not send transactions at that
                     // feerate? Don't bother sending it.
-                    if (txinfo.fee < filterrate.GetFee(txinfo.vsize)) {
+                    if (announcement->fee <
+                        filterrate.GetFee(announcement->vsize)) {
                         continue;
                     }
                     if (tx_relay->m_bloom_filter &&
                         !tx_relay->m_bloom_filter->IsRelevantAndUpdate(
-                            *txinfo.tx)) {
+                            *announcement->tx)) {
                         continue;
                     }
                     // Send
@@ -8775,7 +9632,7 @@ bool PeerManagerImpl::SendMessages(const Config &config, CNode *pto) {
                         }
 
                         auto ret = mapRelay.insert(
-                            std::make_pair(txid, std::move(txinfo.tx)));
+                            std::make_pair(txid, announcement->tx));
                         if (ret.second) {
                             g_relay_expiration.push_back(std::make_pair(
                                 current_time + RELAY_TX_CACHE_TIME, ret.first));
@@ -8904,14 +9761,15 @@ bool PeerManagerImpl::SendMessages(const Config &config, CNode *pto) {
 
         CNodeState &state = *State(pto->GetId());
 
+        const size_t max_blocks_in_flight{GetMaxBlocksInFlight(state)};
         if (CanServeBlocks(*peer) &&
             ((sync_blocks_and_headers_from_peer && !IsLimitedPeer(*peer)) ||
              !m_chainman.ActiveChainstate().IsInitialBlockDownload()) &&
-            state.vBlocksInFlight.size() < MAX_BLOCKS_IN_TRANSIT_PER_PEER) {
+            state.vBlocksInFlight.size() < max_blocks_in_flight) {
             std::vector<const CBlockIndex *> vToDownload;
             NodeId staller = -1;
             FindNextBlocksToDownload(pto->GetId(),
-                                     MAX_BLOCKS_IN_TRANSIT_PER_PEER -
+                                     max_blocks_in_flight -
                                          state.vBlocksInFlight.size(),
                                      vToDownload, staller);
             for (const CBlockIndex *pindex : vToDownload) {
@@ -9,6 +9,7 @@
 #include <avalanche/avalanche.h>
 #include <net.h>
 #include <sync.h>
+#include <util/histogram.h>
 #include <validationinterface.h>
 
 namespace avalanche {
@@ -51,12 +52,33 @@ static constexpr size_t MAX_ADDR_TO_SEND{1000};
  */
 static const unsigned int MAX_HEADERS_RESULTS = 2000;
 
+/** Timings of the processing of the messages of one type. */
+struct NetMsgTimingStats {
+    //! From the receipt of each message to the start of its processing
+    DurationHistogram::Snapshot queue_wait;
+    //! Spent processing each message
+    DurationHistogram::Snapshot processing;
+    //! Spent holding cs_main while processing each message
+    DurationHistogram::Snapshot cs_main;
+};
+
+/** Total timings of the messages of one type received from a peer. */
+struct PeerNetMsgTimingStats {
+    uint64_t count{0};
+    std::chrono::microseconds queue_wait{0};
+    std::chrono::microseconds processing{0};
+    std::chrono::microseconds cs_main{0};
+};
+
 struct CNodeStateStats {
     int nSyncHeight = -1;
     int nCommonHeight = -1;
     int m_starting_height = -1;
     std::chrono::microseconds m_ping_wait;
     std::vector<int> vHeightInFlight;
+    double m_block_download_rate{0};
+    std::chrono::microseconds m_block_download_latency{0};
+    size_t m_max_blocks_in_flight{0};
     bool m_relay_txs;
     Amount m_fee_filter_received;
     uint64_t m_addr_processed = 0;
@@ -64,6 +86,8 @@ struct CNodeStateStats {
     bool m_addr_relay_enabled{false};
     ServiceFlags their_services;
     int64_t presync_height{-1};
+    //! Timings of the messages processed, by type
+    std::map<std::string, PeerNetMsgTimingStats> m_msg_timings;
 };
 
 class PeerManager : public CValidationInterface, public NetEventsInterface {
@@ -130,6 +154,13 @@ public:
     virtual bool GetNodeStateStats(NodeId nodeid,
                                    CNodeStateStats &stats) const = 0;
 
+    /**
+     * Get the timings of the messages processed from all the peers, by type.
+     * Only the types which were received are included.
+     */
+    virtual std::map<std::string, NetMsgTimingStats>
+    GetNetMsgTimingStats() const = 0;
+
     /** Whether this node ignores txs received over p2p. */
     virtual bool IgnoresIncomingTxs() = 0;
 
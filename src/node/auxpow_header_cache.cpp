@@ -0,0 +1,80 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/auxpow_header_cache.h>
+
+#include <core_memusage.h>
+#include <memusage.h>
+#include <primitives/auxpow.h>
+
+namespace node {
+
+size_t AuxPowHeaderCache::EntryUsage(const CAuxPow &auxpow) {
+    using MapNode = memusage::unordered_node<
+        std::pair<const CBlockIndex *const, LruList::iterator>>;
+    // List node (entry plus two pointers), hash map node, then the shared
+    // auxpow itself and its dynamically allocated members.
+    return memusage::MallocUsage(sizeof(Entry) + 2 * sizeof(void *)) +
+           memusage::MallocUsage(sizeof(MapNode)) +
+           memusage::MallocUsage(sizeof(CAuxPow)) +
+           memusage::MallocUsage(sizeof(memusage::stl_shared_counter)) +
+           RecursiveDynamicUsage(auxpow.coinbaseTx) +
+           memusage::DynamicUsage(auxpow.vMerkleBranch) +
+           memusage::DynamicUsage(auxpow.vChainMerkleBranch);
+}
+
+std::shared_ptr<CAuxPow> AuxPowHeaderCache::Get(const CBlockIndex &index) {
+    LOCK(m_mutex);
+    auto it = m_map.find(&index);
+    if (it == m_map.end()) {
+        ++m_misses;
+        return nullptr;
+    }
+    ++m_hits;
+    m_lru.splice(m_lru.begin(), m_lru, it->second);
+    return it->second->second;
+}
+
+void AuxPowHeaderCache::Insert(const CBlockIndex &index,
+                               std::shared_ptr<CAuxPow> auxpow) {
+    if (!auxpow) {
+        return;
+    }
+
+    const size_t usage = EntryUsage(*auxpow);
+    if (usage > m_max_usage) {
+        return;
+    }
+
+    LOCK(m_mutex);
+    auto it = m_map.find(&index);
+    if (it != m_map.end()) {
+        m_usage -= EntryUsage(*it->second->second);
+        it->second->second = std::move(auxpow);
+        m_lru.splice(m_lru.begin(), m_lru, it->second);
+    } else {
+        m_lru.emplace_front(&index, std::move(auxpow));
+        m_map.emplace(&index, m_lru.begin());
+    }
+    m_usage += usage;
+    Evict();
+}
+
+void AuxPowHeaderCache::Evict() {
+    AssertLockHeld(m_mutex);
+    while (m_usage > m_max_usage && !m_lru.empty()) {
+        const Entry &oldest = m_lru.back();
+        m_usage -= EntryUsage(*oldest.second);
+        m_map.erase(oldest.first);
+        m_lru.pop_back();
+    }
+}
+
+AuxPowHeaderCache::Stats AuxPowHeaderCache::GetStats() const {
+    LOCK(m_mutex);
+    return Stats{m_map.size(), m_usage, m_max_usage, m_hits.load(),
+                 m_misses.load()};
+}
+
+} // namespace node
@@ -0,0 +1,80 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_AUXPOW_HEADER_CACHE_H
+#define BITCOIN_NODE_AUXPOW_HEADER_CACHE_H
+
+#include <sync.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+
+class CAuxPow;
+class CBlockIndex;
+
+namespace node {
+
+/**
+ * Bounded LRU cache of the auxpow of merge-mined block headers.
+ *
+ * CDiskBlockIndex does not persist the auxpow, so without this cache
+ * rebuilding such a header from its CBlockIndex means reading it back from
+ * the block files. Entries are keyed by the CBlockIndex, which has a stable
+ * address for the lifetime of the BlockManager, and the total memory usage of
+ * the entries is kept below max_usage.
+ */
+class AuxPowHeaderCache {
+public:
+    struct Stats {
+        size_t entries;
+        size_t usage;
+        size_t max_usage;
+        uint64_t hits;
+        uint64_t misses;
+    };
+
+    explicit AuxPowHeaderCache(size_t max_usage) : m_max_usage{max_usage} {}
+
+    /** Return the cached auxpow for this block, or nullptr on a miss. */
+    std::shared_ptr<CAuxPow> Get(const CBlockIndex &index)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Add or refresh the auxpow for this block, evicting the least recently
+     * used entries to stay within the memory bound.
+     */
+    void Insert(const CBlockIndex &index, std::shared_ptr<CAuxPow> auxpow)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    Stats GetStats() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    using Entry = std::pair<const CBlockIndex *, std::shared_ptr<CAuxPow>>;
+    using LruList = std::list<Entry>;
+
+    /** Approximate memory used by an entry, including container overhead. */
+    static size_t EntryUsage(const CAuxPow &auxpow);
+
+    void Evict() EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+
+    mutable Mutex m_mutex;
+    //! Most recently used entries first.
+    LruList m_lru GUARDED_BY(m_mutex);
+    std::unordered_map<const CBlockIndex *, LruList::iterator>
+        m_map GUARDED_BY(m_mutex);
+    size_t m_usage GUARDED_BY(m_mutex){0};
+    const size_t m_max_usage;
+
+    std::atomic<uint64_t> m_hits{0};
+    std::atomic<uint64_t> m_misses{0};
+};
+
+} // namespace node
+
+#endif // BITCOIN_NODE_AUXPOW_HEADER_CACHE_H
@@ -0,0 +1,171 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/block_read_ahead.h>
+
+#include <core_memusage.h>
+#include <logging.h>
+#include <memusage.h>
+#include <node/blockstorage.h>
+#include <primitives/block.h>
+#include <util/thread.h>
+
+#include <algorithm>
+
+namespace node {
+
+static size_t BlockUsage(const CBlock &block) {
+    size_t usage{memusage::DynamicUsage(block.vtx)};
+    for (const CTransactionRef &tx : block.vtx) {
+        usage += RecursiveDynamicUsage(tx);
+    }
+    return usage;
+}
+
+BlockReadAhead::BlockReadAhead(const BlockManager &blockman, size_t max_usage)
+    : m_blockman{blockman}, m_max_usage{max_usage} {}
+
+BlockReadAhead::~BlockReadAhead() {
+    {
+        LOCK(m_mutex);
+        m_request_stop = true;
+    }
+    m_cv.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+void BlockReadAhead::Schedule(std::vector<Request> requests) {
+    {
+        LOCK(m_mutex);
+        std::deque<Entry> queue;
+        size_t usage{0};
+        for (Request &req : requests) {
+            auto it = std::find_if(m_queue.begin(), m_queue.end(),
+                                   [&](const Entry &entry) {
+                                       return entry.req.index == req.index;
+                                   });
+            if (it != m_queue.end()) {
+                usage += it->usage;
+                queue.push_back(std::move(*it));
+            } else {
+                queue.emplace_back(std::move(req));
+            }
+        }
+        m_queue = std::move(queue);
+        m_usage = usage;
+    }
+
+    if (!m_thread.joinable()) {
+        m_thread = std::thread(&util::TraceThread, "blockread",
+                               [this] { ThreadRead(); });
+    }
+    m_cv.notify_all();
+}
+
+std::shared_ptr<const CBlock>
+BlockReadAhead::Take(const CBlockIndex &index,
+                     std::chrono::microseconds &stall) {
+    std::shared_ptr<const CBlock> block;
+    {
+        WAIT_LOCK(m_mutex, lock);
+        auto it = std::find_if(
+            m_queue.begin(), m_queue.end(),
+            [&](const Entry &entry) { return entry.req.index == &index; });
+        if (it == m_queue.end()) {
+            return nullptr;
+        }
+
+        // Everything scheduled before this block is no longer needed, which
+        // also makes it the head of the queue so the worker reads it next.
+        for (auto drop = m_queue.begin(); drop != it; ++drop) {
+            m_usage -= drop->usage;
+        }
+        m_queue.erase(m_queue.begin(), it);
+        m_cv.notify_all();
+
+        const auto start{std::chrono::steady_clock::now()};
+        m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+            return m_queue.empty() || m_queue.front().req.index != &index ||
+                   m_queue.front().done;
+        });
+        stall += std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start);
+
+        // The queue may have been replaced while waiting.
+        if (m_queue.empty() || m_queue.front().req.index != &index) {
+            return nullptr;
+        }
+
+        block = std::move(m_queue.front().block);
+        m_usage -= m_queue.front().usage;
+        m_queue.pop_front();
+    }
+    // Room was freed for the next blocks.
+    m_cv.notify_all();
+    return block;
+}
+
+BlockReadAhead::Entry *BlockReadAhead::NextToRead() {
+    AssertLockHeld(m_mutex);
+    for (Entry &entry : m_queue) {
+        if (entry.done) {
+            continue;
+        }
+        // The head of the queue is always read, the others only while there
+        // is room for them.
+        if (&entry != &m_queue.front() && m_usage >= m_max_usage) {
+            return nullptr;
+        }
+        return &entry;
+    }
+    return nullptr;
+}
+
+void BlockReadAhead::ThreadRead() {
+    WAIT_LOCK(m_mutex, lock);
+    while (true) {
+        Entry *entry{nullptr};
+        m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+            return m_request_stop || (entry = NextToRead()) != nullptr;
+        });
+        if (m_request_stop) {
+            return;
+        }
+
+        const Request req{entry->req};
+
+        std::shared_ptr<CBlock> block;
+        size_t usage{0};
+        {
+            REVERSE_LOCK(lock);
+            block = std::make_shared<CBlock>();
+            if (!m_blockman.ReadBlockFromDisk(*block, req.pos,
+                                              req.check_pow) ||
+                block->GetHash() != req.hash) {
+                LogPrint(BCLog::VALIDATION,
+                         "Block read-ahead failed for %s at %s\n",
+                         req.hash.ToString(), req.pos.ToString());
+                block.reset();
+            } else {
+                usage = BlockUsage(*block);
+            }
+        }
+
+        // The entry may have been dropped or rescheduled in the meantime.
+        for (Entry &e : m_queue) {
+            if (e.req.index == req.index && !e.done) {
+                e.done = true;
+                e.block = std::move(block);
+                e.usage = usage;
+                m_usage += usage;
+                break;
+            }
+        }
+        m_cv.notify_all();
+    }
+}
+
+} // namespace node
@@ -0,0 +1,108 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_NODE_BLOCK_READ_AHEAD_H
+#define BITCOIN_NODE_BLOCK_READ_AHEAD_H
+
+#include <flatfile.h>
+#include <primitives/blockhash.h>
+#include <sync.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class CBlock;
+class CBlockIndex;
+
+namespace node {
+
+class BlockManager;
+
+/**
+ * Background reader for the blocks that are about to be connected.
+ *
+ * The validation thread schedules the blocks on the path to the most-work
+ * chain, in connection order. A single worker thread reads and deserializes
+ * them from the block files (checking the (Aux)PoW of the ones that are not
+ * trusted yet) while the previous blocks are being connected. Read blocks are
+ * buffered until their total memory usage reaches max_usage; the block at the
+ * head of the queue is always read so that a single large block cannot stall
+ * the pipeline.
+ *
+ * The worker never touches the CBlockIndex entries: their position, hash and
+ * trust are captured when scheduling, so that it can run without cs_main.
+ */
+class BlockReadAhead {
+public:
+    struct Request {
+        const CBlockIndex *index;
+        FlatFilePos pos;
+        BlockHash hash;
+        bool check_pow;
+    };
+
+    BlockReadAhead(const BlockManager &blockman, size_t max_usage);
+    ~BlockReadAhead();
+
+    BlockReadAhead(const BlockReadAhead &) = delete;
+    BlockReadAhead &operator=(const BlockReadAhead &) = delete;
+
+    /**
+     * Replace the scheduled blocks with requests, in connection order.
+     * Blocks that were already scheduled are kept along with their data, the
+     * others are dropped.
+     */
+    void Schedule(std::vector<Request> requests)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Take the block for index out of the queue, waiting for it to be read if
+     * needed. The time spent waiting is added to stall. Any block scheduled
+     * before it is dropped.
+     *
+     * @returns the block, or nullptr if it was not scheduled or could not be
+     *          read, in which case the caller should read it itself.
+     */
+    std::shared_ptr<const CBlock> Take(const CBlockIndex &index,
+                                       std::chrono::microseconds &stall)
+        EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    struct Entry {
+        explicit Entry(Request r) : req{std::move(r)} {}
+
+        Request req;
+        bool done{false};
+        std::shared_ptr<const CBlock> block;
+        size_t usage{0};
+    };
+
+    const BlockManager &m_blockman;
+    const size_t m_max_usage;
+
+    Mutex m_mutex;
+    std::condition_variable m_cv;
+    //! Scheduled blocks, in connection order.
+    std::deque<Entry> m_queue GUARDED_BY(m_mutex);
+    //! Memory usage of the blocks in m_queue that have been read.
+    size_t m_usage GUARDED_BY(m_mutex){0};
+    bool m_request_stop GUARDED_BY(m_mutex){false};
+
+    //! Started on the first call to Schedule.
+    std::thread m_thread;
+
+    void ThreadRead() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+    //! The next entry the worker should read, or nullptr if it should wait.
+    Entry *NextToRead() EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+};
+
+} // namespace node
+
+#endif // BITCOIN_NODE_BLOCK_READ_AHEAD_H
@@ -41,6 +41,13 @@ std::optional<bilingual_str> ApplyArgsManOptions(const ArgsManager &args,
     if (auto value{args.GetBoolArg("-stopafterblockimport")}) {
         opts.stop_after_block_import = *value;
     }
+    if (auto value{args.GetIntArg("-auxpowheadercache")}) {
+        if (*value < 0) {
+            return _("AuxPoW header cache cannot be configured with a "
+                     "negative value.");
+        }
+        opts.auxpow_header_cache_bytes = size_t(*value) << 20;
+    }
 
     return std::nullopt;
 }
@@ -85,6 +85,9 @@ CBlockIndex *BlockManager::AddToBlockIndex(const CBlockHeader &block,
         (pindexNew->pprev ? pindexNew->pprev->nChainWork : 0) +
         GetBlockProof(*pindexNew);
     pindexNew->RaiseValidity(BlockValidity::TREE);
+    if (block.auxpow) {
+        m_auxpow_header_cache.Insert(*pindexNew, block.auxpow);
+    }
     if (best_header == nullptr ||
         best_header->nChainWork < pindexNew->nChainWork) {
         best_header = pindexNew;
@@ -782,7 +785,8 @@ bool BlockManager::WriteUndoDataForBlock(const CBlockUndo &blockundo,
 }
 
 bool BlockManager::ReadBlockFromDisk(CBlock &block,
-                                     const FlatFilePos &pos) const {
+                                     const FlatFilePos &pos,
+                                     bool check_pow) const {
     block.SetNull();
 
     // Open history file to read
@@ -801,7 +805,7 @@ bool BlockManager::ReadBlockFromDisk(CBlock &block,
     }
 
     // Check the header
-    if (!CheckAuxProofOfWork(block, GetConsensus())) {
+    if (check_pow && !CheckAuxProofOfWork(block, GetConsensus())) {
         return error("ReadBlockFromDisk: Errors in block header at %s",
                      pos.ToString());
     }
@@ -811,9 +815,15 @@ bool BlockManager::ReadBlockFromDisk(CBlock &block,
 
 bool BlockManager::ReadBlockFromDisk(CBlock &block,
                                      const CBlockIndex &index) const {
-    const FlatFilePos block_pos{WITH_LOCK(cs_main, return index.GetBlockPos())};
+    FlatFilePos block_pos;
+    bool trusted;
+    {
+        LOCK(cs_main);
+        block_pos = index.GetBlockPos();
+        trusted = index.IsValid(BlockValidity::TRANSACTIONS);
+    }
 
-    if (!ReadBlockFromDisk(block, block_pos)) {
+    if (!ReadBlockFromDisk(block, block_pos, /*check_pow=*/!trusted)) {
         return false;
     }
 
@@ -826,8 +836,103 @@ bool BlockManager::ReadBlockFromDisk(CBlock &block,
     return true;
 }
 
+bool BlockManager::ReadRawBlockFromDisk(std::vector<uint8_t> &block,
+                                        const FlatFilePos &pos,
+                                        bool check_pow) const {
+    block.clear();
+
+    if (pos.nPos < BLOCK_SERIALIZATION_HEADER_SIZE) {
+        return error("%s: Invalid block position %s", __func__,
+                     pos.ToString());
+    }
+
+    // Open history file at the header written by WriteBlockToDisk, which
+    // holds the size of the block
+    FlatFilePos header_pos{pos};
+    header_pos.nPos -= BLOCK_SERIALIZATION_HEADER_SIZE;
+    CAutoFile filein(OpenBlockFile(header_pos, true), SER_DISK,
+                     CLIENT_VERSION);
+    if (filein.IsNull()) {
+        return error("%s: OpenBlockFile failed for %s", __func__,
+                     pos.ToString());
+    }
+
+    // Read block
+    try {
+        CMessageHeader::MessageMagic magic;
+        unsigned int size;
+        filein >> magic >> size;
+        if (magic != GetParams().DiskMagic()) {
+            return error("%s: Block magic mismatch at %s", __func__,
+                         pos.ToString());
+        }
+        // Blocks can be larger than MAX_SIZE with -excessiveblocksize, so the
+        // size is only bounded by what is left in the file.
+        std::error_code ec;
+        const uintmax_t file_size{fs::file_size(GetBlockPosFilename(pos), ec)};
+        if (ec || pos.nPos > file_size || size > file_size - pos.nPos) {
+            return error("%s: Block size %u exceeds the file at %s", __func__,
+                         size, pos.ToString());
+        }
+        block.resize(size);
+        filein.read(MakeWritableByteSpan(block));
+    } catch (const std::exception &e) {
+        return error("%s: Deserialize or I/O error - %s at %s", __func__,
+                     e.what(), pos.ToString());
+    }
+
+    // Check the header
+    if (check_pow) {
+        CBlockHeader header;
+        try {
+            SpanReader{SER_DISK, CLIENT_VERSION, block} >> header;
+        } catch (const std::exception &e) {
+            return error("%s: Deserialize error - %s at %s", __func__,
+                         e.what(), pos.ToString());
+        }
+        if (!CheckAuxProofOfWork(header, GetConsensus())) {
+            return error("%s: Errors in block header at %s", __func__,
+                         pos.ToString());
+        }
+    }
+
+    return true;
+}
+
+bool BlockManager::ReadRawBlockFromDisk(std::vector<uint8_t> &block,
+                                        const CBlockIndex &index) const {
+    FlatFilePos block_pos;
+    bool trusted;
+    {
+        LOCK(cs_main);
+        block_pos = index.GetBlockPos();
+        trusted = index.IsValid(BlockValidity::TRANSACTIONS);
+    }
+
+    if (!ReadRawBlockFromDisk(block, block_pos, /*check_pow=*/!trusted)) {
+        return false;
+    }
+
+    // The block hash only covers the base header, which the serialized block
+    // starts with.
+    CBaseBlockHeader header;
+    try {
+        SpanReader{SER_DISK, CLIENT_VERSION, block} >> header;
+    } catch (const std::exception &e) {
+        return error("%s: Deserialize error - %s at %s", __func__, e.what(),
+                     block_pos.ToString());
+    }
+    if (header.GetHash() != index.GetBlockHash()) {
+        return error("%s: GetHash() doesn't match index for %s at %s",
+                     __func__, index.ToString(), block_pos.ToString());
+    }
+
+    return true;
+}
+
 bool BlockManager::ReadBlockHeaderFromDisk(CBlockHeader &header,
-                                           const FlatFilePos &pos) const {
+                                           const FlatFilePos &pos,
+                                           bool check_pow) const {
     header.SetNull();
 
     // Open history file to read
@@ -846,7 +951,7 @@ bool BlockManager::ReadBlockHeaderFromDisk(CBlockHeader &header,
     }
 
     // Check the header
-    if (!CheckAuxProofOfWork(header, GetConsensus())) {
+    if (check_pow && !CheckAuxProofOfWork(header, GetConsensus())) {
         return error("ReadBlockHeaderFromDisk: Errors in block header at %s",
                      pos.ToString());
     }
@@ -856,9 +961,15 @@ bool BlockManager::ReadBlockHeaderFromDisk(CBlockHeader &header,
 
 bool BlockManager::ReadBlockHeaderFromDisk(CBlockHeader &header,
                                            const CBlockIndex &index) const {
-    const FlatFilePos block_pos{WITH_LOCK(cs_main, return index.GetBlockPos())};
+    FlatFilePos block_pos;
+    bool trusted;
+    {
+        LOCK(cs_main);
+        block_pos = index.GetBlockPos();
+        trusted = index.IsValid(BlockValidity::TRANSACTIONS);
+    }
 
-    if (!ReadBlockHeaderFromDisk(header, block_pos)) {
+    if (!ReadBlockHeaderFromDisk(header, block_pos, /*check_pow=*/!trusted)) {
         return false;
     }
 
@@ -871,6 +982,20 @@ bool BlockManager::ReadBlockHeaderFromDisk(CBlockHeader &header,
     return true;
 }
 
+std::shared_ptr<CAuxPow>
+BlockManager::GetAuxPow(const CBlockIndex &index) const {
+    if (auto auxpow = m_auxpow_header_cache.Get(index)) {
+        return auxpow;
+    }
+
+    CBlockHeader header;
+    if (!ReadBlockHeaderFromDisk(header, index)) {
+        return nullptr;
+    }
+    m_auxpow_header_cache.Insert(index, header.auxpow);
+    return header.auxpow;
+}
+
 bool BlockManager::ReadTxFromDisk(CMutableTransaction &tx,
                                   const FlatFilePos &pos) const {
     // Open history file to read
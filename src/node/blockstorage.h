@@ -13,12 +13,14 @@
 #include <chainparams.h>
 #include <kernel/blockmanager_opts.h>
 #include <kernel/cs_main.h>
+#include <node/auxpow_header_cache.h>
 #include <protocol.h> // For CMessageHeader::MessageStartChars
 #include <sync.h>
 #include <txdb.h>
 #include <util/fs.h>
 
 class BlockValidationState;
+class CAuxPow;
 class CBlock;
 class CBlockFileInfo;
 class CBlockHeader;
@@ -169,11 +171,15 @@ private:
 
     const kernel::BlockManagerOpts m_opts;
 
+    //! Auxpows of merge-mined headers, which the block index does not store
+    mutable AuxPowHeaderCache m_auxpow_header_cache;
+
 public:
     using Options = kernel::BlockManagerOpts;
 
     explicit BlockManager(Options opts)
-        : m_prune_mode{opts.prune_target > 0}, m_opts{std::move(opts)} {};
+        : m_prune_mode{opts.prune_target > 0}, m_opts{std::move(opts)},
+          m_auxpow_header_cache{m_opts.auxpow_header_cache_bytes} {};
 
     std::atomic<bool> m_importing{false};
 
@@ -284,16 +290,46 @@ public:
      */
     void UnlinkPrunedFiles(const std::set<int> &setFilesToPrune) const;
 
-    /** Functions for disk access for blocks */
-    bool ReadBlockFromDisk(CBlock &block, const FlatFilePos &pos) const;
+    /**
+     * Functions for disk access for blocks.
+     *
+     * Reading by position only is untrusted and always re-checks the
+     * (Aux)PoW. Reading through a CBlockIndex skips that check when the index
+     * entry is already valid up to BlockValidity::TRANSACTIONS, since the
+     * header was fully checked before the block data was ever written and
+     * the hash is still compared against the index.
+     */
+    bool ReadBlockFromDisk(CBlock &block, const FlatFilePos &pos,
+                           bool check_pow = true) const;
     bool ReadBlockFromDisk(CBlock &block, const CBlockIndex &index) const;
-    bool ReadBlockHeaderFromDisk(CBlockHeader &header,
-                                 const FlatFilePos &pos) const;
+    /**
+     * Read a block as it is serialized on disk, which is also its network
+     * serialization, without deserializing its transactions. Only the header
+     * is deserialized, to run the same checks as ReadBlockFromDisk().
+     */
+    bool ReadRawBlockFromDisk(std::vector<uint8_t> &block,
+                              const FlatFilePos &pos,
+                              bool check_pow = true) const;
+    bool ReadRawBlockFromDisk(std::vector<uint8_t> &block,
+                              const CBlockIndex &index) const;
+    bool ReadBlockHeaderFromDisk(CBlockHeader &header, const FlatFilePos &pos,
+                                 bool check_pow = true) const;
     bool ReadBlockHeaderFromDisk(CBlockHeader &header,
                                  const CBlockIndex &index) const;
     bool UndoReadFromDisk(CBlockUndo &blockundo,
                           const CBlockIndex &index) const;
 
+    /**
+     * Get the auxpow of a merge-mined block header, from memory if possible
+     * and from the block files otherwise. Returns nullptr if it could not be
+     * read.
+     */
+    std::shared_ptr<CAuxPow> GetAuxPow(const CBlockIndex &index) const;
+
+    AuxPowHeaderCache::Stats GetAuxPowHeaderCacheStats() const {
+        return m_auxpow_header_cache.GetStats();
+    }
+
     /** Functions for disk access for txs */
     bool ReadTxFromDisk(CMutableTransaction &tx, const FlatFilePos &pos) const;
     bool ReadTxUndoFromDisk(CTxUndo &tx, const FlatFilePos &pos) const;
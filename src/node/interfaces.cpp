@@ -371,7 +371,7 @@ namespace {
     };
 
     bool FillBlock(const CBlockIndex *index, const FoundBlock &block,
-                   UniqueLock<RecursiveMutex> &lock, const CChain &active,
+                   UniqueLock<decltype(::cs_main)> &lock, const CChain &active,
                    const BlockManager &blockman) {
         if (!index) {
             return false;
@@ -119,6 +119,9 @@ void BlockAssembler::resetBlock() {
     // These counters do not include coinbase tx.
     nBlockTx = 0;
     nFees = Amount::zero();
+
+    m_selected_entries.clear();
+    m_block_full = false;
 }
 
 std::optional<int64_t> BlockAssembler::m_last_block_num_txs{std::nullopt};
@@ -162,16 +165,9 @@ BlockAssembler::CreateNewBlock(const CScript &scriptPubKeyIn) {
 
     if (m_mempool) {
         LOCK(m_mempool->cs);
-        addTxs(*m_mempool);
-    }
-
-    if (IsMagneticAnomalyEnabled(consensusParams, pindexPrev)) {
-        // If magnetic anomaly is enabled, we make sure transaction are
-        // canonically ordered.
-        std::sort(std::begin(pblocktemplate->entries) + 1,
-                  std::end(pblocktemplate->entries),
-                  [](const CBlockTemplateEntry &a, const CBlockTemplateEntry &b)
-                      -> bool { return a.tx->GetId() < b.tx->GetId(); });
+        addTemplateCandidates(*m_mempool, pindexPrev->GetBlockHash(),
+                              IsMagneticAnomalyEnabled(consensusParams,
+                                                       pindexPrev));
     }
 
     // Copy all the transactions refs into the block
@@ -228,7 +224,13 @@ BlockAssembler::CreateNewBlock(const CScript &scriptPubKeyIn) {
     pblocktemplate->entries[0].fees = -1 * nFees;
     pblock->vtx[0] = pblocktemplate->entries[0].tx;
 
-    uint64_t nSerializeSize = GetSerializeSize(*pblock, PROTOCOL_VERSION);
+    // The block is sized from its parts rather than serialized; nBlockSize
+    // includes the space reserved for the coinbase in resetBlock().
+    coinbaseSize = ::GetSerializeSize(*pblock->vtx[0], PROTOCOL_VERSION);
+    uint64_t nSerializeSize =
+        ::GetSerializeSize(pblock->GetBlockHeader(), PROTOCOL_VERSION) +
+        GetSizeOfCompactSize(pblock->vtx.size()) + coinbaseSize +
+        (nBlockSize - 1000);
 
     LogPrintf(
         "CreateNewBlock(): total size: %u txs: %u fees: %ld sigChecks %d\n",
@@ -373,6 +375,7 @@ void BlockAssembler::addTxs(const CTxMemPool &mempool) {
 
         // Check whether the tx will exceed the block limits.
         if (!TestTxFits(entry->GetTxSize(), entry->GetSigChecks())) {
+            m_block_full = true;
             ++nConsecutiveFailed;
             if (nConsecutiveFailed > MAX_CONSECUTIVE_FAILURES &&
                 nBlockSize > nMaxGeneratedBlockSize - 1000) {
@@ -393,6 +396,7 @@ void BlockAssembler::addTxs(const CTxMemPool &mempool) {
 
         // Tx can be added.
         AddToBlock(entry);
+        m_selected_entries.push_back(entry);
 
         // This tx's children may now be candidates for addition if they have
         // higher scores than the tx at the cursor. We can only process a
@@ -421,4 +425,55 @@ void BlockAssembler::addTxs(const CTxMemPool &mempool) {
         }
     }
 }
+
+void BlockAssembler::addTemplateCandidates(const CTxMemPool &mempool,
+                                           const BlockHash &tip,
+                                           bool canonical_order) {
+    BlockTemplateCandidates &candidates = mempool.m_template_candidates;
+    const BlockTemplateCandidates::Limits limits{
+        tip, nMaxGeneratedBlockSize, nMaxGeneratedBlockSigChecks,
+        blockMinFeeRate};
+
+    if (!candidates.IsValidFor(limits)) {
+        addTxs(mempool);
+        // The transactions entering the mempool later on are checked the
+        // same way as by addTxs(), against this tip.
+        candidates.Reset(
+            limits, m_selected_entries, nBlockSize, nBlockSigChecks,
+            m_block_full,
+            [&params = chainParams.GetConsensus(), height = nHeight,
+             lock_time_cutoff = m_lock_time_cutoff](const CTransaction &tx) {
+                TxValidationState state;
+                return ContextualCheckTransaction(params, tx, state, height,
+                                                  lock_time_cutoff);
+            });
+
+        if (canonical_order) {
+            // If magnetic anomaly is enabled, we make sure transaction are
+            // canonically ordered.
+            std::sort(std::begin(pblocktemplate->entries) + 1,
+                      std::end(pblocktemplate->entries),
+                      [](const CBlockTemplateEntry &a,
+                         const CBlockTemplateEntry &b) -> bool {
+                          return a.tx->GetId() < b.tx->GetId();
+                      });
+        }
+        return;
+    }
+
+    // The candidates are kept both in canonical and selection order, so they
+    // are added in block order directly.
+    pblocktemplate->entries.reserve(candidates.GetEntries().size() + 1);
+    if (canonical_order) {
+        for (const CTxMemPoolEntryRef &entry :
+             candidates.GetEntries().get<txid_order>()) {
+            AddToBlock(entry);
+        }
+    } else {
+        for (const CTxMemPoolEntryRef &entry :
+             candidates.GetEntries().get<selection_order>()) {
+            AddToBlock(entry);
+        }
+    }
+}
 } // namespace node
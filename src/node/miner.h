@@ -77,6 +77,11 @@ private:
 
     const bool fPrintPriority;
 
+    // Transactions added to the block by addTxs(), in selection order
+    std::vector<CTxMemPoolEntryRef> m_selected_entries;
+    // Whether addTxs() left transactions out of the block for lack of room
+    bool m_block_full;
+
 public:
     struct Options {
         Options();
@@ -113,6 +118,14 @@ private:
      * Add transactions from the mempool based on individual tx feerate.
      */
     void addTxs(const CTxMemPool &mempool) EXCLUSIVE_LOCKS_REQUIRED(mempool.cs);
+    /**
+     * Add the transactions the mempool keeps selected for the next block,
+     * selecting them with addTxs() first if that selection is not up to date
+     * for this tip and these options.
+     */
+    void addTemplateCandidates(const CTxMemPool &mempool, const BlockHash &tip,
+                               bool canonical_order)
+        EXCLUSIVE_LOCKS_REQUIRED(mempool.cs);
 
     // helper functions for addTxs()
     /** Test if a new Tx would "fit" in the block */
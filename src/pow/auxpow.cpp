@@ -2,14 +2,29 @@
 // Distributed under the MIT software license, see the accompanying
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
+#include <pow/auxpow.h>
+
 #include <consensus/params.h>
 #include <logging.h>
 #include <pow/pow.h>
 #include <primitives/auxpow.h>
 #include <primitives/block.h>
 
+const CBaseBlockHeader &GetPowHeader(const CBlockHeader &block) {
+    if (block.auxpow) {
+        return block.auxpow->parentBlock;
+    }
+    return block;
+}
+
 bool CheckAuxProofOfWork(const CBlockHeader &block,
                          const Consensus::Params &params) {
+    return CheckAuxProofOfWork(block, GetPowHeader(block).GetPowHash(),
+                               params);
+}
+
+bool CheckAuxProofOfWork(const CBlockHeader &block, const BlockHash &powHash,
+                         const Consensus::Params &params) {
     // Except for legacy blocks with full version 1 or 2, ensure that the chain
     // ID is correct. Legacy blocks are not allowed since the merge-mining
     // start, which is checked in AcceptBlockHeader where the height is known.
@@ -28,7 +43,7 @@ bool CheckAuxProofOfWork(const CBlockHeader &block,
                          __func__, block.GetHash().ToString(), block.nVersion);
         }
 
-        if (!CheckProofOfWork(block.GetPowHash(), block.nBits, params)) {
+        if (!CheckProofOfWork(powHash, block.nBits, params)) {
             return error("%s: non-AUX proof of work failed", __func__);
         }
 
@@ -47,8 +62,7 @@ bool CheckAuxProofOfWork(const CBlockHeader &block,
                      ErrorString(auxResult).original);
     }
 
-    if (!CheckProofOfWork(BlockHash(block.auxpow->parentBlock.GetPowHash()),
-                          block.nBits, params)) {
+    if (!CheckProofOfWork(powHash, block.nBits, params)) {
         return error("%s: Auxillary header proof of work failed", __func__);
     }
 
@@ -5,6 +5,8 @@
 #ifndef BITCOIN_POW_AUXPOW_H
 #define BITCOIN_POW_AUXPOW_H
 
+struct BlockHash;
+class CBaseBlockHeader;
 class CBlockHeader;
 
 namespace Consensus {
@@ -14,4 +16,17 @@ struct Params;
 bool CheckAuxProofOfWork(const CBlockHeader &block,
                          const Consensus::Params &params);
 
+/**
+ * Same as above, with the scrypt hash of GetPowHeader(block) already
+ * computed, e.g. by GetPowHashes.
+ */
+bool CheckAuxProofOfWork(const CBlockHeader &block, const BlockHash &powHash,
+                         const Consensus::Params &params);
+
+/**
+ * The header whose scrypt hash has to meet the target: the block itself, or
+ * the parent block for merge-mined blocks.
+ */
+const CBaseBlockHeader &GetPowHeader(const CBlockHeader &block);
+
 #endif // BITCOIN_POW_AUXPOW_H
@@ -9,41 +9,66 @@
 #include <hash.h>
 #include <serialize.h>
 
+#include <array>
+
 BlockHash CBaseBlockHeader::GetHash() const {
     return BlockHash(SerializeHash(*this));
 }
 
-BlockHash CBaseBlockHeader::GetPowHash() const {
+/** Serialize the header into the 80 bytes hashed by scrypt. */
+static void GetPowHashInput(const CBaseBlockHeader &header, uint8_t *bytes) {
     // TODO: Dedup serialization, e.g. using a SpanWriter
-    uint8_t bytes[80];
     size_t idx = 0;
-    uint32_t version = this->nVersion;
+    uint32_t version = header.nVersion;
     for (size_t i = 0; i < 4; ++i) {
         bytes[idx++] = version & 0xff;
         version >>= 8;
     }
-    for (uint8_t byte : this->hashPrevBlock) {
+    for (uint8_t byte : header.hashPrevBlock) {
         bytes[idx++] = byte;
     }
-    for (uint8_t byte : this->hashMerkleRoot) {
+    for (uint8_t byte : header.hashMerkleRoot) {
         bytes[idx++] = byte;
     }
-    uint32_t time = this->nTime;
+    uint32_t time = header.nTime;
     for (size_t i = 0; i < 4; ++i) {
         bytes[idx++] = time & 0xff;
         time >>= 8;
     }
-    uint32_t bits = this->nBits;
+    uint32_t bits = header.nBits;
     for (size_t i = 0; i < 4; ++i) {
         bytes[idx++] = bits & 0xff;
         bits >>= 8;
     }
-    uint32_t nonce = this->nNonce;
+    uint32_t nonce = header.nNonce;
     for (size_t i = 0; i < 4; ++i) {
         bytes[idx++] = nonce & 0xff;
         nonce >>= 8;
     }
+}
+
+BlockHash CBaseBlockHeader::GetPowHash() const {
+    uint8_t bytes[80];
+    GetPowHashInput(*this, bytes);
     uint256 hash;
     scrypt_1024_1_1_256(bytes, hash.data());
     return BlockHash(hash);
 }
+
+std::vector<BlockHash>
+GetPowHashes(const std::vector<const CBaseBlockHeader *> &headers) {
+    std::vector<std::array<uint8_t, 80>> inputs(headers.size());
+    std::vector<uint256> hashes(headers.size());
+    std::vector<const uint8_t *> input_ptrs(headers.size());
+    std::vector<uint8_t *> output_ptrs(headers.size());
+    for (size_t i = 0; i < headers.size(); ++i) {
+        GetPowHashInput(*headers[i], inputs[i].data());
+        input_ptrs[i] = inputs[i].data();
+        output_ptrs[i] = hashes[i].data();
+    }
+
+    scrypt_1024_1_1_256_multi(input_ptrs.data(), output_ptrs.data(),
+                              headers.size());
+
+    return std::vector<BlockHash>(hashes.begin(), hashes.end());
+}
@@ -10,6 +10,8 @@
 #include <uint256.h>
 #include <util/time.h>
 
+#include <vector>
+
 /**
  * Dogecoin specific: A normal Bitcoin header without auxpow information, for
  * merge-mining.
@@ -66,4 +68,11 @@ public:
     int64_t GetBlockTime() const { return (int64_t)nTime; }
 };
 
+/**
+ * Compute the "PoW hash" of several headers at once, letting scrypt hash them
+ * on interleaved SIMD lanes where the CPU supports it.
+ */
+std::vector<BlockHash>
+GetPowHashes(const std::vector<const CBaseBlockHeader *> &headers);
+
 #endif // BITCOIN_PRIMITIVES_BASEHEADER_H
@@ -224,6 +224,59 @@ bool CPubKey::VerifySchnorr(const uint256 &hash,
     return VerifySchnorr(hash, sig);
 }
 
+void SchnorrBatch::Add(const CPubKey &pubkey, const uint256 &hash,
+                       const std::array<uint8_t, CPubKey::SCHNORR_SIZE> &sig) {
+    m_entries.push_back({pubkey, hash, sig});
+}
+
+void SchnorrBatch::Add(const CPubKey &pubkey, const uint256 &hash,
+                       const std::vector<uint8_t> &vchSig) {
+    assert(vchSig.size() == CPubKey::SCHNORR_SIZE);
+    Entry &entry = m_entries.emplace_back();
+    entry.pubkey = pubkey;
+    entry.hash = hash;
+    std::copy(vchSig.begin(), vchSig.end(), entry.sig.begin());
+}
+
+bool SchnorrBatch::Verify() const {
+    assert(secp256k1_context_verify &&
+           "secp256k1_context_verify must be initialized to use CPubKey.");
+    const size_t n = m_entries.size();
+    std::vector<secp256k1_pubkey> pubkeys(n);
+    std::vector<const secp256k1_pubkey *> pubkey_ptrs(n);
+    std::vector<const uint8_t *> sig_ptrs(n);
+    std::vector<const uint8_t *> hash_ptrs(n);
+    for (size_t i = 0; i < n; ++i) {
+        const Entry &entry = m_entries[i];
+        if (!entry.pubkey.IsValid() ||
+            !secp256k1_ec_pubkey_parse(secp256k1_context_verify, &pubkeys[i],
+                                       entry.pubkey.data(),
+                                       entry.pubkey.size())) {
+            return false;
+        }
+        pubkey_ptrs[i] = &pubkeys[i];
+        sig_ptrs[i] = entry.sig.data();
+        hash_ptrs[i] = entry.hash.begin();
+    }
+
+    return secp256k1_schnorr_verify_batch(secp256k1_context_verify,
+                                          sig_ptrs.data(), hash_ptrs.data(),
+                                          pubkey_ptrs.data(), n);
+}
+
+std::vector<bool> SchnorrBatch::VerifyEach() const {
+    if (Verify()) {
+        return std::vector<bool>(m_entries.size(), true);
+    }
+
+    std::vector<bool> valid;
+    valid.reserve(m_entries.size());
+    for (const Entry &entry : m_entries) {
+        valid.push_back(entry.pubkey.VerifySchnorr(entry.hash, entry.sig));
+    }
+    return valid;
+}
+
 bool CPubKey::RecoverCompact(const uint256 &hash,
                              const std::vector<uint8_t> &vchSig) {
     if (vchSig.size() != COMPACT_SIGNATURE_SIZE) {
@@ -13,6 +13,7 @@
 
 #include <boost/range/adaptor/sliced.hpp>
 
+#include <array>
 #include <stdexcept>
 #include <vector>
 
@@ -190,6 +191,44 @@ public:
                 const ChainCode &cc) const;
 };
 
+/**
+ * Collects Schnorr signatures so they can be verified all at once, which is
+ * substantially cheaper than verifying them one by one. A failed batch does
+ * not tell which of the signatures is invalid.
+ */
+class SchnorrBatch {
+private:
+    struct Entry {
+        CPubKey pubkey;
+        uint256 hash;
+        std::array<uint8_t, CPubKey::SCHNORR_SIZE> sig;
+    };
+    std::vector<Entry> m_entries;
+
+public:
+    void Add(const CPubKey &pubkey, const uint256 &hash,
+             const std::array<uint8_t, CPubKey::SCHNORR_SIZE> &sig);
+    void Add(const CPubKey &pubkey, const uint256 &hash,
+             const std::vector<uint8_t> &vchSig);
+
+    /**
+     * Whether all the signatures are valid. Same as calling VerifySchnorr()
+     * for each of them, and true if the batch is empty.
+     */
+    bool Verify() const;
+
+    /**
+     * Whether each of the signatures is valid, in the order they were added.
+     * They are verified all at once first, and one by one only if the batch
+     * fails.
+     */
+    std::vector<bool> VerifyEach() const;
+
+    size_t size() const { return m_entries.size(); }
+    bool empty() const { return m_entries.empty(); }
+    void clear() { m_entries.clear(); }
+};
+
 struct CExtPubKey {
     uint8_t nDepth;
     uint8_t vchFingerprint[4];
@@ -296,7 +296,6 @@ static bool rest_block(const Config &config, const std::any &context,
 
     const BlockHash hash(rawHash);
 
-    CBlock block;
     const CBlockIndex *pblockindex = nullptr;
     const CBlockIndex *tip = nullptr;
     ChainstateManager *maybe_chainman = GetChainman(context, req);
@@ -317,32 +316,37 @@ static bool rest_block(const Config &config, const std::any &context,
                            hashStr + " not available (pruned data)");
         }
     }
-    if (!chainman.m_blockman.ReadBlockFromDisk(block, *pblockindex)) {
+    // The block is serialized on disk as it is on the network, so it is only
+    // deserialized when needed.
+    std::vector<uint8_t> block_data;
+    if (!chainman.m_blockman.ReadRawBlockFromDisk(block_data, *pblockindex)) {
         return RESTERR(req, HTTP_NOT_FOUND, hashStr + " not found");
     }
 
     switch (rf) {
         case RetFormat::BINARY: {
-            CDataStream ssBlock(SER_NETWORK,
-                                PROTOCOL_VERSION | RPCSerializationFlags());
-            ssBlock << block;
-            std::string binaryBlock = ssBlock.str();
+            const std::string binaryBlock{block_data.begin(),
+                                          block_data.end()};
             req->WriteHeader("Content-Type", "application/octet-stream");
             req->WriteReply(HTTP_OK, binaryBlock);
             return true;
         }
 
         case RetFormat::HEX: {
-            CDataStream ssBlock(SER_NETWORK,
-                                PROTOCOL_VERSION | RPCSerializationFlags());
-            ssBlock << block;
-            std::string strHex = HexStr(ssBlock) + "\n";
+            std::string strHex = HexStr(block_data) + "\n";
             req->WriteHeader("Content-Type", "text/plain");
             req->WriteReply(HTTP_OK, strHex);
             return true;
         }
 
         case RetFormat::JSON: {
+            CBlock block;
+            try {
+                SpanReader{SER_NETWORK, PROTOCOL_VERSION, block_data} >> block;
+            } catch (const std::exception &) {
+                return RESTERR(req, HTTP_INTERNAL_SERVER_ERROR,
+                               hashStr + " could not be deserialized");
+            }
             UniValue objBlock = blockToJSON(chainman.m_blockman, block, tip,
                                             pblockindex, showTxDetails);
             std::string strJSON = objBlock.write() + "\n";
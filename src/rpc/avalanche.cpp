@@ -23,6 +23,7 @@
 #include <rpc/server_util.h>
 #include <rpc/util.h>
 #include <util/strencodings.h>
+#include <util/time.h>
 #include <util/translation.h>
 
 #include <univalue.h>
@@ -705,6 +706,26 @@ static RPCHelpMan getavalancheinfo() {
                      {RPCResult::Type::NUM, "pending_node_count",
                       "The number of avalanche nodes pending for a proof."},
                  }},
+                {RPCResult::Type::OBJ,
+                 "proof_revalidation",
+                 "Statistics about the revalidation of the proofs when the "
+                 "chain tip changes.",
+                 {
+                     {RPCResult::Type::NUM, "count",
+                      "The number of times the proofs have been revalidated."},
+                     {RPCResult::Type::NUM, "total_duration",
+                      "The total time spent revalidating the proofs, in "
+                      "seconds."},
+                     {RPCResult::Type::NUM, "last_duration",
+                      "The time the last revalidation took, in seconds."},
+                     {RPCResult::Type::NUM, "last_checked_proof_count",
+                      "The number of proofs checked against the UTXO set "
+                      "during the last revalidation."},
+                     {RPCResult::Type::BOOL, "last_incremental",
+                      "Whether the last revalidation only checked the proofs "
+                      "staking coins spent by the new blocks against the UTXO "
+                      "set."},
+                 }},
             },
         },
         RPCExamples{HelpExampleCli("getavalancheinfo", "") +
@@ -817,6 +838,22 @@ static RPCHelpMan getavalancheinfo() {
                 network.pushKV("pending_node_count", pendingNodes);
 
                 ret.pushKV("network", network);
+
+                const avalanche::ProofRevalidationStats revalidationStats =
+                    pm.getProofRevalidationStats();
+                UniValue revalidation(UniValue::VOBJ);
+                revalidation.pushKV("count", revalidationStats.count);
+                revalidation.pushKV(
+                    "total_duration",
+                    CountSecondsDouble(revalidationStats.totalDuration));
+                revalidation.pushKV(
+                    "last_duration",
+                    CountSecondsDouble(revalidationStats.lastDuration));
+                revalidation.pushKV("last_checked_proof_count",
+                                    revalidationStats.lastCheckedProofCount);
+                revalidation.pushKV("last_incremental",
+                                    revalidationStats.lastIncremental);
+                ret.pushKV("proof_revalidation", revalidation);
             });
 
             return ret;
@@ -50,6 +50,7 @@
 using kernel::CCoinsStats;
 using kernel::CoinStatsHashType;
 
+using node::AuxPowHeaderCache;
 using node::BlockManager;
 using node::GetUTXOStats;
 using node::NodeContext;
@@ -655,6 +656,25 @@ static CBlock GetBlockChecked(BlockManager &blockman,
     return block;
 }
 
+static std::vector<uint8_t> GetRawBlockChecked(BlockManager &blockman,
+                                               const CBlockIndex *pblockindex) {
+    std::vector<uint8_t> data;
+    {
+        LOCK(cs_main);
+        if (blockman.IsBlockPruned(pblockindex)) {
+            throw JSONRPCError(RPC_MISC_ERROR,
+                               "Block not available (pruned data)");
+        }
+    }
+
+    if (!blockman.ReadRawBlockFromDisk(data, *pblockindex)) {
+        // Block not found on disk, see GetBlockChecked().
+        throw JSONRPCError(RPC_MISC_ERROR, "Block not found on disk");
+    }
+
+    return data;
+}
+
 static CBlockUndo GetUndoChecked(BlockManager &blockman,
                                  const CBlockIndex *pblockindex) {
     CBlockUndo blockUndo;
@@ -796,17 +816,15 @@ static RPCHelpMan getblock() {
                 }
             }
 
-            const CBlock block =
-                GetBlockChecked(chainman.m_blockman, pblockindex);
-
             if (verbosity <= 0) {
-                CDataStream ssBlock(SER_NETWORK,
-                                    PROTOCOL_VERSION | RPCSerializationFlags());
-                ssBlock << block;
-                std::string strHex = HexStr(ssBlock);
-                return strHex;
+                // The block is serialized on disk as it is on the network.
+                return HexStr(
+                    GetRawBlockChecked(chainman.m_blockman, pblockindex));
             }
 
+            const CBlock block =
+                GetBlockChecked(chainman.m_blockman, pblockindex);
+
             return blockToJSON(chainman.m_blockman, block, tip, pblockindex,
                                verbosity >= 2);
         },
@@ -982,6 +1000,25 @@ static RPCHelpMan gettxoutsetinfo() {
                         "Fee rewards that miners did not claim in their "
                         "coinbase transaction"},
                    }}}},
+                {RPCResult::Type::OBJ,
+                 "coins_flush",
+                 "Statistics about the flushes of the coins cache to the "
+                 "chainstate database, before the one done by this call (not "
+                 "available when coinstatsindex is used)",
+                 {
+                     {RPCResult::Type::NUM, "flushes",
+                      "The number of flushes since startup"},
+                     {RPCResult::Type::NUM, "background_flushes",
+                      "The number of flushes written in the background while "
+                      "validation continued"},
+                     {RPCResult::Type::NUM, "last_coins",
+                      "The number of coins written by the last flush"},
+                     {RPCResult::Type::NUM, "last_duration",
+                      "The time it took to write the last flush, in seconds"},
+                     {RPCResult::Type::NUM, "stall_time",
+                      "The total time spent waiting for background flushes to "
+                      "complete, in seconds"},
+                 }},
             }},
         RPCExamples{
             HelpExampleCli("gettxoutsetinfo", "") +
@@ -1011,6 +1048,9 @@ static RPCHelpMan gettxoutsetinfo() {
             NodeContext &node = EnsureAnyNodeContext(request.context);
             ChainstateManager &chainman = EnsureChainman(node);
             Chainstate &active_chainstate = chainman.ActiveChainstate();
+            const CCoinsViewBackgroundFlush::Stats flush_stats{
+                WITH_LOCK(::cs_main,
+                          return active_chainstate.CoinsFlushView().GetStats())};
             active_chainstate.ForceFlushStateToDisk();
 
             CCoinsView *coins_view;
@@ -1078,6 +1118,20 @@ static RPCHelpMan gettxoutsetinfo() {
                     ret.pushKV("transactions",
                                static_cast<int64_t>(stats.nTransactions));
                     ret.pushKV("disk_size", stats.nDiskSize);
+
+                    UniValue coins_flush(UniValue::VOBJ);
+                    coins_flush.pushKV("flushes", flush_stats.flushes);
+                    coins_flush.pushKV("background_flushes",
+                                       flush_stats.background_flushes);
+                    coins_flush.pushKV("last_coins",
+                                       uint64_t(flush_stats.last_coins));
+                    coins_flush.pushKV(
+                        "last_duration",
+                        Ticks<SecondsDouble>(flush_stats.last_duration));
+                    coins_flush.pushKV(
+                        "stall_time",
+                        Ticks<SecondsDouble>(flush_stats.total_stall));
+                    ret.pushKV("coins_flush", coins_flush);
                 } else {
                     ret.pushKV("total_unspendable_amount",
                                stats.total_unspendable_amount);
@@ -1328,6 +1382,22 @@ RPCHelpMan getblockchaininfo() {
                 {RPCResult::Type::NUM, "prune_target_size",
                  "the target size used by pruning (only present if automatic "
                  "pruning is enabled)"},
+                {RPCResult::Type::OBJ,
+                 "auxpow_header_cache",
+                 "statistics of the in-memory cache of merge-mined headers",
+                 {
+                     {RPCResult::Type::NUM, "entries",
+                      "the number of cached auxpows"},
+                     {RPCResult::Type::NUM, "usage",
+                      "the memory used by the cache in bytes"},
+                     {RPCResult::Type::NUM, "max_usage",
+                      "the maximum memory the cache may use in bytes"},
+                     {RPCResult::Type::NUM, "hits",
+                      "the number of lookups served from memory"},
+                     {RPCResult::Type::NUM, "misses",
+                      "the number of lookups that had to read the block "
+                      "files"},
+                 }},
                 {RPCResult::Type::STR, "warnings",
                  "any network and blockchain warnings"},
             }},
@@ -1380,6 +1450,16 @@ RPCHelpMan getblockchaininfo() {
                 }
             }
 
+            const AuxPowHeaderCache::Stats cache_stats{
+                chainman.m_blockman.GetAuxPowHeaderCacheStats()};
+            UniValue auxpow_header_cache(UniValue::VOBJ);
+            auxpow_header_cache.pushKV("entries", cache_stats.entries);
+            auxpow_header_cache.pushKV("usage", cache_stats.usage);
+            auxpow_header_cache.pushKV("max_usage", cache_stats.max_usage);
+            auxpow_header_cache.pushKV("hits", cache_stats.hits);
+            auxpow_header_cache.pushKV("misses", cache_stats.misses);
+            obj.pushKV("auxpow_header_cache", auxpow_header_cache);
+
             obj.pushKV("warnings", GetWarnings(false).original);
             return obj;
         },
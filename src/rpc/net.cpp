@@ -30,6 +30,7 @@
 #include <version.h>
 #include <warnings.h>
 
+#include <algorithm>
 #include <optional>
 
 #include <univalue.h>
@@ -182,6 +183,18 @@ static RPCHelpMan getpeerinfo() {
                           "The heights of blocks we're currently asking from "
                           "this peer"},
                      }},
+                    {RPCResult::Type::NUM, "inflightlimit",
+                     "The maximum number of blocks we ask from this peer at "
+                     "once, scaled by its block download rate relative to "
+                     "the fastest peer"},
+                    {RPCResult::Type::NUM, "blockdownloadrate",
+                     "The moving average of the rate at which this peer "
+                     "sends the blocks we ask for, in bytes per second, or 0 "
+                     "if it did not send any yet"},
+                    {RPCResult::Type::NUM, "blockdownloadlatency",
+                     "The moving average of the time this peer takes to "
+                     "send a block we ask for while no other block is in "
+                     "flight from it, in seconds"},
                     {RPCResult::Type::BOOL, "addr_relay_enabled",
                      "Whether we participate in address relay with this peer"},
                     {RPCResult::Type::NUM, "minfeefilter",
@@ -289,6 +302,13 @@ static RPCHelpMan getpeerinfo() {
                         heights.push_back(height);
                     }
                     obj.pushKV("inflight", heights);
+                    obj.pushKV("inflightlimit",
+                               uint64_t(statestats.m_max_blocks_in_flight));
+                    obj.pushKV("blockdownloadrate",
+                               statestats.m_block_download_rate);
+                    obj.pushKV("blockdownloadlatency",
+                               CountSecondsDouble(
+                                   statestats.m_block_download_latency));
                     obj.pushKV("relaytxes", statestats.m_relay_txs);
                     obj.pushKV("minfeefilter",
                                statestats.m_fee_filter_received);
@@ -632,6 +652,10 @@ static RPCHelpMan getnettotals() {
                 {RPCResult::Type::NUM, "totalbytesrecv",
                  "Total bytes received"},
                 {RPCResult::Type::NUM, "totalbytessent", "Total bytes sent"},
+                {RPCResult::Type::NUM, "totalsendcalls",
+                 "Total number of send system calls"},
+                {RPCResult::Type::NUM, "sendcallsperbyte",
+                 "Number of send system calls per byte sent"},
                 {RPCResult::Type::NUM_TIME, "timemillis",
                  "Current " + UNIX_EPOCH_TIME + " in milliseconds"},
                 {RPCResult::Type::OBJ,
@@ -660,7 +684,14 @@ static RPCHelpMan getnettotals() {
 
             UniValue obj(UniValue::VOBJ);
             obj.pushKV("totalbytesrecv", connman.GetTotalBytesRecv());
-            obj.pushKV("totalbytessent", connman.GetTotalBytesSent());
+            const uint64_t total_bytes_sent{connman.GetTotalBytesSent()};
+            const uint64_t total_send_calls{connman.GetTotalSendCalls()};
+            obj.pushKV("totalbytessent", total_bytes_sent);
+            obj.pushKV("totalsendcalls", total_send_calls);
+            obj.pushKV("sendcallsperbyte",
+                       total_bytes_sent ? double(total_send_calls) /
+                                              double(total_bytes_sent)
+                                        : 0.0);
             obj.pushKV("timemillis", GetTimeMillis());
 
             UniValue outboundLimit(UniValue::VOBJ);
@@ -682,6 +713,154 @@ static RPCHelpMan getnettotals() {
     };
 }
 
+static RPCResult NetMsgTimingResult(const std::string &name,
+                                    const std::string &description) {
+    return {RPCResult::Type::OBJ,
+            name,
+            description,
+            {
+                {RPCResult::Type::NUM, "total", "Total time in seconds"},
+                {RPCResult::Type::ARR,
+                 "histogram",
+                 "Number of messages by duration. The first element counts "
+                 "the durations shorter than 2 microseconds and the i-th one "
+                 "the durations in [2^i, 2^(i+1)) microseconds. The trailing "
+                 "empty buckets are omitted.",
+                 {{RPCResult::Type::NUM, "", "Number of messages"}}},
+            }};
+}
+
+static UniValue
+NetMsgTimingToUniValue(const DurationHistogram::Snapshot &timing) {
+    UniValue histogram(UniValue::VARR);
+    const auto last_bucket{std::find_if(timing.buckets.rbegin(),
+                                        timing.buckets.rend(),
+                                        [](uint64_t n) { return n > 0; })};
+    std::for_each(timing.buckets.begin(), last_bucket.base(),
+                  [&](uint64_t n) { histogram.push_back(n); });
+
+    UniValue obj(UniValue::VOBJ);
+    obj.pushKV("total", CountSecondsDouble(timing.total));
+    obj.pushKV("histogram", histogram);
+    return obj;
+}
+
+static RPCHelpMan getnetmsgstats() {
+    return RPCHelpMan{
+        "getnetmsgstats",
+        "Returns how long the messages received from the peers waited to be "
+        "processed, how long their processing took and how long cs_main was "
+        "held meanwhile, by message type.\n"
+        "The queue wait of the avalanche responses includes the verification "
+        "of their signature by the message processing worker threads.\n",
+        {},
+        RPCResult{
+            RPCResult::Type::OBJ,
+            "",
+            "",
+            {
+                {RPCResult::Type::OBJ_DYN,
+                 "msgtypes",
+                 "The messages received from all the peers since startup. "
+                 "Only the types which were received are listed, the unknown "
+                 "types are aggregated under '" +
+                     NET_MESSAGE_COMMAND_OTHER + "'.",
+                 {{RPCResult::Type::OBJ,
+                   "msgtype",
+                   "",
+                   {
+                       {RPCResult::Type::NUM, "count",
+                        "Number of messages processed"},
+                       NetMsgTimingResult("queuewait",
+                                          "From the receipt of each message "
+                                          "to the start of its processing"),
+                       NetMsgTimingResult("processing",
+                                          "Spent processing each message"),
+                       NetMsgTimingResult("cs_main",
+                                          "Spent holding cs_main while "
+                                          "processing each message"),
+                   }}}},
+                {RPCResult::Type::ARR,
+                 "peers",
+                 "The messages received from each connected peer",
+                 {{RPCResult::Type::OBJ,
+                   "",
+                   "",
+                   {
+                       {RPCResult::Type::NUM, "id", "Peer index"},
+                       {RPCResult::Type::OBJ_DYN,
+                        "msgtypes",
+                        "Only the types which were received are listed",
+                        {{RPCResult::Type::OBJ,
+                          "msgtype",
+                          "",
+                          {
+                              {RPCResult::Type::NUM, "count",
+                               "Number of messages processed"},
+                              {RPCResult::Type::NUM, "queuewait",
+                               "Total queue wait in seconds"},
+                              {RPCResult::Type::NUM, "processing",
+                               "Total processing time in seconds"},
+                              {RPCResult::Type::NUM, "cs_main",
+                               "Total time cs_main was held in seconds"},
+                          }}}},
+                   }}}},
+            }},
+        RPCExamples{HelpExampleCli("getnetmsgstats", "") +
+                    HelpExampleRpc("getnetmsgstats", "")},
+        [&](const RPCHelpMan &self, const Config &config,
+            const JSONRPCRequest &request) -> UniValue {
+            NodeContext &node = EnsureAnyNodeContext(request.context);
+            const CConnman &connman = EnsureConnman(node);
+            const PeerManager &peerman = EnsurePeerman(node);
+
+            UniValue msg_types(UniValue::VOBJ);
+            for (const auto &[msg_type, timings] :
+                 peerman.GetNetMsgTimingStats()) {
+                UniValue obj(UniValue::VOBJ);
+                obj.pushKV("count", timings.processing.count);
+                obj.pushKV("queuewait",
+                           NetMsgTimingToUniValue(timings.queue_wait));
+                obj.pushKV("processing",
+                           NetMsgTimingToUniValue(timings.processing));
+                obj.pushKV("cs_main", NetMsgTimingToUniValue(timings.cs_main));
+                msg_types.pushKV(msg_type, obj);
+            }
+
+            std::vector<CNodeStats> vstats;
+            connman.GetNodeStats(vstats);
+            UniValue peers(UniValue::VARR);
+            for (const CNodeStats &stats : vstats) {
+                CNodeStateStats statestats;
+                if (!peerman.GetNodeStateStats(stats.nodeid, statestats)) {
+                    continue;
+                }
+                UniValue peer_msg_types(UniValue::VOBJ);
+                for (const auto &[msg_type, timings] :
+                     statestats.m_msg_timings) {
+                    UniValue obj(UniValue::VOBJ);
+                    obj.pushKV("count", timings.count);
+                    obj.pushKV("queuewait",
+                               CountSecondsDouble(timings.queue_wait));
+                    obj.pushKV("processing",
+                               CountSecondsDouble(timings.processing));
+                    obj.pushKV("cs_main", CountSecondsDouble(timings.cs_main));
+                    peer_msg_types.pushKV(msg_type, obj);
+                }
+                UniValue peer(UniValue::VOBJ);
+                peer.pushKV("id", stats.nodeid);
+                peer.pushKV("msgtypes", peer_msg_types);
+                peers.push_back(peer);
+            }
+
+            UniValue ret(UniValue::VOBJ);
+            ret.pushKV("msgtypes", msg_types);
+            ret.pushKV("peers", peers);
+            return ret;
+        },
+    };
+}
+
 static UniValue GetNetworksInfo() {
     UniValue networks(UniValue::VARR);
     for (int n = 0; n < NET_MAX; ++n) {
@@ -1253,6 +1432,7 @@ void RegisterNetRPCCommands(CRPCTable &t) {
         { "network",            disconnectnode,          },
         { "network",            getaddednodeinfo,        },
         { "network",            getnettotals,            },
+        { "network",            getnetmsgstats,          },
         { "network",            getnetworkinfo,          },
         { "network",            setban,                  },
         { "network",            listbanned,              },
@@ -127,3 +127,19 @@ bool CachingTransactionSignatureChecker::VerifySignature(
                                                             sighash, flags);
     });
 }
+
+bool BatchingTransactionSignatureChecker::VerifySignature(
+    const std::vector<uint8_t> &vchSig, const CPubKey &pubkey,
+    const uint256 &sighash, uint32_t flags) const {
+    // Same signature type dispatch as BaseSignatureChecker::VerifySignature
+    if (!m_defer || vchSig.size() != CPubKey::SCHNORR_SIZE ||
+        (flags & SCRIPT_VERIFY_LEGACY_RULES) != 0) {
+        return CachingTransactionSignatureChecker::VerifySignature(
+            vchSig, pubkey, sighash, flags);
+    }
+    return RunMemoizedCheck(vchSig, pubkey, sighash, /*storeOrErase=*/false,
+                            [&] {
+                                m_batch.Add(pubkey, sighash, vchSig);
+                                return true;
+                            });
+}
@@ -41,6 +41,36 @@ public:
     friend class TestCachingTransactionSignatureChecker;
 };
 
+class SchnorrBatch;
+
+/**
+ * A CachingTransactionSignatureChecker which, unless it is asked to store
+ * results in the cache, adds the Schnorr signatures it does not find in the
+ * cache to a SchnorrBatch instead of verifying them. Such signatures are
+ * reported as valid, so a script that passes with this checker is only valid
+ * if the batch verifies as well.
+ */
+class BatchingTransactionSignatureChecker
+    : public CachingTransactionSignatureChecker {
+private:
+    bool m_defer;
+    SchnorrBatch &m_batch;
+
+public:
+    BatchingTransactionSignatureChecker(const CTransaction *txToIn,
+                                        unsigned int nInIn,
+                                        const Amount amountIn, bool storeIn,
+                                        PrecomputedTransactionData &txdataIn,
+                                        SchnorrBatch &batchIn)
+        : CachingTransactionSignatureChecker(txToIn, nInIn, amountIn, storeIn,
+                                             txdataIn),
+          m_defer(!storeIn), m_batch(batchIn) {}
+
+    bool VerifySignature(const std::vector<uint8_t> &vchSig,
+                         const CPubKey &vchPubKey, const uint256 &sighash,
+                         uint32_t flags) const override;
+};
+
 [[nodiscard]] bool InitSignatureCache(size_t max_size_bytes);
 
 #endif // BITCOIN_SCRIPT_SIGCACHE_H
@@ -28,6 +28,30 @@ SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_schnorr_verify(
   const secp256k1_pubkey *pubkey
 ) SECP256K1_ARG_NONNULL(1) SECP256K1_ARG_NONNULL(2) SECP256K1_ARG_NONNULL(3) SECP256K1_ARG_NONNULL(4);
 
+/**
+ * Verify a batch of signatures created by secp256k1_schnorr_sign at once.
+ * This is faster than verifying them one by one, but does not tell which
+ * signature is invalid if the batch fails.
+ * Returns: 1: all signatures are correct
+ *          0: at least one signature is incorrect
+ * Args:    ctx:       a secp256k1 context object, initialized for verification.
+ * In:      sig64:     array of n pointers to 64-byte signatures (cannot be
+ *                     NULL if n > 0)
+ *          msghash32: array of n pointers to the 32-byte message hashes the
+ *                     signatures commit to (cannot be NULL if n > 0), with
+ *                     the same caveats as for secp256k1_schnorr_verify.
+ *          pubkeys:   array of n pointers to the public keys to verify with
+ *                     (cannot be NULL if n > 0)
+ *          n:         the number of signatures in the batch
+ */
+SECP256K1_API SECP256K1_WARN_UNUSED_RESULT int secp256k1_schnorr_verify_batch(
+  const secp256k1_context* ctx,
+  const unsigned char *const *sig64,
+  const unsigned char *const *msghash32,
+  const secp256k1_pubkey *const *pubkeys,
+  size_t n
+) SECP256K1_ARG_NONNULL(1);
+
 /**
  * Create a signature using a custom EC-Schnorr-SHA256 construction. It
  * produces non-malleable 64-byte signatures which support batch validation,
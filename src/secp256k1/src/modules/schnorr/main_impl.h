@@ -30,6 +30,49 @@ int secp256k1_schnorr_verify(
     return secp256k1_schnorr_sig_verify(&ctx->ecmult_ctx, sig64, &q, msghash32);
 }
 
+int secp256k1_schnorr_verify_batch(
+    const secp256k1_context* ctx,
+    const unsigned char *const *sig64,
+    const unsigned char *const *msghash32,
+    const secp256k1_pubkey *const *pubkeys,
+    size_t n
+) {
+    secp256k1_ge *q;
+    size_t i;
+    int ret = 0;
+    VERIFY_CHECK(ctx != NULL);
+    ARG_CHECK(secp256k1_ecmult_context_is_built(&ctx->ecmult_ctx));
+    ARG_CHECK(n == 0 || sig64 != NULL);
+    ARG_CHECK(n == 0 || msghash32 != NULL);
+    ARG_CHECK(n == 0 || pubkeys != NULL);
+
+    for (i = 0; i < n; i++) {
+        ARG_CHECK(sig64[i] != NULL);
+        ARG_CHECK(msghash32[i] != NULL);
+        ARG_CHECK(pubkeys[i] != NULL);
+    }
+
+    if (n == 0) {
+        return 1;
+    }
+
+    q = (secp256k1_ge *)checked_malloc(&ctx->error_callback, n * sizeof(secp256k1_ge));
+    if (q == NULL) {
+        return 0;
+    }
+    for (i = 0; i < n; i++) {
+        if (!secp256k1_pubkey_load(ctx, &q[i], pubkeys[i])) {
+            goto done;
+        }
+    }
+
+    ret = secp256k1_schnorr_sig_verify_batch(&ctx->error_callback, &ctx->ecmult_ctx, sig64, q, msghash32, n);
+
+done:
+    free(q);
+    return ret;
+}
+
 int secp256k1_schnorr_sign(
     const secp256k1_context *ctx,
     unsigned char *sig64,
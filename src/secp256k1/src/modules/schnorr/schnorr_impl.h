@@ -98,6 +98,140 @@ static int secp256k1_schnorr_sig_verify(
     return 1;
 }
 
+typedef struct {
+    /* For each signature, R with scalar a and P with scalar a * e. */
+    const secp256k1_ge *points;
+    const secp256k1_scalar *scalars;
+} secp256k1_schnorr_verify_batch_data;
+
+static int secp256k1_schnorr_verify_batch_callback(secp256k1_scalar *sc, secp256k1_ge *pt, size_t idx, void *data) {
+    const secp256k1_schnorr_verify_batch_data *batch = (const secp256k1_schnorr_verify_batch_data *)data;
+    *sc = batch->scalars[idx];
+    *pt = batch->points[idx];
+    return 1;
+}
+
+/**
+ * Batch verification, using option 2 above:
+ *   Derive random-looking scalars a_i from all the inputs, with a_0 = 1.
+ *   Decompress each r_i into R_i, and reject if any is not on the curve.
+ *   The batch is valid if sum(a_i * R_i + (a_i * e_i) * P_i) -
+ *   sum(a_i * s_i) * G == 0.
+ *
+ * The scalars a_i prevent invalid signatures from cancelling each other out.
+ * They only need to be unpredictable to whoever created the signatures, so
+ * they are derived from a hash committing to the whole batch.
+ */
+static int secp256k1_schnorr_sig_verify_batch(
+    const secp256k1_callback* error_callback,
+    const secp256k1_ecmult_context* ctx,
+    const unsigned char *const *sig64,
+    secp256k1_ge *pubkeys,
+    const unsigned char *const *msg32,
+    size_t n
+) {
+    secp256k1_schnorr_verify_batch_data data;
+    secp256k1_ge *points;
+    secp256k1_scalar *scalars;
+    secp256k1_scratch *scratch;
+    secp256k1_sha256 sha;
+    secp256k1_scalar a, e, s, sum_s;
+    secp256k1_fe Rx;
+    secp256k1_gej res;
+    unsigned char seed[32], buf[36];
+    size_t i, n_points, scratch_size;
+    size_t size;
+    int overflow;
+    int ret = 0;
+
+    if (n == 0) {
+        return 1;
+    }
+
+    /* Commit to every input of the batch. */
+    secp256k1_sha256_initialize(&sha);
+    for (i = 0; i < n; i++) {
+        secp256k1_sha256_write(&sha, sig64[i], 64);
+        secp256k1_sha256_write(&sha, msg32[i], 32);
+        secp256k1_eckey_pubkey_serialize(&pubkeys[i], buf, &size, 1);
+        VERIFY_CHECK(size == 33);
+        secp256k1_sha256_write(&sha, buf, 33);
+    }
+    secp256k1_sha256_finalize(&sha, seed);
+
+    n_points = 2 * n;
+    points = (secp256k1_ge *)checked_malloc(error_callback, n_points * sizeof(secp256k1_ge));
+    scalars = (secp256k1_scalar *)checked_malloc(error_callback, n_points * sizeof(secp256k1_scalar));
+    if (points == NULL || scalars == NULL) {
+        goto done;
+    }
+
+    secp256k1_scalar_set_int(&sum_s, 0);
+    for (i = 0; i < n; i++) {
+        /* Extract s */
+        overflow = 0;
+        secp256k1_scalar_set_b32(&s, sig64[i] + 32, &overflow);
+        if (overflow) {
+            goto done;
+        }
+
+        /* Extract R.x and decompress R, with R.y a quadratic residue */
+        if (!secp256k1_fe_set_b32(&Rx, sig64[i])) {
+            goto done;
+        }
+        if (!secp256k1_ge_set_xquad(&points[2 * i], &Rx)) {
+            goto done;
+        }
+        points[2 * i + 1] = pubkeys[i];
+
+        /* Compute a */
+        if (i == 0) {
+            secp256k1_scalar_set_int(&a, 1);
+        } else {
+            memcpy(buf, seed, 32);
+            buf[32] = (unsigned char)(i >> 24);
+            buf[33] = (unsigned char)(i >> 16);
+            buf[34] = (unsigned char)(i >> 8);
+            buf[35] = (unsigned char)i;
+            secp256k1_sha256_initialize(&sha);
+            secp256k1_sha256_write(&sha, buf, 36);
+            secp256k1_sha256_finalize(&sha, buf);
+            secp256k1_scalar_set_b32(&a, buf, NULL);
+        }
+
+        /* Compute e */
+        secp256k1_schnorr_compute_e(&e, sig64[i], &pubkeys[i], msg32[i]);
+
+        scalars[2 * i] = a;
+        secp256k1_scalar_mul(&scalars[2 * i + 1], &a, &e);
+        secp256k1_scalar_mul(&s, &s, &a);
+        secp256k1_scalar_add(&sum_s, &sum_s, &s);
+    }
+    secp256k1_scalar_negate(&sum_s, &sum_s);
+
+    if (n_points >= ECMULT_PIPPENGER_THRESHOLD) {
+        scratch_size = secp256k1_pippenger_scratch_size(n_points, secp256k1_pippenger_bucket_window(n_points)) + PIPPENGER_SCRATCH_OBJECTS * ALIGNMENT;
+    } else {
+        scratch_size = secp256k1_strauss_scratch_size(n_points) + STRAUSS_SCRATCH_OBJECTS * ALIGNMENT;
+    }
+    scratch = secp256k1_scratch_create(error_callback, scratch_size);
+    if (scratch == NULL) {
+        goto done;
+    }
+
+    data.points = points;
+    data.scalars = scalars;
+    if (secp256k1_ecmult_multi_var(error_callback, ctx, scratch, &res, &sum_s, secp256k1_schnorr_verify_batch_callback, &data, n_points)) {
+        ret = secp256k1_gej_is_infinity(&res);
+    }
+    secp256k1_scratch_destroy(error_callback, scratch);
+
+done:
+    free(points);
+    free(scalars);
+    return ret;
+}
+
 static int secp256k1_schnorr_compute_e(
     secp256k1_scalar* e,
     const unsigned char *r,
@@ -78,6 +78,54 @@ void test_schnorr_sign_verify(void) {
 
 #undef SIG_COUNT
 
+#define BATCH_MAX_COUNT 50
+
+void test_schnorr_verify_batch(void) {
+    unsigned char privkey[BATCH_MAX_COUNT][32];
+    unsigned char msg[BATCH_MAX_COUNT][32];
+    unsigned char sig[BATCH_MAX_COUNT][64];
+    secp256k1_pubkey pubkey[BATCH_MAX_COUNT];
+    const unsigned char *sigptr[BATCH_MAX_COUNT];
+    const unsigned char *msgptr[BATCH_MAX_COUNT];
+    const secp256k1_pubkey *pubkeyptr[BATCH_MAX_COUNT];
+    /* The last size is large enough for Pippenger's algorithm to be used. */
+    static const size_t sizes[] = {1, 2, 16, BATCH_MAX_COUNT};
+    size_t i, j, n;
+
+    for (i = 0; i < BATCH_MAX_COUNT; i++) {
+        secp256k1_scalar key;
+        random_scalar_order_test(&key);
+        secp256k1_scalar_get_b32(privkey[i], &key);
+        secp256k1_testrand256_test(msg[i]);
+        CHECK(secp256k1_ec_pubkey_create(ctx, &pubkey[i], privkey[i]) == 1);
+        CHECK(secp256k1_schnorr_sign(ctx, sig[i], msg[i], privkey[i], NULL, NULL) == 1);
+        sigptr[i] = sig[i];
+        msgptr[i] = msg[i];
+        pubkeyptr[i] = &pubkey[i];
+    }
+
+    CHECK(secp256k1_schnorr_verify_batch(ctx, NULL, NULL, NULL, 0) == 1);
+
+    for (i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        n = sizes[i];
+        CHECK(secp256k1_schnorr_verify_batch(ctx, sigptr, msgptr, pubkeyptr, n) == 1);
+
+        /* A single bad signature, in any position, fails the batch. */
+        j = secp256k1_testrand_int(n);
+        sig[j][secp256k1_testrand_bits(6)] ^= 1 + secp256k1_testrand_int(255);
+        CHECK(secp256k1_schnorr_verify_batch(ctx, sigptr, msgptr, pubkeyptr, n) == 0);
+        CHECK(secp256k1_schnorr_sign(ctx, sig[j], msg[j], privkey[j], NULL, NULL) == 1);
+        CHECK(secp256k1_schnorr_verify_batch(ctx, sigptr, msgptr, pubkeyptr, n) == 1);
+
+        /* So does a signature checked against the wrong key. */
+        pubkeyptr[j] = &pubkey[(j + 1) % BATCH_MAX_COUNT];
+        CHECK(secp256k1_schnorr_verify_batch(ctx, sigptr, msgptr, pubkeyptr, n) == 0);
+        pubkeyptr[j] = &pubkey[j];
+    }
+}
+
+#undef BATCH_MAX_COUNT
+
 void run_schnorr_compact_test(void) {
     {
         /* Test vector 1 */
@@ -516,6 +564,7 @@ void run_schnorr_tests(void) {
     }
 
     test_schnorr_sign_verify();
+    test_schnorr_verify_batch();
     run_schnorr_compact_test();
 }
 
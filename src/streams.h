@@ -226,6 +226,7 @@ public:
         vch.resize(n + nReadPos, c);
     }
     void reserve(size_type n) { vch.reserve(n + nReadPos); }
+    size_type capacity() const { return vch.capacity() - nReadPos; }
     const_reference operator[](size_type pos) const {
         return vch[pos + nReadPos];
     }
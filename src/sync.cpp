@@ -11,6 +11,7 @@
 
 #include <tinyformat.h>
 
+#include <chrono>
 #include <map>
 #include <mutex>
 #include <set>
@@ -213,6 +214,8 @@ template void EnterCritical(const char *, const char *, int, std::mutex *,
                             bool);
 template void EnterCritical(const char *, const char *, int,
                             std::recursive_mutex *, bool);
+template void EnterCritical(const char *, const char *, int,
+                            HeldTimeRecursiveMutex *, bool);
 
 void CheckLastCritical(void *cs, std::string &lockname, const char *guardname,
                        const char *file, int line) {
@@ -291,6 +294,8 @@ void AssertLockHeldInternal(const char *pszName, const char *pszFile, int nLine,
 template void AssertLockHeldInternal(const char *, const char *, int, Mutex *);
 template void AssertLockHeldInternal(const char *, const char *, int,
                                      RecursiveMutex *);
+template void AssertLockHeldInternal(const char *, const char *, int,
+                                     HeldTimeRecursiveMutex *);
 
 template <typename MutexType>
 void AssertLockNotHeldInternal(const char *pszName, const char *pszFile,
@@ -340,3 +345,37 @@ bool LockStackEmpty() {
 bool g_debug_lockorder_abort = true;
 
 #endif /* DEBUG_LOCKORDER */
+
+//! Time the thread has held a HeldTimeRecursiveMutex, see GetThreadHeldTime().
+static thread_local std::chrono::nanoseconds g_thread_held_time{0};
+
+void HeldTimeRecursiveMutex::OnLocked() {
+    if (m_lock_depth++ == 0) {
+        m_locked_since = std::chrono::steady_clock::now();
+    }
+}
+
+void HeldTimeRecursiveMutex::lock() {
+    std::recursive_mutex::lock();
+    OnLocked();
+}
+
+void HeldTimeRecursiveMutex::unlock() {
+    if (--m_lock_depth == 0) {
+        g_thread_held_time +=
+            std::chrono::steady_clock::now() - m_locked_since;
+    }
+    std::recursive_mutex::unlock();
+}
+
+bool HeldTimeRecursiveMutex::try_lock() {
+    if (!std::recursive_mutex::try_lock()) {
+        return false;
+    }
+    OnLocked();
+    return true;
+}
+
+std::chrono::nanoseconds HeldTimeRecursiveMutex::GetThreadHeldTime() {
+    return g_thread_held_time;
+}
@@ -14,6 +14,7 @@
 #include <threadsafety.h>
 #include <util/macros.h>
 
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 #include <string>
@@ -131,6 +132,35 @@ using RecursiveMutex = AnnotatedMixin<std::recursive_mutex>;
 /** Wrapped mutex: supports waiting but not recursive locking */
 using Mutex = AnnotatedMixin<std::mutex>;
 
+/**
+ * RecursiveMutex which also accounts for how long each thread holds it, from
+ * the outermost lock to the matching unlock.
+ *
+ * The accounting is per thread but shared by all the instances, so it is
+ * only meant for a single, global mutex such as cs_main.
+ */
+class LOCKABLE HeldTimeRecursiveMutex : public RecursiveMutex {
+public:
+    void lock() EXCLUSIVE_LOCK_FUNCTION();
+    void unlock() UNLOCK_FUNCTION();
+    bool try_lock() EXCLUSIVE_TRYLOCK_FUNCTION(true);
+
+    using UniqueLock = std::unique_lock<HeldTimeRecursiveMutex>;
+
+    /**
+     * Total time the calling thread has held a HeldTimeRecursiveMutex,
+     * excluding the hold in progress if any.
+     */
+    static std::chrono::nanoseconds GetThreadHeldTime();
+
+private:
+    void OnLocked();
+
+    //! Only accessed by the thread holding the mutex.
+    int m_lock_depth{0};
+    std::chrono::steady_clock::time_point m_locked_since;
+};
+
 /**
  * Different type to mark Mutex at global scope
  *
@@ -302,6 +332,14 @@ inline RecursiveMutex *MaybeCheckNotHeld(RecursiveMutex *cs) LOCKS_EXCLUDED(cs)
     LOCK_RETURNED(cs) {
     return cs;
 }
+inline HeldTimeRecursiveMutex &MaybeCheckNotHeld(HeldTimeRecursiveMutex &cs)
+    LOCKS_EXCLUDED(cs) LOCK_RETURNED(cs) {
+    return cs;
+}
+inline HeldTimeRecursiveMutex *MaybeCheckNotHeld(HeldTimeRecursiveMutex *cs)
+    LOCKS_EXCLUDED(cs) LOCK_RETURNED(cs) {
+    return cs;
+}
 
 #define LOCK(cs)                                                               \
     DebugLock<decltype(cs)> UNIQUE_LOG_NAME(criticalblock)(                    \
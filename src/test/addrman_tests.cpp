@@ -20,6 +20,7 @@
 #include <boost/test/unit_test.hpp>
 
 #include <optional>
+#include <set>
 #include <string>
 
 using namespace std::literals;
@@ -287,6 +288,57 @@ BOOST_AUTO_TEST_CASE(addrman_select) {
     BOOST_CHECK_EQUAL(ports.size(), 3U);
 }
 
+BOOST_AUTO_TEST_CASE(addrman_select_sparse_and_churned) {
+    // Check the consistency of the tables, including the index of their
+    // non-empty buckets, after every operation.
+    AddrMan addrman(/*asmap=*/std::vector<bool>(),
+                    /*consistency_check_ratio=*/1);
+
+    // A single address in each table is found without retrying.
+    const CService new_addr = ResolveService("250.1.1.1", 22556);
+    const CService tried_addr = ResolveService("250.2.2.2", 22556);
+    const CNetAddr source = ResolveIP("252.2.2.2");
+    BOOST_CHECK(addrman.Add({CAddress(new_addr, NODE_NONE),
+                             CAddress(tried_addr, NODE_NONE)},
+                            source));
+    addrman.Good(CAddress(tried_addr, NODE_NONE));
+    std::set<std::string> selected;
+    for (int i = 0; i < 100; ++i) {
+        selected.insert(addrman.Select().first.ToStringIPPort());
+    }
+    const std::set<std::string> expected{new_addr.ToStringIPPort(),
+                                         tried_addr.ToStringIPPort()};
+    BOOST_CHECK(selected == expected);
+    BOOST_CHECK_EQUAL(addrman.Select(/*newOnly=*/true).first.ToStringIPPort(),
+                      new_addr.ToStringIPPort());
+
+    // Fill the tables from many sources in batches, and move addresses to
+    // tried so that entries get evicted back to new.
+    std::set<std::string> added{new_addr.ToStringIPPort(),
+                                tried_addr.ToStringIPPort()};
+    for (int source_i = 0; source_i < 64; ++source_i) {
+        const CNetAddr batch_source =
+            ResolveIP(strprintf("251.%i.1.1", source_i));
+        std::vector<CAddress> batch;
+        for (int addr_i = 0; addr_i < 32; ++addr_i) {
+            batch.emplace_back(
+                ResolveService(strprintf("250.%i.%i.1", source_i, addr_i),
+                               22556),
+                NODE_NONE);
+            added.insert(batch.back().ToStringIPPort());
+        }
+        addrman.Add(batch, batch_source);
+        for (int addr_i = 0; addr_i < 32; addr_i += 4) {
+            addrman.Good(batch[addr_i]);
+        }
+    }
+
+    for (int i = 0; i < 100; ++i) {
+        const auto [addr, last_try] = addrman.Select();
+        BOOST_CHECK(added.count(addr.ToStringIPPort()));
+    }
+}
+
 BOOST_AUTO_TEST_CASE(addrman_new_collisions) {
     AddrManTest addrman;
 
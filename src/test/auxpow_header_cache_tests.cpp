@@ -0,0 +1,110 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <node/auxpow_header_cache.h>
+#include <node/blockstorage.h>
+#include <primitives/auxpow.h>
+#include <streams.h>
+#include <validation.h>
+
+#include <test/util/setup_common.h>
+
+#include <boost/test/unit_test.hpp>
+
+using node::AuxPowHeaderCache;
+
+BOOST_FIXTURE_TEST_SUITE(auxpow_header_cache_tests, TestChain100Setup)
+
+static std::shared_ptr<CAuxPow> MakeAuxPow(size_t branch_length) {
+    auto auxpow = std::make_shared<CAuxPow>();
+    auxpow->coinbaseTx = MakeTransactionRef(CMutableTransaction());
+    auxpow->vMerkleBranch.resize(branch_length);
+    return auxpow;
+}
+
+BOOST_AUTO_TEST_CASE(lru_eviction) {
+    std::vector<CBlockIndex> indices(10);
+
+    // Measure the usage of a single entry
+    size_t entry_usage;
+    {
+        AuxPowHeaderCache cache{1 << 20};
+        cache.Insert(indices[0], MakeAuxPow(8));
+        entry_usage = cache.GetStats().usage;
+        BOOST_CHECK_GT(entry_usage, 8 * sizeof(uint256));
+    }
+
+    // Room for exactly 3 entries
+    AuxPowHeaderCache cache{3 * entry_usage};
+    for (size_t i = 0; i < 3; ++i) {
+        cache.Insert(indices[i], MakeAuxPow(8));
+    }
+    BOOST_CHECK_EQUAL(cache.GetStats().entries, 3);
+    BOOST_CHECK_EQUAL(cache.GetStats().usage, 3 * entry_usage);
+
+    // Touch the oldest entry, so the next insertion evicts the second one
+    BOOST_CHECK(cache.Get(indices[0]));
+    cache.Insert(indices[3], MakeAuxPow(8));
+    BOOST_CHECK_EQUAL(cache.GetStats().entries, 3);
+    BOOST_CHECK(cache.Get(indices[0]));
+    BOOST_CHECK(!cache.Get(indices[1]));
+    BOOST_CHECK(cache.Get(indices[2]));
+    BOOST_CHECK(cache.Get(indices[3]));
+
+    // A larger entry evicts as many entries as needed
+    cache.Insert(indices[4], MakeAuxPow(40));
+    BOOST_CHECK_LE(cache.GetStats().usage, 3 * entry_usage);
+    BOOST_CHECK(cache.Get(indices[4]));
+
+    // Entries that can never fit are not cached
+    cache.Insert(indices[5], MakeAuxPow(1000));
+    BOOST_CHECK(!cache.Get(indices[5]));
+    BOOST_CHECK_LE(cache.GetStats().usage, 3 * entry_usage);
+
+    const AuxPowHeaderCache::Stats stats = cache.GetStats();
+    BOOST_CHECK_EQUAL(stats.max_usage, 3 * entry_usage);
+    BOOST_CHECK_EQUAL(stats.hits, 5);
+    BOOST_CHECK_EQUAL(stats.misses, 2);
+}
+
+BOOST_AUTO_TEST_CASE(get_block_header) {
+    ChainstateManager &chainman = *Assert(m_node.chainman);
+
+    std::vector<CBlock> blocks;
+    for (uint32_t i = 0; i < 5; ++i) {
+        blocks.push_back(CreateAndProcessAuxPowBlock(
+            {}, CScript() << OP_1, /*parentChainId=*/42,
+            /*mergeMineNonce=*/i, {}, {}));
+    }
+
+    const auto stats_before = chainman.m_blockman.GetAuxPowHeaderCacheStats();
+    BOOST_CHECK_GE(stats_before.entries, blocks.size());
+
+    for (const CBlock &block : blocks) {
+        const CBlockIndex *pindex = WITH_LOCK(
+            cs_main, return chainman.m_blockman.LookupBlockIndex(
+                         block.GetHash()));
+        BOOST_REQUIRE(pindex);
+
+        // The header rebuilt from the index and cache matches the one on disk
+        const CBlockHeader header = pindex->GetBlockHeader(chainman.m_blockman);
+        CBlockHeader disk_header;
+        BOOST_CHECK(
+            chainman.m_blockman.ReadBlockHeaderFromDisk(disk_header, *pindex));
+        BOOST_CHECK_EQUAL(header.GetHash(), block.GetHash());
+
+        CDataStream ss_header(SER_NETWORK, PROTOCOL_VERSION);
+        CDataStream ss_disk_header(SER_NETWORK, PROTOCOL_VERSION);
+        ss_header << header;
+        ss_disk_header << disk_header;
+        BOOST_CHECK(ss_header.str() == ss_disk_header.str());
+    }
+
+    // The auxpows were cached as the headers were accepted
+    const auto stats_after = chainman.m_blockman.GetAuxPowHeaderCacheStats();
+    BOOST_CHECK_EQUAL(stats_after.hits, stats_before.hits + blocks.size());
+    BOOST_CHECK_EQUAL(stats_after.misses, stats_before.misses);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
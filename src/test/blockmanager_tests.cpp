@@ -3,6 +3,7 @@
 // file COPYING or http://www.opensource.org/licenses/mit-license.php.
 
 #include <chainparams.h>
+#include <node/block_read_ahead.h>
 #include <node/blockstorage.h>
 #include <node/context.h>
 #include <validation.h>
@@ -12,6 +13,7 @@
 
 using node::BLOCK_SERIALIZATION_HEADER_SIZE;
 using node::BlockManager;
+using node::BlockReadAhead;
 using node::MAX_BLOCKFILE_SIZE;
 
 // use BasicTestingSetup here for the data directory configuration, setup, and
@@ -103,4 +105,58 @@ BOOST_FIXTURE_TEST_CASE(blockmanager_scan_unlink_already_pruned_files,
     BOOST_CHECK(!AutoFile(blockman.OpenBlockFile(new_pos, true)).IsNull());
 }
 
+BOOST_FIXTURE_TEST_CASE(block_read_ahead, TestChain100Setup) {
+    auto &chainman{m_node.chainman};
+    auto &blockman{chainman->m_blockman};
+
+    std::vector<const CBlockIndex *> indexes;
+    std::vector<BlockReadAhead::Request> requests;
+    {
+        LOCK(chainman->GetMutex());
+        for (int height = 1; height <= 10; ++height) {
+            const CBlockIndex *pindex{chainman->ActiveChain()[height]};
+            indexes.push_back(pindex);
+            requests.push_back({pindex, pindex->GetBlockPos(),
+                                pindex->GetBlockHash(), /*check_pow=*/true});
+        }
+    }
+
+    // A budget of a single byte still reads the head of the queue.
+    for (size_t max_usage : {size_t{1}, size_t{1} << 20}) {
+        BlockReadAhead read_ahead{blockman, max_usage};
+        std::chrono::microseconds stall{0};
+
+        // Nothing scheduled yet.
+        BOOST_CHECK(!read_ahead.Take(*indexes[0], stall));
+
+        read_ahead.Schedule(requests);
+        for (size_t i = 0; i < 3; ++i) {
+            auto block{read_ahead.Take(*indexes[i], stall)};
+            BOOST_REQUIRE(block);
+            BOOST_CHECK_EQUAL(block->GetHash(), indexes[i]->GetBlockHash());
+        }
+        // Already taken.
+        BOOST_CHECK(!read_ahead.Take(*indexes[2], stall));
+
+        // Taking a block drops the ones scheduled before it.
+        auto block{read_ahead.Take(*indexes[5], stall)};
+        BOOST_REQUIRE(block);
+        BOOST_CHECK_EQUAL(block->GetHash(), indexes[5]->GetBlockHash());
+        BOOST_CHECK(!read_ahead.Take(*indexes[4], stall));
+
+        // Rescheduling drops the blocks that are not requested anymore.
+        read_ahead.Schedule({requests[7], requests[9]});
+        BOOST_CHECK(!read_ahead.Take(*indexes[8], stall));
+        block = read_ahead.Take(*indexes[9], stall);
+        BOOST_REQUIRE(block);
+        BOOST_CHECK_EQUAL(block->GetHash(), indexes[9]->GetBlockHash());
+
+        // A block that doesn't match the expected hash is not returned.
+        BlockReadAhead::Request bad{requests[0]};
+        bad.hash = indexes[1]->GetBlockHash();
+        read_ahead.Schedule({bad});
+        BOOST_CHECK(!read_ahead.Take(*indexes[0], stall));
+    }
+}
+
 BOOST_AUTO_TEST_SUITE_END()
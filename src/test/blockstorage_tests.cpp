@@ -5,8 +5,11 @@
 #include <chainparams.h>
 #include <config.h>
 #include <node/blockstorage.h>
+#include <pow/pow.h>
+#include <streams.h>
 #include <undo.h>
 #include <validation.h>
+#include <version.h>
 
 #include <test/util/setup_common.h>
 
@@ -110,4 +113,104 @@ BOOST_AUTO_TEST_CASE(read_tx_data_from_disk_bad) {
         txundo, FlatFilePos(0, 0x7fffffff)));
 }
 
+BOOST_AUTO_TEST_CASE(read_block_trusted) {
+    ChainstateManager &chainman = *Assert(m_node.chainman);
+    const Consensus::Params &params = chainman.GetConsensus();
+
+    CBlock block = CreateAndProcessBlock({}, CScript() << OP_1,
+                                         &chainman.ActiveChainstate());
+
+    // Grind the nonce until the block no longer satisfies its target
+    while (CheckProofOfWork(block.GetPowHash(), block.nBits, params)) {
+        ++block.nNonce;
+    }
+
+    const FlatFilePos pos = WITH_LOCK(
+        cs_main, return chainman.m_blockman.SaveBlockToDisk(
+                     block, 0, chainman.ActiveChain(), nullptr));
+    BOOST_CHECK(!pos.IsNull());
+
+    // An untrusted read rejects the block...
+    CBlock read;
+    CBlockHeader header;
+    BOOST_CHECK(!chainman.m_blockman.ReadBlockFromDisk(read, pos));
+    BOOST_CHECK(!chainman.m_blockman.ReadBlockHeaderFromDisk(header, pos));
+
+    // ... while a trusted read returns it unchecked
+    BOOST_CHECK(chainman.m_blockman.ReadBlockFromDisk(read, pos,
+                                                      /*check_pow=*/false));
+    BOOST_CHECK_EQUAL(read.GetHash(), block.GetHash());
+    BOOST_CHECK(chainman.m_blockman.ReadBlockHeaderFromDisk(
+        header, pos, /*check_pow=*/false));
+    BOOST_CHECK_EQUAL(header.GetHash(), block.GetHash());
+
+    // Same for the raw block
+    std::vector<uint8_t> raw;
+    BOOST_CHECK(!chainman.m_blockman.ReadRawBlockFromDisk(raw, pos));
+    BOOST_CHECK(chainman.m_blockman.ReadRawBlockFromDisk(raw, pos,
+                                                         /*check_pow=*/false));
+    CDataStream expected(SER_NETWORK, PROTOCOL_VERSION);
+    expected << block;
+    BOOST_CHECK(MakeUCharSpan(expected) == MakeUCharSpan(raw));
+}
+
+BOOST_AUTO_TEST_CASE(read_raw_block) {
+    ChainstateManager &chainman = *Assert(m_node.chainman);
+
+    auto active_tip =
+        WITH_LOCK(chainman.GetMutex(), return chainman.ActiveTip());
+    for (int32_t height = 0; height <= active_tip->nHeight; ++height) {
+        const CBlockIndex *pindex = active_tip->GetAncestor(height);
+        CBlock block;
+        std::vector<uint8_t> raw;
+        BOOST_CHECK(chainman.m_blockman.ReadBlockFromDisk(block, *pindex));
+        BOOST_CHECK(chainman.m_blockman.ReadRawBlockFromDisk(raw, *pindex));
+
+        // The block is stored with its network serialization
+        CDataStream expected(SER_NETWORK, PROTOCOL_VERSION);
+        expected << block;
+        BOOST_CHECK(MakeUCharSpan(expected) == MakeUCharSpan(raw));
+    }
+
+    // The hash is checked against the index
+    const CBlockIndex *genesis = active_tip->GetAncestor(0);
+    CBlockIndex wrong_index{*active_tip};
+    WITH_LOCK(cs_main, wrong_index.nDataPos = genesis->nDataPos);
+    std::vector<uint8_t> raw;
+    BOOST_CHECK(!chainman.m_blockman.ReadRawBlockFromDisk(raw, wrong_index));
+
+    BOOST_CHECK(!chainman.m_blockman.ReadRawBlockFromDisk(
+        raw, FlatFilePos(0x7fffffff, 0x7fffffff)));
+    BOOST_CHECK(
+        !chainman.m_blockman.ReadRawBlockFromDisk(raw, FlatFilePos(0, 0)));
+}
+
+BOOST_AUTO_TEST_CASE(read_raw_block_larger_than_max_size) {
+    ChainstateManager &chainman = *Assert(m_node.chainman);
+
+    // Blocks can be larger than MAX_SIZE with a large -excessiveblocksize.
+    const std::vector<uint8_t> filler(1 << 20, OP_NOP);
+    CMutableTransaction tx;
+    tx.vin.resize(1);
+    for (size_t i = 0; i <= MAX_SIZE >> 20; ++i) {
+        tx.vout.emplace_back(Amount::zero(),
+                             CScript(filler.begin(), filler.end()));
+    }
+    CBlock block;
+    block.vtx.push_back(MakeTransactionRef(tx));
+
+    const FlatFilePos pos = WITH_LOCK(
+        cs_main, return chainman.m_blockman.SaveBlockToDisk(
+                     block, 0, chainman.ActiveChain(), nullptr));
+    BOOST_CHECK(!pos.IsNull());
+
+    std::vector<uint8_t> raw;
+    BOOST_CHECK(chainman.m_blockman.ReadRawBlockFromDisk(raw, pos,
+                                                         /*check_pow=*/false));
+    BOOST_CHECK_GT(raw.size(), MAX_SIZE);
+    CDataStream expected(SER_NETWORK, PROTOCOL_VERSION);
+    expected << block;
+    BOOST_CHECK(MakeUCharSpan(expected) == MakeUCharSpan(raw));
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -6,6 +6,7 @@
 
 #include <clientversion.h>
 #include <script/standard.h>
+#include <shutdown.h>
 #include <streams.h>
 #include <test/util/poolresourcetester.h>
 #include <txdb.h>
@@ -18,6 +19,7 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <atomic>
 #include <map>
 #include <vector>
 
@@ -1196,4 +1198,109 @@ BOOST_AUTO_TEST_CASE(coins_resource_is_used) {
     PoolResourceTester::CheckAllDataAccountedFor(resource);
 }
 
+BOOST_AUTO_TEST_CASE(coin_prefetch) {
+    CCoinsViewTest base;
+    CCoinsViewCacheTest cache(&base);
+    const COutPoint outp{TxId(InsecureRand256()), 0};
+    const CTxOut txout{10 * SATOSHI, CScript() << OP_TRUE};
+
+    // A prefetched coin is cached clean, so flushing does not write it back.
+    cache.PrefetchCoin(outp, Coin(txout, 1, false));
+    cache.SelfTest();
+    BOOST_CHECK(cache.HaveCoinInCache(outp));
+    BOOST_CHECK_EQUAL(cache.map().at(outp).flags, 0);
+    BOOST_CHECK(cache.AccessCoin(outp).GetTxOut() == txout);
+    BOOST_CHECK(cache.Flush());
+    BOOST_CHECK(!base.HaveCoin(outp));
+
+    // Prefetching never replaces an existing entry, spent or not.
+    cache.AddCoin(outp, Coin(txout, 2, false), /*possible_overwrite=*/true);
+    cache.PrefetchCoin(outp, Coin(txout, 1, false));
+    BOOST_CHECK_EQUAL(cache.AccessCoin(outp).GetHeight(), 2U);
+    BOOST_CHECK(cache.SpendCoin(outp));
+    cache.PrefetchCoin(outp, Coin(txout, 1, false));
+    BOOST_CHECK(!cache.HaveCoinInCache(outp));
+    cache.SelfTest();
+}
+
+BOOST_AUTO_TEST_CASE(coins_background_flush) {
+    CCoinsViewDB db{
+        {.path = "test", .cache_bytes = 1 << 23, .memory_only = true}, {}};
+    CCoinsViewBackgroundFlush flush_view{&db};
+    CCoinsViewCacheTest cache{&flush_view};
+
+    const CTxOut txout{10 * SATOSHI, CScript() << OP_TRUE};
+    std::vector<COutPoint> outpoints;
+    for (uint32_t i = 0; i < 100; ++i) {
+        outpoints.emplace_back(TxId(InsecureRand256()), i);
+        cache.AddCoin(outpoints.back(), Coin(txout, 1, false),
+                      /*possible_overwrite=*/false);
+    }
+    const BlockHash block1{InsecureRand256()};
+    cache.SetBestBlock(block1);
+
+    // Detaching leaves the cache empty, the coins are still visible through
+    // the frozen layer while they are being written.
+    std::atomic<bool> done{false};
+    BOOST_CHECK(flush_view.BatchWriteInBackground(cache.Detach(),
+                                                  [&] { done = true; }));
+    BOOST_CHECK_EQUAL(cache.GetCacheSize(), 0U);
+    BOOST_CHECK(cache.GetBestBlock() == block1);
+    BOOST_CHECK(flush_view.GetBestBlock() == block1);
+    for (const COutPoint &outpoint : outpoints) {
+        BOOST_CHECK(cache.HaveCoin(outpoint));
+    }
+
+    // Keep going on the fresh cache, then flush it synchronously, which
+    // waits for the background write to complete first.
+    BOOST_CHECK(cache.SpendCoin(outpoints[0]));
+    const COutPoint added{TxId(InsecureRand256()), 0};
+    cache.AddCoin(added, Coin(txout, 2, false), /*possible_overwrite=*/false);
+    const BlockHash block2{InsecureRand256()};
+    cache.SetBestBlock(block2);
+    BOOST_CHECK(cache.Flush());
+    BOOST_CHECK(done);
+    BOOST_CHECK(!flush_view.IsFlushing());
+    BOOST_CHECK_EQUAL(flush_view.DynamicMemoryUsage(), 0U);
+
+    BOOST_CHECK(db.GetBestBlock() == block2);
+    BOOST_CHECK(!db.HaveCoin(outpoints[0]));
+    for (size_t i = 1; i < outpoints.size(); ++i) {
+        BOOST_CHECK(db.HaveCoin(outpoints[i]));
+    }
+    BOOST_CHECK(db.HaveCoin(added));
+
+    const CCoinsViewBackgroundFlush::Stats stats{flush_view.GetStats()};
+    BOOST_CHECK_EQUAL(stats.flushes, 2U);
+    BOOST_CHECK_EQUAL(stats.background_flushes, 1U);
+    // All the coins looked up above were cached again.
+    BOOST_CHECK_EQUAL(stats.last_coins, outpoints.size() + 1);
+}
+
+BOOST_AUTO_TEST_CASE(coins_background_flush_failure) {
+    BOOST_REQUIRE(InitShutdownState());
+
+    // The base view fails every write.
+    CCoinsView base;
+    CCoinsViewBackgroundFlush flush_view{&base};
+    CCoinsViewCacheTest cache{&flush_view};
+
+    const COutPoint outpoint{TxId(InsecureRand256()), 0};
+    cache.AddCoin(outpoint,
+                  Coin(CTxOut{10 * SATOSHI, CScript() << OP_TRUE}, 1, false),
+                  /*possible_overwrite=*/false);
+    cache.SetBestBlock(BlockHash{InsecureRand256()});
+
+    // The node is shut down as soon as the write fails, the coins remain
+    // readable until then.
+    BOOST_CHECK(!ShutdownRequested());
+    BOOST_CHECK(flush_view.BatchWriteInBackground(cache.Detach(), {}));
+    BOOST_CHECK(!flush_view.Wait());
+    BOOST_CHECK(ShutdownRequested());
+    BOOST_CHECK(cache.HaveCoin(outpoint));
+    BOOST_CHECK(!cache.Flush());
+
+    AbortShutdown();
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -153,7 +153,8 @@ class Tester {
     }
 
 public:
-    Tester() : m_tracker(true) {}
+    explicit Tester(InvRequestTrackerImplType type)
+        : m_tracker(/*deterministic=*/true, type) {}
 
     std::chrono::microseconds Now() const { return m_now; }
 
@@ -328,9 +329,11 @@ public:
 };
 } // namespace
 
-FUZZ_TARGET(txrequest) {
+namespace {
+void RunTester(const std::vector<uint8_t> &buffer,
+               InvRequestTrackerImplType type) {
     // Tester object (which encapsulates a TxRequestTracker).
-    Tester tester;
+    Tester tester{type};
 
     // Decode the input as a sequence of instructions with parameters
     auto it = buffer.begin();
@@ -404,3 +407,10 @@ FUZZ_TARGET(txrequest) {
     }
     tester.Check();
 }
+} // namespace
+
+FUZZ_TARGET(txrequest) {
+    // Both implementations must behave like the naive one on the same input.
+    RunTester(buffer, InvRequestTrackerImplType::ORDERED);
+    RunTester(buffer, InvRequestTrackerImplType::FLAT);
+}
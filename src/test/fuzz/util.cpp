@@ -56,6 +56,16 @@ ssize_t FuzzedSock::Send(const void *data, size_t len, int flags) const {
     return r;
 }
 
+ssize_t FuzzedSock::SendMany(Span<const Span<const uint8_t>> data,
+                             int flags) const {
+    size_t len{0};
+    for (const auto &buf :
+         data.first(std::min(data.size(), MAX_SEND_BUFFERS))) {
+        len += buf.size();
+    }
+    return Send(nullptr, len, flags);
+}
+
 ssize_t FuzzedSock::Recv(void *buf, size_t len, int flags) const {
     constexpr std::array<int, 10> recv_errnos{{
         EAGAIN,
@@ -56,6 +56,9 @@ public:
 
     ssize_t Send(const void *data, size_t len, int flags) const override;
 
+    ssize_t SendMany(Span<const Span<const uint8_t>> data,
+                     int flags) const override;
+
     ssize_t Recv(void *buf, size_t len, int flags) const override;
 
     std::unique_ptr<Sock> Accept(sockaddr *addr,
@@ -12,6 +12,7 @@
 #include <util/strencodings.h>
 #include <util/string.h>
 
+#include <test/util/random.h>
 #include <test/util/setup_common.h>
 
 #include <boost/test/unit_test.hpp>
@@ -377,6 +378,58 @@ BOOST_AUTO_TEST_CASE(key_signature_tests) {
     BOOST_CHECK(found_small);
 }
 
+BOOST_AUTO_TEST_CASE(schnorr_batch) {
+    SchnorrBatch batch;
+    BOOST_CHECK(batch.Verify());
+
+    std::vector<CKey> keys;
+    std::vector<uint256> hashes;
+    std::vector<std::vector<uint8_t>> sigs;
+    for (int i = 0; i < 40; ++i) {
+        CKey &key = keys.emplace_back();
+        key.MakeNewKey(true);
+        hashes.push_back(InsecureRand256());
+        BOOST_CHECK(key.SignSchnorr(hashes.back(), sigs.emplace_back()));
+        batch.Add(key.GetPubKey(), hashes.back(), sigs.back());
+        BOOST_CHECK(batch.Verify());
+    }
+    BOOST_CHECK_EQUAL(batch.size(), 40U);
+    BOOST_CHECK(batch.VerifyEach() == std::vector<bool>(40, true));
+
+    // A single invalid signature, or a signature for another key or message,
+    // fails the whole batch.
+    for (int i = 0; i < 10; ++i) {
+        const size_t j = InsecureRandRange(keys.size());
+        for (int fault = 0; fault < 3; ++fault) {
+            batch.clear();
+            for (size_t k = 0; k < keys.size(); ++k) {
+                CPubKey pubkey = keys[k].GetPubKey();
+                uint256 hash = hashes[k];
+                std::vector<uint8_t> sig = sigs[k];
+                if (k == j) {
+                    if (fault == 0) {
+                        sig[InsecureRandRange(sig.size())] ^= 1;
+                    } else if (fault == 1) {
+                        pubkey = keys[(k + 1) % keys.size()].GetPubKey();
+                    } else {
+                        hash = InsecureRand256();
+                    }
+                    BOOST_CHECK(!pubkey.VerifySchnorr(hash, sig));
+                }
+                batch.Add(pubkey, hash, sig);
+            }
+            BOOST_CHECK(!batch.Verify());
+
+            // Only the faulty signature is reported invalid
+            const std::vector<bool> valid = batch.VerifyEach();
+            BOOST_CHECK_EQUAL(valid.size(), keys.size());
+            for (size_t k = 0; k < keys.size(); ++k) {
+                BOOST_CHECK_EQUAL(valid[k], k != j);
+            }
+        }
+    }
+}
+
 BOOST_AUTO_TEST_CASE(key_key_negation) {
     // create a dummy hash for signature comparison
     uint8_t rnd[8];
@@ -831,6 +831,92 @@ BOOST_AUTO_TEST_CASE(BlockAssembler_construction) {
     }
 }
 
+BOOST_FIXTURE_TEST_CASE(BlockTemplateCandidates_incremental,
+                        TestChain100Setup) {
+    CTxMemPool &mempool = *m_node.mempool;
+    const CScript scriptPubKey =
+        GetScriptForDestination(PKHash(coinbaseKey.GetPubKey()));
+
+    auto createBlock = [&]() {
+        return BlockAssembler{m_node.chainman->ActiveChainstate(), &mempool,
+                              BlockAssembler::Options()}
+            .CreateNewBlock(scriptPubKey);
+    };
+    auto blockTxIds = [](const CBlockTemplate &blocktemplate) {
+        const std::vector<CTransactionRef> &vtx = blocktemplate.block.vtx;
+        // Regtest blocks are canonically ordered.
+        BOOST_CHECK(std::is_sorted(vtx.begin() + 1, vtx.end(),
+                                   [](const auto &a, const auto &b) {
+                                       return a->GetId() < b->GetId();
+                                   }));
+        std::set<TxId> txids;
+        for (auto it = vtx.begin() + 1; it != vtx.end(); ++it) {
+            txids.insert((*it)->GetId());
+        }
+        return txids;
+    };
+    auto numCandidates = [&]() {
+        LOCK(mempool.cs);
+        return mempool.m_template_candidates.GetEntries().size();
+    };
+
+    // Mature the second coinbase.
+    CreateAndProcessBlock({}, scriptPubKey);
+
+    const CTransactionRef tx0 = MakeTransactionRef(
+        CreateValidMempoolTransaction(m_coinbase_txns[0], 0, 0, coinbaseKey,
+                                      scriptPubKey, 49 * COIN));
+    BOOST_CHECK(blockTxIds(*createBlock()) == std::set<TxId>{tx0->GetId()});
+    // Nothing changed, the same template is made again.
+    BOOST_CHECK(blockTxIds(*createBlock()) == std::set<TxId>{tx0->GetId()});
+
+    // New transactions are added to the selection as they enter the mempool,
+    // children included.
+    const CTransactionRef tx1 = MakeTransactionRef(
+        CreateValidMempoolTransaction(tx0, 0, 101, coinbaseKey, scriptPubKey,
+                                      48 * COIN));
+    const CTransactionRef tx2 = MakeTransactionRef(
+        CreateValidMempoolTransaction(m_coinbase_txns[1], 0, 0, coinbaseKey,
+                                      scriptPubKey, 49 * COIN));
+    BOOST_CHECK_EQUAL(numCandidates(), 3);
+    const std::set<TxId> allTxIds{tx0->GetId(), tx1->GetId(), tx2->GetId()};
+    BOOST_CHECK(blockTxIds(*createBlock()) == allTxIds);
+
+    // Transactions that can't be included in the next block are left out, as
+    // when the template is made from scratch.
+    CMutableTransaction nonFinal;
+    nonFinal.vin.emplace_back(COutPoint(m_coinbase_txns[2]->GetId(), 0),
+                              CScript() << OP_1, CTxIn::SEQUENCE_FINAL - 1);
+    nonFinal.vout.emplace_back(49 * COIN, scriptPubKey);
+    nonFinal.nLockTime = m_node.chainman->ActiveHeight() + 1;
+    {
+        LOCK2(cs_main, mempool.cs);
+        mempool.addUnchecked(
+            TestMemPoolEntryHelper{}.Fee(COIN).Time(GetTime()).FromTx(
+                nonFinal));
+    }
+    BOOST_CHECK_EQUAL(numCandidates(), 3);
+    BOOST_CHECK(blockTxIds(*createBlock()) == allTxIds);
+    WITH_LOCK(mempool.cs, mempool.removeRecursive(
+                              CTransaction{nonFinal},
+                              MemPoolRemovalReason::CONFLICT));
+
+    // The same template is made from scratch.
+    WITH_LOCK(mempool.cs, mempool.m_template_candidates.Invalidate());
+    BOOST_CHECK(blockTxIds(*createBlock()) == allTxIds);
+
+    // Removed transactions leave the selection along with their descendants.
+    WITH_LOCK(mempool.cs,
+              mempool.removeRecursive(*tx0, MemPoolRemovalReason::CONFLICT));
+    BOOST_CHECK_EQUAL(numCandidates(), 1);
+    BOOST_CHECK(blockTxIds(*createBlock()) == std::set<TxId>{tx2->GetId()});
+
+    // Connecting a block drops the selection.
+    CreateAndProcessBlock({CMutableTransaction(*tx2)}, scriptPubKey);
+    BOOST_CHECK_EQUAL(numCandidates(), 0);
+    BOOST_CHECK(blockTxIds(*createBlock()).empty());
+}
+
 BOOST_AUTO_TEST_CASE(TestCBlockTemplateEntry) {
     const CTransaction tx;
     CTransactionRef txRef = MakeTransactionRef(tx);
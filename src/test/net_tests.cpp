@@ -12,21 +12,30 @@
 #include <clientversion.h>
 #include <compat.h>
 #include <config.h>
+#include <crypto/common.h>
+#include <kernel/mempool_entry.h>
+#include <logging.h>
 #include <net_processing.h>
 #include <netaddress.h>
 #include <netbase.h>
 #include <netmessagemaker.h>
+#include <protocol.h>
+#include <script/script.h>
 #include <serialize.h>
 #include <span.h>
 #include <streams.h>
 #include <test/util/validation.h>
 #include <threadsafety.h>
 #include <timedata.h>
+#include <txmempool.h>
 #include <util/strencodings.h>
 #include <util/string.h>
+#include <util/time.h>
 #include <util/translation.h> // for bilingual_str
+#include <validation.h>
 #include <version.h>
 
+#include <test/util/net.h>
 #include <test/util/setup_common.h>
 
 #include <boost/test/unit_test.hpp>
@@ -39,6 +48,7 @@
 #include <functional>
 #include <ios>
 #include <memory>
+#include <numeric>
 #include <string>
 
 using namespace std::literals;
@@ -52,6 +62,7 @@ static CNetAddr ip(uint32_t ip) {
 namespace {
 struct CConnmanTest : public CConnman {
     using CConnman::CConnman;
+    using CConnman::SocketSendData;
 
     Mutex cs;
     size_t outboundFullRelayCount GUARDED_BY(cs);
@@ -1392,4 +1403,431 @@ BOOST_AUTO_TEST_CASE(already_connected_to_address) {
     BOOST_CHECK(connman.AlreadyConnectedToAddress(ip1port2));
 }
 
+/**
+ * A mocked Sock that accepts at most a fixed number of bytes per send call and
+ * records what was sent.
+ */
+class PartialSendSock : public Sock {
+public:
+    explicit PartialSendSock(size_t max_bytes) : m_max_bytes{max_bytes} {
+        m_socket = 1000;
+    }
+
+    ~PartialSendSock() override { Reset(); }
+
+    PartialSendSock &operator=(Sock &&other) override {
+        assert(false && "Move of Sock into PartialSendSock not allowed.");
+        return *this;
+    }
+
+    void Reset() override { m_socket = INVALID_SOCKET; }
+
+    ssize_t SendMany(Span<const Span<const uint8_t>> data,
+                     int) const override {
+        ++m_calls;
+        size_t sent{0};
+        for (const auto &buf : data) {
+            const size_t len{std::min(buf.size(), m_max_bytes - sent)};
+            m_sent.insert(m_sent.end(), buf.begin(), buf.begin() + len);
+            sent += len;
+            if (sent == m_max_bytes) {
+                break;
+            }
+        }
+        return sent;
+    }
+
+    mutable std::vector<uint8_t> m_sent;
+    mutable size_t m_calls{0};
+
+private:
+    const size_t m_max_bytes;
+};
+
+BOOST_AUTO_TEST_CASE(socket_send_data_gathers_messages) {
+    CConnmanTest connman(m_node.chainman->GetConfig(), 0x1337, 0x1337,
+                         *m_node.addrman);
+
+    for (const size_t max_bytes : {size_t{7}, size_t{24}, size_t{100000}}) {
+        auto sock{std::make_shared<PartialSendSock>(max_bytes)};
+        CNode node{/*id=*/0,
+                   sock,
+                   /*addrIn=*/CAddress{},
+                   /*nKeyedNetGroupIn=*/0,
+                   /*nLocalHostNonceIn=*/0,
+                   /*nLocalExtraEntropyIn=*/0,
+                   /*addrBindIn=*/CAddress{},
+                   /*addrNameIn=*/std::string{},
+                   /*conn_type_in=*/ConnectionType::OUTBOUND_FULL_RELAY,
+                   /*inbound_onion=*/false};
+
+        LOCK(node.cs_vSend);
+        std::vector<uint8_t> expected;
+        for (const size_t size : {24, 100, 24, 1, 24, 50}) {
+            std::vector<uint8_t> msg(size);
+            std::iota(msg.begin(), msg.end(), uint8_t(expected.size()));
+            expected.insert(expected.end(), msg.begin(), msg.end());
+            node.nSendSize += msg.size();
+            node.vSendMsg.push_back(std::move(msg));
+        }
+
+        // Everything that fits in a call is sent with that call, and the
+        // following call resumes where the previous one stopped.
+        const size_t num_calls{(expected.size() + max_bytes - 1) / max_bytes};
+        for (size_t i = 0; i < num_calls; ++i) {
+            const auto [sent, data_left] = connman.SocketSendData(node);
+            BOOST_CHECK_EQUAL(sent, std::min(max_bytes, expected.size() -
+                                                            i * max_bytes));
+            BOOST_CHECK_EQUAL(data_left, i + 1 < num_calls);
+        }
+        BOOST_CHECK_EQUAL(sock->m_calls, num_calls);
+        BOOST_CHECK(sock->m_sent == expected);
+        BOOST_CHECK(node.vSendMsg.empty());
+        BOOST_CHECK_EQUAL(node.nSendOffset, 0U);
+        BOOST_CHECK_EQUAL(node.nSendSize, 0U);
+        BOOST_CHECK_EQUAL(node.nSendBytes, expected.size());
+    }
+}
+
+/** Take the messages queued for sending to a node without a socket. */
+static std::vector<std::pair<std::string, std::vector<uint8_t>>>
+TakeSentMessages(const Config &config, CNode &node) {
+    std::vector<std::pair<std::string, std::vector<uint8_t>>> sent;
+    LOCK(node.cs_vSend);
+    for (auto it = node.vSendMsg.begin(); it != node.vSendMsg.end(); ++it) {
+        CMessageHeader header{config.GetChainParams().NetMagic()};
+        CDataStream{*it, SER_NETWORK, PROTOCOL_VERSION} >> header;
+        std::vector<uint8_t> payload;
+        if (header.nMessageSize > 0) {
+            payload = *++it;
+        }
+        sent.emplace_back(header.GetCommand(), std::move(payload));
+    }
+    node.vSendMsg.clear();
+    node.nSendSize = 0;
+    return sent;
+}
+
+BOOST_AUTO_TEST_CASE(recv_buffer_pool) {
+    RecvBufferPool pool;
+
+    // Buffers come from the smallest size class fitting the payload and are
+    // recycled once given back.
+    CDataStream stream{pool.Acquire(100, SER_NETWORK, PROTOCOL_VERSION)};
+    BOOST_CHECK(stream.empty());
+    BOOST_CHECK_EQUAL(stream.capacity(), RecvBufferPool::MIN_BUFFER_SIZE);
+    stream.resize(100);
+    const auto *buffer{stream.data()};
+    pool.Release(std::move(stream));
+    BOOST_CHECK_EQUAL(pool.GetPooledBytes(), RecvBufferPool::MIN_BUFFER_SIZE);
+
+    // A larger payload needs a buffer of another size class.
+    CDataStream larger{pool.Acquire(1000, SER_NETWORK, PROTOCOL_VERSION)};
+    BOOST_CHECK_EQUAL(larger.capacity(), 4 * RecvBufferPool::MIN_BUFFER_SIZE);
+    BOOST_CHECK_EQUAL(pool.GetPooledBytes(), RecvBufferPool::MIN_BUFFER_SIZE);
+
+    stream = pool.Acquire(RecvBufferPool::MIN_BUFFER_SIZE, SER_DISK,
+                          INIT_PROTO_VERSION);
+    BOOST_CHECK(stream.empty());
+    BOOST_CHECK_EQUAL(stream.GetType(), SER_DISK);
+    BOOST_CHECK_EQUAL(stream.GetVersion(), INIT_PROTO_VERSION);
+    stream.resize(1);
+    BOOST_CHECK(stream.data() == buffer);
+    BOOST_CHECK_EQUAL(pool.GetPooledBytes(), 0);
+
+    // The buffers of the payloads too large to be pooled are freed.
+    CDataStream oversized{pool.Acquire(RecvBufferPool::MAX_BUFFER_SIZE + 1,
+                                       SER_NETWORK, PROTOCOL_VERSION)};
+    BOOST_CHECK_EQUAL(oversized.capacity(), 0);
+    oversized.resize(4 * RecvBufferPool::MAX_BUFFER_SIZE);
+    pool.Release(std::move(oversized));
+    BOOST_CHECK_EQUAL(pool.GetPooledBytes(), 0);
+
+    // The pool does not hold more than MAX_POOLED_BYTES.
+    std::vector<CDataStream> streams;
+    for (size_t i = 0; i <= RecvBufferPool::MAX_POOLED_BYTES /
+                                RecvBufferPool::MAX_BUFFER_SIZE;
+         ++i) {
+        streams.push_back(pool.Acquire(RecvBufferPool::MAX_BUFFER_SIZE,
+                                       SER_NETWORK, PROTOCOL_VERSION));
+    }
+    for (auto &s : streams) {
+        pool.Release(std::move(s));
+    }
+    BOOST_CHECK_EQUAL(pool.GetPooledBytes(), RecvBufferPool::MAX_POOLED_BYTES);
+}
+
+BOOST_AUTO_TEST_CASE(deserializer_recycles_recv_buffers) {
+    const Config &config = m_node.chainman->GetConfig();
+    auto pool{std::make_shared<RecvBufferPool>()};
+    V1TransportDeserializer deserializer{config.GetChainParams().NetMagic(),
+                                         SER_NETWORK, PROTOCOL_VERSION, pool};
+    V1TransportSerializer serializer;
+    const CNetMsgMaker msg_maker{PROTOCOL_VERSION};
+
+    for (const uint64_t nonce : {1, 2, 3}) {
+        CSerializedNetMsg ping{msg_maker.Make(NetMsgType::PING, nonce)};
+        std::vector<uint8_t> wire;
+        serializer.prepareForTransport(config, ping, wire);
+        wire.insert(wire.end(), ping.data.begin(), ping.data.end());
+
+        // Feed the message one byte at a time, the checksum is computed as
+        // the payload comes in.
+        Span<const uint8_t> msg_bytes{wire};
+        while (!msg_bytes.empty()) {
+            Span<const uint8_t> byte{msg_bytes.first(1)};
+            BOOST_CHECK_EQUAL(deserializer.Read(config, byte), 1);
+            msg_bytes = msg_bytes.subspan(1);
+        }
+        BOOST_REQUIRE(deserializer.Complete());
+
+        // The buffer given back by the previous message is reused.
+        BOOST_CHECK_EQUAL(pool->GetPooledBytes(), 0);
+        {
+            CNetMessage msg{
+                deserializer.GetMessage(config, std::chrono::microseconds{0})};
+            BOOST_CHECK(msg.m_valid_checksum);
+            BOOST_CHECK_EQUAL(msg.m_type, NetMsgType::PING);
+            uint64_t received_nonce;
+            msg.m_recv >> received_nonce;
+            BOOST_CHECK_EQUAL(received_nonce, nonce);
+        }
+        BOOST_CHECK_EQUAL(pool->GetPooledBytes(),
+                          RecvBufferPool::MIN_BUFFER_SIZE);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(process_messages_in_background) {
+    LOCK(NetEventsInterface::g_msgproc_mutex);
+
+    const Config &config = m_node.chainman->GetConfig();
+    ConnmanTestMsg &connman = static_cast<ConnmanTestMsg &>(*m_node.connman);
+
+    in_addr ipv4Addr;
+    ipv4Addr.s_addr = 0xa0b0c001;
+    CNode node{/*id=*/0,
+               /*sock=*/nullptr,
+               /*addrIn=*/CAddress{CService{ipv4Addr, 7777}, NODE_NETWORK},
+               /*nKeyedNetGroupIn=*/0,
+               /*nLocalHostNonceIn=*/0,
+               /*nLocalExtraEntropyIn=*/0,
+               /*addrBindIn=*/CAddress{},
+               /*addrNameIn=*/std::string{},
+               /*conn_type_in=*/ConnectionType::INBOUND,
+               /*inbound_onion=*/false};
+    connman.Handshake(node, /*successfully_connected=*/true,
+                      /*remote_services=*/ServiceFlags(NODE_NETWORK),
+                      /*local_services=*/ServiceFlags(NODE_NETWORK),
+                      /*version=*/PROTOCOL_VERSION, /*relay_txs=*/true);
+    {
+        LOCK(node.cs_vSend);
+        node.vSendMsg.clear();
+        node.nSendSize = 0;
+    }
+
+    connman.StartMessageWorkers(2);
+
+    // Pings and getdata are processed by the worker threads, which must not
+    // reorder the replies.
+    const CNetMsgMaker msg_maker{PROTOCOL_VERSION};
+    const BlockHash genesis_hash{
+        config.GetChainParams().GenesisBlock().GetHash()};
+    CSerializedNetMsg ping1{msg_maker.Make(NetMsgType::PING, uint64_t{1})};
+    CSerializedNetMsg getdata{msg_maker.Make(
+        NetMsgType::GETDATA, std::vector<CInv>{CInv{MSG_BLOCK, genesis_hash}})};
+    CSerializedNetMsg ping2{msg_maker.Make(NetMsgType::PING, uint64_t{2})};
+    (void)connman.ReceiveMsgFrom(node, ping1);
+    (void)connman.ReceiveMsgFrom(node, getdata);
+    (void)connman.ReceiveMsgFrom(node, ping2);
+
+    // A node is referenced while one of its messages is being processed in the
+    // background.
+    while (node.GetRefCount() > 0 ||
+           WITH_LOCK(node.cs_vProcessMsg, return !node.vProcessMsg.empty())) {
+        node.fPauseSend = false;
+        connman.ProcessMessagesOnce(node);
+    }
+
+    connman.StopMessageWorkers();
+    m_node.peerman->FinalizeNode(config, node);
+
+    const auto sent{TakeSentMessages(config, node)};
+    BOOST_REQUIRE_EQUAL(sent.size(), 3);
+    BOOST_CHECK_EQUAL(sent[0].first, NetMsgType::PONG);
+    BOOST_CHECK_EQUAL(ReadLE64(sent[0].second.data()), 1);
+    BOOST_CHECK_EQUAL(sent[1].first, NetMsgType::BLOCK);
+    BOOST_CHECK_EQUAL(sent[2].first, NetMsgType::PONG);
+    BOOST_CHECK_EQUAL(ReadLE64(sent[2].second.data()), 2);
+}
+
+BOOST_AUTO_TEST_CASE(serve_blocks_in_background) {
+    LOCK(NetEventsInterface::g_msgproc_mutex);
+
+    const Config &config = m_node.chainman->GetConfig();
+    ConnmanTestMsg &connman = static_cast<ConnmanTestMsg &>(*m_node.connman);
+
+    in_addr ipv4Addr;
+    ipv4Addr.s_addr = 0xa0b0c001;
+    CNode node{/*id=*/0,
+               /*sock=*/nullptr,
+               /*addrIn=*/CAddress{CService{ipv4Addr, 7777}, NODE_NETWORK},
+               /*nKeyedNetGroupIn=*/0,
+               /*nLocalHostNonceIn=*/0,
+               /*nLocalExtraEntropyIn=*/0,
+               /*addrBindIn=*/CAddress{},
+               /*addrNameIn=*/std::string{},
+               /*conn_type_in=*/ConnectionType::INBOUND,
+               /*inbound_onion=*/false};
+    connman.Handshake(node, /*successfully_connected=*/true,
+                      /*remote_services=*/ServiceFlags(NODE_NETWORK),
+                      /*local_services=*/ServiceFlags(NODE_NETWORK),
+                      /*version=*/PROTOCOL_VERSION, /*relay_txs=*/true);
+    (void)TakeSentMessages(config, node);
+    node.fPauseSend = false;
+
+    // Record the name of the thread sending each block.
+    const bool log_threadnames{LogInstance().m_log_threadnames};
+    const bool log_netdebug{LogInstance().WillLogCategory(BCLog::NETDEBUG)};
+    LogInstance().m_log_threadnames = true;
+    LogInstance().EnableCategory(BCLog::NETDEBUG);
+    Mutex senders_mutex;
+    std::vector<std::string> senders;
+    const auto print_callback{
+        LogInstance().PushBackCallback([&](const std::string &str) {
+            if (str.find("sending block ") != std::string::npos) {
+                LOCK(senders_mutex);
+                senders.push_back(str);
+            }
+        })};
+
+    connman.StartMessageWorkers(2);
+
+    // The test connman has no send buffer, so it is full after each block and
+    // the worker serving them stops until it drains.
+    constexpr size_t NUM_BLOCKS{10};
+    const CNetMsgMaker msg_maker{PROTOCOL_VERSION};
+    const BlockHash genesis_hash{
+        config.GetChainParams().GenesisBlock().GetHash()};
+    CSerializedNetMsg getdata{msg_maker.Make(
+        NetMsgType::GETDATA,
+        std::vector<CInv>(NUM_BLOCKS, CInv{MSG_BLOCK, genesis_hash}))};
+    (void)connman.ReceiveMsgFrom(node, getdata);
+
+    size_t served{0};
+    for (int i = 0; i < 1000 && served < NUM_BLOCKS; ++i) {
+        connman.ProcessMessagesOnce(node);
+        // Wait for the worker thread to complete.
+        while (node.GetRefCount() > 0) {
+            UninterruptibleSleep(1ms);
+        }
+
+        const auto sent{TakeSentMessages(config, node)};
+        BOOST_CHECK_LE(sent.size(), 1);
+        for (const auto &[msg_type, payload] : sent) {
+            BOOST_CHECK_EQUAL(msg_type, NetMsgType::BLOCK);
+            ++served;
+        }
+
+        // Drain the send buffer like the socket handler does. The message
+        // handler is to be woken up as long as there are blocks left.
+        if (node.fPauseSend) {
+            BOOST_CHECK_EQUAL(node.m_wake_msghand_on_send.exchange(false),
+                              served < NUM_BLOCKS);
+            node.fPauseSend = false;
+        }
+    }
+
+    connman.StopMessageWorkers();
+    m_node.peerman->FinalizeNode(config, node);
+    LogInstance().DeleteCallback(print_callback);
+    LogInstance().m_log_threadnames = log_threadnames;
+    if (!log_netdebug) {
+        LogInstance().DisableCategory(BCLog::NETDEBUG);
+    }
+
+    // All the blocks were served by the worker threads.
+    BOOST_CHECK_EQUAL(served, NUM_BLOCKS);
+    LOCK(senders_mutex);
+    BOOST_CHECK_EQUAL(senders.size(), NUM_BLOCKS);
+    for (const std::string &sender : senders) {
+        BOOST_CHECK_MESSAGE(sender.find("[msgproc.") != std::string::npos,
+                            sender);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(relay_transaction_batch) {
+    LOCK(NetEventsInterface::g_msgproc_mutex);
+
+    const Config &config = m_node.chainman->GetConfig();
+    ConnmanTestMsg &connman = static_cast<ConnmanTestMsg &>(*m_node.connman);
+    CTxMemPool &mempool = *m_node.mempool;
+    // Freeze the time, so the transactions are only announced once it moves.
+    SetMockTime(GetTime());
+
+    in_addr ipv4Addr;
+    ipv4Addr.s_addr = 0xa0b0c001;
+    CNode node{/*id=*/0,
+               /*sock=*/nullptr,
+               /*addrIn=*/CAddress{CService{ipv4Addr, 7777}, NODE_NETWORK},
+               /*nKeyedNetGroupIn=*/0,
+               /*nLocalHostNonceIn=*/0,
+               /*nLocalExtraEntropyIn=*/0,
+               /*addrBindIn=*/CAddress{},
+               /*addrNameIn=*/std::string{},
+               /*conn_type_in=*/ConnectionType::OUTBOUND_FULL_RELAY,
+               /*inbound_onion=*/false};
+    connman.Handshake(node, /*successfully_connected=*/true,
+                      /*remote_services=*/ServiceFlags(NODE_NETWORK),
+                      /*local_services=*/ServiceFlags(NODE_NETWORK),
+                      /*version=*/PROTOCOL_VERSION, /*relay_txs=*/true);
+    TakeSentMessages(config, node);
+
+    // A parent and its child, relayed in reverse order, and a transaction
+    // that leaves the mempool before it is announced.
+    std::vector<CTransactionRef> txs;
+    for (int i = 0; i < 3; ++i) {
+        CMutableTransaction tx;
+        tx.vin.resize(1);
+        if (i == 1) {
+            tx.vin[0].prevout = COutPoint{txs[0]->GetId(), 0};
+        } else {
+            tx.vin[0].scriptSig = CScript() << CScriptNum(i);
+        }
+        tx.vout.resize(1);
+        tx.vout[0].scriptPubKey = CScript() << OP_TRUE;
+        tx.vout[0].nValue = COIN;
+        txs.push_back(MakeTransactionRef(tx));
+
+        LOCK2(cs_main, mempool.cs);
+        LockPoints lp;
+        mempool.addUnchecked(CTxMemPoolEntryRef::make(
+            txs.back(), 1000 * SATOSHI, /*time=*/0, /*height=*/1,
+            /*sigChecks=*/1, lp));
+    }
+    m_node.peerman->RelayTransaction(txs[2]->GetId());
+    m_node.peerman->RelayTransaction(txs[1]->GetId());
+    m_node.peerman->RelayTransaction(txs[0]->GetId());
+    m_node.peerman->SendMessages(config, &node);
+    WITH_LOCK(mempool.cs, mempool.removeRecursive(
+                              *txs[2], MemPoolRemovalReason::CONFLICT));
+
+    SetMockTime(GetTime() + 60);
+    m_node.peerman->SendMessages(config, &node);
+
+    std::vector<CInv> invs;
+    for (const auto &[msg_type, payload] : TakeSentMessages(config, node)) {
+        if (msg_type == NetMsgType::INV) {
+            CDataStream{payload, SER_NETWORK, PROTOCOL_VERSION} >> invs;
+        }
+    }
+    BOOST_REQUIRE_EQUAL(invs.size(), 2);
+    BOOST_CHECK_EQUAL(invs[0].type, MSG_TX);
+    BOOST_CHECK_EQUAL(invs[0].hash, txs[0]->GetId());
+    BOOST_CHECK_EQUAL(invs[1].type, MSG_TX);
+    BOOST_CHECK_EQUAL(invs[1].hash, txs[1]->GetId());
+
+    SetMockTime(0);
+    m_node.peerman->FinalizeNode(config, node);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
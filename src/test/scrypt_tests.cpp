@@ -70,6 +70,27 @@ BOOST_AUTO_TEST_CASE(scrypt_hashtest) {
                                        scratchpad);
         BOOST_CHECK_EQUAL(scrypthash.ToString().c_str(), test_case.output);
     }
+
+    // Test the multi-lane API over every batch size up to two full batches,
+    // cycling through the test vectors.
+    for (size_t n = 1; n <= 2 * SCRYPT_MAX_LANES; ++n) {
+        std::vector<std::vector<uint8_t>> inputs;
+        std::vector<uint256> hashes(n);
+        std::vector<const uint8_t *> input_ptrs;
+        std::vector<uint8_t *> output_ptrs;
+        for (size_t i = 0; i < n; ++i) {
+            inputs.push_back(ParseHex(TEST_CASES[i % TEST_CASES.size()].input));
+        }
+        for (size_t i = 0; i < n; ++i) {
+            input_ptrs.push_back(inputs[i].data());
+            output_ptrs.push_back(hashes[i].data());
+        }
+        scrypt_1024_1_1_256_multi(input_ptrs.data(), output_ptrs.data(), n);
+        for (size_t i = 0; i < n; ++i) {
+            BOOST_CHECK_EQUAL(hashes[i].ToString(),
+                              TEST_CASES[i % TEST_CASES.size()].output);
+        }
+    }
 }
 
 BOOST_AUTO_TEST_SUITE_END()
@@ -8,6 +8,7 @@
 #include <compat.h>
 #include <test/util/setup_common.h>
 #include <threadinterrupt.h>
+#include <util/sockwaitset.h>
 
 #include <boost/test/unit_test.hpp>
 
@@ -139,6 +140,52 @@ BOOST_AUTO_TEST_CASE(wait) {
     waiter.join();
 }
 
+BOOST_AUTO_TEST_CASE(wait_set) {
+    for (const bool use_epoll : {true, false}) {
+        const std::unique_ptr<SockWaitSet> wait_set{MakeSockWaitSet(use_epoll)};
+        Sock::EventsPerSock events_per_sock;
+
+        // Nothing to wait on.
+        BOOST_CHECK(!wait_set->Wait(0ms, events_per_sock));
+
+        int s[2];
+        CreateSocketPair(s);
+        const auto sock0{std::make_shared<const Sock>(s[0])};
+        const auto sock1{std::make_shared<const Sock>(s[1])};
+
+        wait_set->Set(sock0, Sock::RECV);
+        wait_set->Set(sock1, Sock::RECV);
+        BOOST_CHECK_EQUAL(wait_set->Size(), 2U);
+
+        // Neither socket is readable yet.
+        BOOST_REQUIRE(wait_set->Wait(0ms, events_per_sock));
+        for (const auto &[sock, events] : events_per_sock) {
+            BOOST_CHECK_EQUAL(events.occurred, 0);
+        }
+
+        BOOST_REQUIRE_EQUAL(sock1->Send("a", 1, 0), 1);
+        BOOST_REQUIRE(wait_set->Wait(1min, events_per_sock));
+        BOOST_CHECK(events_per_sock.at(sock0).occurred & Sock::RECV);
+        if (auto it = events_per_sock.find(sock1);
+            it != events_per_sock.end()) {
+            BOOST_CHECK_EQUAL(it->second.occurred, 0);
+        }
+
+        // Updating the requested events is reflected by the next wait.
+        wait_set->Set(sock1, Sock::RECV | Sock::SEND);
+        BOOST_CHECK_EQUAL(wait_set->Size(), 2U);
+        BOOST_REQUIRE(wait_set->Wait(1min, events_per_sock));
+        BOOST_CHECK(events_per_sock.at(sock1).occurred & Sock::SEND);
+
+        // Removed sockets are not reported anymore.
+        wait_set->Set(sock0, 0);
+        wait_set->Set(sock1, 0);
+        BOOST_CHECK_EQUAL(wait_set->Size(), 0U);
+        BOOST_CHECK(!wait_set->Wait(0ms, events_per_sock));
+        BOOST_CHECK(events_per_sock.empty());
+    }
+}
+
 BOOST_AUTO_TEST_CASE(recv_until_terminator_limit) {
     // High enough timeout so that it is never hit.
     constexpr auto timeout = 1min;
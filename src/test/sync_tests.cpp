@@ -7,7 +7,9 @@
 
 #include <boost/test/unit_test.hpp>
 
+#include <chrono>
 #include <mutex>
+#include <thread>
 
 namespace {
 template <typename MutexType>
@@ -87,6 +89,10 @@ BOOST_AUTO_TEST_CASE(potential_deadlock_detected) {
     // exception.
     TestPotentialDeadLockDetected(rmutex1, rmutex2);
 
+    HeldTimeRecursiveMutex htmutex1, htmutex2;
+    TestPotentialDeadLockDetected(htmutex1, htmutex2);
+    TestPotentialDeadLockDetected(htmutex1, htmutex2);
+
     Mutex mutex1, mutex2;
     TestPotentialDeadLockDetected(mutex1, mutex2);
     // The second test ensures that lock tracking data have not been broken by
@@ -135,7 +141,39 @@ BOOST_AUTO_TEST_CASE(double_lock_mutex) {
 
 BOOST_AUTO_TEST_CASE(double_lock_recursive_mutex) {
     TestDoubleLock<RecursiveMutex>(false /* should not throw */);
+    TestDoubleLock<HeldTimeRecursiveMutex>(false /* should not throw */);
 }
 #endif /* DEBUG_LOCKORDER */
 
+BOOST_AUTO_TEST_CASE(held_time_recursive_mutex) {
+    HeldTimeRecursiveMutex mutex;
+    const auto held_time_before{HeldTimeRecursiveMutex::GetThreadHeldTime()};
+    const auto start{std::chrono::steady_clock::now()};
+    {
+        LOCK(mutex);
+        {
+            // The time is accounted for once the outermost lock is released.
+            LOCK(mutex);
+            std::this_thread::sleep_for(std::chrono::milliseconds{10});
+        }
+        BOOST_CHECK(HeldTimeRecursiveMutex::GetThreadHeldTime() ==
+                    held_time_before);
+    }
+    const auto elapsed{std::chrono::steady_clock::now() - start};
+    const auto held_time{HeldTimeRecursiveMutex::GetThreadHeldTime() -
+                         held_time_before};
+    BOOST_CHECK(held_time >= std::chrono::milliseconds{10});
+    BOOST_CHECK(held_time <= elapsed);
+
+    // Each thread accounts for its own time.
+    std::thread{[&] {
+        BOOST_CHECK(HeldTimeRecursiveMutex::GetThreadHeldTime() ==
+                    std::chrono::nanoseconds{0});
+        TRY_LOCK(mutex, locked);
+        BOOST_CHECK(bool{locked});
+    }}.join();
+    BOOST_CHECK(HeldTimeRecursiveMutex::GetThreadHeldTime() ==
+                held_time_before + held_time);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
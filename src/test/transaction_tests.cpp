@@ -454,6 +454,65 @@ BOOST_AUTO_TEST_CASE(test_big_transaction) {
     scriptcheckqueue.StopWorkerThreads();
 }
 
+BOOST_AUTO_TEST_CASE(test_batched_script_check) {
+    // Without NULLFAIL, a script may deliberately contain an invalid signature.
+    const uint32_t flags = SCRIPT_VERIFY_P2SH | SCRIPT_VERIFY_STRICTENC |
+                           SCRIPT_ENABLE_SIGHASH_FORKID;
+    const Amount amount = 1000 * SATOSHI;
+    CKey key;
+    key.MakeNewKey(true);
+    const CScript p2pk = CScript() << ToByteVector(key.GetPubKey())
+                                   << OP_CHECKSIG;
+    const CScript p2pk_not = CScript() << ToByteVector(key.GetPubKey())
+                                       << OP_CHECKSIG << OP_NOT;
+
+    const size_t n_inputs = 40;
+    CMutableTransaction mtx;
+    mtx.vin.resize(n_inputs + 1);
+    for (size_t i = 0; i < mtx.vin.size(); i++) {
+        mtx.vin[i].prevout = COutPoint(TxId(InsecureRand256()), 0);
+    }
+    mtx.vout.emplace_back(amount, CScript() << OP_1);
+
+    const auto schnorr_sig = [&](const CScript &script, size_t nIn, bool valid) {
+        const SigHashType sighash_type = SigHashType().withForkId();
+        uint256 hash = SignatureHash(script, CTransaction(mtx), nIn,
+                                     sighash_type, amount);
+        if (!valid) {
+            hash = InsecureRand256();
+        }
+        std::vector<uint8_t> sig;
+        BOOST_CHECK(key.SignSchnorr(hash, sig));
+        sig.push_back(uint8_t(sighash_type.getRawSigHashType()));
+        return sig;
+    };
+
+    // Check the last input with each of these script/signature combinations,
+    // together with n_inputs valid P2PK spends.
+    const std::vector<std::tuple<CScript, bool, bool>> cases{
+        {p2pk, true, true},
+        {p2pk, false, false},
+        {p2pk_not, false, true},
+        {p2pk_not, true, false},
+    };
+    for (const auto &[last_script, last_sig_valid, expected] : cases) {
+        for (size_t i = 0; i < n_inputs; i++) {
+            mtx.vin[i].scriptSig = CScript() << schnorr_sig(p2pk, i, true);
+        }
+        mtx.vin[n_inputs].scriptSig =
+            CScript() << schnorr_sig(last_script, n_inputs, last_sig_valid);
+
+        const CTransaction tx(mtx);
+        const PrecomputedTransactionData txdata(tx);
+        std::vector<CScriptCheck> checks;
+        for (size_t i = 0; i <= n_inputs; i++) {
+            checks.emplace_back(CTxOut(amount, i < n_inputs ? p2pk : last_script),
+                                tx, i, flags, false, txdata);
+        }
+        BOOST_CHECK_EQUAL(CBatchedScriptCheck(std::move(checks))(), expected);
+    }
+}
+
 SignatureData CombineSignatures(const CMutableTransaction &input1,
                                 const CMutableTransaction &input2,
                                 const CTransactionRef tx) {
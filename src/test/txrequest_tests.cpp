@@ -51,6 +51,9 @@ struct Runner {
      * tests.
      */
     std::multiset<std::pair<NodeId, TxId>> expired;
+
+    explicit Runner(InvRequestTrackerImplType type)
+        : txrequest{/*deterministic=*/false, type} {}
 };
 
 std::chrono::microseconds RandomTime8s() {
@@ -701,7 +704,7 @@ void BuildWeirdRequestsTest(Scenario &scenario) {
     scenario.Check(peer2, {}, 0, 0, 0, "q23");
 }
 
-void TestInterleavedScenarios() {
+void TestInterleavedScenarios(InvRequestTrackerImplType type) {
     // Create a list of functions which add tests to scenarios.
     std::vector<std::function<void(Scenario &)>> builders;
     // Add instances of every test, for every configuration.
@@ -724,7 +727,7 @@ void TestInterleavedScenarios() {
     // Randomly shuffle all those functions.
     Shuffle(builders.begin(), builders.end(), g_insecure_rand_ctx);
 
-    Runner runner;
+    Runner runner{type};
     auto starttime = RandomTime1y();
     // Construct many scenarios, and run (up to) 10 randomly-chosen tests
     // consecutively in each.
@@ -759,8 +762,11 @@ void TestInterleavedScenarios() {
 } // namespace
 
 BOOST_AUTO_TEST_CASE(TxRequestTest) {
-    for (int i = 0; i < 5; ++i) {
-        TestInterleavedScenarios();
+    for (const auto type : {InvRequestTrackerImplType::ORDERED,
+                            InvRequestTrackerImplType::FLAT}) {
+        for (int i = 0; i < 5; ++i) {
+            TestInterleavedScenarios(type);
+        }
     }
 }
 
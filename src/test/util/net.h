@@ -10,6 +10,7 @@
 #include <netaddress.h>
 #include <util/sock.h>
 
+#include <algorithm>
 #include <array>
 #include <cassert>
 #include <cstring>
@@ -35,6 +36,11 @@ struct ConnmanTestMsg : public CConnman {
         m_nodes.clear();
     }
 
+    void StartMessageWorkers(int num_workers) {
+        m_msgproc_workers.Start(num_workers);
+    }
+    void StopMessageWorkers() { m_msgproc_workers.Stop(); }
+
     void Handshake(CNode &node, bool successfully_connected,
                    ServiceFlags remote_services, ServiceFlags local_services,
                    int32_t version, bool relay_txs)
@@ -108,6 +114,16 @@ public:
 
     ssize_t Send(const void *, size_t len, int) const override { return len; }
 
+    ssize_t SendMany(Span<const Span<const uint8_t>> data,
+                     int) const override {
+        ssize_t len{0};
+        for (const auto &buf : data.first(std::min(data.size(),
+                                                   MAX_SEND_BUFFERS))) {
+            len += buf.size();
+        }
+        return len;
+    }
+
     ssize_t Recv(void *buf, size_t len, int flags) const override {
         const size_t consume_bytes{
             std::min(len, m_contents.size() - m_consumed)};
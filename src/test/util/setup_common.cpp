@@ -15,6 +15,7 @@
 #include <consensus/consensus.h>
 #include <consensus/merkle.h>
 #include <consensus/validation.h>
+#include <crypto/scrypt.h>
 #include <crypto/sha256.h>
 #include <init.h>
 #include <interfaces/chain.h>
@@ -140,6 +141,7 @@ BasicTestingSetup::BasicTestingSetup(
     AppInitParameterInteraction(config, *m_node.args);
     LogInstance().StartLogging();
     SHA256AutoDetect();
+    ScryptAutoDetect();
     ECC_Start();
     SetupEnvironment();
     SetupNetworking();
@@ -224,6 +226,8 @@ ChainTestingSetup::ChainTestingSetup(
     constexpr int script_check_threads = 2;
     StartScriptCheckWorkerThreads(script_check_threads);
     StartPowCheckWorkerThreads(script_check_threads);
+    StartCoinPrefetchWorkerThreads(script_check_threads);
+    StartCoinsDBWriteWorkerThreads(script_check_threads);
 }
 
 ChainTestingSetup::~ChainTestingSetup() {
@@ -232,6 +236,8 @@ ChainTestingSetup::~ChainTestingSetup() {
     }
     StopScriptCheckWorkerThreads();
     StopPowCheckWorkerThreads();
+    StopCoinPrefetchWorkerThreads();
+    StopCoinsDBWriteWorkerThreads();
     GetMainSignals().FlushBackgroundCallbacks();
     GetMainSignals().UnregisterBackgroundSignalScheduler();
     m_node.connman.reset();
@@ -15,8 +15,10 @@
 #include <util/fs.h>
 #include <util/fs_helpers.h>
 #include <util/getuniquepath.h>
+#include <util/histogram.h>
 #include <util/message.h> // For MessageSign(), MessageVerify(), MESSAGE_MAGIC
 #include <util/moneystr.h>
+#include <util/ringqueue.h>
 #include <util/spanparsing.h>
 #include <util/strencodings.h>
 #include <util/string.h>
@@ -34,6 +36,7 @@
 #include <cmath>
 #include <cstdint>
 #include <cstring>
+#include <memory>
 #include <optional>
 #include <utility>
 #ifndef WIN32
@@ -2924,4 +2927,72 @@ BOOST_AUTO_TEST_CASE(remove_prefix) {
     BOOST_CHECK_EQUAL(RemovePrefix("", ""), "");
 }
 
+BOOST_AUTO_TEST_CASE(duration_histogram) {
+    using namespace std::chrono_literals;
+
+    BOOST_CHECK_EQUAL(DurationHistogram::GetBucket(-1us), 0);
+    BOOST_CHECK_EQUAL(DurationHistogram::GetBucket(0us), 0);
+    BOOST_CHECK_EQUAL(DurationHistogram::GetBucket(1us), 0);
+    BOOST_CHECK_EQUAL(DurationHistogram::GetBucket(2us), 1);
+    BOOST_CHECK_EQUAL(DurationHistogram::GetBucket(3us), 1);
+    BOOST_CHECK_EQUAL(DurationHistogram::GetBucket(4us), 2);
+    BOOST_CHECK_EQUAL(DurationHistogram::GetBucket(1023us), 9);
+    BOOST_CHECK_EQUAL(DurationHistogram::GetBucket(1024us), 10);
+    BOOST_CHECK_EQUAL(DurationHistogram::GetBucket(1h),
+                      DurationHistogram::NUM_BUCKETS - 1);
+
+    DurationHistogram histogram;
+    BOOST_CHECK_EQUAL(histogram.GetSnapshot().count, 0);
+    histogram.Record(1us);
+    histogram.Record(3us);
+    histogram.Record(2us);
+    histogram.Record(1h);
+
+    const DurationHistogram::Snapshot snapshot{histogram.GetSnapshot()};
+    BOOST_CHECK_EQUAL(snapshot.count, 4);
+    BOOST_CHECK(snapshot.total == 1h + 6us);
+    std::array<uint64_t, DurationHistogram::NUM_BUCKETS> expected_buckets{};
+    expected_buckets[0] = 1;
+    expected_buckets[1] = 2;
+    expected_buckets[DurationHistogram::NUM_BUCKETS - 1] = 1;
+    BOOST_CHECK(snapshot.buckets == expected_buckets);
+}
+
+BOOST_AUTO_TEST_CASE(ringqueue) {
+    RingQueue<std::unique_ptr<int>> queue;
+    BOOST_CHECK(queue.empty());
+    BOOST_CHECK_EQUAL(queue.capacity(), 0);
+
+    // Interleave pushes and pops so that the elements wrap around the end of
+    // the buffer, and check they come out in order across reallocations.
+    int next_push{0};
+    int next_pop{0};
+    for (int round = 0; round < 10; ++round) {
+        for (int i = 0; i < 2 * round + 3; ++i) {
+            queue.push_back(std::make_unique<int>(next_push++));
+        }
+        for (int i = 0; i < round + 2; ++i) {
+            BOOST_CHECK_EQUAL(*queue.take_front(), next_pop++);
+        }
+        BOOST_CHECK_EQUAL(queue.size(), next_push - next_pop);
+        BOOST_CHECK_GE(queue.capacity(), queue.size());
+    }
+
+    // Popping and pushing no more than the capacity does not reallocate.
+    const size_t capacity{queue.capacity()};
+    BOOST_CHECK_EQUAL(*queue.front(), next_pop);
+    queue.pop_front();
+    ++next_pop;
+    queue.emplace_back(std::make_unique<int>(next_push++));
+    BOOST_CHECK_EQUAL(queue.capacity(), capacity);
+    BOOST_CHECK_EQUAL(*queue.front(), next_pop);
+
+    queue.clear();
+    BOOST_CHECK(queue.empty());
+    BOOST_CHECK_EQUAL(queue.capacity(), capacity);
+    queue.push_back(std::make_unique<int>(42));
+    BOOST_CHECK_EQUAL(*queue.front(), 42);
+    BOOST_CHECK_EQUAL(queue.size(), 1);
+}
+
 BOOST_AUTO_TEST_SUITE_END()
@@ -6,16 +6,21 @@
 #include <txdb.h>
 
 #include <chain.h>
+#include <checkqueue.h>
 #include <common/system.h>
 #include <logging.h>
 #include <node/ui_interface.h>
 #include <pow/pow.h>
 #include <random.h>
 #include <shutdown.h>
+#include <util/thread.h>
+#include <util/time.h>
 #include <util/translation.h>
 #include <util/vector.h>
 #include <version.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
 #include <memory>
 
@@ -116,6 +121,67 @@ std::vector<BlockHash> CCoinsViewDB::GetHeadBlocks() const {
     return vhashHeadBlocks;
 }
 
+namespace {
+/**
+ * Serialize and obfuscate a slice of the dirty coins written by
+ * CCoinsViewDB::BatchWrite into their own batch.
+ */
+class CCoinsBatchEncoder {
+private:
+    const CDBWrapper *m_db;
+    const std::vector<CCoinsMap::iterator> *m_entries;
+    size_t m_begin;
+    size_t m_end;
+    std::unique_ptr<CDBBatch> *m_batch;
+
+public:
+    CCoinsBatchEncoder(const CDBWrapper &db,
+                       const std::vector<CCoinsMap::iterator> &entries,
+                       size_t begin, size_t end,
+                       std::unique_ptr<CDBBatch> &batch)
+        : m_db(&db), m_entries(&entries), m_begin(begin), m_end(end),
+          m_batch(&batch) {}
+
+    bool operator()() {
+        auto batch = std::make_unique<CDBBatch>(*m_db);
+        for (size_t i = m_begin; i < m_end; ++i) {
+            const auto &[outpoint, entry] = *(*m_entries)[i];
+            CoinEntry key(&outpoint);
+            if (entry.coin.IsSpent()) {
+                batch->Erase(key);
+            } else {
+                batch->Write(key, entry.coin);
+            }
+        }
+        *m_batch = std::move(batch);
+        return true;
+    }
+};
+} // namespace
+
+static CCheckQueue<CCoinsBatchEncoder> coinswritequeue(1);
+static std::atomic<int> g_coins_write_threads{0};
+
+// The worker threads are started and stopped while no BatchWrite is using the
+// queue, which may be running in the background coins flush thread.
+void StartCoinsDBWriteWorkerThreads(int threads_num) {
+    LOCK(coinswritequeue.m_control_mutex);
+    coinswritequeue.StartWorkerThreads(threads_num);
+    g_coins_write_threads = threads_num;
+}
+
+void StopCoinsDBWriteWorkerThreads() {
+    LOCK(coinswritequeue.m_control_mutex);
+    coinswritequeue.StopWorkerThreads();
+    g_coins_write_threads = 0;
+}
+
+/**
+ * Rough size of a coin write in a batch, used to give each
+ * CCoinsBatchEncoder about batch_write_bytes worth of coins.
+ */
+static constexpr size_t COIN_WRITE_SIZE_ESTIMATE{64};
+
 bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock,
                               bool erase) {
     CDBBatch batch(*m_db);
@@ -139,24 +205,55 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock,
     // interrupting after partial writes from multiple independent reorgs.
     batch.Erase(DB_BEST_BLOCK);
     batch.Write(DB_HEAD_BLOCKS, Vector(hashBlock, old_tip));
+    m_db->WriteBatch(batch);
+    batch.Clear();
+
+    // The dirty coins are encoded in rounds, one batch per thread, and the
+    // batches are committed in order. Every coin key is written at most once
+    // so the order does not matter between them, only that they all land
+    // between the head blocks markers.
+    const size_t entries_per_batch{
+        std::max<size_t>(1, m_options.batch_write_bytes /
+                                COIN_WRITE_SIZE_ESTIMATE)};
+    const size_t batches_per_round{size_t(g_coins_write_threads) + 1};
+    std::vector<CCoinsMap::iterator> entries;
+    std::vector<std::unique_ptr<CDBBatch>> batches;
 
     for (CCoinsMap::iterator it = mapCoins.begin(); it != mapCoins.end();) {
-        if (it->second.flags & CCoinsCacheEntry::DIRTY) {
-            CoinEntry entry(&it->first);
-            if (it->second.coin.IsSpent()) {
-                batch.Erase(entry);
+        entries.clear();
+        while (it != mapCoins.end() &&
+               entries.size() < entries_per_batch * batches_per_round) {
+            count++;
+            if (it->second.flags & CCoinsCacheEntry::DIRTY) {
+                entries.push_back(it++);
+                changed++;
             } else {
-                batch.Write(entry, it->second.coin);
+                it = erase ? mapCoins.erase(it) : std::next(it);
+            }
+        }
+
+        const size_t num_batches{
+            (entries.size() + entries_per_batch - 1) / entries_per_batch};
+        batches.clear();
+        batches.resize(num_batches);
+        {
+            CCheckQueueControl<CCoinsBatchEncoder> control(&coinswritequeue);
+            std::vector<CCoinsBatchEncoder> encoders;
+            encoders.reserve(num_batches);
+            for (size_t i = 0; i < num_batches; ++i) {
+                encoders.emplace_back(
+                    *m_db, entries, i * entries_per_batch,
+                    std::min(entries.size(), (i + 1) * entries_per_batch),
+                    batches[i]);
             }
-            changed++;
+            control.Add(std::move(encoders));
+            control.Wait();
         }
-        count++;
-        it = erase ? mapCoins.erase(it) : std::next(it);
-        if (batch.SizeEstimate() > m_options.batch_write_bytes) {
+
+        for (const std::unique_ptr<CDBBatch> &partial : batches) {
             LogPrint(BCLog::COINDB, "Writing partial batch of %.2f MiB\n",
-                     batch.SizeEstimate() * (1.0 / 1048576.0));
-            m_db->WriteBatch(batch);
-            batch.Clear();
+                     partial->SizeEstimate() * (1.0 / 1048576.0));
+            m_db->WriteBatch(*partial);
             if (m_options.simulate_crash_ratio) {
                 static FastRandomContext rng;
                 if (rng.randrange(m_options.simulate_crash_ratio) == 0) {
@@ -165,6 +262,12 @@ bool CCoinsViewDB::BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock,
                 }
             }
         }
+
+        if (erase) {
+            for (const CCoinsMap::iterator &entry : entries) {
+                mapCoins.erase(entry);
+            }
+        }
     }
 
     // In the last batch, mark the database as consistent with hashBlock again.
@@ -259,6 +362,197 @@ void CCoinsViewDBCursor::Next() {
     }
 }
 
+CCoinsViewBackgroundFlush::~CCoinsViewBackgroundFlush() {
+    {
+        LOCK(m_mutex);
+        m_request_stop = true;
+    }
+    m_cv.notify_all();
+    if (m_thread.joinable()) {
+        m_thread.join();
+    }
+}
+
+bool CCoinsViewBackgroundFlush::GetCoin(const COutPoint &outpoint,
+                                        Coin &coin) const {
+    const std::shared_ptr<const CCoinsMapDetached> frozen{
+        WITH_LOCK(m_mutex, return m_frozen)};
+    if (frozen) {
+        // The frozen coins are not modified until they are released.
+        auto it = frozen->coins.find(outpoint);
+        if (it != frozen->coins.end()) {
+            if (it->second.coin.IsSpent()) {
+                return false;
+            }
+            coin = it->second.coin;
+            return true;
+        }
+    }
+    return base->GetCoin(outpoint, coin);
+}
+
+bool CCoinsViewBackgroundFlush::HaveCoin(const COutPoint &outpoint) const {
+    const std::shared_ptr<const CCoinsMapDetached> frozen{
+        WITH_LOCK(m_mutex, return m_frozen)};
+    if (frozen) {
+        auto it = frozen->coins.find(outpoint);
+        if (it != frozen->coins.end()) {
+            return !it->second.coin.IsSpent();
+        }
+    }
+    return base->HaveCoin(outpoint);
+}
+
+BlockHash CCoinsViewBackgroundFlush::GetBestBlock() const {
+    {
+        LOCK(m_mutex);
+        if (m_frozen) {
+            return m_frozen->hashBlock;
+        }
+    }
+    return base->GetBestBlock();
+}
+
+bool CCoinsViewBackgroundFlush::BatchWrite(CCoinsMap &mapCoins,
+                                           const BlockHash &hashBlock,
+                                           bool erase) {
+    if (!Wait()) {
+        return false;
+    }
+
+    const size_t coins{mapCoins.size()};
+    const auto start{SteadyClock::now()};
+    const bool ret{base->BatchWrite(mapCoins, hashBlock, erase)};
+
+    LOCK(m_mutex);
+    ++m_stats.flushes;
+    m_stats.last_coins = coins;
+    m_stats.last_duration =
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            SteadyClock::now() - start);
+    return ret;
+}
+
+CCoinsViewCursor *CCoinsViewBackgroundFlush::Cursor() const {
+    Wait();
+    return base->Cursor();
+}
+
+bool CCoinsViewBackgroundFlush::BatchWriteInBackground(
+    CCoinsMapDetached &&coins, std::function<void()> on_done) {
+    {
+        WAIT_LOCK(m_mutex, lock);
+        if (!WaitLocked(lock)) {
+            return false;
+        }
+        m_frozen = std::make_shared<CCoinsMapDetached>(std::move(coins));
+        m_on_done = std::move(on_done);
+        m_writing = true;
+    }
+
+    if (!m_thread.joinable()) {
+        m_thread = std::thread(&util::TraceThread, "coinsflush",
+                               [this] { ThreadFlush(); });
+    }
+    m_cv.notify_all();
+    return true;
+}
+
+bool CCoinsViewBackgroundFlush::Wait() const {
+    WAIT_LOCK(m_mutex, lock);
+    return WaitLocked(lock);
+}
+
+bool CCoinsViewBackgroundFlush::WaitLocked(UniqueLock<Mutex> &lock) const {
+    AssertLockHeld(m_mutex);
+    if (m_writing) {
+        const auto start{SteadyClock::now()};
+        m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+            return !m_writing;
+        });
+        const auto stall{std::chrono::duration_cast<std::chrono::microseconds>(
+            SteadyClock::now() - start)};
+        m_stats.total_stall += stall;
+        LogPrintf("Waited %.2fms for the background coins flush\n",
+                  count_microseconds(stall) / 1000.0);
+    }
+    return !m_failed;
+}
+
+bool CCoinsViewBackgroundFlush::IsFlushing() const {
+    return WITH_LOCK(m_mutex, return m_writing);
+}
+
+size_t CCoinsViewBackgroundFlush::DynamicMemoryUsage() const {
+    LOCK(m_mutex);
+    return m_frozen ? m_frozen->usage : 0;
+}
+
+CCoinsViewBackgroundFlush::Stats CCoinsViewBackgroundFlush::GetStats() const {
+    return WITH_LOCK(m_mutex, return m_stats);
+}
+
+void CCoinsViewBackgroundFlush::ThreadFlush() {
+    WAIT_LOCK(m_mutex, lock);
+    while (true) {
+        m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+            return m_request_stop || m_writing;
+        });
+        // Pending coins are written even when stopping, they would be lost
+        // otherwise.
+        if (!m_writing) {
+            return;
+        }
+
+        const std::shared_ptr<CCoinsMapDetached> frozen{m_frozen};
+        std::function<void()> on_done{std::move(m_on_done)};
+
+        bool ret{false};
+        const auto start{SteadyClock::now()};
+        {
+            REVERSE_LOCK(lock);
+            try {
+                // Readers may look coins up concurrently, so the map must not
+                // be modified.
+                ret = base->BatchWrite(frozen->coins, frozen->hashBlock,
+                                       /*erase=*/false);
+            } catch (const std::exception &e) {
+                LogPrintf("%s: %s\n", __func__, e.what());
+            }
+        }
+        const auto duration{
+            std::chrono::duration_cast<std::chrono::microseconds>(
+                SteadyClock::now() - start)};
+
+        if (ret) {
+            LogPrintf("Flushed %u coins to disk in the background in %.2fs\n",
+                      frozen->coins.size(), Ticks<SecondsDouble>(duration));
+            if (on_done) {
+                REVERSE_LOCK(lock);
+                on_done();
+            }
+            // The base now has everything.
+            m_frozen.reset();
+        } else {
+            // Keep the coins around so reads remain correct until the node
+            // shuts down.
+            LogPrintf("Failed to flush coins to disk in the background\n");
+            m_failed = true;
+            // Don't let the node run on coins that never made it to disk, the
+            // same as a failed foreground flush. The shutdown is requested
+            // before the waiters are released.
+            REVERSE_LOCK(lock);
+            AbortNode("Failed to write to coin database");
+        }
+        ++m_stats.flushes;
+        ++m_stats.background_flushes;
+        m_stats.last_coins = frozen->coins.size();
+        m_stats.last_duration = duration;
+        m_writing = false;
+        m_cv.notify_all();
+    }
+}
+
 bool CBlockTreeDB::WriteBatchSync(
     const std::vector<std::pair<int, const CBlockFileInfo *>> &fileInfo,
     int nLastFile, const std::vector<const CBlockIndex *> &blockinfo) {
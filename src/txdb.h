@@ -11,15 +11,19 @@
 #include <dbwrapper.h>
 #include <flatfile.h>
 #include <kernel/cs_main.h>
+#include <sync.h>
 #include <util/fs.h>
 #include <util/result.h>
 
+#include <chrono>
+#include <condition_variable>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <memory>
 #include <optional>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -52,6 +56,11 @@ static constexpr int64_t MAX_FILTER_INDEX_CACHE_MB = 1024;
 //! Max memory allocated to coin DB specific cache (MiB)
 static constexpr int64_t MAX_COINS_DB_CACHE_MB = 8;
 
+/** Maximum number of dedicated coins database write threads allowed */
+static constexpr int MAX_COINSDB_WRITE_THREADS{15};
+/** -pardbwrite default (number of coins database write threads, 0 = auto) */
+static constexpr int DEFAULT_COINSDB_WRITE_THREADS{0};
+
 //! User-controlled performance and debug options.
 struct CoinsViewOptions {
     //! Maximum database write batch size in bytes.
@@ -92,6 +101,14 @@ public:
     std::optional<fs::path> StoragePath() { return m_db->StoragePath(); }
 };
 
+/**
+ * Run the threads serializing the coins written by CCoinsViewDB::BatchWrite.
+ * Without them, the coins are serialized by the writing thread.
+ */
+void StartCoinsDBWriteWorkerThreads(int threads_num);
+/** Stop all of the coins database write threads */
+void StopCoinsDBWriteWorkerThreads();
+
 /** Specialization of CCoinsViewCursor to iterate over a CCoinsViewDB */
 class CCoinsViewDBCursor : public CCoinsViewCursor {
 public:
@@ -113,6 +130,91 @@ private:
     friend class CCoinsViewDB;
 };
 
+/**
+ * CCoinsView that can write the coins of a flushed cache to its base, the
+ * coin database, in the background.
+ *
+ * The coins handed to BatchWriteInBackground() become a frozen, read-only
+ * layer that is consulted before the database until they are fully written,
+ * so the caches on top of this view keep seeing a consistent UTXO set while
+ * validation continues. The write itself is the base's regular BatchWrite(),
+ * so a crash in the middle of it is still recovered from DB_HEAD_BLOCKS by
+ * Chainstate::ReplayBlocks().
+ *
+ * Only one write runs at a time: any other write to the base first waits for
+ * the one in progress. Reads are safe from any thread.
+ */
+class CCoinsViewBackgroundFlush final : public CCoinsViewBacked {
+public:
+    struct Stats {
+        //! Number of writes to the base, including synchronous ones.
+        uint64_t flushes{0};
+        //! Number of writes done in the background.
+        uint64_t background_flushes{0};
+        //! Number of coins written by the last write.
+        size_t last_coins{0};
+        //! Duration of the last write.
+        std::chrono::microseconds last_duration{0};
+        //! Total time spent waiting for background writes to complete.
+        std::chrono::microseconds total_stall{0};
+    };
+
+    explicit CCoinsViewBackgroundFlush(CCoinsView *view)
+        : CCoinsViewBacked(view) {}
+    //! Completes the background write in progress, if any.
+    ~CCoinsViewBackgroundFlush();
+
+    bool GetCoin(const COutPoint &outpoint, Coin &coin) const override;
+    bool HaveCoin(const COutPoint &outpoint) const override;
+    BlockHash GetBestBlock() const override;
+    bool BatchWrite(CCoinsMap &mapCoins, const BlockHash &hashBlock,
+                    bool erase = true) override;
+    CCoinsViewCursor *Cursor() const override;
+
+    /**
+     * Start writing coins to the base in the background, after the previous
+     * background write completed. on_done is called from the background
+     * thread once the coins are written.
+     *
+     * @returns false if a previous background write failed.
+     */
+    bool BatchWriteInBackground(CCoinsMapDetached &&coins,
+                                std::function<void()> on_done);
+
+    /**
+     * Wait for the background write in progress, if any.
+     *
+     * @returns false if it failed.
+     */
+    bool Wait() const;
+
+    //! Whether a background write is in progress.
+    bool IsFlushing() const;
+
+    //! Memory usage of the coins being written in the background.
+    size_t DynamicMemoryUsage() const;
+
+    Stats GetStats() const;
+
+private:
+    bool WaitLocked(UniqueLock<Mutex> &lock) const
+        EXCLUSIVE_LOCKS_REQUIRED(m_mutex);
+    void ThreadFlush();
+
+    mutable Mutex m_mutex;
+    mutable std::condition_variable m_cv;
+    //! The coins being written, or that failed to be written.
+    std::shared_ptr<CCoinsMapDetached> m_frozen GUARDED_BY(m_mutex);
+    std::function<void()> m_on_done GUARDED_BY(m_mutex);
+    bool m_writing GUARDED_BY(m_mutex){false};
+    bool m_failed GUARDED_BY(m_mutex){false};
+    bool m_request_stop GUARDED_BY(m_mutex){false};
+    mutable Stats m_stats GUARDED_BY(m_mutex);
+
+    //! Started on the first background write.
+    std::thread m_thread;
+};
+
 /** Access to the block database (blocks/index/) */
 class CBlockTreeDB : public CDBWrapper {
 public:
@@ -186,6 +186,8 @@ void CTxMemPool::addUnchecked(CTxMemPoolEntryRef entry) {
 
     UpdateParentsOf(true, newit);
 
+    m_template_candidates.TransactionAdded(entry);
+
     nTransactionsUpdated++;
     totalTxSize += entry->GetTxSize();
     m_total_fee += entry->GetFee();
@@ -222,6 +224,7 @@ void CTxMemPool::removeUnchecked(txiter it, MemPoolRemovalReason reason) {
     cachedInnerUsage -=
         memusage::DynamicUsage((*it)->GetMemPoolParentsConst()) +
         memusage::DynamicUsage((*it)->GetMemPoolChildrenConst());
+    m_template_candidates.TransactionRemoved(*it);
     mapTx.erase(it);
     nTransactionsUpdated++;
 }
@@ -337,6 +340,7 @@ void CTxMemPool::_clear() {
     lastRollingFeeUpdate = GetTime();
     blockSinceLastRollingFeeBump = false;
     rollingMinimumFeeRate = 0;
+    m_template_candidates.Invalidate();
     ++nTransactionsUpdated;
 }
 
@@ -489,7 +493,8 @@ static TxMempoolInfo
 GetInfo(CTxMemPool::indexed_transaction_set::const_iterator it) {
     return TxMempoolInfo{(*it)->GetSharedTx(), (*it)->GetTime(),
                          (*it)->GetFee(), (*it)->GetTxSize(),
-                         (*it)->GetModifiedFee() - (*it)->GetFee()};
+                         (*it)->GetModifiedFee() - (*it)->GetFee(),
+                         (*it)->GetEntryId()};
 }
 
 std::vector<TxMempoolInfo> CTxMemPool::infoAll() const {
@@ -506,6 +511,23 @@ std::vector<TxMempoolInfo> CTxMemPool::infoAll() const {
     return ret;
 }
 
+std::vector<TxMempoolInfo>
+CTxMemPool::infoMany(const std::vector<TxId> &txids) const {
+    LOCK(cs);
+
+    std::vector<TxMempoolInfo> ret;
+    ret.reserve(txids.size());
+
+    for (const TxId &txid : txids) {
+        indexed_transaction_set::const_iterator i = mapTx.find(txid);
+        if (i != mapTx.end()) {
+            ret.push_back(GetInfo(i));
+        }
+    }
+
+    return ret;
+}
+
 CTransactionRef CTxMemPool::get(const TxId &txid) const {
     LOCK(cs);
     indexed_transaction_set::const_iterator i = mapTx.find(txid);
@@ -547,6 +569,8 @@ void CTxMemPool::PrioritiseTransaction(const TxId &txid,
             mapTx.modify(it, [&delta](CTxMemPoolEntryRef &e) {
                 e->UpdateFeeDelta(delta);
             });
+            // The transaction may move in or out of the selection.
+            m_template_candidates.Invalidate();
             ++nTransactionsUpdated;
         }
     }
@@ -837,3 +861,99 @@ RemovalReasonToString(const MemPoolRemovalReason &r) noexcept {
     }
     assert(false);
 }
+
+void BlockTemplateCandidates::Reset(
+    const Limits &limits, const std::vector<CTxMemPoolEntryRef> &entries,
+    uint64_t block_size, uint64_t block_sigchecks, bool full,
+    CheckTxFn check_tx) {
+    m_entries.clear();
+    m_lowest_fee_rate = CFeeRate(MAX_MONEY);
+    for (const CTxMemPoolEntryRef &entry : entries) {
+        m_entries.push_back(entry);
+        m_lowest_fee_rate =
+            std::min(m_lowest_fee_rate, entry->GetModifiedFeeRate());
+    }
+    m_limits = limits;
+    m_check_tx = std::move(check_tx);
+    m_block_size = block_size;
+    m_block_sigchecks = block_sigchecks;
+    m_full = full;
+    m_valid = true;
+}
+
+void BlockTemplateCandidates::Invalidate() {
+    if (!m_valid) {
+        return;
+    }
+    m_valid = false;
+    m_entries.clear();
+    m_check_tx = nullptr;
+}
+
+void BlockTemplateCandidates::TransactionAdded(
+    const CTxMemPoolEntryRef &entry) {
+    if (!m_valid) {
+        return;
+    }
+
+    const CFeeRate fee_rate{entry->GetModifiedFeeRate()};
+    if (fee_rate < m_limits.min_fee_rate) {
+        return;
+    }
+
+    // Non-final transactions and the like are left out, as addTxs() does.
+    if (!m_check_tx(entry->GetTx())) {
+        return;
+    }
+
+    // Transactions are only selected after all their parents.
+    const auto &by_txid = m_entries.get<txid_order>();
+    for (const auto &parent : entry->GetMemPoolParentsConst()) {
+        if (by_txid.count(parent.get()->GetTx().GetId()) == 0) {
+            return;
+        }
+    }
+
+    if (m_block_size + entry->GetTxSize() >= m_limits.max_size ||
+        m_block_sigchecks + entry->GetSigChecks() >= m_limits.max_sigchecks) {
+        if (fee_rate > m_lowest_fee_rate) {
+            // It would have been selected in place of other transactions.
+            Invalidate();
+        } else {
+            m_full = true;
+        }
+        return;
+    }
+
+    m_entries.push_back(entry);
+    m_block_size += entry->GetTxSize();
+    m_block_sigchecks += entry->GetSigChecks();
+    m_lowest_fee_rate = std::min(m_lowest_fee_rate, fee_rate);
+}
+
+void BlockTemplateCandidates::TransactionRemoved(
+    const CTxMemPoolEntryRef &entry) {
+    if (!m_valid) {
+        return;
+    }
+
+    auto &by_txid = m_entries.get<txid_order>();
+    auto it = by_txid.find(entry->GetTx().GetId());
+    if (it == by_txid.end()) {
+        return;
+    }
+
+    if (m_full) {
+        // The freed room may fit transactions that were left out.
+        Invalidate();
+        return;
+    }
+
+    // DisconnectedBlockTransactions::removeForBlock() invalidates the
+    // selection before the transactions of a connected block are removed.
+    // Otherwise the descendants are removed along with the transaction, so the
+    // selection keeps all the parents of its transactions.
+    m_block_size -= entry->GetTxSize();
+    m_block_sigchecks -= entry->GetSigChecks();
+    by_txid.erase(it);
+}
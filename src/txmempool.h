@@ -9,11 +9,13 @@
 #include <coins.h>
 #include <consensus/amount.h>
 #include <core_memusage.h>
+#include <feerate.h>
 #include <indirectmap.h>
 #include <kernel/cs_main.h>
 #include <kernel/mempool_entry.h>
 #include <kernel/mempool_options.h>
 #include <policy/packages.h>
+#include <primitives/blockhash.h>
 #include <primitives/transaction.h>
 #include <radix.h>
 #include <sync.h>
@@ -28,6 +30,7 @@
 #include <boost/multi_index_container.hpp>
 
 #include <atomic>
+#include <functional>
 #include <map>
 #include <memory>
 #include <optional>
@@ -123,6 +126,8 @@ struct CompareTxMemPoolEntryByModifiedFeeRate {
 struct entry_time {};
 struct modified_feerate {};
 struct entry_id {};
+struct txid_order {};
+struct selection_order {};
 
 /**
  * Information about a mempool transaction.
@@ -142,6 +147,12 @@ struct TxMempoolInfo {
 
     /** The fee delta. */
     Amount nFeeDelta;
+
+    /**
+     * Order in which the transaction entered the mempool, which is a
+     * topological order.
+     */
+    uint64_t m_entry_id{0};
 };
 
 /**
@@ -165,6 +176,87 @@ enum class MemPoolRemovalReason {
 
 const std::string RemovalReasonToString(const MemPoolRemovalReason &r) noexcept;
 
+/**
+ * The mempool transactions selected for the next block by
+ * node::BlockAssembler, kept up to date by the mempool as transactions enter
+ * and leave it so that block templates don't need to be assembled from scratch
+ * every time.
+ *
+ * A new transaction is appended to the selection when it passes the same
+ * checks as in node::BlockAssembler, all its in-mempool parents are selected
+ * and it fits in the block. Whenever an update could make the selection stale
+ * (a block is connected, fees are prioritised) or leave
+ * out a transaction a fresh selection would include (room is freed in a full
+ * block, a transaction with a better feerate does not fit), it is invalidated
+ * instead and the next template is assembled from scratch.
+ */
+class BlockTemplateCandidates {
+public:
+    //! What the selection was made for.
+    struct Limits {
+        BlockHash tip;
+        uint64_t max_size;
+        uint64_t max_sigchecks;
+        CFeeRate min_fee_rate;
+
+        bool operator==(const Limits &other) const {
+            return tip == other.tip && max_size == other.max_size &&
+                   max_sigchecks == other.max_sigchecks &&
+                   min_fee_rate == other.min_fee_rate;
+        }
+    };
+
+    typedef boost::multi_index_container<
+        CTxMemPoolEntryRef,
+        boost::multi_index::indexed_by<
+            // in selection order, which is topological
+            boost::multi_index::sequenced<
+                boost::multi_index::tag<selection_order>>,
+            // sorted by txid (canonical transaction order)
+            boost::multi_index::ordered_unique<
+                boost::multi_index::tag<txid_order>, mempoolentry_txid>>>
+        indexed_entry_set;
+
+    //! Whether a transaction can be included in a block on the tip.
+    using CheckTxFn = std::function<bool(const CTransaction &tx)>;
+
+    /**
+     * Replace the selection with entries, made for limits and given in
+     * selection order. Sizes and sigchecks include the space reserved for the
+     * coinbase. Transactions added later on are only selected if they pass
+     * check_tx.
+     */
+    void Reset(const Limits &limits,
+               const std::vector<CTxMemPoolEntryRef> &entries,
+               uint64_t block_size, uint64_t block_sigchecks, bool full,
+               CheckTxFn check_tx);
+    void Invalidate();
+
+    //! Whether the selection is up to date for limits.
+    bool IsValidFor(const Limits &limits) const {
+        return m_valid && m_limits == limits;
+    }
+
+    //! Called by the mempool when entry was added to it.
+    void TransactionAdded(const CTxMemPoolEntryRef &entry);
+    //! Called by the mempool before entry is removed from it.
+    void TransactionRemoved(const CTxMemPoolEntryRef &entry);
+
+    const indexed_entry_set &GetEntries() const { return m_entries; }
+
+private:
+    bool m_valid{false};
+    Limits m_limits;
+    CheckTxFn m_check_tx;
+    indexed_entry_set m_entries;
+    uint64_t m_block_size{0};
+    uint64_t m_block_sigchecks{0};
+    //! Whether a transaction was left out for lack of room.
+    bool m_full{false};
+    //! No higher than the lowest feerate in the selection.
+    CFeeRate m_lowest_fee_rate;
+};
+
 /**
  * CTxMemPool stores valid-according-to-the-current-best-chain transactions that
  * may be included in the next block.
@@ -313,6 +405,9 @@ public:
 
     RadixTree<CTxMemPoolEntry, MemPoolEntryRadixTreeAdapter> finalizedTxs;
 
+    //! Used by node::BlockAssembler to avoid assembling blocks from scratch.
+    mutable BlockTemplateCandidates m_template_candidates GUARDED_BY(cs);
+
 private:
     void UpdateParent(txiter entry, txiter parent, bool add)
         EXCLUSIVE_LOCKS_REQUIRED(cs);
@@ -518,6 +613,11 @@ public:
     CTransactionRef get(const TxId &txid) const;
     TxMempoolInfo info(const TxId &txid) const;
     std::vector<TxMempoolInfo> infoAll() const;
+    /**
+     * Look up several transactions under a single lock. The ones no longer in
+     * the mempool are skipped.
+     */
+    std::vector<TxMempoolInfo> infoMany(const std::vector<TxId> &txids) const;
 
     CFeeRate estimateFee() const;
 
@@ -0,0 +1,69 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_UTIL_HISTOGRAM_H
+#define BITCOIN_UTIL_HISTOGRAM_H
+
+#include <crypto/common.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Histogram of durations with buckets of exponentially increasing width.
+ *
+ * Bucket 0 counts the durations shorter than 2 microseconds and bucket i > 0
+ * the ones in [2^i, 2^(i+1)) microseconds, except for the last bucket which
+ * also counts all the longer durations.
+ *
+ * Durations are recorded and read without locking, so the histogram can be
+ * updated from any thread. A snapshot taken while durations are recorded
+ * may be off by these durations, which is fine for statistics.
+ */
+class DurationHistogram {
+public:
+    //! The last bucket starts at about 36 minutes.
+    static constexpr size_t NUM_BUCKETS{32};
+
+    struct Snapshot {
+        uint64_t count{0};
+        std::chrono::microseconds total{0};
+        std::array<uint64_t, NUM_BUCKETS> buckets{};
+    };
+
+    static size_t GetBucket(std::chrono::microseconds duration) {
+        const uint64_t micros = std::max<int64_t>(duration.count(), 0);
+        return std::min<size_t>(std::max<uint64_t>(CountBits(micros), 1) - 1,
+                                NUM_BUCKETS - 1);
+    }
+
+    void Record(std::chrono::microseconds duration) {
+        m_buckets[GetBucket(duration)].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        m_total_micros.fetch_add(std::max<int64_t>(duration.count(), 0),
+                                 std::memory_order_relaxed);
+    }
+
+    Snapshot GetSnapshot() const {
+        Snapshot snapshot;
+        snapshot.count = m_count.load(std::memory_order_relaxed);
+        snapshot.total = std::chrono::microseconds{
+            m_total_micros.load(std::memory_order_relaxed)};
+        for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+            snapshot.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+        }
+        return snapshot;
+    }
+
+private:
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_total_micros{0};
+    std::array<std::atomic<uint64_t>, NUM_BUCKETS> m_buckets{};
+};
+
+#endif // BITCOIN_UTIL_HISTOGRAM_H
@@ -0,0 +1,91 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_UTIL_RINGQUEUE_H
+#define BITCOIN_UTIL_RINGQUEUE_H
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+/**
+ * A first-in first-out queue stored in a growable ring buffer.
+ *
+ * Unlike std::list or std::deque, pushing and popping elements does not
+ * allocate once the buffer has grown to the largest size the queue reached:
+ * the storage is only reallocated when the queue outgrows it, and is never
+ * shrunk.
+ */
+template <typename T> class RingQueue {
+public:
+    bool empty() const { return m_size == 0; }
+    size_t size() const { return m_size; }
+    size_t capacity() const { return m_buffer.size(); }
+
+    T &front() {
+        assert(!empty());
+        return *m_buffer[m_head];
+    }
+    const T &front() const {
+        assert(!empty());
+        return *m_buffer[m_head];
+    }
+
+    template <typename... Args> T &emplace_back(Args &&...args) {
+        if (m_size == m_buffer.size()) {
+            Grow();
+        }
+        auto &slot = m_buffer[(m_head + m_size) % m_buffer.size()];
+        slot.emplace(std::forward<Args>(args)...);
+        ++m_size;
+        return *slot;
+    }
+    void push_back(T &&value) { emplace_back(std::move(value)); }
+
+    /** Remove the first element. The queue must not be empty. */
+    void pop_front() {
+        assert(!empty());
+        m_buffer[m_head].reset();
+        m_head = (m_head + 1) % m_buffer.size();
+        --m_size;
+    }
+
+    /** Remove and return the first element. The queue must not be empty. */
+    T take_front() {
+        T value{std::move(front())};
+        pop_front();
+        return value;
+    }
+
+    /** Remove all the elements, keeping the storage for reuse. */
+    void clear() {
+        while (!empty()) {
+            pop_front();
+        }
+        m_head = 0;
+    }
+
+private:
+    static constexpr size_t MIN_CAPACITY{8};
+
+    void Grow() {
+        std::vector<std::optional<T>> buffer(
+            std::max(MIN_CAPACITY, 2 * m_buffer.size()));
+        for (size_t i = 0; i < m_size; ++i) {
+            buffer[i].emplace(
+                std::move(*m_buffer[(m_head + i) % m_buffer.size()]));
+        }
+        m_buffer = std::move(buffer);
+        m_head = 0;
+    }
+
+    std::vector<std::optional<T>> m_buffer;
+    size_t m_head{0};
+    size_t m_size{0};
+};
+
+#endif // BITCOIN_UTIL_RINGQUEUE_H
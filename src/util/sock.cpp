@@ -12,6 +12,9 @@
 #include <util/syserror.h>
 #include <util/time.h>
 
+#include <algorithm>
+#include <array>
+#include <climits>
 #include <codecvt>
 #include <cwchar>
 #include <locale>
@@ -23,6 +26,14 @@
 #include <poll.h>
 #endif
 
+#ifndef WIN32
+#include <sys/uio.h>
+#endif
+
+#ifdef IOV_MAX
+static_assert(Sock::MAX_SEND_BUFFERS <= IOV_MAX);
+#endif
+
 static inline bool IOErrorIsPermanent(int err) {
     return err != WSAEAGAIN && err != WSAEINTR && err != WSAEWOULDBLOCK &&
            err != WSAEINPROGRESS;
@@ -66,6 +77,28 @@ ssize_t Sock::Send(const void *data, size_t len, int flags) const {
     return send(m_socket, static_cast<const char *>(data), len, flags);
 }
 
+ssize_t Sock::SendMany(Span<const Span<const uint8_t>> data,
+                       int flags) const {
+    if (data.empty()) {
+        return 0;
+    }
+#ifdef WIN32
+    return Send(data[0].data(), data[0].size(), flags);
+#else
+    std::array<iovec, MAX_SEND_BUFFERS> iov;
+    const size_t count{std::min(data.size(), MAX_SEND_BUFFERS)};
+    for (size_t i = 0; i < count; ++i) {
+        iov[i].iov_base = const_cast<uint8_t *>(data[i].data());
+        iov[i].iov_len = data[i].size();
+    }
+
+    msghdr msg{};
+    msg.msg_iov = iov.data();
+    msg.msg_iovlen = count;
+    return sendmsg(m_socket, &msg, flags);
+#endif
+}
+
 ssize_t Sock::Recv(void *buf, size_t len, int flags) const {
     return recv(m_socket, static_cast<char *>(buf), len, flags);
 }
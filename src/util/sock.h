@@ -7,6 +7,7 @@
 
 #include <compat.h>
 #include <threadinterrupt.h>
+#include <span.h>
 #include <util/time.h>
 
 #include <chrono>
@@ -92,6 +93,24 @@ public:
      */
     virtual ssize_t Send(const void *data, size_t len, int flags) const;
 
+    /**
+     * Maximum number of buffers sent by a single call to `SendMany()`. This
+     * does not exceed IOV_MAX on any supported platform.
+     */
+    static constexpr size_t MAX_SEND_BUFFERS{1024};
+
+    /**
+     * sendmsg(2) wrapper sending the buffers one after the other as if they
+     * were concatenated, in a single system call. Only the first
+     * `MAX_SEND_BUFFERS` buffers are sent. Like `Send()`, this may send less
+     * than the total size of the buffers.
+     * Where sendmsg(2) is not available, only the first buffer is sent.
+     * Code that uses this wrapper can be unit tested if this method is
+     * overridden by a mock Sock implementation.
+     */
+    virtual ssize_t SendMany(Span<const Span<const uint8_t>> data,
+                             int flags) const;
+
     /**
      * recv(2) wrapper. Equivalent to `recv(this->Get(), buf, len, flags);`.
      * Code that uses this wrapper can be unit tested if this method is
@@ -0,0 +1,176 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <util/sockwaitset.h>
+
+#include <compat.h>
+#include <logging.h>
+#include <util/syserror.h>
+#include <util/time.h>
+
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+#ifdef USE_EPOLL
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+/** Fallback calling Sock::WaitMany() on the whole set for each wait. */
+class WaitManySockWaitSet final : public SockWaitSet {
+public:
+    void Set(const std::shared_ptr<const Sock> &sock,
+             Sock::Event requested) override {
+        if (requested == 0) {
+            m_events_per_sock.erase(sock);
+            return;
+        }
+        m_events_per_sock.insert_or_assign(sock, Sock::Events{requested});
+    }
+
+    bool Wait(std::chrono::milliseconds timeout,
+              Sock::EventsPerSock &events_per_sock) override {
+        events_per_sock = m_events_per_sock;
+        return !events_per_sock.empty() &&
+               events_per_sock.begin()->first->WaitMany(timeout,
+                                                        events_per_sock);
+    }
+
+    size_t Size() const override { return m_events_per_sock.size(); }
+
+    std::string GetName() const override {
+#ifdef USE_POLL
+        return "poll";
+#else
+        return "select";
+#endif
+    }
+
+private:
+    Sock::EventsPerSock m_events_per_sock;
+};
+
+#ifdef USE_EPOLL
+/**
+ * Maximum number of events reported by a single epoll_wait(2) call. The
+ * sockets are registered level-triggered, so any event left out is reported by
+ * the next call.
+ */
+static constexpr size_t MAX_EPOLL_EVENTS{1024};
+
+class EpollSockWaitSet final : public SockWaitSet {
+public:
+    explicit EpollSockWaitSet(int epoll_fd) : m_epoll_fd{epoll_fd} {}
+
+    ~EpollSockWaitSet() override { close(m_epoll_fd); }
+
+    void Set(const std::shared_ptr<const Sock> &sock,
+             Sock::Event requested) override {
+        const SOCKET fd{sock->Get()};
+        auto it = m_socks.find(fd);
+
+        if (requested == 0) {
+            if (it != m_socks.end()) {
+                epoll_ctl(m_epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+                m_socks.erase(it);
+            }
+            return;
+        }
+
+        if (it != m_socks.end() && it->second.requested == requested) {
+            it->second.sock = sock;
+            return;
+        }
+
+        epoll_event event{};
+        if (requested & Sock::RECV) {
+            event.events |= EPOLLIN;
+        }
+        if (requested & Sock::SEND) {
+            event.events |= EPOLLOUT;
+        }
+        event.data.fd = fd;
+        const int op{it == m_socks.end() ? EPOLL_CTL_ADD : EPOLL_CTL_MOD};
+        if (epoll_ctl(m_epoll_fd, op, fd, &event) != 0) {
+            LogPrint(BCLog::NET, "epoll_ctl() failed for socket %d: %s\n", fd,
+                     SysErrorString(errno));
+            return;
+        }
+        m_socks.insert_or_assign(fd, Entry{sock, requested});
+    }
+
+    bool Wait(std::chrono::milliseconds timeout,
+              Sock::EventsPerSock &events_per_sock) override {
+        events_per_sock.clear();
+        if (m_socks.empty()) {
+            return false;
+        }
+
+        m_events.resize(std::min(m_socks.size(), MAX_EPOLL_EVENTS));
+        const int num_events{epoll_wait(m_epoll_fd, m_events.data(),
+                                        m_events.size(),
+                                        count_milliseconds(timeout))};
+        if (num_events < 0) {
+            // Interrupted by a signal, report no event like on timeout.
+            return errno == EINTR;
+        }
+
+        for (int i = 0; i < num_events; ++i) {
+            const epoll_event &event = m_events[i];
+            const auto it = m_socks.find(event.data.fd);
+            if (it == m_socks.end()) {
+                continue;
+            }
+            Sock::Events events{it->second.requested};
+            if (event.events & EPOLLIN) {
+                events.occurred |= Sock::RECV;
+            }
+            if (event.events & EPOLLOUT) {
+                events.occurred |= Sock::SEND;
+            }
+            if (event.events & (EPOLLERR | EPOLLHUP)) {
+                events.occurred |= Sock::ERR;
+            }
+            events_per_sock.emplace(it->second.sock, events);
+        }
+
+        return true;
+    }
+
+    size_t Size() const override { return m_socks.size(); }
+
+    std::string GetName() const override { return "epoll"; }
+
+private:
+    struct Entry {
+        std::shared_ptr<const Sock> sock;
+        Sock::Event requested;
+    };
+
+    const int m_epoll_fd;
+    std::unordered_map<SOCKET, Entry> m_socks;
+    //! Buffer for the events reported by epoll_wait(2), reused across calls.
+    std::vector<epoll_event> m_events;
+};
+#endif // USE_EPOLL
+
+} // namespace
+
+std::unique_ptr<SockWaitSet> MakeSockWaitSet(bool use_epoll) {
+#ifdef USE_EPOLL
+    if (use_epoll) {
+        const int epoll_fd{epoll_create1(EPOLL_CLOEXEC)};
+        if (epoll_fd != -1) {
+            return std::make_unique<EpollSockWaitSet>(epoll_fd);
+        }
+        LogPrintf("Unable to create an epoll instance, falling back to "
+                  "poll: %s\n",
+                  SysErrorString(errno));
+    }
+#endif
+    return std::make_unique<WaitManySockWaitSet>();
+}
@@ -0,0 +1,64 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_UTIL_SOCKWAITSET_H
+#define BITCOIN_UTIL_SOCKWAITSET_H
+
+#include <util/sock.h>
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+
+/**
+ * A persistent set of sockets to wait on, for callers that wait on mostly the
+ * same sockets over and over again. The events to wait for on each socket are
+ * registered once and updated only when they change, instead of being passed
+ * to every call like with `Sock::WaitMany()`.
+ *
+ * The set holds a reference to the registered sockets, so a socket is only
+ * closed once it has been removed from the set.
+ */
+class SockWaitSet {
+public:
+    virtual ~SockWaitSet() = default;
+
+    /**
+     * Wait for requested events on sock, replacing the events it was
+     * registered with if any.
+     * @param[in] sock The socket to wait on.
+     * @param[in] requested Bitwise-or of `Sock::RECV` and `Sock::SEND`, or 0
+     *     to remove the socket from the set.
+     */
+    virtual void Set(const std::shared_ptr<const Sock> &sock,
+                     Sock::Event requested) = 0;
+
+    /**
+     * Wait for the registered events on all the sockets in the set.
+     * @param[in] timeout Wait this long for at least one of the events to
+     *     occur.
+     * @param[out] events_per_sock Filled with the sockets on which events
+     *     occurred. Sockets with no occurred events may be included as well.
+     * @return false if the set is empty or on error, in which case the
+     *     caller should wait for the timeout by itself.
+     */
+    [[nodiscard]] virtual bool Wait(std::chrono::milliseconds timeout,
+                                    Sock::EventsPerSock &events_per_sock) = 0;
+
+    /** Number of sockets in the set */
+    virtual size_t Size() const = 0;
+
+    /** Name of the mechanism used to wait, for logging */
+    virtual std::string GetName() const = 0;
+};
+
+/**
+ * Create an empty SockWaitSet. On Linux it is backed by epoll(7), unless
+ * use_epoll is false or it cannot be used, in which case `Sock::WaitMany()` is
+ * called on the whole set for each wait.
+ */
+std::unique_ptr<SockWaitSet> MakeSockWaitSet(bool use_epoll = true);
+
+#endif // BITCOIN_UTIL_SOCKWAITSET_H
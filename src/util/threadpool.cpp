@@ -0,0 +1,86 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#include <util/threadpool.h>
+
+#include <logging.h>
+#include <tinyformat.h>
+#include <util/threadnames.h>
+
+#include <cassert>
+#include <exception>
+#include <utility>
+
+ThreadPool::ThreadPool(std::string name) : m_name{std::move(name)} {}
+
+ThreadPool::~ThreadPool() {
+    Stop();
+}
+
+void ThreadPool::Start(int num_workers) {
+    LOCK(m_mutex);
+    assert(m_workers.empty());
+    m_running = num_workers > 0;
+    for (int n = 0; n < num_workers; ++n) {
+        m_workers.emplace_back([this, n]() {
+            util::ThreadRename(strprintf("%s.%i", m_name, n));
+            Loop();
+        });
+    }
+}
+
+void ThreadPool::Stop() {
+    std::vector<std::thread> workers;
+    {
+        LOCK(m_mutex);
+        m_running = false;
+        workers.swap(m_workers);
+    }
+    m_cv.notify_all();
+    for (std::thread &worker : workers) {
+        worker.join();
+    }
+}
+
+bool ThreadPool::Submit(std::function<void()> task) {
+    {
+        LOCK(m_mutex);
+        if (!m_running) {
+            return false;
+        }
+        m_tasks.push_back(std::move(task));
+    }
+    m_cv.notify_one();
+    return true;
+}
+
+size_t ThreadPool::WorkersCount() const {
+    LOCK(m_mutex);
+    return m_workers.size();
+}
+
+void ThreadPool::Loop() {
+    while (true) {
+        std::function<void()> task;
+        {
+            WAIT_LOCK(m_mutex, lock);
+            m_cv.wait(lock, [&]() EXCLUSIVE_LOCKS_REQUIRED(m_mutex) {
+                return !m_running || !m_tasks.empty();
+            });
+            if (m_tasks.empty()) {
+                // Stopping and nothing left to run.
+                return;
+            }
+            task = std::move(m_tasks.front());
+            m_tasks.pop_front();
+        }
+
+        try {
+            task();
+        } catch (const std::exception &e) {
+            LogPrintf("%s: task threw an exception: %s\n",
+                      util::ThreadGetInternalName(), e.what());
+        }
+    }
+}
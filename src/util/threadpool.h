@@ -0,0 +1,66 @@
+// Copyright (c) 2024 The Bitcoin developers
+// Distributed under the MIT software license, see the accompanying
+// file COPYING or http://www.opensource.org/licenses/mit-license.php.
+
+#ifndef BITCOIN_UTIL_THREADPOOL_H
+#define BITCOIN_UTIL_THREADPOOL_H
+
+#include <sync.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * A fixed set of worker threads running the tasks submitted to them, in
+ * submission order but possibly concurrently.
+ *
+ * Unlike CCheckQueue there is no master thread waiting for a batch of tasks to
+ * complete: the submitter returns as soon as the task is queued, and it is up
+ * to the task to report its completion.
+ */
+class ThreadPool {
+public:
+    /** The worker threads are named "<name>.<index>". */
+    explicit ThreadPool(std::string name);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /** Start num_workers worker threads. Must not be running already. */
+    void Start(int num_workers) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Run the tasks left in the queue, then join the worker threads. Tasks
+     * submitted from now on are rejected.
+     */
+    void Stop() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /**
+     * Queue a task to be run by one of the worker threads.
+     * @return false if the pool is not running, in which case the task is
+     *     dropped.
+     */
+    bool Submit(std::function<void()> task) EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    /** Number of worker threads, 0 if the pool is not running. */
+    size_t WorkersCount() const EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+private:
+    void Loop() EXCLUSIVE_LOCKS_REQUIRED(!m_mutex);
+
+    const std::string m_name;
+
+    mutable Mutex m_mutex;
+    std::condition_variable m_cv;
+    std::deque<std::function<void()>> m_tasks GUARDED_BY(m_mutex);
+    bool m_running GUARDED_BY(m_mutex){false};
+    std::vector<std::thread> m_workers GUARDED_BY(m_mutex);
+};
+
+#endif // BITCOIN_UTIL_THREADPOOL_H
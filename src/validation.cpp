@@ -27,11 +27,13 @@
 #include <consensus/tx_check.h>
 #include <consensus/tx_verify.h>
 #include <consensus/validation.h>
+#include <crypto/scrypt.h>
 #include <hash.h>
 #include <kernel/notifications_interface.h>
 #include <logging.h>
 #include <logging/timer.h>
 #include <minerfund.h>
+#include <node/block_read_ahead.h>
 #include <node/blockstorage.h>
 #include <node/utxo_snapshot.h>
 #include <policy/block/minerfund.h>
@@ -1548,7 +1550,7 @@ Amount GetBlockSubsidy(int nHeight, const Consensus::Params &consensusParams,
 
 CoinsViews::CoinsViews(DBParams db_params, CoinsViewOptions options)
     : m_dbview{std::move(db_params), std::move(options)},
-      m_catcherview(&m_dbview) {}
+      m_flushview(&m_dbview), m_catcherview(&m_flushview) {}
 
 void CoinsViews::InitCache() {
     AssertLockHeld(::cs_main);
@@ -1771,6 +1773,19 @@ bool CScriptCheck::operator()() {
                       metrics, &error)) {
         return false;
     }
+    return ConsumeSigChecks();
+}
+
+bool CScriptCheck::RunDeferred(SchnorrBatch &batch) {
+    const CScript &scriptSig = ptxTo->vin[nIn].scriptSig;
+    return VerifyScript(scriptSig, m_tx_out.scriptPubKey, nFlags,
+                        BatchingTransactionSignatureChecker(
+                            ptxTo, nIn, m_tx_out.nValue, cacheStore, txdata,
+                            batch),
+                        metrics, &error);
+}
+
+bool CScriptCheck::ConsumeSigChecks() {
     if ((pTxLimitSigChecks &&
          !pTxLimitSigChecks->consume_and_check(metrics.nSigChecks)) ||
         (pBlockLimitSigChecks &&
@@ -1784,6 +1799,35 @@ bool CScriptCheck::operator()() {
     return true;
 }
 
+bool CBatchedScriptCheck::operator()() {
+    SchnorrBatch batch;
+    bool fDeferredOk = true;
+    for (CScriptCheck &check : m_checks) {
+        if (!check.RunDeferred(batch)) {
+            fDeferredOk = false;
+            break;
+        }
+    }
+    if (fDeferredOk && batch.Verify()) {
+        for (CScriptCheck &check : m_checks) {
+            if (!check.ConsumeSigChecks()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Either a signature is invalid or a script failed while assuming its
+    // signatures were valid. Neither necessarily makes a script fail, so
+    // settle it by verifying each signature individually.
+    for (CScriptCheck &check : m_checks) {
+        if (!check()) {
+            return false;
+        }
+    }
+    return true;
+}
+
 bool CheckInputScripts(const CTransaction &tx, TxValidationState &state,
                        const CCoinsViewCache &inputs, const uint32_t flags,
                        bool sigCacheStore, bool scriptCacheStore,
@@ -2016,21 +2060,45 @@ DisconnectResult ApplyBlockUndo(CBlockUndo &&blockUndo, const CBlock &block,
     return fClean ? DisconnectResult::OK : DisconnectResult::UNCLEAN;
 }
 
+/**
+ * Checks the PoW of up to SCRYPT_MAX_LANES headers, so their scrypt hashes
+ * can be computed together on the multi-lane kernels.
+ */
 class CPowCheck {
 private:
-    CBlockHeader m_header;
+    std::vector<CBlockHeader> m_headers;
     Consensus::Params m_consensusParams;
 
 public:
-    CPowCheck(CBlockHeader header, Consensus::Params consensusParams)
-        : m_header(header), m_consensusParams(consensusParams) {}
+    CPowCheck(std::vector<CBlockHeader> headers,
+              Consensus::Params consensusParams)
+        : m_headers(std::move(headers)), m_consensusParams(consensusParams) {}
 
     bool operator()() {
-        return CheckAuxProofOfWork(m_header, m_consensusParams);
+        std::vector<const CBaseBlockHeader *> powHeaders;
+        powHeaders.reserve(m_headers.size());
+        for (const CBlockHeader &header : m_headers) {
+            powHeaders.push_back(&GetPowHeader(header));
+        }
+        const std::vector<BlockHash> powHashes = GetPowHashes(powHeaders);
+        for (size_t i = 0; i < m_headers.size(); ++i) {
+            if (!CheckAuxProofOfWork(m_headers[i], powHashes[i],
+                                     m_consensusParams)) {
+                return false;
+            }
+        }
+        return true;
     }
 };
 
-static CCheckQueue<CScriptCheck> scriptcheckqueue(128);
+static CCheckQueue<CBatchedScriptCheck> scriptcheckqueue(128);
+
+/**
+ * Number of script checks grouped into a CBatchedScriptCheck. Larger groups
+ * make batch verification cheaper per signature, but leave fewer units of work
+ * to spread over the script check threads.
+ */
+static constexpr size_t SCRIPT_CHECKS_PER_BATCH = 32;
 
 void StartScriptCheckWorkerThreads(int threads_num) {
     scriptcheckqueue.StartWorkerThreads(threads_num);
@@ -2050,6 +2118,109 @@ void StopPowCheckWorkerThreads() {
     powcheckqueue.StopWorkerThreads();
 }
 
+/**
+ * Reads a chunk of the coins spent by a block from the coins database, so the
+ * lookups can run concurrently ahead of the serial loop in ConnectBlock. Each
+ * check only writes to its own slots of the result vector.
+ */
+class CCoinPrefetch {
+private:
+    const CCoinsView *m_db;
+    const std::vector<COutPoint> *m_outpoints;
+    std::vector<std::optional<Coin>> *m_coins;
+    size_t m_begin;
+    size_t m_end;
+
+public:
+    CCoinPrefetch(const CCoinsView &db, const std::vector<COutPoint> &outpoints,
+                  std::vector<std::optional<Coin>> &coins, size_t begin,
+                  size_t end)
+        : m_db(&db), m_outpoints(&outpoints), m_coins(&coins), m_begin(begin),
+          m_end(end) {}
+
+    bool operator()() {
+        for (size_t i = m_begin; i < m_end; ++i) {
+            Coin coin;
+            try {
+                if (m_db->GetCoin((*m_outpoints)[i], coin)) {
+                    (*m_coins)[i] = std::move(coin);
+                }
+            } catch (const std::exception &) {
+                // Leave the coin to the serial lookup, which reports read
+                // errors through CCoinsViewErrorCatcher.
+            }
+        }
+        return true;
+    }
+};
+
+static CCheckQueue<CCoinPrefetch> coinprefetchqueue(8);
+
+void StartCoinPrefetchWorkerThreads(int threads_num) {
+    coinprefetchqueue.StartWorkerThreads(threads_num);
+}
+
+void StopCoinPrefetchWorkerThreads() {
+    coinprefetchqueue.StopWorkerThreads();
+}
+
+/** Number of outpoints looked up by a single CCoinPrefetch. */
+static constexpr size_t COIN_PREFETCH_CHUNK_SIZE = 16;
+
+/**
+ * Load the coins spent by a block that are in neither view nor tip into the
+ * tip cache, reading them from db on the prefetch worker threads. Outputs
+ * created by the block itself are skipped as they are already in view.
+ * Returns the number of coins that were loaded.
+ */
+static size_t PrefetchBlockCoins(const CBlock &block,
+                                 const CCoinsViewCache &view,
+                                 CCoinsViewCache &tip, const CCoinsView &db) {
+    if (!coinprefetchqueue.HasThreads()) {
+        return 0;
+    }
+
+    std::vector<COutPoint> outpoints;
+    for (const auto &ptx : block.vtx) {
+        if (ptx->IsCoinBase()) {
+            continue;
+        }
+        for (const CTxIn &txin : ptx->vin) {
+            if (!view.HaveCoinInCache(txin.prevout) &&
+                !tip.HaveCoinInCache(txin.prevout)) {
+                outpoints.push_back(txin.prevout);
+            }
+        }
+    }
+    if (outpoints.empty()) {
+        return 0;
+    }
+
+    std::vector<std::optional<Coin>> coins(outpoints.size());
+    {
+        CCheckQueueControl<CCoinPrefetch> control(&coinprefetchqueue);
+        std::vector<CCoinPrefetch> vChecks;
+        vChecks.reserve((outpoints.size() + COIN_PREFETCH_CHUNK_SIZE - 1) /
+                        COIN_PREFETCH_CHUNK_SIZE);
+        for (size_t i = 0; i < outpoints.size(); i += COIN_PREFETCH_CHUNK_SIZE) {
+            vChecks.emplace_back(
+                db, outpoints, coins, i,
+                std::min(i + COIN_PREFETCH_CHUNK_SIZE, outpoints.size()));
+        }
+        control.Add(std::move(vChecks));
+        control.Wait();
+    }
+
+    size_t loaded = 0;
+    for (size_t i = 0; i < outpoints.size(); ++i) {
+        if (coins[i]) {
+            tip.PrefetchCoin(outpoints[i], std::move(*coins[i]));
+            ++loaded;
+        }
+    }
+    return loaded;
+}
+
 // Returns the script flags which should be checked for the block after
 // the given block.
 static uint32_t GetNextBlockScriptFlags(const CBlockIndex *pindex,
@@ -2131,6 +2302,7 @@ static int64_t nTimeCheck = 0;
 static int64_t nTimeForks = 0;
 static int64_t nTimeVerify = 0;
 static int64_t nTimeConnect = 0;
+static int64_t nTimePrefetch = 0;
 static int64_t nTimeIndex = 0;
 static int64_t nTimeTotal = 0;
 static int64_t nBlocksTotal = 0;
@@ -2358,8 +2530,31 @@ bool Chainstate::ConnectBlock(const CBlock &block, BlockValidationState &state,
     CBlockUndo blockundo;
     blockundo.vtxundo.resize(block.vtx.size() - 1);
 
-    CCheckQueueControl<CScriptCheck> control(fScriptChecks ? &scriptcheckqueue
-                                                           : nullptr);
+    CCheckQueueControl<CBatchedScriptCheck> control(
+        fScriptChecks ? &scriptcheckqueue : nullptr);
+    std::vector<CScriptCheck> vPendingChecks;
+    // Queue the pending checks in groups of SCRIPT_CHECKS_PER_BATCH, splitting
+    // the checks of large transactions so they still spread over the threads.
+    // A partial group is kept for the next transaction unless fFlushAll is set.
+    const auto AddPendingChecks = [&](bool fFlushAll) {
+        std::vector<CBatchedScriptCheck> vBatch;
+        auto it = vPendingChecks.begin();
+        while (it != vPendingChecks.end()) {
+            const size_t count = std::min<size_t>(
+                SCRIPT_CHECKS_PER_BATCH, vPendingChecks.end() - it);
+            if (count < SCRIPT_CHECKS_PER_BATCH && !fFlushAll) {
+                break;
+            }
+            vBatch.emplace_back(std::vector<CScriptCheck>(
+                std::make_move_iterator(it),
+                std::make_move_iterator(it + count)));
+            it += count;
+        }
+        vPendingChecks.erase(vPendingChecks.begin(), it);
+        if (!vBatch.empty()) {
+            control.Add(std::move(vBatch));
+        }
+    };
 
     // Add all outputs
     try {
@@ -2380,6 +2575,19 @@ bool Chainstate::ConnectBlock(const CBlock &block, BlockValidationState &state,
                              "tx-duplicate");
     }
 
+    // Resolve the coins this block spends concurrently, so the loop below
+    // finds them in the cache instead of reading them one at a time.
+    int64_t nTimePrefetchStart = GetTimeMicros();
+    const size_t nPrefetched =
+        PrefetchBlockCoins(block, view, CoinsTip(), CoinsErrorCatcher());
+    int64_t nTimePrefetchEnd = GetTimeMicros();
+    nTimePrefetch += nTimePrefetchEnd - nTimePrefetchStart;
+    LogPrint(BCLog::BENCH,
+             "      - Prefetch %u coins: %.2fms [%.2fs (%.2fms/blk)]\n",
+             (unsigned)nPrefetched,
+             MILLI * (nTimePrefetchEnd - nTimePrefetchStart),
+             nTimePrefetch * MICRO, nTimePrefetch * MILLI / nBlocksTotal);
+
     uint64_t nSigOps = 0;
     size_t txIndex = 0;
     // nSigChecksRet may be accurate (found in cache) or 0 (checks were
@@ -2476,7 +2684,10 @@ bool Chainstate::ConnectBlock(const CBlock &block, BlockValidationState &state,
                 tx.GetId().ToString(), state.ToString());
         }
 
-        control.Add(std::move(vChecks));
+        vPendingChecks.insert(vPendingChecks.end(),
+                              std::make_move_iterator(vChecks.begin()),
+                              std::make_move_iterator(vChecks.end()));
+        AddPendingChecks(/*fFlushAll=*/false);
 
         // Note: this must execute in the same iteration as CheckTxInputs (not
         // in a separate loop) in order to detect double spends. However,
@@ -2486,6 +2697,7 @@ bool Chainstate::ConnectBlock(const CBlock &block, BlockValidationState &state,
         SpendCoins(view, tx, blockundo.vtxundo.at(txIndex), pindex->nHeight);
         txIndex++;
     }
+    AddPendingChecks(/*fFlushAll=*/true);
 
     int64_t nTime3 = GetTimeMicros();
     nTimeConnect += nTime3 - nTime2;
@@ -2568,7 +2780,9 @@ Chainstate::GetCoinsCacheSizeState(size_t max_coins_cache_size_bytes,
                                    size_t max_mempool_size_bytes) {
     AssertLockHeld(::cs_main);
     int64_t nMempoolUsage = m_mempool ? m_mempool->DynamicMemoryUsage() : 0;
-    int64_t cacheSize = CoinsTip().DynamicMemoryUsage();
+    // Coins still being flushed in the background count towards the limit.
+    int64_t cacheSize = CoinsTip().DynamicMemoryUsage() +
+                        CoinsFlushView().DynamicMemoryUsage();
     int64_t nTotalSpace =
         max_coins_cache_size_bytes +
         std::max<int64_t>(int64_t(max_mempool_size_bytes) - nMempoolUsage, 0);
@@ -2605,6 +2819,10 @@ bool Chainstate::FlushStateToDisk(BlockValidationState &state,
             bool fDoFullFlush = false;
 
             CoinsCacheSizeState cache_state = GetCoinsCacheSizeState();
+            // Don't queue up flushes behind a background one unless we have
+            // to.
+            const bool background_flush_running =
+                CoinsFlushView().IsFlushing();
             LOCK(m_blockman.cs_LastBlockFile);
             if (m_blockman.IsPruneMode() &&
                 (m_blockman.m_check_for_pruning || nManualPruneHeight > 0) &&
@@ -2672,7 +2890,8 @@ bool Chainstate::FlushStateToDisk(BlockValidationState &state,
             // The cache is large and we're within 10% and 10 MiB of the limit,
             // but we have time now (not in the middle of a block processing).
             bool fCacheLarge = mode == FlushStateMode::PERIODIC &&
-                               cache_state >= CoinsCacheSizeState::LARGE;
+                               cache_state >= CoinsCacheSizeState::LARGE &&
+                               !background_flush_running;
             // The cache is over the limit, we have to write now.
             bool fCacheCritical = mode == FlushStateMode::IF_NEEDED &&
                                   cache_state >= CoinsCacheSizeState::CRITICAL;
@@ -2682,8 +2901,10 @@ bool Chainstate::FlushStateToDisk(BlockValidationState &state,
                                   nNow > m_last_write + DATABASE_WRITE_INTERVAL;
             // It's been very long since we flushed the cache. Do this
             // infrequently, to optimize cache usage.
-            bool fPeriodicFlush = mode == FlushStateMode::PERIODIC &&
-                                  nNow > m_last_flush + DATABASE_FLUSH_INTERVAL;
+            bool fPeriodicFlush =
+                mode == FlushStateMode::PERIODIC &&
+                nNow > m_last_flush + DATABASE_FLUSH_INTERVAL &&
+                !background_flush_running;
             // Combine all conditions that result in a full cache flush.
             fDoFullFlush = (mode == FlushStateMode::ALWAYS) || fCacheLarge ||
                            fCacheCritical || fPeriodicFlush || fFlushForPrune;
@@ -2745,12 +2966,28 @@ bool Chainstate::FlushStateToDisk(BlockValidationState &state,
                 }
 
                 // Flush the chainstate (which may refer to block index
-                // entries).
-                if (!CoinsTip().Flush()) {
-                    return AbortNode(state, "Failed to write to coin database");
+                // entries). Unless we have to be done with it before
+                // returning, it is written in the background while validation
+                // continues on an empty cache.
+                if (mode == FlushStateMode::ALWAYS || fFlushForPrune) {
+                    if (!CoinsTip().Flush()) {
+                        return AbortNode(state,
+                                         "Failed to write to coin database");
+                    }
+                    full_flush_completed = true;
+                } else {
+                    if (!CoinsFlushView().BatchWriteInBackground(
+                            CoinsTip().Detach(),
+                            [locator = m_chain.GetLocator()] {
+                                // Update best block in wallet (so we can
+                                // detect restored wallets).
+                                GetMainSignals().ChainStateFlushed(locator);
+                            })) {
+                        return AbortNode(state,
+                                         "Failed to write to coin database");
+                    }
                 }
                 m_last_flush = nNow;
-                full_flush_completed = true;
             }
 
             TRACE5(utxocache, flush,
@@ -2790,21 +3027,23 @@ void Chainstate::PruneAndFlush() {
 static void UpdateTipLog(const CCoinsViewCache &coins_tip,
                          const CBlockIndex *tip, const CChainParams &params,
                          const std::string &func_name,
-                         const std::string &prefix)
+                         const std::string &prefix,
+                         std::chrono::microseconds read_stall)
     EXCLUSIVE_LOCKS_REQUIRED(::cs_main) {
     AssertLockHeld(::cs_main);
     LogPrintf("%s%s: new best=%s height=%d version=0x%08x log2_work=%f tx=%ld "
-              "date='%s' progress=%f cache=%.1fMiB(%utxo)\n",
+              "date='%s' progress=%f cache=%.1fMiB(%utxo) read_stall=%.2fms\n",
               prefix, func_name, tip->GetBlockHash().ToString(), tip->nHeight,
               tip->nVersion, log(tip->nChainWork.getdouble()) / log(2.0),
               tip->GetChainTxCount(),
               FormatISO8601DateTime(tip->GetBlockTime()),
               GuessVerificationProgress(params.TxData(), tip),
               coins_tip.DynamicMemoryUsage() * (1.0 / (1 << 20)),
-              coins_tip.GetCacheSize());
+              coins_tip.GetCacheSize(), count_microseconds(read_stall) * MILLI);
 }
 
-void Chainstate::UpdateTip(const CBlockIndex *pindexNew) {
+void Chainstate::UpdateTip(const CBlockIndex *pindexNew,
+                           std::chrono::microseconds read_stall) {
     AssertLockHeld(::cs_main);
     const auto &coins_tip = CoinsTip();
 
@@ -2818,7 +3057,7 @@ void Chainstate::UpdateTip(const CBlockIndex *pindexNew) {
         constexpr int BACKGROUND_LOG_INTERVAL = 2000;
         if (pindexNew->nHeight % BACKGROUND_LOG_INTERVAL == 0) {
             UpdateTipLog(coins_tip, pindexNew, params, __func__,
-                         "[background validation] ");
+                         "[background validation] ", read_stall);
         }
         return;
     }
@@ -2834,7 +3073,7 @@ void Chainstate::UpdateTip(const CBlockIndex *pindexNew) {
         g_best_block_cv.notify_all();
     }
 
-    UpdateTipLog(coins_tip, pindexNew, params, __func__, "");
+    UpdateTipLog(coins_tip, pindexNew, params, __func__, "", read_stall);
 }
 
 /**
@@ -2940,15 +3179,24 @@ static int64_t nTimeFlush = 0;
 static int64_t nTimeChainState = 0;
 static int64_t nTimePostConnect = 0;
 
+/**
+ * Memory usage of the blocks read ahead of the one being connected in
+ * ActivateBestChain. The next block is always read regardless.
+ */
+static constexpr size_t BLOCK_READ_AHEAD_MAX_USAGE{64 << 20};
+
 /**
  * Connect a new block to m_chain. pblock is either nullptr or a pointer to
  * a CBlock corresponding to pindexNew, to bypass loading it again from disk.
+ * Otherwise the block is taken from read_ahead if it was scheduled there, and
+ * read from disk as a last resort.
  */
 bool Chainstate::ConnectTip(BlockValidationState &state,
                             BlockPolicyValidationState &blockPolicyState,
                             CBlockIndex *pindexNew,
                             const std::shared_ptr<const CBlock> &pblock,
                             DisconnectedBlockTransactions &disconnectpool,
+                            node::BlockReadAhead &read_ahead,
                             const avalanche::Processor *const avalanche) {
     AssertLockHeld(cs_main);
     if (m_mempool) {
@@ -2961,14 +3209,19 @@ bool Chainstate::ConnectTip(BlockValidationState &state,
     // Read block from disk.
     int64_t nTime1 = GetTimeMicros();
     std::shared_ptr<const CBlock> pthisBlock;
+    std::chrono::microseconds read_stall{0};
     if (!pblock) {
+        pthisBlock = read_ahead.Take(*pindexNew, read_stall);
+    } else {
+        pthisBlock = pblock;
+    }
+    if (!pthisBlock) {
         std::shared_ptr<CBlock> pblockNew = std::make_shared<CBlock>();
         if (!m_blockman.ReadBlockFromDisk(*pblockNew, *pindexNew)) {
             return AbortNode(state, "Failed to read block");
         }
         pthisBlock = pblockNew;
-    } else {
-        pthisBlock = pblock;
+        read_stall = std::chrono::microseconds{GetTimeMicros() - nTime1};
     }
 
     const CBlock &blockConnecting = *pthisBlock;
@@ -3119,7 +3372,7 @@ bool Chainstate::ConnectTip(BlockValidationState &state,
 
     // Update m_chain & related variables.
     m_chain.SetTip(*pindexNew);
-    UpdateTip(pindexNew);
+    UpdateTip(pindexNew, read_stall);
 
     int64_t nTime6 = GetTimeMicros();
     nTimePostConnect += nTime6 - nTime5;
@@ -3337,6 +3590,7 @@ void Chainstate::PruneBlockIndexCandidates() {
 bool Chainstate::ActivateBestChainStep(
     BlockValidationState &state, CBlockIndex *pindexMostWork,
     const std::shared_ptr<const CBlock> &pblock, bool &fInvalidFound,
+    node::BlockReadAhead &read_ahead,
     const avalanche::Processor *const avalanche) {
     AssertLockHeld(cs_main);
     if (m_mempool) {
@@ -3394,6 +3648,22 @@ bool Chainstate::ActivateBestChainStep(
 
         nHeight = nTargetHeight;
 
+        // Start reading the blocks we don't have yet in the background, so
+        // they are ready by the time we get to connect them.
+        std::vector<node::BlockReadAhead::Request> read_requests;
+        for (const CBlockIndex *pindex : reverse_iterate(vpindexToConnect)) {
+            if ((pindex == pindexMostWork && pblock) ||
+                !pindex->nStatus.hasData()) {
+                continue;
+            }
+            read_requests.push_back(
+                {pindex, pindex->GetBlockPos(), pindex->GetBlockHash(),
+                 /*check_pow=*/!pindex->IsValid(BlockValidity::TRANSACTIONS)});
+        }
+        if (!read_requests.empty()) {
+            read_ahead.Schedule(std::move(read_requests));
+        }
+
         // Connect new blocks.
         for (CBlockIndex *pindexConnect : reverse_iterate(vpindexToConnect)) {
             BlockPolicyValidationState blockPolicyState;
@@ -3401,7 +3671,7 @@ bool Chainstate::ActivateBestChainStep(
                             pindexConnect == pindexMostWork
                                 ? pblock
                                 : std::shared_ptr<const CBlock>(),
-                            disconnectpool, avalanche)) {
+                            disconnectpool, read_ahead, avalanche)) {
                 if (state.IsInvalid()) {
                     // The block violates a consensus rule.
                     if (state.GetResult() !=
@@ -3541,6 +3811,10 @@ bool Chainstate::ActivateBestChain(BlockValidationState &state,
     CBlockIndex *pindexMostWork = nullptr;
     CBlockIndex *pindexNewTip = nullptr;
     int nStopAtHeight = gArgs.GetIntArg("-stopatheight", DEFAULT_STOPATHEIGHT);
+    // Outlives the steps below so blocks keep being read while cs_main is
+    // released between them. Its thread is only started if there is more than
+    // the new block to read.
+    node::BlockReadAhead read_ahead{m_blockman, BLOCK_READ_AHEAD_MAX_USAGE};
     do {
         // Block until the validation queue drains. This should largely
         // never happen in normal operation, however may happen during
@@ -3586,7 +3860,7 @@ bool Chainstate::ActivateBestChain(BlockValidationState &state,
                                       pindexMostWork->GetBlockHash()
                             ? pblock
                             : nullBlockPtr,
-                        fInvalidFound, avalanche)) {
+                        fInvalidFound, read_ahead, avalanche)) {
                     // A system error occurred
                     return false;
                 }
@@ -4289,10 +4563,14 @@ bool CheckBlock(const CBlock &block, BlockValidationState &state,
 bool HasValidProofOfWork(const std::vector<CBlockHeader> &headers,
                          const Consensus::Params &consensusParams) {
     // Validate PoW in parallel. On Dogecoin, the PoW is very expensive.
+    // Each check hashes a full set of scrypt lanes at once.
     CCheckQueueControl<CPowCheck> control(&powcheckqueue);
     std::vector<CPowCheck> vChecks;
-    for (const CBlockHeader &header : headers) {
-        vChecks.emplace_back(header, consensusParams);
+    for (size_t i = 0; i < headers.size(); i += SCRYPT_MAX_LANES) {
+        const size_t end = std::min(headers.size(), i + SCRYPT_MAX_LANES);
+        vChecks.emplace_back(std::vector<CBlockHeader>(headers.begin() + i,
+                                                       headers.begin() + end),
+                             consensusParams);
     }
     control.Add(std::move(vChecks));
     return control.Wait();
@@ -41,6 +41,7 @@
 #include <util/translation.h>
 
 #include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <map>
 #include <memory>
@@ -57,6 +58,7 @@ class CChainParams;
 class Chainstate;
 class ChainstateManager;
 class CScriptCheck;
+class SchnorrBatch;
 class CTxMemPool;
 class CTxUndo;
 class DisconnectedBlockTransactions;
@@ -67,6 +69,7 @@ struct PrecomputedTransactionData;
 struct LockPoints;
 struct AssumeutxoData;
 namespace node {
+class BlockReadAhead;
 class SnapshotMetadata;
 } // namespace node
 namespace Consensus {
@@ -83,6 +86,10 @@ class Processor;
 static const int MAX_SCRIPTCHECK_THREADS = 15;
 /** -par default (number of script-checking threads, 0 = auto) */
 static const int DEFAULT_SCRIPTCHECK_THREADS = 0;
+/** Maximum number of dedicated coin prefetch threads allowed */
+static const int MAX_COINPREFETCH_THREADS = 15;
+/** -parprefetch default (number of coin prefetch threads, 0 = auto) */
+static const int DEFAULT_COINPREFETCH_THREADS = 0;
 
 static const bool DEFAULT_PEERBLOOMFILTERS = true;
 
@@ -166,6 +173,13 @@ void StartPowCheckWorkerThreads(int threads_num);
 void StopScriptCheckWorkerThreads();
 void StopPowCheckWorkerThreads();
 
+/**
+ * Run/stop the worker threads that read the coins spent by a block from the
+ * coins database before it is connected
+ */
+void StartCoinPrefetchWorkerThreads(int threads_num);
+void StopCoinPrefetchWorkerThreads();
+
 Amount GetBlockSubsidy(int nHeight, const Consensus::Params &consensusParams,
                        uint256 prevHash);
 
@@ -556,6 +570,16 @@ public:
 
     bool operator()();
 
+    /**
+     * Run the script, adding the Schnorr signatures to batch instead of
+     * verifying them. The sigchecks are not counted until ConsumeSigChecks()
+     * is called.
+     */
+    bool RunDeferred(SchnorrBatch &batch);
+
+    /** Count the sigchecks of the last run against the limiters. */
+    bool ConsumeSigChecks();
+
     ScriptError GetScriptError() const { return error; }
 
     ScriptExecutionMetrics GetScriptExecutionMetrics() const { return metrics; }
@@ -566,6 +590,22 @@ static_assert(std::is_nothrow_move_assignable_v<CScriptCheck>);
 static_assert(std::is_nothrow_move_constructible_v<CScriptCheck>);
 static_assert(std::is_nothrow_destructible_v<CScriptCheck>);
 
+/**
+ * A group of script checks whose Schnorr signatures are verified as a single
+ * batch. If the batch or any of the scripts fail, the checks are run again one
+ * by one, so the outcome is the same as running them separately.
+ */
+class CBatchedScriptCheck {
+private:
+    std::vector<CScriptCheck> m_checks;
+
+public:
+    explicit CBatchedScriptCheck(std::vector<CScriptCheck> &&checks)
+        : m_checks(std::move(checks)) {}
+
+    bool operator()();
+};
+
 /** Functions for validating blocks and updating the block tree */
 
 /**
@@ -655,6 +695,10 @@ public:
     //! database on disk. All unspent coins reside in this store.
     CCoinsViewDB m_dbview GUARDED_BY(cs_main);
 
+    //! This view holds the coins of a cache flush while they are written to
+    //! the leveldb instance in the background.
+    CCoinsViewBackgroundFlush m_flushview GUARDED_BY(cs_main);
+
     //! This view wraps access to the leveldb instance and handles read errors
     //! gracefully.
     CCoinsViewErrorCatcher m_catcherview GUARDED_BY(cs_main);
@@ -663,12 +707,12 @@ public:
     //! memory as can fit per the dbcache setting.
     std::unique_ptr<CCoinsViewCache> m_cacheview GUARDED_BY(cs_main);
 
-    //! This constructor initializes CCoinsViewDB and CCoinsViewErrorCatcher
-    //! instances, but it *does not* create a CCoinsViewCache instance by
-    //! default. This is done separately because the presence of the cache has
-    //! implications on whether or not we're allowed to flush the cache's state
-    //! to disk, which should not be done until the health of the database is
-    //! verified.
+    //! This constructor initializes CCoinsViewDB, CCoinsViewBackgroundFlush
+    //! and CCoinsViewErrorCatcher instances, but it *does not* create a
+    //! CCoinsViewCache instance by default. This is done separately because
+    //! the presence of the cache has implications on whether or not we're
+    //! allowed to flush the cache's state to disk, which should not be done
+    //! until the health of the database is verified.
     //!
     //! All arguments forwarded onto CCoinsViewDB.
     CoinsViews(DBParams db_params, CoinsViewOptions options);
@@ -840,10 +884,20 @@ public:
         return *Assert(m_coins_views->m_cacheview);
     }
 
-    //! @returns A reference to the on-disk UTXO set database.
+    //! @returns A reference to the on-disk UTXO set database, once any
+    //! background flush to it has completed.
     CCoinsViewDB &CoinsDB() EXCLUSIVE_LOCKS_REQUIRED(::cs_main) {
         AssertLockHeld(::cs_main);
-        return Assert(m_coins_views)->m_dbview;
+        Assert(m_coins_views)->m_flushview.Wait();
+        return m_coins_views->m_dbview;
+    }
+
+    //! @returns A reference to the view writing coins cache flushes to the
+    //! on-disk UTXO set database.
+    CCoinsViewBackgroundFlush &CoinsFlushView()
+        EXCLUSIVE_LOCKS_REQUIRED(::cs_main) {
+        AssertLockHeld(::cs_main);
+        return Assert(m_coins_views)->m_flushview;
     }
 
     //! @returns A pointer to the mempool.
@@ -1110,6 +1164,7 @@ private:
     bool ActivateBestChainStep(
         BlockValidationState &state, CBlockIndex *pindexMostWork,
         const std::shared_ptr<const CBlock> &pblock, bool &fInvalidFound,
+        node::BlockReadAhead &read_ahead,
         const avalanche::Processor *const avalanche = nullptr)
         EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_mempool->cs,
                                  !cs_avalancheFinalizedBlockIndex);
@@ -1118,6 +1173,7 @@ private:
                     CBlockIndex *pindexNew,
                     const std::shared_ptr<const CBlock> &pblock,
                     DisconnectedBlockTransactions &disconnectpool,
+                    node::BlockReadAhead &read_ahead,
                     const avalanche::Processor *const avalanche = nullptr)
         EXCLUSIVE_LOCKS_REQUIRED(cs_main, m_mempool->cs,
                                  !cs_avalancheFinalizedBlockIndex);
@@ -1154,8 +1210,12 @@ private:
 
     /**
      * Check warning conditions and do some notifications on new chain tip set.
+     * read_stall is the time spent waiting for the block data, if it was
+     * just connected.
      */
-    void UpdateTip(const CBlockIndex *pindexNew)
+    void UpdateTip(const CBlockIndex *pindexNew,
+                   std::chrono::microseconds read_stall =
+                       std::chrono::microseconds{0})
         EXCLUSIVE_LOCKS_REQUIRED(::cs_main);
 
     std::chrono::microseconds m_last_write{0};
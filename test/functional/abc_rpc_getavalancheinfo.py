@@ -20,6 +20,7 @@ from test_framework.p2p import P2PInterface
 from test_framework.test_framework import BitcoinTestFramework
 from test_framework.util import (
     assert_equal,
+    assert_greater_than_or_equal,
     assert_raises_rpc_error,
     try_rpc,
     uint256_hex,
@@ -53,8 +54,23 @@ class GetAvalancheInfoTest(BitcoinTestFramework):
 
         privkey, proof = gen_proof(self, node, expiry=2000000000)
 
+        def get_avalancheinfo():
+            info = node.getavalancheinfo()
+            # The proof revalidation statistics depend on timing
+            assert_equal(
+                set(info.pop("proof_revalidation").keys()),
+                {
+                    "count",
+                    "total_duration",
+                    "last_duration",
+                    "last_checked_proof_count",
+                    "last_incremental",
+                },
+            )
+            return info
+
         def assert_avalancheinfo(expected):
-            assert_equal(node.getavalancheinfo(), expected)
+            assert_equal(get_avalancheinfo(), expected)
 
         coinbase_amount = Decimal("25000000.00")
 
@@ -240,7 +256,7 @@ class GetAvalancheInfoTest(BitcoinTestFramework):
         self.log.info("Mine a block to trigger proof validation, check it is immature")
         self.generate(node, 1, sync_fun=self.no_op)
         self.wait_until(
-            lambda: node.getavalancheinfo()
+            lambda: get_avalancheinfo()
             == {
                 "ready_to_poll": False,
                 "local": {
@@ -275,7 +291,7 @@ class GetAvalancheInfoTest(BitcoinTestFramework):
         )
         self.generate(node, 1, sync_fun=self.no_op)
         self.wait_until(
-            lambda: node.getavalancheinfo()
+            lambda: get_avalancheinfo()
             == {
                 "ready_to_poll": False,
                 "local": {
@@ -308,7 +324,7 @@ class GetAvalancheInfoTest(BitcoinTestFramework):
         self.log.info("Mine another block to mature the local proof")
         self.generate(node, 1, sync_fun=self.no_op)
         self.wait_until(
-            lambda: node.getavalancheinfo()
+            lambda: get_avalancheinfo()
             == {
                 "ready_to_poll": False,
                 "local": {
@@ -383,7 +399,7 @@ class GetAvalancheInfoTest(BitcoinTestFramework):
         n.send_avaproof(immature_proof)
 
         self.wait_until(
-            lambda: node.getavalancheinfo()
+            lambda: get_avalancheinfo()
             == {
                 "ready_to_poll": True,
                 "local": {
@@ -421,7 +437,7 @@ class GetAvalancheInfoTest(BitcoinTestFramework):
             n.wait_for_disconnect()
 
         self.wait_until(
-            lambda: node.getavalancheinfo()
+            lambda: get_avalancheinfo()
             == {
                 "ready_to_poll": True,
                 "local": {
@@ -602,7 +618,7 @@ class GetAvalancheInfoTest(BitcoinTestFramework):
         node.mockscheduler(AVALANCHE_CLEANUP_INTERVAL)
 
         self.wait_until(
-            lambda: node.getavalancheinfo()
+            lambda: get_avalancheinfo()
             == {
                 "ready_to_poll": False,
                 "local": {
@@ -699,6 +715,22 @@ class GetAvalancheInfoTest(BitcoinTestFramework):
 
         self.wait_until(local_status_invalid)
 
+        self.log.info(
+            "Check only the proofs spent by a new block are checked against the "
+            "UTXO set"
+        )
+        node.syncwithvalidationinterfacequeue()
+        revalidation_count = node.getavalancheinfo()["proof_revalidation"]["count"]
+        self.generate(node, 1, sync_fun=self.no_op)
+        node.syncwithvalidationinterfacequeue()
+        revalidation = node.getavalancheinfo()["proof_revalidation"]
+        assert_equal(revalidation["count"], revalidation_count + 1)
+        assert_equal(revalidation["last_incremental"], True)
+        assert_equal(revalidation["last_checked_proof_count"], 0)
+        assert_greater_than_or_equal(
+            revalidation["total_duration"], revalidation["last_duration"]
+        )
+
 
 if __name__ == "__main__":
     GetAvalancheInfoTest().main()
@@ -65,8 +65,9 @@ class CoinStatsIndexTest(BitcoinTestFramework):
         )
         res0 = node.gettxoutsetinfo("none")
 
-        # The fields 'disk_size' and 'transactions' do not exist on the index
-        del res0["disk_size"], res0["transactions"]
+        # The fields 'disk_size', 'transactions' and 'coins_flush' do not exist
+        # on the index
+        del res0["disk_size"], res0["transactions"], res0["coins_flush"]
 
         for hash_option in index_hash_options:
             res1 = index_node.gettxoutsetinfo(hash_option)
@@ -249,6 +250,7 @@ class CoinStatsIndexTest(BitcoinTestFramework):
             hash_type="muhash", hash_or_height=None, use_index=False
         )
         del res["disk_size"], option_res["disk_size"]
+        del res["coins_flush"], option_res["coins_flush"]
         assert_equal(res, option_res)
 
     def _test_reorg_index(self):
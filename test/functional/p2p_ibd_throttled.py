@@ -0,0 +1,138 @@
+# Copyright (c) 2024 The Bitcoin developers
+# Distributed under the MIT software license, see the accompanying
+# file COPYING or http://www.opensource.org/licenses/mit-license.php.
+"""
+Test that a slow peer does not hold up IBD while a faster peer is available
+"""
+
+import time
+
+from test_framework.blocktools import (
+    VERSION_CHAIN_ID_BITS,
+    create_block,
+    create_coinbase,
+)
+from test_framework.messages import (
+    MSG_BLOCK,
+    MSG_TYPE_MASK,
+    CBlockHeader,
+    msg_block,
+    msg_headers,
+)
+from test_framework.p2p import NetworkThread, P2PDataStore
+from test_framework.test_framework import BitcoinTestFramework
+from test_framework.util import assert_equal, assert_greater_than
+
+
+class P2PThrottled(P2PDataStore):
+    """Send the requested blocks in order, no faster than one every delay
+    seconds."""
+
+    def __init__(self, block_store, delay):
+        super().__init__()
+        self.block_store = block_store
+        self.delay = delay
+        self.next_send_time = 0
+
+    def on_getdata(self, message):
+        loop = NetworkThread.network_event_loop
+        for inv in message.inv:
+            if (inv.type & MSG_TYPE_MASK) != MSG_BLOCK:
+                continue
+            self.getdata_requests.append(inv.hash)
+            self.next_send_time = max(loop.time(), self.next_send_time) + self.delay
+            loop.call_at(self.next_send_time, self.send_block, inv.hash)
+
+    def send_block(self, block_hash):
+        if self.is_connected:
+            self.send_message(msg_block(self.block_store[block_hash]))
+
+    def on_getheaders(self, message):
+        pass
+
+
+class P2PIBDThrottledTest(BitcoinTestFramework):
+    def set_test_params(self):
+        self.setup_clean_chain = True
+        self.num_nodes = 1
+
+    def run_test(self):
+        NUM_BLOCKS = 200
+        SLOW_PEER_DELAY = 1
+        node = self.nodes[0]
+        tip = int(node.getbestblockhash(), 16)
+        height = 1
+        block_time = node.getblock(node.getbestblockhash())["time"] + 1
+        self.log.info("Prepare blocks without sending them to the node")
+        blocks = []
+        block_store = {}
+        for _ in range(NUM_BLOCKS):
+            blocks.append(
+                create_block(
+                    tip,
+                    create_coinbase(height),
+                    block_time,
+                    version=VERSION_CHAIN_ID_BITS | 4,
+                )
+            )
+            blocks[-1].solve()
+            tip = blocks[-1].sha256
+            block_time += 1
+            height += 1
+            block_store[blocks[-1].sha256] = blocks[-1]
+
+        headers_message = msg_headers()
+        headers_message.headers = [CBlockHeader(b) for b in blocks]
+
+        self.log.info("Let a slow peer be asked for the first blocks")
+        slow_peer = node.add_outbound_p2p_connection(
+            P2PThrottled(block_store, SLOW_PEER_DELAY),
+            p2p_idx=0,
+            connection_type="outbound-full-relay",
+        )
+        start_time = time.time()
+        slow_peer.send_message(headers_message)
+        self.wait_until(lambda: len(slow_peer.getdata_requests) == 16)
+        assert_equal(slow_peer.getdata_requests[0], blocks[0].sha256)
+
+        self.log.info("Connect a fast peer and check that IBD completes")
+        fast_peer = node.add_outbound_p2p_connection(
+            P2PThrottled(block_store, 0),
+            p2p_idx=1,
+            connection_type="outbound-full-relay",
+        )
+        fast_peer.send_message(headers_message)
+        self.wait_until(lambda: node.getblockcount() == NUM_BLOCKS)
+        ibd_time = time.time() - start_time
+
+        self.log.info(
+            "Check that the blocks stuck at the slow peer were requested from the "
+            "fast peer"
+        )
+        slow_requests = set(slow_peer.getdata_requests)
+        assert slow_requests & set(fast_peer.getdata_requests)
+        # Had they only been downloaded from the slow peer, it would have taken
+        # at least this long.
+        slow_peer_time = len(slow_requests) * SLOW_PEER_DELAY
+        self.log.info(
+            f"IBD took {ibd_time:.1f}s, the slow peer alone would have taken at "
+            f"least {slow_peer_time}s to send the {len(slow_requests)} blocks "
+            "it was asked for"
+        )
+        assert_greater_than(slow_peer_time, ibd_time)
+
+        self.log.info(
+            "Check that the download rates are reported, and that fewer blocks "
+            "are asked at once from the slow peer"
+        )
+        slow_info, fast_info = node.getpeerinfo()
+        assert_greater_than(
+            fast_info["blockdownloadrate"], slow_info["blockdownloadrate"]
+        )
+        assert_greater_than(slow_info["blockdownloadlatency"], 0)
+        assert_equal(fast_info["inflightlimit"], 16)
+        assert_greater_than(fast_info["inflightlimit"], slow_info["inflightlimit"])
+
+
+if __name__ == "__main__":
+    P2PIBDThrottledTest().main()
@@ -125,6 +125,7 @@ class BlockchainTest(BitcoinTestFramework):
         self.log.info("Test getblockchaininfo")
 
         keys = [
+            "auxpow_header_cache",
             "bestblockhash",
             "blocks",
             "chain",
@@ -296,6 +297,12 @@ class BlockchainTest(BitcoinTestFramework):
         assert size < 64000
         assert_equal(len(res["bestblock"]), 64)
         assert_equal(len(res["hash_serialized"]), 64)
+        coins_flush = res["coins_flush"]
+        assert_greater_than_or_equal(
+            coins_flush["flushes"], coins_flush["background_flushes"]
+        )
+        assert_greater_than_or_equal(coins_flush["last_duration"], 0)
+        assert_greater_than_or_equal(coins_flush["stall_time"], 0)
 
         self.log.info(
             "Test gettxoutsetinfo works for blockchain with just the genesis block"
@@ -319,16 +326,18 @@ class BlockchainTest(BitcoinTestFramework):
         node.reconsiderblock(b1hash)
 
         res3 = node.gettxoutsetinfo()
-        # The field 'disk_size' is non-deterministic and can thus not be
-        # compared between res and res3.  Everything else should be the same.
+        # The fields 'disk_size' and 'coins_flush' are non-deterministic and
+        # can thus not be compared between res and res3.  Everything else
+        # should be the same.
         del res["disk_size"], res3["disk_size"]
+        del res["coins_flush"], res3["coins_flush"]
         assert_equal(res, res3)
 
         self.log.info("Test gettxoutsetinfo hash_type option")
         # Adding hash_type 'hash_serialized', which is the default, should not
         # change the result.
         res4 = node.gettxoutsetinfo(hash_type="hash_serialized")
-        del res4["disk_size"]
+        del res4["disk_size"], res4["coins_flush"]
         assert_equal(res, res4)
 
         # hash_type none should not return a UTXO set hash.
@@ -69,6 +69,7 @@ class NetTest(BitcoinTestFramework):
         self.test_connection_count()
         self.test_getpeerinfo()
         self.test_getnettotals()
+        self.test_getnetmsgstats()
         self.test_getnetworkinfo()
         self.test_getaddednodeinfo()
         self.test_service_flags()
@@ -120,6 +121,49 @@ class NetTest(BitcoinTestFramework):
                 timeout=10,
             )
 
+        # The header and payload of the messages are sent with a single system
+        # call, so each call sends at least a whole message header.
+        net_totals_after = self.nodes[0].getnettotals()
+        assert_greater_than(
+            net_totals_after["totalsendcalls"], net_totals_before["totalsendcalls"]
+        )
+        assert_greater_than(1 / 24, net_totals_after["sendcallsperbyte"])
+
+    def test_getnetmsgstats(self):
+        self.log.info("Test getnetmsgstats")
+        stats_before = self.nodes[0].getnetmsgstats()
+        pongs_before = stats_before["msgtypes"]["pong"]["count"]
+        self.nodes[0].ping()
+        self.wait_until(
+            lambda: self.nodes[0].getnetmsgstats()["msgtypes"]["pong"]["count"]
+            >= pongs_before + 2,
+            timeout=10,
+        )
+
+        stats = self.nodes[0].getnetmsgstats()
+        for msg_type, msg_stats in stats["msgtypes"].items():
+            for timing in ["queuewait", "processing", "cs_main"]:
+                histogram = msg_stats[timing]["histogram"]
+                assert_equal(sum(histogram), msg_stats["count"])
+                assert_greater_than(histogram[-1], 0)
+                assert msg_stats[timing]["total"] >= 0
+
+            peers_count = sum(
+                peer["msgtypes"].get(msg_type, {"count": 0})["count"]
+                for peer in stats["peers"]
+            )
+            assert_equal(peers_count, msg_stats["count"])
+
+        # The version handshake happened with both peers.
+        assert_equal(
+            sorted(peer["id"] for peer in stats["peers"]),
+            sorted(peer["id"] for peer in self.nodes[0].getpeerinfo()),
+        )
+        for peer in stats["peers"]:
+            assert_equal(peer["msgtypes"]["version"]["count"], 1)
+            assert_equal(peer["msgtypes"]["verack"]["count"], 1)
+            assert peer["msgtypes"]["version"]["cs_main"] >= 0
+
     def test_getnetworkinfo(self):
         self.log.info("Test getnetworkinfo")
         info = self.nodes[0].getnetworkinfo()
@@ -254,7 +298,15 @@ class NetTest(BitcoinTestFramework):
         for node, peer, field in product(
             range(self.num_nodes),
             range(2),
-            ["startingheight", "synced_headers", "synced_blocks", "inflight"],
+            [
+                "startingheight",
+                "synced_headers",
+                "synced_blocks",
+                "inflight",
+                "inflightlimit",
+                "blockdownloadrate",
+                "blockdownloadlatency",
+            ],
         ):
             assert field in peer_info[node][peer].keys()
 